@@ -105,7 +105,10 @@ testScripts = [
     'lelantus_setmintstatus_validation.py',
     'lelantus_mintspend.py',
     'lelantus_spend_gettransaction.py',
+    'lelantus_joinsplit_async.py',
+    'lelantus_simulatejoinsplit_locked.py',
     'elysium_create_denomination.py',
+    'elysium_marker_index.py',
     'elysium_property_creation_fee.py',
     'elysium_sendmint.py',
     'elysium_sendmint_wallet_encryption.py',
@@ -174,6 +177,7 @@ testScripts = [
     # 'rpcnamedargs.py',
     'listsinceblock.py',
     'p2p-leaktests.py',
+    'p2p-socketevents.py',
     'notifications.py',
 
     # Firo-specific tests
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+from test_framework.test_framework import ElysiumTestFramework
+from test_framework.util import assert_equal, connect_nodes, start_node, stop_node
+
+class ElysiumMarkerIndexTest(ElysiumTestFramework):
+    def run_test(self):
+        super().run_test()
+
+        self.nodes[0].elysium_sendissuancefixed(
+            self.addrs[0], 1, 1, 0, '', '', 'Token', '', '', '1000000'
+        )
+        self.nodes[0].generate(1)
+        token = 3
+
+        # blocks with and without marked transactions
+        self.nodes[0].elysium_send(self.addrs[0], self.addrs[1], token, '100')
+        self.nodes[0].generate(6)
+
+        self.nodes[0].elysium_send(self.addrs[0], self.addrs[1], token, '20')
+        self.nodes[0].elysium_send(self.addrs[0], self.addrs[1], token, '3')
+        self.nodes[0].generate(1)
+
+        # reorg, the entries of the disconnected block are replaced by the ones of the new block
+        self.nodes[0].elysium_send(self.addrs[0], self.addrs[1], token, '1000')
+        forked_block = self.nodes[0].generate(1)
+        self.nodes[0].invalidateblock(forked_block[0])
+        self.nodes[0].clearmempool()
+
+        self.nodes[0].elysium_send(self.addrs[0], self.addrs[1], token, '4000')
+        self.nodes[0].generate(2)
+        self.sync_all()
+
+        # the send of the disconnected block is not mined again
+        for node in self.nodes:
+            node.clearmempool()
+
+        assert_equal('995877', self.nodes[0].elysium_getbalance(self.addrs[0], token)['balance'])
+        assert_equal('4123', self.nodes[0].elysium_getbalance(self.addrs[1], token)['balance'])
+
+        # reparse the whole chain, reading the marked transactions through the index
+        blockcount = self.nodes[0].getblockcount()
+        stop_node(self.nodes[0], 0)
+        self.nodes[0] = start_node(0, self.options.tmpdir, ['-elysium', '-startclean'])
+        connect_nodes(self.nodes[0], 1)
+
+        assert_equal(blockcount, self.nodes[0].getblockcount())
+        assert_equal('995877', self.nodes[0].elysium_getbalance(self.addrs[0], token)['balance'])
+        assert_equal('4123', self.nodes[0].elysium_getbalance(self.addrs[1], token)['balance'])
+        assert_equal('Token', self.nodes[0].elysium_getproperty(token)['name'])
+
+        # the state keeps following the chain after the reparse
+        self.nodes[0].elysium_send(self.addrs[0], self.addrs[1], token, '1')
+        self.nodes[0].generate(1)
+        self.sync_all()
+
+        assert_equal('995876', self.nodes[0].elysium_getbalance(self.addrs[0], token)['balance'])
+        assert_equal('4124', self.nodes[0].elysium_getbalance(self.addrs[1], token)['balance'])
+        assert_equal('4124', self.nodes[1].elysium_getbalance(self.addrs[1], token)['balance'])
+
+if __name__ == '__main__':
+    ElysiumMarkerIndexTest().main()
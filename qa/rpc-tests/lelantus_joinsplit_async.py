@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+from decimal import *
+import time
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import *
+
+class LelantusJoinSplitAsyncTest(BitcoinTestFramework):
+    def __init__(self):
+        super().__init__()
+        self.num_nodes = 2
+        self.setup_clean_chain = True
+
+    def wait_for_job(self, jobid, timeout=120):
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            job = self.nodes[0].getjoinsplitstatus(jobid)
+            if job['status'] in ('committed', 'failed'):
+                return job
+            time.sleep(0.5)
+        raise AssertionError('Joinsplit job {} did not finish'.format(jobid))
+
+    def run_test(self):
+        self.nodes[0].generate(401)
+        self.sync_all()
+
+        for _ in range(10):
+            self.nodes[0].mintlelantus(1)
+
+        self.nodes[0].generate(10)
+        self.sync_all()
+
+        # two jobs proved at the same time don't spend the same coins
+        addresses = [self.nodes[1].getnewaddress() for _ in range(2)]
+        jobs = [self.nodes[0].joinsplit({address: 1}, [], {}, True) for address in addresses]
+        assert jobs[0] != jobs[1]
+
+        txids = list()
+        for jobid in jobs:
+            job = self.nodes[0].getjoinsplitstatus(jobid)
+            assert_equal(job['jobid'], jobid)
+            job = self.wait_for_job(jobid)
+            assert_equal(job['status'], 'committed')
+            assert 'error' not in job
+            txids.append(job['txid'])
+
+        assert txids[0] != txids[1]
+        for txid in txids:
+            assert txid in self.nodes[0].getrawmempool()
+
+        self.nodes[0].generate(1)
+        self.sync_all()
+
+        for address in addresses:
+            assert_equal(self.nodes[1].getreceivedbyaddress(address, 0), Decimal(1))
+
+        # failures are reported by the job
+        jobid = self.nodes[0].joinsplit({addresses[0]: 100000}, [], {}, True)
+        job = self.wait_for_job(jobid)
+        assert_equal(job['status'], 'failed')
+        assert 'txid' not in job
+
+        assert_raises_jsonrpc(-8, 'Unknown joinsplit job', self.nodes[0].getjoinsplitstatus, '00' * 32)
+
+if __name__ == '__main__':
+    LelantusJoinSplitAsyncTest().main()
@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+from decimal import *
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import *
+
+class LelantusSimulateJoinSplitLockedTest(BitcoinTestFramework):
+    def __init__(self):
+        super().__init__()
+        self.num_nodes = 1
+        self.setup_clean_chain = True
+
+    def run_test(self):
+        self.nodes[0].generate(401)
+
+        self.nodes[0].mintlelantus(1)
+        self.nodes[0].mintlelantus(2)
+        self.nodes[0].generate(2)
+
+        address = self.nodes[0].getnewaddress()
+        expected = self.nodes[0].simulatejoinsplit({address: Decimal('1.5')})
+        assert expected['fee'] > 0
+        assert len(expected['inputs']) > 0
+
+        passphrase = 'test'
+        self.nodes[0].encryptwallet(passphrase)
+        bitcoind_processes[0].wait()
+        self.nodes = start_nodes(self.num_nodes, self.options.tmpdir)
+
+        # the estimation doesn't need the private values of the coins
+        simulated = self.nodes[0].simulatejoinsplit({address: Decimal('1.5')})
+        assert_equal(expected['fee'], simulated['fee'])
+        assert_equal(expected['size'], simulated['size'])
+        assert_equal(expected['inputs'], simulated['inputs'])
+        assert_equal(expected['change'], simulated['change'])
+
+        # while the joinsplit itself does
+        assert_raises_jsonrpc(-13, 'Error: Please enter the wallet passphrase with walletpassphrase first.',
+            self.nodes[0].joinsplit, {address: Decimal('1.5')})
+
+        self.nodes[0].walletpassphrase(passphrase, 10)
+        self.nodes[0].joinsplit({address: Decimal('1.5')})
+
+if __name__ == '__main__':
+    LelantusSimulateJoinSplitLockedTest().main()
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Firo Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+from test_framework.mininode import *
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import *
+
+import sys
+
+'''
+Test that every queued message is sent with -socketevents=epoll
+
+Sockets are registered edge triggered, a socket which stays writable reports no
+new EPOLLOUT event. This test checks that the node answers a burst of pings and
+later pings on the same connection, and that blocks relayed one after another
+reach a peer.
+'''
+
+class PongCounter(SingleNodeConnCB):
+    def __init__(self):
+        super().__init__()
+        self.pongs = set()
+
+    def on_pong(self, conn, message):
+        self.pongs.add(message.nonce)
+
+    def wait_for_pongs(self, nonces, timeout=10):
+        def received():
+            with mininode_lock:
+                return set(nonces).issubset(self.pongs)
+        return wait_until(received, timeout=timeout)
+
+class P2PSocketEventsTest(BitcoinTestFramework):
+
+    def __init__(self):
+        super().__init__()
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+
+    def setup_network(self):
+        args = ["-socketevents=epoll"] if sys.platform.startswith('linux') else []
+        self.nodes = start_nodes(self.num_nodes, self.options.tmpdir, [args] * self.num_nodes)
+        connect_nodes_bi(self.nodes, 0, 1)
+        self.is_network_split = False
+        self.sync_all()
+
+    def run_test(self):
+        if not sys.platform.startswith('linux'):
+            print("Skipping, epoll is only available on Linux")
+            return
+
+        node = PongCounter()
+        connection = NodeConn('127.0.0.1', p2p_port(0), self.nodes[0], node)
+        node.add_connection(connection)
+        NetworkThread().start()
+        node.wait_for_verack()
+
+        # A burst of messages queued back to back on one connection
+        nonces = list(range(1, 21))
+        for nonce in nonces:
+            node.send_message(msg_ping(nonce=nonce))
+        assert(node.wait_for_pongs(nonces))
+
+        # Single messages after the socket went idle and stayed writable
+        for nonce in range(100, 105):
+            time.sleep(0.5)
+            node.send_message(msg_ping(nonce=nonce))
+            assert(node.wait_for_pongs([nonce], timeout=5))
+
+        # Blocks are announced and sent one after another between the nodes
+        for i in range(10):
+            self.nodes[0].generate(1)
+            sync_blocks(self.nodes, timeout=10)
+        self.nodes[1].generate(10)
+        sync_blocks(self.nodes, timeout=10)
+        assert_equal(self.nodes[0].getblockcount(), 20)
+
+if __name__ == '__main__':
+    P2PSocketEventsTest().main()
@@ -19,6 +19,8 @@ class ZMQTest (BitcoinTestFramework):
         self.num_nodes = 4
 
     port = 28332
+    privacyPort = 28333
+    privacyTopics = [b"lelantusmint", b"lelantusspend", b"lelantusgroup", b"sigmamint", b"sigmaspend", b"sigmagroup"]
 
     def setup_nodes(self):
         self.zmqContext = zmq.Context()
@@ -26,8 +28,17 @@ class ZMQTest (BitcoinTestFramework):
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"hashblock")
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"hashtx")
         self.zmqSubSocket.connect("tcp://127.0.0.1:%i" % self.port)
+
+        # the Lelantus and Sigma topics are read from their own socket, so they don't mix with the ones above
+        self.zmqPrivacySocket = self.zmqContext.socket(zmq.SUB)
+        for topic in self.privacyTopics:
+            self.zmqPrivacySocket.setsockopt(zmq.SUBSCRIBE, topic)
+        self.zmqPrivacySocket.setsockopt(zmq.RCVTIMEO, 3000)
+        self.zmqPrivacySocket.connect("tcp://127.0.0.1:%i" % self.privacyPort)
+        privacyArgs = ['-zmqpub%s=tcp://127.0.0.1:%i' % (topic.decode(), self.privacyPort) for topic in self.privacyTopics]
+
         return start_nodes(self.num_nodes, self.options.tmpdir, extra_args=[
-            ['-zmqpubhashtx=tcp://127.0.0.1:'+str(self.port), '-zmqpubhashblock=tcp://127.0.0.1:'+str(self.port)],
+            ['-zmqpubhashtx=tcp://127.0.0.1:'+str(self.port), '-zmqpubhashblock=tcp://127.0.0.1:'+str(self.port)] + privacyArgs,
             [],
             [],
             []
@@ -92,6 +103,97 @@ class ZMQTest (BitcoinTestFramework):
 
         assert_equal(hashRPC, hashZMQ) #blockhash from generate must be equal to the hash received over zmq
 
+        self.test_privacy_notifications()
+
+    # Reads the Lelantus and Sigma notifications until none arrives for a while, returns a list of
+    # (topic, block hash, height, connected, number of changes) in the order they were published
+    def receive_privacy_notifications(self):
+        notifications = []
+        while True:
+            try:
+                msg = self.zmqPrivacySocket.recv_multipart()
+            except zmq.Again:
+                return notifications
+            topic = msg[0]
+            body = msg[1]
+            assert(topic in self.privacyTopics)
+            blockhash = bytes_to_hex_str(body[31::-1])
+            height, connected = struct.unpack('<i?', body[32:37])
+            count = body[37]
+            assert(count < 253)
+            notifications.append((topic, blockhash, height, connected, count))
+
+    def generate_and_receive(self, n=1):
+        hashes = self.nodes[0].generate(n)
+        self.sync_all()
+        return hashes, self.receive_privacy_notifications()
+
+    def test_privacy_notifications(self):
+        # Sigma mints, the first of a denomination starts its group
+        self.nodes[0].mint(2)
+        hashes, notifications = self.generate_and_receive()
+        height = self.nodes[0].getblockcount()
+        assert_equal(sorted(notifications), [
+            (b"sigmagroup", hashes[0], height, True, 1),
+            (b"sigmamint", hashes[0], height, True, 2)])
+
+        # blocks without changes are not published
+        hashes, notifications = self.generate_and_receive(2)
+        assert_equal(notifications, [])
+
+        # the change of the spend is minted again, so only the spent serials are checked
+        myaddr = self.nodes[0].getnewaddress()
+        self.nodes[0].spendmany("", {myaddr: 1})
+        hashes, notifications = self.generate_and_receive()
+        spendNotifications = [n for n in notifications if n[0] == b"sigmaspend"]
+        assert_equal(len(spendNotifications), 1)
+        assert_equal(spendNotifications[0][1:4], (hashes[0], height + 3, True))
+
+        # Lelantus mints, joinsplits spend and mint. The joinsplit is larger than the remaining Sigma coins,
+        # so it has to spend the Lelantus coin
+        self.nodes[0].generate(401 - self.nodes[0].getblockcount())
+        self.sync_all()
+        assert_equal(self.receive_privacy_notifications(), [])
+
+        self.nodes[0].mintlelantus(2)
+        mintHashes, notifications = self.generate_and_receive()
+        mintHeight = self.nodes[0].getblockcount()
+        assert_equal(sorted(notifications), [
+            (b"lelantusgroup", mintHashes[0], mintHeight, True, 1),
+            (b"lelantusmint", mintHashes[0], mintHeight, True, 1)])
+
+        self.generate_and_receive()
+        self.nodes[0].joinsplit({myaddr: 1.5})
+        spendHashes, notifications = self.generate_and_receive()
+        spendHeight = self.nodes[0].getblockcount()
+        spendNotifications = [n for n in notifications if n[0] == b"lelantusspend"]
+        assert_equal(len(spendNotifications), 1)
+        assert_equal(spendNotifications[0][1:4], (spendHashes[0], spendHeight, True))
+
+        # a reorg reports the blocks it disconnects as reverted, from the tip down, and the ones it connects again
+        self.nodes[0].invalidateblock(mintHashes[0])
+        notifications = self.receive_privacy_notifications()
+        reverted = [n[0:4] for n in notifications]
+        blocks = [n[1] for n in notifications]
+        assert((b"lelantusspend", spendHashes[0], spendHeight, False) in reverted)
+        assert((b"lelantusmint", mintHashes[0], mintHeight, False) in reverted)
+        assert((b"lelantusgroup", mintHashes[0], mintHeight, False) in reverted)
+        assert(all(not n[3] for n in notifications))
+        assert_equal(set(blocks), set([spendHashes[0], mintHashes[0]]))
+        assert(blocks.index(mintHashes[0]) > len(blocks) - 1 - blocks[::-1].index(spendHashes[0]))
+
+        self.nodes[0].reconsiderblock(mintHashes[0])
+        notifications = self.receive_privacy_notifications()
+        reconnected = [n[0:4] for n in notifications]
+        blocks = [n[1] for n in notifications]
+        assert((b"lelantusmint", mintHashes[0], mintHeight, True) in reconnected)
+        assert((b"lelantusgroup", mintHashes[0], mintHeight, True) in reconnected)
+        assert((b"lelantusspend", spendHashes[0], spendHeight, True) in reconnected)
+        assert(all(n[3] for n in notifications))
+        assert_equal(set(blocks), set([spendHashes[0], mintHashes[0]]))
+        assert(blocks.index(spendHashes[0]) > len(blocks) - 1 - blocks[::-1].index(mintHashes[0]))
+        assert_equal(self.nodes[0].getbestblockhash(), spendHashes[0])
+
 
 if __name__ == '__main__':
     ZMQTest ().main ()
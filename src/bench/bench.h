@@ -47,8 +47,9 @@ namespace benchmark {
         uint64_t lastCycles;
         uint64_t minCycles;
         uint64_t maxCycles;
+        uint64_t itemsPerIteration;
     public:
-        State(std::string _name, double _maxElapsed) : name(_name), maxElapsed(_maxElapsed), count(0) {
+        State(std::string _name, double _maxElapsed) : name(_name), maxElapsed(_maxElapsed), count(0), itemsPerIteration(1) {
             minTime = std::numeric_limits<double>::max();
             maxTime = std::numeric_limits<double>::min();
             minCycles = std::numeric_limits<uint64_t>::max();
@@ -57,6 +58,8 @@ namespace benchmark {
             countMaskInv = 1./(countMask + 1);
         }
         bool KeepRunning();
+        /** Sets the number of items (proofs, signatures, hashes...) processed by one iteration, for the throughput column */
+        void SetItemsPerIteration(uint64_t items) { itemsPerIteration = items; }
     };
 
     typedef boost::function<void(State&)> BenchFunction;
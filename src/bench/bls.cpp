@@ -0,0 +1,87 @@
+// Copyright (c) 2020 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "bls/bls.h"
+#include "bls/bls_batchverifier.h"
+#include "hash.h"
+
+#include <vector>
+
+#include <assert.h>
+
+struct BLSMessage
+{
+    int sourceId;
+    uint256 msgHash;
+    CBLSSignature sig;
+    CBLSPublicKey pubKey;
+};
+
+// Keys are derived from fixed seeds, hashes which aren't valid secret keys are skipped
+static CBLSSecretKey SeededSecretKey(uint64_t i)
+{
+    for (uint64_t attempt = 0; ; attempt++) {
+        uint256 seed = (CHashWriter(SER_GETHASH, 0) << std::string("bls") << i << attempt).GetHash();
+        CBLSSecretKey sk(std::vector<unsigned char>(seed.begin(), seed.end()));
+        if (sk.IsValid()) {
+            return sk;
+        }
+    }
+}
+
+// Signatures of distinct messages by each of the sources, like the recovered signatures
+// and signature shares of a round of LLMQ signing
+static std::vector<BLSMessage> CreateMessages(int sourceCount, int messagesPerSource)
+{
+    std::vector<BLSMessage> messages;
+    for (int source = 0; source < sourceCount; source++) {
+        CBLSSecretKey sk = SeededSecretKey(source);
+        CBLSPublicKey pubKey = sk.GetPublicKey();
+        for (int i = 0; i < messagesPerSource; i++) {
+            uint256 msgHash = (CHashWriter(SER_GETHASH, 0) << source << i).GetHash();
+            messages.push_back({source, msgHash, sk.Sign(msgHash), pubKey});
+        }
+    }
+    return messages;
+}
+
+static void BLSVerify(benchmark::State& state)
+{
+    std::vector<BLSMessage> messages = CreateMessages(1, 1);
+    const BLSMessage& message = messages[0];
+
+    while (state.KeepRunning()) {
+        assert(message.sig.VerifyInsecure(message.pubKey, message.msgHash));
+    }
+}
+
+static void BLSBatchVerify(benchmark::State& state, bool secureVerification)
+{
+    std::vector<BLSMessage> messages = CreateMessages(100, 10);
+
+    state.SetItemsPerIteration(messages.size());
+    while (state.KeepRunning()) {
+        CBLSBatchVerifier<int, uint256> batchVerifier(secureVerification, true);
+        for (const BLSMessage& message : messages) {
+            batchVerifier.PushMessage(message.sourceId, message.msgHash, message.msgHash, message.sig, message.pubKey);
+        }
+        batchVerifier.Verify();
+        assert(batchVerifier.badSources.empty());
+    }
+}
+
+static void BLSBatchVerifyInsecure(benchmark::State& state)
+{
+    BLSBatchVerify(state, false);
+}
+
+static void BLSBatchVerifySecure(benchmark::State& state)
+{
+    BLSBatchVerify(state, true);
+}
+
+BENCHMARK(BLSVerify);
+BENCHMARK(BLSBatchVerifyInsecure);
+BENCHMARK(BLSBatchVerifySecure);
@@ -0,0 +1,60 @@
+// Copyright (c) 2020 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "elysium/consensushash.h"
+#include "elysium/elysium.h"
+#include "elysium/mdex.h"
+#include "elysium/sp.h"
+#include "elysium/tally.h"
+#include "tinyformat.h"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+
+// Hashes the state of 10000 addresses holding 20 properties, 10000 open MetaDEx orders
+// and 100 properties, all derived from the loop counters so every run hashes the same state.
+static void ElysiumConsensusHash(benchmark::State& state)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("bench_elysium_%%%%%%%%");
+    elysium::_my_sps = new CMPSPInfo(path / "MP_spinfo", true);
+
+    for (int i = 0; i < 100; i++) {
+        CMPSPInfo::Entry sp;
+        sp.issuer = strprintf("issuer%d", i);
+        sp.prop_type = ELYSIUM_PROPERTY_TYPE_DIVISIBLE;
+        sp.num_tokens = 1000000;
+        sp.name = strprintf("Property %d", i);
+        elysium::_my_sps->putSP(ELYSIUM_PROPERTY_ELYSIUM, sp);
+    }
+
+    uint32_t n = 0;
+    for (int i = 0; i < 10000; i++) {
+        std::string address = strprintf("address%d", i);
+        for (uint32_t property = 3; property < 23; property++) {
+            elysium::mp_tally_map.updateMoney(address, property, 1000 + i, BALANCE);
+        }
+
+        // every address sells a property for the next one
+        uint32_t property = 3 + i % 20;
+        uint32_t desired = 3 + (i + 1) % 20;
+        uint256 txid;
+        *reinterpret_cast<uint32_t*>(txid.begin()) = ++n;
+        elysium::metadex.insert(CMPMetaDEx(address, n / 1000, property, 100, desired, 100 + i % 50, txid, n % 1000, CMPTransaction::ADD));
+        elysium::mp_tally_map.updateMoney(address, property, 100, METADEX_RESERVE);
+    }
+
+    while (state.KeepRunning()) {
+        elysium::GetConsensusHash();
+    }
+
+    elysium::metadex.clear();
+    elysium::mp_tally_map.clear();
+    delete elysium::_my_sps;
+    elysium::_my_sps = nullptr;
+    boost::filesystem::remove_all(path);
+}
+
+BENCHMARK(ElysiumConsensusHash);
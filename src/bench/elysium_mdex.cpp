@@ -0,0 +1,69 @@
+// Copyright (c) 2020 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "elysium/mdex.h"
+
+#include <string>
+#include <vector>
+
+#include <assert.h>
+
+static std::vector<CMPMetaDEx> CreateOrders(const std::vector<std::string>& senders)
+{
+    std::vector<CMPMetaDEx> orders;
+    uint32_t n = 0;
+
+    // orders of all senders, spread over 20 pairs with 50 price levels each
+    for (uint32_t property = 3; property < 8; property++) {
+        for (uint32_t desired = 3; desired < 8; desired++) {
+            if (property == desired) continue;
+            for (int64_t price = 1; price <= 50; price++) {
+                for (const std::string& sender : senders) {
+                    uint256 txid;
+                    *reinterpret_cast<uint32_t*>(txid.begin()) = ++n;
+                    orders.push_back(CMPMetaDEx(sender, n / 1000, property, 100, desired, 100 * price, txid, n % 1000, CMPTransaction::ADD));
+                }
+            }
+        }
+    }
+
+    return orders;
+}
+
+// Fills the order book, looks up the best offer of each pair and cancels
+// everything of each sender, like a stream of orders and cancellations would.
+static void MetaDExBookUpdates(benchmark::State& state)
+{
+    std::vector<std::string> senders;
+    for (int i = 0; i < 20; i++) {
+        senders.push_back("sender" + std::to_string(i));
+    }
+
+    std::vector<CMPMetaDEx> orders = CreateOrders(senders);
+
+    while (state.KeepRunning()) {
+        elysium::MetaDExBook book;
+
+        for (const CMPMetaDEx& order : orders) {
+            book.insert(order);
+        }
+
+        int64_t best = 0;
+        for (elysium::MetaDExBook::const_iterator it = book.begin(); it != book.end(); ++it) {
+            const elysium::md_PricesMap* prices = book.getPrices(it->first.first, it->first.second);
+            best += prices->begin()->second.begin()->getAmountDesired();
+        }
+        assert(best > 0);
+
+        for (const std::string& sender : senders) {
+            for (const CMPMetaDEx* order : book.getOrders(sender)) {
+                book.erase(order->getHash());
+            }
+        }
+        assert(book.empty());
+    }
+}
+
+BENCHMARK(MetaDExBookUpdates);
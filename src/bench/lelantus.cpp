@@ -0,0 +1,243 @@
+// Copyright (c) 2020 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "firo_params.h"
+#include "hash.h"
+#include "liblelantus/lelantus_prover.h"
+#include "liblelantus/params.h"
+#include "liblelantus/range_prover.h"
+#include "liblelantus/range_verifier.h"
+#include "liblelantus/sigmaextended_prover.h"
+#include "liblelantus/sigmaextended_verifier.h"
+#include "secp256k1/include/MultiExponent.h"
+
+#include <string>
+#include <vector>
+
+#include <assert.h>
+
+using namespace lelantus;
+
+// Sets, secrets and challenges are derived from fixed seeds so every run measures the same
+// statements. The provers still pick their own blinding factors.
+
+static Scalar SeededScalar(const std::string& domain, uint64_t i)
+{
+    uint256 seed = (CHashWriter(SER_GETHASH, 0) << domain << i).GetHash();
+    Scalar s;
+    s.memberFromSeed(seed.begin());
+    return s;
+}
+
+static GroupElement SeededGroupElement(const std::string& domain, uint64_t i)
+{
+    uint256 seed = (CHashWriter(SER_GETHASH, 0) << domain << i).GetHash();
+    GroupElement g;
+    g.generate(seed.begin());
+    return g;
+}
+
+// Hashing to the curve is slow, so the points are shared by all benchmarks of the file
+static std::vector<GroupElement> SeededPoints(size_t size)
+{
+    static std::vector<GroupElement> points;
+    while (points.size() < size) {
+        points.push_back(SeededGroupElement("point", points.size()));
+    }
+    return std::vector<GroupElement>(points.begin(), points.begin() + size);
+}
+
+static void SigmaExtendedVerify(benchmark::State& state, size_t n, size_t m, size_t proofCount)
+{
+    size_t N = 1;
+    for (size_t j = 0; j < m; j++) {
+        N *= n;
+    }
+
+    GroupElement g = SeededGroupElement("g", 0);
+    std::vector<GroupElement> h_gens;
+    for (size_t i = 0; i < n * m; i++) {
+        h_gens.push_back(SeededGroupElement("h", i));
+    }
+
+    // the spent coins are spread over the set
+    std::vector<GroupElement> commits = SeededPoints(N);
+    std::vector<size_t> indexes;
+    std::vector<Scalar> serials, values, randoms, challenges;
+    for (size_t i = 0; i < proofCount; i++) {
+        indexes.push_back(i * (N / proofCount));
+        serials.push_back(SeededScalar("serial", i));
+        values.push_back(SeededScalar("value", i));
+        randoms.push_back(SeededScalar("randomness", i));
+        challenges.push_back(SeededScalar("challenge", i));
+        commits[indexes[i]] = LelantusPrimitives::double_commit(g, serials[i], h_gens[1], values[i], h_gens[0], randoms[i]);
+    }
+
+    SigmaExtendedProver prover(g, h_gens, n, m);
+    std::vector<SigmaExtendedProof> proofs(proofCount);
+    for (size_t i = 0; i < proofCount; i++) {
+        GroupElement gs = g * serials[i].negate();
+        std::vector<GroupElement> shifted(commits);
+        for (GroupElement& c : shifted) {
+            c += gs;
+        }
+
+        Scalar rA = SeededScalar("rA", i), rB = SeededScalar("rB", i), rC = SeededScalar("rC", i), rD = SeededScalar("rD", i);
+        std::vector<Scalar> sigma, a(n * m), Tk(m), Pk(m), Yk(m);
+        prover.sigma_commit(shifted, indexes[i], rA, rB, rC, rD, a, Tk, Pk, Yk, sigma, proofs[i]);
+        prover.sigma_response(sigma, a, rA, rB, rC, rD, values[i], randoms[i], Tk, Pk, challenges[i], proofs[i]);
+    }
+
+    SigmaExtendedVerifier verifier(g, h_gens, n, m);
+    std::vector<size_t> setSizes(proofCount, N);
+
+    state.SetItemsPerIteration(proofCount);
+    while (state.KeepRunning()) {
+        if (proofCount == 1) {
+            assert(verifier.singleverify(commits, challenges[0], serials[0], proofs[0]));
+        } else {
+            assert(verifier.batchverify(commits, challenges, serials, setSizes, proofs));
+        }
+    }
+}
+
+static void LelantusSigmaVerify256(benchmark::State& state)
+{
+    SigmaExtendedVerify(state, 16, 2, 1);
+}
+
+static void LelantusSigmaVerify4096(benchmark::State& state)
+{
+    SigmaExtendedVerify(state, 16, 3, 1);
+}
+
+static void LelantusSigmaVerify65536(benchmark::State& state)
+{
+    SigmaExtendedVerify(state, 16, 4, 1);
+}
+
+static void LelantusSigmaBatchVerify4096(benchmark::State& state)
+{
+    SigmaExtendedVerify(state, 16, 3, 10);
+}
+
+static void LelantusSigmaBatchVerify65536(benchmark::State& state)
+{
+    SigmaExtendedVerify(state, 16, 4, 10);
+}
+
+// Batch of range proofs of joinsplits with two outputs, so every proof covers four values
+static void LelantusRangeVerify(benchmark::State& state)
+{
+    const lelantus::Params* params = lelantus::Params::get_default();
+    const size_t n = params->get_bulletproofs_n();
+    const size_t m = 4;
+    const size_t proofCount = 10;
+
+    std::vector<GroupElement> g_(params->get_bulletproofs_g().begin(), params->get_bulletproofs_g().begin() + n * m);
+    std::vector<GroupElement> h_(params->get_bulletproofs_h().begin(), params->get_bulletproofs_h().begin() + n * m);
+
+    RangeProver prover(params->get_h1(), params->get_h0(), params->get_g(), g_, h_, n, LELANTUS_TX_TPAYLOAD);
+    std::vector<std::vector<GroupElement>> V(proofCount);
+    std::vector<RangeProof> proofs(proofCount);
+    for (size_t i = 0; i < proofCount; i++) {
+        std::vector<Scalar> v_s, serials, randoms;
+        for (size_t j = 0; j < m; j++) {
+            v_s.push_back(Scalar(uint64_t(i * m + j + 1)));
+            serials.push_back(SeededScalar("serial", i * m + j));
+            randoms.push_back(SeededScalar("randomness", i * m + j));
+            V[i].push_back(LelantusPrimitives::double_commit(params->get_h1(), v_s[j], params->get_h0(), randoms[j], params->get_g(), serials[j]));
+        }
+        prover.proof(v_s, serials, randoms, V[i], proofs[i]);
+    }
+
+    RangeVerifier verifier(params->get_h1(), params->get_h0(), params->get_g(), g_, h_, n, LELANTUS_TX_TPAYLOAD);
+
+    state.SetItemsPerIteration(proofCount);
+    while (state.KeepRunning()) {
+        assert(verifier.verify(V, V, proofs));
+    }
+}
+
+// A joinsplit spending one coin of a full anonymity set into two new coins
+static void LelantusProve(benchmark::State& state)
+{
+    const lelantus::Params* params = lelantus::Params::get_default();
+    size_t N = 1;
+    for (int j = 0; j < params->get_sigma_m(); j++) {
+        N *= params->get_sigma_n();
+    }
+
+    std::vector<unsigned char> seckey(32, 0x01);
+    PrivateCoin input(params, SeededScalar("serial", 0), 5, SeededScalar("randomness", 0), seckey, LELANTUS_TX_VERSION_4);
+    std::vector<PrivateCoin> Cout = {
+        PrivateCoin(params, SeededScalar("serial", 1), 2, SeededScalar("randomness", 1), seckey, LELANTUS_TX_VERSION_4),
+        PrivateCoin(params, SeededScalar("serial", 2), 2, SeededScalar("randomness", 2), seckey, LELANTUS_TX_VERSION_4)
+    };
+
+    std::vector<PublicCoin> set;
+    for (const GroupElement& point : SeededPoints(N)) {
+        set.emplace_back(point);
+    }
+    set[N / 2] = input.getPublicCoin();
+
+    std::map<uint32_t, std::vector<PublicCoin>> anonymitySets = {{1, set}};
+    std::vector<std::pair<PrivateCoin, uint32_t>> Cin = {{input, 1}};
+    std::vector<size_t> indexes = {N / 2};
+
+    LelantusProver prover(params, LELANTUS_TX_TPAYLOAD);
+    while (state.KeepRunning()) {
+        LelantusProof proof;
+        SchnorrProof qkSchnorrProof;
+        prover.proof(anonymitySets, {}, Scalar(uint64_t(0)), Cin, indexes, {}, Scalar(uint64_t(0)), Cout, Scalar(uint64_t(1)), proof, qkSchnorrProof);
+    }
+}
+
+static void MultiExponentiation(benchmark::State& state, size_t size)
+{
+    std::vector<GroupElement> points = SeededPoints(size);
+    std::vector<Scalar> scalars;
+    for (size_t i = 0; i < size; i++) {
+        scalars.push_back(SeededScalar("exponent", i));
+    }
+
+    state.SetItemsPerIteration(size);
+    while (state.KeepRunning()) {
+        MultiExponent mult(points, scalars);
+        mult.get_multiple();
+    }
+}
+
+static void MultiExponent1024(benchmark::State& state)
+{
+    MultiExponentiation(state, 1 << 10);
+}
+
+static void MultiExponent4096(benchmark::State& state)
+{
+    MultiExponentiation(state, 1 << 12);
+}
+
+static void MultiExponent16384(benchmark::State& state)
+{
+    MultiExponentiation(state, 1 << 14);
+}
+
+static void MultiExponent65536(benchmark::State& state)
+{
+    MultiExponentiation(state, 1 << 16);
+}
+
+BENCHMARK(LelantusSigmaVerify256);
+BENCHMARK(LelantusSigmaVerify4096);
+BENCHMARK(LelantusSigmaVerify65536);
+BENCHMARK(LelantusSigmaBatchVerify4096);
+BENCHMARK(LelantusSigmaBatchVerify65536);
+BENCHMARK(LelantusRangeVerify);
+BENCHMARK(LelantusProve);
+BENCHMARK(MultiExponent1024);
+BENCHMARK(MultiExponent4096);
+BENCHMARK(MultiExponent16384);
+BENCHMARK(MultiExponent65536);
@@ -0,0 +1,96 @@
+// Copyright (c) 2020 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "crypto/MerkleTreeProof/mtp.h"
+#include "crypto/progpow.h"
+#include "primitives/block.h"
+#include "streams.h"
+#include "uint256.h"
+#include "version.h"
+
+#include <memory>
+
+#include <assert.h>
+
+namespace pow_bench {
+#include "bench/data/mtp_proof_regtest.raw.h"
+}
+
+static CProgPowHeader CreateProgPowHeader()
+{
+    CProgPowHeader header;
+    header.nVersion = 0x20001000;
+    header.hashPrevBlock = uint256S("5b7f3a59b5cd5e5e1ee4d4eb1cbd8c0c8a9b1b54b8c34a07e95e1f0e8d2ef1a1");
+    header.hashMerkleRoot = uint256S("0dd1cb9b2d1a2e0a4f9d8a18c1f3b7b6e8f0cbb8c5e4d2d8c8a3ea4b2f9c7e11");
+    header.nTime = 1635228000;
+    header.nBits = 0x1b0404cb;
+    // a height of the first months of ProgPow on mainnet, it selects the epoch of the DAG
+    header.nHeight = 430000;
+    header.nNonce64 = 0;
+    return header;
+}
+
+static void ProgPowHashFull(benchmark::State& state)
+{
+    CProgPowHeader header = CreateProgPowHeader();
+
+    // the epoch context is built by the first hash and cached
+    uint256 mix_hash;
+    progpow_hash_full(header, mix_hash);
+
+    while (state.KeepRunning()) {
+        header.nNonce64++;
+        progpow_hash_full(header, mix_hash);
+    }
+}
+
+static void ProgPowHashLight(benchmark::State& state)
+{
+    CProgPowHeader header = CreateProgPowHeader();
+    progpow_hash_full(header, header.mix_hash);
+
+    while (state.KeepRunning()) {
+        progpow_hash_light(header);
+    }
+}
+
+// Verifies the proof of the regtest header of mtp_tests. There is no mainnet MTP block in the tree, so the
+// nonce and the proof, serialized like the MTP data of a block, were solved once and stored in the fixture
+static void MTPVerify(benchmark::State& state)
+{
+    static const char input[] = {
+        (char)0x00, (char)0x00, (char)0x00, (char)0x20, (char)0x7f, (char)0xda,
+        (char)0x1a, (char)0xbd, (char)0xca, (char)0x0f, (char)0x11, (char)0xc3,
+        (char)0xca, (char)0xd5, (char)0xf6, (char)0x7e, (char)0x73, (char)0xd8,
+        (char)0x48, (char)0x59, (char)0x22, (char)0xe2, (char)0x56, (char)0xa1,
+        (char)0x94, (char)0xa9, (char)0x22, (char)0x90, (char)0xb0, (char)0x00,
+        (char)0x85, (char)0x51, (char)0x5d, (char)0xf4, (char)0x64, (char)0xdd,
+        (char)0x1d, (char)0xe2, (char)0x9e, (char)0xeb, (char)0x54, (char)0x46,
+        (char)0x23, (char)0x0c, (char)0x0a, (char)0x17, (char)0xeb, (char)0x84,
+        (char)0x11, (char)0x59, (char)0xd4, (char)0x1a, (char)0xc0, (char)0x63,
+        (char)0x6c, (char)0x52, (char)0x18, (char)0xc8, (char)0xef, (char)0xaf,
+        (char)0x78, (char)0x0b, (char)0x96, (char)0xcf, (char)0xca, (char)0x94,
+        (char)0x88, (char)0x54, (char)0x3d, (char)0x13, (char)0x32, (char)0x5b,
+        (char)0xff, (char)0xff, (char)0x00, (char)0x20, (char)0x00, (char)0x10,
+        (char)0x00, (char)0x00 };
+
+    const uint32_t target = 0x2000fffful;
+    const uint256 pow_limit = uint256S("00ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+
+    CDataStream stream((const char*)pow_bench::mtp_proof_regtest,
+            (const char*)&pow_bench::mtp_proof_regtest[sizeof(pow_bench::mtp_proof_regtest)],
+            SER_NETWORK, PROTOCOL_VERSION);
+    uint32_t nonce;
+    std::unique_ptr<CMTPHashData> proof(new CMTPHashData);
+    stream >> nonce >> *proof;
+
+    while (state.KeepRunning()) {
+        assert(mtp::impl::mtp_verify(input, target, proof->hashRootMTP, nonce, proof->nBlockMTP, proof->nProofMTP, pow_limit));
+    }
+}
+
+BENCHMARK(ProgPowHashFull);
+BENCHMARK(ProgPowHashLight);
+BENCHMARK(MTPVerify);
@@ -0,0 +1,82 @@
+// Copyright (c) 2020 The Firo Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "hash.h"
+#include "sigma/params.h"
+#include "sigma/sigmaplus_prover.h"
+#include "sigma/sigmaplus_verifier.h"
+
+#include <vector>
+
+#include <assert.h>
+
+typedef sigma::SigmaPlusProof<secp_primitives::Scalar, secp_primitives::GroupElement> SigmaProof;
+
+static uint256 SeedHash(const std::string& domain, uint64_t i)
+{
+    return (CHashWriter(SER_GETHASH, 0) << domain << i).GetHash();
+}
+
+// Verifies spends of a full anonymity set with the default parameters, the set and the
+// spent coins are derived from fixed seeds
+static void SigmaPlusBatchVerify(benchmark::State& state, size_t proofCount)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    const size_t n = params->get_n();
+    const size_t m = params->get_m();
+    size_t N = 1;
+    for (size_t j = 0; j < m; j++) {
+        N *= n;
+    }
+
+    const secp_primitives::GroupElement& g = params->get_g();
+    const std::vector<secp_primitives::GroupElement>& h_gens = params->get_h();
+
+    std::vector<secp_primitives::GroupElement> commits(N);
+    for (size_t i = 0; i < N; i++) {
+        uint256 seed = SeedHash("point", i);
+        commits[i].generate(seed.begin());
+    }
+
+    std::vector<size_t> indexes;
+    std::vector<secp_primitives::Scalar> r(proofCount);
+    for (size_t i = 0; i < proofCount; i++) {
+        uint256 seed = SeedHash("randomness", i);
+        r[i].memberFromSeed(seed.begin());
+        indexes.push_back(i * (N / proofCount));
+        commits[indexes.back()] = h_gens[0] * r[i];
+    }
+
+    sigma::SigmaPlusProver<secp_primitives::Scalar, secp_primitives::GroupElement> prover(g, h_gens, n, m);
+    std::vector<SigmaProof> proofs;
+    for (size_t i = 0; i < proofCount; i++) {
+        SigmaProof proof(n, m);
+        prover.proof(commits, indexes[i], r[i], true, proof);
+        proofs.push_back(proof);
+    }
+
+    sigma::SigmaPlusVerifier<secp_primitives::Scalar, secp_primitives::GroupElement> verifier(g, h_gens, n, m);
+    std::vector<secp_primitives::Scalar> serials(proofCount, secp_primitives::Scalar(uint64_t(0)));
+    std::vector<bool> fPadding(proofCount, true);
+    std::vector<size_t> setSizes(proofCount, N);
+
+    state.SetItemsPerIteration(proofCount);
+    while (state.KeepRunning()) {
+        assert(verifier.batch_verify(commits, serials, fPadding, setSizes, proofs));
+    }
+}
+
+static void SigmaVerify(benchmark::State& state)
+{
+    SigmaPlusBatchVerify(state, 1);
+}
+
+static void SigmaBatchVerify(benchmark::State& state)
+{
+    SigmaPlusBatchVerify(state, 10);
+}
+
+BENCHMARK(SigmaVerify);
+BENCHMARK(SigmaBatchVerify);
@@ -216,6 +216,14 @@ MyAddrContT const & CAccountReceiver::generateMyNextAddresses() const
     return nextAddresses;
 }
 
+bool CAccountReceiver::markChannelAddressUsed(size_t channel, CBitcoinAddress const & address)
+{
+    if (channel >= pchannels.size() || !pchannels[channel].markAddressUsed(address))
+        return false;
+    generateMyNextAddresses();
+    return true;
+}
+
 bool CAccountReceiver::markAddressUsed(CBitcoinAddress const & address)
 {
     for (PChannelContT::iterator iter = pchannels.begin(); iter != pchannels.end(); ++iter) {
@@ -237,9 +245,8 @@ void CAccountReceiver::acceptPcode(CPaymentCode const & theirPcode)
 bool CAccountReceiver::acceptMaskedPayload(std::vector<unsigned char> const & maskedPayload, COutPoint const & outpoint, CPubKey const & outpoinPubkey)
 {
     std::unique_ptr<CPaymentCode> pcode;
-    CExtKey pcodePrivkey = utils::Derive(privkey, {0});
     try {
-        pcode = bip47::utils::PcodeFromMaskedPayload(maskedPayload, outpoint, pcodePrivkey.key, outpoinPubkey);
+        pcode = bip47::utils::PcodeFromMaskedPayload(maskedPayload, outpoint, getMyNotificationKey(), outpoinPubkey);
         if (!pcode)
             return false;
     } catch (std::runtime_error const &) {
@@ -260,11 +267,10 @@ bool CAccountReceiver::acceptMaskedPayload(std::vector<unsigned char> const & ma
     if (!jsplit)
         return false;
     std::unique_ptr<CPaymentCode> pcode;
-    CExtKey pcodePrivkey = utils::Derive(privkey, {0});
     try {
         CDataStream ds(SER_NETWORK, 0);
         ds << jsplit->getCoinSerialNumbers()[0];
-        pcode = bip47::utils::PcodeFromMaskedPayload(maskedPayload, (unsigned char const *)ds.vch.data(), ds.vch.size(), pcodePrivkey.key, jsplit->GetEcdsaPubkeys()[0]);
+        pcode = bip47::utils::PcodeFromMaskedPayload(maskedPayload, (unsigned char const *)ds.vch.data(), ds.vch.size(), getMyNotificationKey(), jsplit->GetEcdsaPubkeys()[0]);
         if (!pcode)
             return false;
     } catch (std::runtime_error const &) {
@@ -302,6 +308,7 @@ CAccountReceiver & CWallet::createReceivingAccount(std::string const & label)
     uint32_t const accNum = (accReceivers.empty() ? 0 : accReceivers.rbegin()->first + 1);
     accReceivers.emplace(accNum, CAccountReceiver(privkeyReceive, accNum, label));
     CAccountReceiver & acc = accReceivers.rbegin()->second;
+    updateAddressIndex(acc);
     LogBip47("Created for receiving: pcode: %s, naddr: %s, accNum: %d\n", acc.getMyPcode().toString(), acc.getMyPcode().getNotificationAddress().ToString(), accNum);
     return acc;
 }
@@ -331,7 +338,9 @@ void CWallet::readReceiver(CAccountReceiver && receiver)
 {
     if (accReceivers.find(receiver.getAccountNum()) != accReceivers.end())
         throw std::runtime_error("There is already an account with number " + std::to_string(receiver.getAccountNum()));
-    accReceivers.insert(std::pair<uint32_t, CAccountReceiver>(receiver.getAccountNum(), std::move(receiver)));
+    uint32_t const accNum = receiver.getAccountNum();
+    accReceivers.insert(std::pair<uint32_t, CAccountReceiver>(accNum, std::move(receiver)));
+    updateAddressIndex(accReceivers.at(accNum));
 }
 
 void CWallet::readSender(CAccountSender && sender)
@@ -374,4 +383,64 @@ void CWallet::enumerateSenders(std::function<bool(CAccountSender const &)> op) c
     }
 }
 
+CAccountReceiver * CWallet::findReceiverByAddress(CBitcoinAddress const & address, bool notificationOnly)
+{
+    CKeyID keyId;
+    if (!address.GetKeyID(keyId))
+        return nullptr;
+    std::map<CKeyID, CReceiverAddress>::const_iterator iter = addressIndex.find(keyId);
+    if (iter == addressIndex.end())
+        return nullptr;
+    if (notificationOnly && iter->second.channel != CReceiverAddress::NotificationChannel)
+        return nullptr;
+    return &accReceivers.at(iter->second.accountNum);
+}
+
+CAccountReceiver * CWallet::markAddressUsed(CBitcoinAddress const & address)
+{
+    CKeyID keyId;
+    if (!address.GetKeyID(keyId))
+        return nullptr;
+    std::map<CKeyID, CReceiverAddress>::const_iterator iter = addressIndex.find(keyId);
+    if (iter == addressIndex.end())
+        return nullptr;
+    CReceiverAddress const location = iter->second;
+    CAccountReceiver & receiver = accReceivers.at(location.accountNum);
+    if (location.channel != CReceiverAddress::NotificationChannel && receiver.markChannelAddressUsed(location.channel, address))
+        updateChannelIndex(receiver, location.channel);
+    return &receiver;
+}
+
+void CWallet::updateAddressIndex(CAccountReceiver const & receiver)
+{
+    updateChannelIndex(receiver, CReceiverAddress::NotificationChannel);
+    for (size_t channel = 0; channel < receiver.getPchannels().size(); ++channel)
+        updateChannelIndex(receiver, channel);
+}
+
+void CWallet::indexAddress(CBitcoinAddress const & address, uint32_t accountNum, size_t channel)
+{
+    CKeyID keyId;
+    if (!address.GetKeyID(keyId))
+        return;
+    addressIndex[keyId] = CReceiverAddress{accountNum, channel};
+    indexedAddresses[std::make_pair(accountNum, channel)].push_back(keyId);
+}
+
+void CWallet::updateChannelIndex(CAccountReceiver const & receiver, size_t channel)
+{
+    uint32_t const accNum = receiver.getAccountNum();
+    std::vector<CKeyID> & indexed = indexedAddresses[std::make_pair(accNum, channel)];
+    for (CKeyID const & keyId : indexed)
+        addressIndex.erase(keyId);
+    indexed.clear();
+
+    if (channel == CReceiverAddress::NotificationChannel) {
+        indexAddress(receiver.getMyNotificationAddress(), accNum, channel);
+        return;
+    }
+    for (MyAddrContT::value_type const & addr : receiver.getPchannels()[channel].generateMyNextAddresses())
+        indexAddress(addr.first, accNum, channel);
+}
+
 }
@@ -1,6 +1,7 @@
 #ifndef ZCOIN_BIP47ACCOUNT_H
 #define ZCOIN_BIP47ACCOUNT_H
 
+#include <limits>
 #include <map>
 
 #include "bip47/defs.h"
@@ -138,6 +139,9 @@ public:
 
     boost::optional<size_t> setMyUsedAddressNumber(CPaymentCode const & theirPcode, size_t number);
 
+    /* Same as addressUsed, but only looks at the next addresses of one payment channel */
+    bool markChannelAddressUsed(size_t channel, CBitcoinAddress const & address);
+
     ADD_DESERIALIZE_CTOR(CAccountReceiver);
     ADD_SERIALIZE_METHODS;
     template <typename Stream, typename Operation>
@@ -162,6 +166,17 @@ private:
 
 /******************************************************************************/
 
+/**
+ * Position of a receiving address in the lookahead index of the wallet.
+ */
+struct CReceiverAddress
+{
+    static constexpr size_t NotificationChannel = std::numeric_limits<size_t>::max();
+
+    uint32_t accountNum;
+    size_t channel;
+};
+
 /**
  * Contains and manages bip47 accounts. 
  * Wallet masterkey is derived using the m/47'/136' path.
@@ -185,10 +200,24 @@ public:
     void enumerateReceivers(std::function<bool(CAccountReceiver const &)> op) const;
     void enumerateSenders(std::function<bool(CAccountSender &)> op);
     void enumerateSenders(std::function<bool(CAccountSender const &)> op) const;
+
+    /* Returns the receiver having the address as its notification address or one of its next addresses */
+    CAccountReceiver * findReceiverByAddress(CBitcoinAddress const & address, bool notificationOnly = false);
+    /* Marks a next address of a receiver as used and tops up the channel in the index. Returns the receiver if found */
+    CAccountReceiver * markAddressUsed(CBitcoinAddress const & address);
+    /* Refreshes the index for the receiver, to be called after its channels or used address numbers change */
+    void updateAddressIndex(CAccountReceiver const & receiver);
 private:
     std::map<uint32_t, CAccountReceiver> accReceivers;
     std::map<uint32_t, CAccountSender> accSenders;
     CExtKey privkeySend, privkeyReceive;
+
+    // notification and next addresses of all receivers, so transactions are matched without deriving them again
+    std::map<CKeyID, CReceiverAddress> addressIndex;
+    std::map<std::pair<uint32_t, size_t>, std::vector<CKeyID>> indexedAddresses;
+
+    void indexAddress(CBitcoinAddress const & address, uint32_t accountNum, size_t channel);
+    void updateChannelIndex(CAccountReceiver const & receiver, size_t channel);
 };
 
 }
@@ -51,19 +51,22 @@ CBitcoinAddress CPaymentChannel::generateTheirNextSecretAddress()
 
 TheirAddrContT CPaymentChannel::generateTheirSecretAddresses(uint32_t fromAddr, uint32_t uptoAddr) const
 {
-    static GroupElement const G(GroupElement().set_base_g());
     std::vector<CBitcoinAddress>  result;
+    CKey const privkey = utils::Derive(myChannelKey, {0}).key;
     for (uint32_t i = fromAddr; i < uptoAddr; ++i) {
         CPubKey const theirPubkey = theirPcode.getNthPubkey(i).pubkey;
-        result.push_back(generate(utils::Derive(myChannelKey, {0}).key, theirPubkey, theirPubkey));
+        result.push_back(generate(privkey, theirPubkey, theirPubkey));
     }
     return result;
 }
 
 CBitcoinAddress CPaymentChannel::getTheirNextSecretAddress() const
 {
-    TheirAddrContT addr = generateTheirSecretAddresses(theirUsedAddressCount, theirUsedAddressCount + 1);
-    return addr.front();
+    if (!theirNextAddress || theirNextAddress->first != theirUsedAddressCount) {
+        TheirAddrContT addr = generateTheirSecretAddresses(theirUsedAddressCount, theirUsedAddressCount + 1);
+        theirNextAddress.emplace(theirUsedAddressCount, addr.front());
+    }
+    return theirNextAddress->second;
 }
 
 TheirAddrContT CPaymentChannel::getTheirUsedSecretAddresses() const
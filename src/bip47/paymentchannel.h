@@ -67,6 +67,8 @@ private:
     uint32_t usedAddressCount, theirUsedAddressCount;
     MyAddrContT mutable usedAddresses, nextAddresses;
     TheirAddrContT mutable theirUsedAddresses;
+    // the address of their next payment with its number, each of them costs an ECDH
+    boost::optional<std::pair<uint32_t, CBitcoinAddress>> mutable theirNextAddress;
     Side side;
 };
 
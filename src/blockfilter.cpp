@@ -0,0 +1,314 @@
+#include "blockfilter.h"
+
+#include "crypto/common.h"
+#include "hash.h"
+#include "lelantus.h"
+#include "primitives/block.h"
+#include "primitives/mint_spend.h"
+#include "sigma.h"
+#include "streams.h"
+#include "util.h"
+
+#include <algorithm>
+
+CBlockFilterDB *pblockfilterdb = nullptr;
+
+static const char DB_BLOCK_FILTER = 'f';
+
+namespace {
+
+// Golomb-Rice codes are written with the most significant bit of every byte first
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out(out), buffer(0), offset(0) {}
+
+    void Write(uint64_t data, int nbits)
+    {
+        while (nbits > 0) {
+            int bits = std::min(8 - offset, nbits);
+            buffer |= ((data >> (nbits - bits)) & ((1 << bits) - 1)) << (8 - offset - bits);
+            offset += bits;
+            nbits -= bits;
+            if (offset == 8) {
+                Flush();
+            }
+        }
+    }
+
+    void Flush()
+    {
+        if (offset == 0) {
+            return;
+        }
+        out.push_back(buffer);
+        buffer = 0;
+        offset = 0;
+    }
+
+private:
+    std::vector<unsigned char>& out;
+    uint8_t buffer;
+    int offset;
+};
+
+class BitReader
+{
+public:
+    BitReader(const std::vector<unsigned char>& in, size_t pos) : in(in), pos(pos), offset(8) {}
+
+    uint64_t Read(int nbits)
+    {
+        uint64_t data = 0;
+        while (nbits > 0) {
+            if (offset == 8) {
+                if (pos >= in.size()) {
+                    throw std::ios_base::failure("BitReader::Read(): end of filter data");
+                }
+                buffer = in[pos++];
+                offset = 0;
+            }
+            int bits = std::min(8 - offset, nbits);
+            data <<= bits;
+            data |= (buffer >> (8 - offset - bits)) & ((1 << bits) - 1);
+            offset += bits;
+            nbits -= bits;
+        }
+        return data;
+    }
+
+private:
+    const std::vector<unsigned char>& in;
+    size_t pos;
+    uint8_t buffer;
+    int offset;
+};
+
+void GolombRiceEncode(BitWriter& writer, uint8_t p, uint64_t x)
+{
+    // the quotient is written in unary
+    uint64_t q = x >> p;
+    while (q > 0) {
+        int nbits = q <= 64 ? static_cast<int>(q) : 64;
+        writer.Write(~0ULL, nbits);
+        q -= nbits;
+    }
+    writer.Write(0, 1);
+    writer.Write(x, p);
+}
+
+uint64_t GolombRiceDecode(BitReader& reader, uint8_t p)
+{
+    uint64_t q = 0;
+    while (reader.Read(1) == 1) {
+        q++;
+    }
+    return (q << p) + reader.Read(p);
+}
+
+// Maps x uniformly into [0, n) with the high 64 bits of x * n, which is cheaper than a modulo
+uint64_t MapIntoRange(uint64_t x, uint64_t n)
+{
+#ifdef __SIZEOF_INT128__
+    return (static_cast<unsigned __int128>(x) * static_cast<unsigned __int128>(n)) >> 64;
+#else
+    uint64_t x_hi = x >> 32, x_lo = x & 0xFFFFFFFF;
+    uint64_t n_hi = n >> 32, n_lo = n & 0xFFFFFFFF;
+
+    uint64_t ac = x_hi * n_hi;
+    uint64_t ad = x_hi * n_lo;
+    uint64_t bc = x_lo * n_hi;
+    uint64_t bd = x_lo * n_lo;
+
+    uint64_t mid34 = (bd >> 32) + (bc & 0xFFFFFFFF) + (ad & 0xFFFFFFFF);
+    return ac + (bc >> 32) + (ad >> 32) + (mid34 >> 32);
+#endif
+}
+
+} // unnamed namespace
+
+GCSFilter::GCSFilter(const uint256& blockHash, std::vector<Element> elements)
+    : k0(ReadLE64(blockHash.begin())), k1(ReadLE64(blockHash.begin() + 8))
+{
+    std::sort(elements.begin(), elements.end());
+    elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+
+    n = elements.size();
+    f = static_cast<uint64_t>(n) * M;
+
+    std::vector<uint64_t> hashes;
+    hashes.reserve(elements.size());
+    for (const Element& element : elements) {
+        hashes.push_back(HashToRange(element));
+    }
+    std::sort(hashes.begin(), hashes.end());
+
+    CVectorWriter stream(SER_NETWORK, PROTOCOL_VERSION, encoded, 0);
+    WriteCompactSize(stream, n);
+
+    BitWriter writer(encoded);
+    uint64_t last = 0;
+    for (uint64_t hash : hashes) {
+        GolombRiceEncode(writer, P, hash - last);
+        last = hash;
+    }
+    writer.Flush();
+}
+
+GCSFilter::GCSFilter(const uint256& blockHash, std::vector<unsigned char> encodedFilter)
+    : k0(ReadLE64(blockHash.begin())), k1(ReadLE64(blockHash.begin() + 8)), encoded(std::move(encodedFilter))
+{
+    CDataStream stream(encoded, SER_NETWORK, PROTOCOL_VERSION);
+    uint64_t nElements = ReadCompactSize(stream);
+    if (nElements > std::numeric_limits<uint32_t>::max()) {
+        throw std::ios_base::failure("GCSFilter(): N must be < 2^32");
+    }
+
+    n = nElements;
+    f = static_cast<uint64_t>(n) * M;
+}
+
+uint64_t GCSFilter::HashToRange(const Element& element) const
+{
+    uint64_t hash = CSipHasher(k0, k1).Write(element.data(), element.size()).Finalize();
+    return MapIntoRange(hash, f);
+}
+
+bool GCSFilter::MatchAnyHashed(const std::vector<uint64_t>& sortedHashes) const
+{
+    if (n == 0 || sortedHashes.empty()) {
+        return false;
+    }
+
+    size_t pos = GetSizeOfCompactSize(n);
+    BitReader reader(encoded, pos);
+
+    uint64_t value = 0;
+    auto query = sortedHashes.begin();
+    for (uint32_t i = 0; i < n; i++) {
+        value += GolombRiceDecode(reader, P);
+
+        while (*query < value) {
+            if (++query == sortedHashes.end()) {
+                return false;
+            }
+        }
+        if (*query == value) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool GCSFilter::Match(const Element& element) const
+{
+    return MatchAnyHashed({HashToRange(element)});
+}
+
+bool GCSFilter::MatchAny(const ElementSet& elements) const
+{
+    std::vector<uint64_t> hashes;
+    hashes.reserve(elements.size());
+    for (const Element& element : elements) {
+        hashes.push_back(HashToRange(element));
+    }
+    std::sort(hashes.begin(), hashes.end());
+    return MatchAnyHashed(hashes);
+}
+
+GCSFilter::Element GetFilterElement(const CScript& script)
+{
+    return GCSFilter::Element(script.begin(), script.end());
+}
+
+GCSFilter::Element GetFilterElement(const COutPoint& outpoint)
+{
+    GCSFilter::Element element;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, element, 0) << outpoint;
+    return element;
+}
+
+GCSFilter::Element GetFilterElement(const uint256& hash)
+{
+    return GCSFilter::Element(hash.begin(), hash.end());
+}
+
+std::vector<GCSFilter::Element> GetBlockFilterElements(const CBlock& block)
+{
+    std::vector<GCSFilter::Element> elements;
+
+    for (const CTransactionRef& tx : block.vtx) {
+        for (const CTxOut& txout : tx->vout) {
+            const CScript& script = txout.scriptPubKey;
+            try {
+                if (script.IsSigmaMint()) {
+                    elements.push_back(GetFilterElement(primitives::GetPubCoinValueHash(sigma::ParseSigmaMintScript(script))));
+                } else if (script.IsLelantusMint()) {
+                    secp_primitives::GroupElement pubcoin;
+                    lelantus::SchnorrProof schnorrProof;
+                    uint256 mintTag;
+                    lelantus::ParseLelantusMintScript(script, pubcoin, schnorrProof, mintTag);
+                    elements.push_back(GetFilterElement(primitives::GetPubCoinValueHash(pubcoin)));
+                    elements.push_back(GetFilterElement(mintTag));
+                } else if (script.IsLelantusJMint()) {
+                    secp_primitives::GroupElement pubcoin;
+                    std::vector<unsigned char> encryptedValue;
+                    uint256 mintTag;
+                    lelantus::ParseLelantusJMintScript(script, pubcoin, encryptedValue, mintTag);
+                    elements.push_back(GetFilterElement(primitives::GetPubCoinValueHash(pubcoin)));
+                    elements.push_back(GetFilterElement(mintTag));
+                } else if (!script.empty() && !script.IsUnspendable()) {
+                    elements.push_back(GetFilterElement(script));
+                }
+            } catch (...) {
+                // malformed mints can't belong to any wallet
+            }
+        }
+
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+
+        if (tx->IsLelantusJoinSplit()) {
+            for (const Scalar& serial : lelantus::GetLelantusJoinSplitSerialNumbers(*tx, tx->vin[0])) {
+                elements.push_back(GetFilterElement(primitives::GetSerialHash(serial)));
+            }
+            continue;
+        }
+
+        for (const CTxIn& txin : tx->vin) {
+            if (txin.IsSigmaSpend()) {
+                try {
+                    auto spend = sigma::ParseSigmaSpend(txin);
+                    elements.push_back(GetFilterElement(primitives::GetSerialHash(spend.first->getCoinSerialNumber())));
+                } catch (...) {
+                }
+            } else if (!txin.IsZerocoinSpend() && !txin.IsZerocoinRemint()) {
+                elements.push_back(GetFilterElement(txin.prevout));
+            }
+        }
+    }
+
+    return elements;
+}
+
+GCSFilter BuildBlockFilter(const CBlock& block)
+{
+    return GCSFilter(block.GetHash(), GetBlockFilterElements(block));
+}
+
+CBlockFilterDB::CBlockFilterDB(size_t nCacheSize, bool fMemory, bool fWipe)
+    : CDBWrapper(GetDataDir() / "blockfilters", nCacheSize, fMemory, fWipe)
+{
+}
+
+bool CBlockFilterDB::ReadFilter(const uint256& blockHash, std::vector<unsigned char>& encodedFilter) const
+{
+    return Read(std::make_pair(DB_BLOCK_FILTER, blockHash), encodedFilter);
+}
+
+bool CBlockFilterDB::WriteFilter(const uint256& blockHash, const GCSFilter& filter)
+{
+    return Write(std::make_pair(DB_BLOCK_FILTER, blockHash), filter.GetEncoded());
+}
@@ -0,0 +1,86 @@
+#ifndef FIRO_BLOCKFILTER_H
+#define FIRO_BLOCKFILTER_H
+
+#include "dbwrapper.h"
+#include "uint256.h"
+
+#include <set>
+#include <stdint.h>
+#include <vector>
+
+class CBlock;
+class COutPoint;
+class CScript;
+
+static const bool DEFAULT_BLOCKFILTERINDEX = false;
+
+/**
+ * Golomb-coded set of the elements of a block as described in BIP158.
+ *
+ * The elements are hashed with SipHash keyed by the block hash into the range [0, N * M), the sorted
+ * values are then stored as Golomb-Rice coded deltas. A query can give false positives with a rate
+ * of 1/M but never false negatives.
+ */
+class GCSFilter
+{
+public:
+    typedef std::vector<unsigned char> Element;
+    typedef std::set<Element> ElementSet;
+
+    static const uint8_t P = 19;
+    static const uint32_t M = 784931;
+
+    /** Builds the filter of the elements, duplicates are only encoded once */
+    GCSFilter(const uint256& blockHash, std::vector<Element> elements);
+    /** Loads an encoded filter, throws std::ios_base::failure if the encoding is malformed */
+    GCSFilter(const uint256& blockHash, std::vector<unsigned char> encodedFilter);
+
+    uint32_t GetN() const { return n; }
+    const std::vector<unsigned char>& GetEncoded() const { return encoded; }
+
+    bool Match(const Element& element) const;
+    /** Returns true if any of the elements may be in the set, decoding the filter only once */
+    bool MatchAny(const ElementSet& elements) const;
+
+private:
+    uint64_t HashToRange(const Element& element) const;
+    bool MatchAnyHashed(const std::vector<uint64_t>& sortedHashes) const;
+
+    uint64_t k0, k1;
+    uint32_t n;
+    uint64_t f;
+    std::vector<unsigned char> encoded;
+};
+
+/** Filter elements of transparent outputs and inputs, the inputs are committed by their prevouts */
+GCSFilter::Element GetFilterElement(const CScript& script);
+GCSFilter::Element GetFilterElement(const COutPoint& outpoint);
+/** Filter elements of the pubcoin hashes, serial hashes and mint tags of Sigma/Lelantus transactions */
+GCSFilter::Element GetFilterElement(const uint256& hash);
+
+/**
+ * Returns the elements a wallet can test for the block: output scripts, spent prevouts, pubcoin hashes of
+ * Sigma/Lelantus mints, Lelantus mint tags and the serial hashes of Sigma spends and Lelantus joinsplits.
+ */
+std::vector<GCSFilter::Element> GetBlockFilterElements(const CBlock& block);
+
+GCSFilter BuildBlockFilter(const CBlock& block);
+
+/** Block filters indexed by block hash, stored in their own database */
+class CBlockFilterDB : public CDBWrapper
+{
+public:
+    CBlockFilterDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+
+    bool ReadFilter(const uint256& blockHash, std::vector<unsigned char>& encodedFilter) const;
+    bool WriteFilter(const uint256& blockHash, const GCSFilter& filter);
+
+private:
+    CBlockFilterDB(const CBlockFilterDB&);
+    void operator=(const CBlockFilterDB&);
+};
+
+/** Set if -blockfilterindex is enabled */
+extern CBlockFilterDB *pblockfilterdb;
+
+#endif // FIRO_BLOCKFILTER_H
@@ -0,0 +1,98 @@
+#include "chainsnapshot.h"
+
+#include "chain.h"
+#include "lelantus.h"
+#include "sigma.h"
+#include "validation.h"
+
+#include <algorithm>
+#include <atomic>
+
+static std::shared_ptr<const CChainSnapshot> chainSnapshot;
+static std::atomic<const CBlockIndex*> bestHeader(nullptr);
+
+CChainSnapshot::CChainSnapshot() : nHeight(-1), lelantusLatestCoinId(0)
+{
+}
+
+CChainSnapshot::CChainSnapshot(const CChain& chain, const CChainSnapshot* previous)
+{
+    AssertLockHeld(cs_main);
+
+    nHeight = chain.Height();
+
+    int nChunks = (nHeight + CHUNK_SIZE) / CHUNK_SIZE;
+    chunks.reserve(nChunks);
+
+    for (int i = 0; i < nChunks; i++) {
+        int first = i * CHUNK_SIZE;
+        int last = std::min(first + CHUNK_SIZE, nHeight + 1) - 1;
+
+        // a chunk ending with the same block has the same ancestors
+        if (previous && i < (int)previous->chunks.size()) {
+            const Chunk& chunk = *previous->chunks[i];
+            if ((int)chunk.size() == last - first + 1 && chunk.back() == chain[last]) {
+                chunks.push_back(previous->chunks[i]);
+                continue;
+            }
+        }
+
+        auto chunk = std::make_shared<Chunk>();
+        chunk->reserve(CHUNK_SIZE);
+        for (int height = first; height <= last; height++) {
+            chunk->push_back(chain[height]);
+        }
+        chunks.push_back(chunk);
+    }
+
+    sigmaLatestCoinIds = sigma::CSigmaState::GetState()->GetLatestCoinIds();
+    lelantusLatestCoinId = lelantus::CLelantusState::GetState()->GetLatestCoinID();
+}
+
+const CBlockIndex* CChainSnapshot::operator[](int height) const
+{
+    if (height < 0 || height > nHeight) {
+        return nullptr;
+    }
+    return (*chunks[height / CHUNK_SIZE])[height % CHUNK_SIZE];
+}
+
+bool CChainSnapshot::Contains(const CBlockIndex* pindex) const
+{
+    return pindex && (*this)[pindex->nHeight] == pindex;
+}
+
+const CBlockIndex* CChainSnapshot::Next(const CBlockIndex* pindex) const
+{
+    return Contains(pindex) ? (*this)[pindex->nHeight + 1] : nullptr;
+}
+
+std::shared_ptr<const CChainSnapshot> GetChainSnapshot()
+{
+    auto snapshot = std::atomic_load(&chainSnapshot);
+    if (!snapshot) {
+        static const auto emptySnapshot = std::make_shared<const CChainSnapshot>();
+        return emptySnapshot;
+    }
+    return snapshot;
+}
+
+void PublishChainSnapshot()
+{
+    LOCK(cs_main);
+
+    auto previous = std::atomic_load(&chainSnapshot);
+    std::atomic_store(&chainSnapshot, std::shared_ptr<const CChainSnapshot>(std::make_shared<CChainSnapshot>(chainActive, previous.get())));
+    PublishBestHeader();
+}
+
+const CBlockIndex* GetBestHeader()
+{
+    return bestHeader.load();
+}
+
+void PublishBestHeader()
+{
+    AssertLockHeld(cs_main);
+    bestHeader.store(pindexBestHeader);
+}
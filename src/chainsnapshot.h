@@ -0,0 +1,66 @@
+#ifndef FIRO_CHAINSNAPSHOT_H
+#define FIRO_CHAINSNAPSHOT_H
+
+#include "sigma/coin.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class CBlockIndex;
+class CChain;
+
+/**
+ * Immutable view of the active chain for read-only RPCs, which can use it without cs_main.
+ *
+ * A snapshot is published after every step of ActivateBestChain(). Block index entries are only freed
+ * when the whole block index is unloaded, and their header fields don't change once they are known, so
+ * the entries of a snapshot can be read without locks. InvalidateBlock() and pruning do change their
+ * validation and storage status (nStatus), which still needs cs_main: a block of an older snapshot may
+ * have left the active chain, and its data may be gone from the disk.
+ */
+class CChainSnapshot
+{
+public:
+    /** Snapshot of an empty chain */
+    CChainSnapshot();
+    /** Builds the snapshot of the active chain, sharing the unchanged parts with the previous one. Requires cs_main. */
+    CChainSnapshot(const CChain& chain, const CChainSnapshot* previous);
+
+    int Height() const { return nHeight; }
+    const CBlockIndex* Tip() const { return nHeight >= 0 ? (*this)[nHeight] : nullptr; }
+
+    /** Returns the block of the chain at a height, or null if the height is out of range. */
+    const CBlockIndex* operator[](int height) const;
+
+    bool Contains(const CBlockIndex* pindex) const;
+    const CBlockIndex* Next(const CBlockIndex* pindex) const;
+
+    const std::unordered_map<sigma::CoinDenomination, int>& SigmaLatestCoinIds() const { return sigmaLatestCoinIds; }
+    int LelantusLatestCoinId() const { return lelantusLatestCoinId; }
+
+private:
+    // heights are split into chunks, so a new snapshot copies the last chunk and shares the others
+    static const int CHUNK_SIZE = 1024;
+    typedef std::vector<const CBlockIndex*> Chunk;
+
+    int nHeight;
+    std::vector<std::shared_ptr<const Chunk>> chunks;
+
+    std::unordered_map<sigma::CoinDenomination, int> sigmaLatestCoinIds;
+    int lelantusLatestCoinId;
+};
+
+/** Returns the latest published snapshot, or the one of an empty chain if none was published yet. */
+std::shared_ptr<const CChainSnapshot> GetChainSnapshot();
+
+/** Publishes a snapshot of chainActive, to be called whenever the tip or the Sigma/Lelantus states change. */
+void PublishChainSnapshot();
+
+/** Returns the best header when it was last published, it is usually ahead of the snapshot tip during sync. */
+const CBlockIndex* GetBestHeader();
+
+/** Publishes pindexBestHeader, to be called whenever a header is added to the block index. Requires cs_main. */
+void PublishBestHeader();
+
+#endif // FIRO_CHAINSNAPSHOT_H
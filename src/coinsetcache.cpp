@@ -0,0 +1,219 @@
+#include "coinsetcache.h"
+
+#include "chain.h"
+#include "chainparams.h"
+#include "firo_params.h"
+#include "lelantus.h"
+#include "sigma.h"
+#include "validation.h"
+
+#include <algorithm>
+
+namespace lelantus {
+
+CCoinSetCache coinSetCache;
+CSigmaToLelantusSetCache sigmaToLelantusSetCache;
+
+static CBlockIndex *LookupStartBlock(const uint256& startBlockHash)
+{
+    if (startBlockHash.IsNull()) {
+        return nullptr;
+    }
+
+    auto it = mapBlockIndex.find(startBlockHash);
+    if (it == mapBlockIndex.end() || !chainActive.Contains(it->second)) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+void CCoinSetCache::CheckTip()
+{
+    uint256 currentTip = chainActive.Tip() ? chainActive.Tip()->GetBlockHash() : uint256();
+
+    if (currentTip != tip) {
+        Clear();
+        tip = currentTip;
+    }
+}
+
+std::shared_ptr<const CAnonymitySetUpdate> CCoinSetCache::GetAnonymitySet(int coinGroupId, const uint256& startBlockHash)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    auto key = std::make_pair(coinGroupId, startBlockHash);
+    auto it = anonymitySets.find(key);
+    if (it != anonymitySets.end()) {
+        return it->second;
+    }
+
+    CBlockIndex *startBlock = LookupStartBlock(startBlockHash);
+    if (!startBlockHash.IsNull() && !startBlock) {
+        return nullptr;
+    }
+
+    auto update = std::make_shared<CAnonymitySetUpdate>();
+    CLelantusState::GetState()->GetCoinsSince(
+            &chainActive,
+            chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1),
+            coinGroupId,
+            startBlock,
+            update->blockHash,
+            update->coins,
+            update->setHash);
+
+    if (anonymitySets.size() >= MAX_ENTRIES) {
+        anonymitySets.clear();
+    }
+
+    anonymitySets.emplace(key, update);
+    return update;
+}
+
+std::shared_ptr<const CUsedSerialsUpdate> CCoinSetCache::GetUsedSerials(const uint256& startBlockHash)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    auto it = usedSerials.find(startBlockHash);
+    if (it != usedSerials.end()) {
+        return it->second;
+    }
+
+    CBlockIndex *startBlock = LookupStartBlock(startBlockHash);
+    if (!startBlockHash.IsNull() && !startBlock) {
+        return nullptr;
+    }
+
+    auto update = std::make_shared<CUsedSerialsUpdate>();
+    update->blockHash = tip;
+
+    // no lelantus spends can be found before the start block of lelantus
+    int firstHeight = std::max(startBlock ? startBlock->nHeight + 1 : 0, ::Params().GetConsensus().nLelantusStartBlock);
+
+    std::vector<CBlockIndex *> blocks;
+    for (CBlockIndex *block = chainActive.Tip(); block && block->nHeight >= firstHeight; block = block->pprev) {
+        if (!block->lelantusSpentSerials.empty()) {
+            blocks.push_back(block);
+        }
+    }
+
+    for (auto block = blocks.rbegin(); block != blocks.rend(); block++) {
+        for (const auto &serial : (*block)->lelantusSpentSerials) {
+            update->serials.push_back(serial.first);
+        }
+    }
+
+    if (usedSerials.size() >= MAX_ENTRIES) {
+        usedSerials.clear();
+    }
+
+    usedSerials.emplace(startBlockHash, update);
+    return update;
+}
+
+void CCoinSetCache::Clear()
+{
+    anonymitySets.clear();
+    usedSerials.clear();
+}
+
+std::shared_ptr<const std::vector<PublicCoin>> CSigmaToLelantusSetCache::GetAnonymitySet(
+        sigma::CoinDenomination denomination,
+        int coinGroupId,
+        const CBlockIndex *firstBlock,
+        const CBlockIndex *lastBlock,
+        bool fSkipBlacklisted)
+{
+    AssertLockHeld(cs_main);
+
+    auto key = std::make_tuple(denomination, coinGroupId, fSkipBlacklisted);
+    auto group = groups.find(key);
+    if (group == groups.end()) {
+        if (groups.size() >= MAX_GROUPS) {
+            groups.erase(std::min_element(groups.begin(), groups.end(), [](const std::pair<const GroupKey, CGroupSets>& a, const std::pair<const GroupKey, CGroupSets>& b) {
+                return a.second.nLastUse < b.second.nLastUse;
+            }));
+        }
+        group = groups.emplace(key, CGroupSets()).first;
+    }
+    group->second.nLastUse = ++nUses;
+
+    auto& sets = group->second.sets;
+    auto it = sets.find(lastBlock->GetBlockHash());
+    if (it != sets.end()) {
+        return it->second.coins;
+    }
+
+    int64_t intDenom;
+    if (!sigma::DenominationToInteger(denomination, intDenom)) {
+        return nullptr;
+    }
+
+    // the same point is added to every coin of the group
+    GroupElement h1Denom = Params::get_default()->get_h1() * intDenom;
+    const auto& blacklist = ::Params().GetConsensus().sigmaBlacklist;
+    auto denominationAndId = std::make_pair(denomination, coinGroupId);
+
+    auto coins = std::make_shared<std::vector<PublicCoin>>();
+    std::shared_ptr<const std::vector<PublicCoin>> olderCoins;
+
+    for (const CBlockIndex *block = lastBlock; ; block = block->pprev) {
+        if (block != lastBlock) {
+            auto older = sets.find(block->GetBlockHash());
+            if (older != sets.end()) {
+                olderCoins = older->second.coins;
+                break;
+            }
+        }
+
+        auto mints = block->sigmaMintedPubCoins.find(denominationAndId);
+        if (mints != block->sigmaMintedPubCoins.end()) {
+            for (const auto& pubCoin : mints->second) {
+                if (fSkipBlacklisted && blacklist.count(pubCoin.getValue()) > 0) {
+                    continue;
+                }
+                coins->emplace_back(pubCoin.getValue() + h1Denom);
+            }
+        }
+
+        if (block == firstBlock) {
+            break;
+        }
+    }
+
+    if (olderCoins) {
+        coins->insert(coins->end(), olderCoins->begin(), olderCoins->end());
+    }
+
+    if (sets.size() >= MAX_SETS_PER_GROUP) {
+        auto lowest = std::min_element(sets.begin(), sets.end(), [](const std::pair<const uint256, CConvertedSet>& a, const std::pair<const uint256, CConvertedSet>& b) {
+            return a.second.nHeight < b.second.nHeight;
+        });
+        sets.erase(lowest);
+    }
+
+    sets[lastBlock->GetBlockHash()] = {lastBlock->nHeight, coins};
+    return coins;
+}
+
+void CSigmaToLelantusSetCache::RemoveBlock(const CBlockIndex *index)
+{
+    for (const auto& mints : index->sigmaMintedPubCoins) {
+        if (mints.second.empty()) {
+            continue;
+        }
+        for (bool fSkipBlacklisted : {false, true}) {
+            groups.erase(std::make_tuple(mints.first.first, mints.first.second, fSkipBlacklisted));
+        }
+    }
+}
+
+void CSigmaToLelantusSetCache::Clear()
+{
+    groups.clear();
+}
+
+} // namespace lelantus
@@ -0,0 +1,132 @@
+#ifndef FIRO_COINSETCACHE_H
+#define FIRO_COINSETCACHE_H
+
+#include "serialize.h"
+#include "uint256.h"
+
+#include "liblelantus/coin.h"
+#include "sigma/coin.h"
+
+#include <secp256k1/include/Scalar.h>
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+class CBlockIndex;
+
+namespace lelantus {
+
+// Coins of a group minted after the block a light wallet already has, in the order they were minted
+struct CAnonymitySetUpdate {
+    // latest block having coins of the group, to be passed back as the start of the next request
+    uint256 blockHash;
+    std::vector<unsigned char> setHash;
+    // coins together with the hashes of their mint transactions
+    std::vector<std::pair<PublicCoin, uint256>> coins;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(blockHash);
+        READWRITE(setHash);
+        READWRITE(coins);
+    }
+};
+
+// Serials spent after the block a light wallet already has
+struct CUsedSerialsUpdate {
+    // chain tip, to be passed back as the start of the next request
+    uint256 blockHash;
+    std::vector<Scalar> serials;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(blockHash);
+        READWRITE(serials);
+    }
+};
+
+/**
+ * Responses served to light wallets, which ask for the same sets over and over again.
+ *
+ * The responses are built once for each start block and kept until the chain tip changes. Callers
+ * must hold cs_main, the returned objects are immutable and can be formatted after releasing it.
+ */
+class CCoinSetCache {
+public:
+    // Returns null if startBlockHash is not null and not a block of the active chain
+    std::shared_ptr<const CAnonymitySetUpdate> GetAnonymitySet(int coinGroupId, const uint256& startBlockHash);
+    std::shared_ptr<const CUsedSerialsUpdate> GetUsedSerials(const uint256& startBlockHash);
+
+    void Clear();
+
+private:
+    void CheckTip();
+
+private:
+    // upper bound of responses kept for each kind of request
+    static const size_t MAX_ENTRIES = 256;
+
+    uint256 tip;
+    std::map<std::pair<int, uint256>, std::shared_ptr<const CAnonymitySetUpdate>> anonymitySets;
+    std::map<uint256, std::shared_ptr<const CUsedSerialsUpdate>> usedSerials;
+};
+
+extern CCoinSetCache coinSetCache;
+
+/**
+ * Sigma coin groups converted to Lelantus commitments, which Sigma-to-Lelantus joinsplits spend from.
+ *
+ * A set is kept for the block ending it. Building the set of a later block of the group converts only the coins
+ * minted after a block which already has one and appends that. The entries of a group are dropped when a block
+ * with its coins is disconnected, or when the group is the least recently used one and another group is needed.
+ * Callers must hold cs_main.
+ */
+class CSigmaToLelantusSetCache {
+public:
+    /**
+     * Returns the coins of the group minted from firstBlock up to lastBlock, newest first, as commitments
+     * of coin + h1 * denomination. Blacklisted coins are left out if fSkipBlacklisted is set.
+     */
+    std::shared_ptr<const std::vector<PublicCoin>> GetAnonymitySet(
+            sigma::CoinDenomination denomination,
+            int coinGroupId,
+            const CBlockIndex *firstBlock,
+            const CBlockIndex *lastBlock,
+            bool fSkipBlacklisted);
+
+    void RemoveBlock(const CBlockIndex *index);
+    void Clear();
+
+private:
+    // sets kept for each group, the ones ending at the lowest blocks are dropped first
+    static const size_t MAX_SETS_PER_GROUP = 4;
+    // upper bound of groups kept, the least recently used one is dropped first
+    static const size_t MAX_GROUPS = 32;
+
+    struct CConvertedSet {
+        int nHeight;
+        std::shared_ptr<const std::vector<PublicCoin>> coins;
+    };
+
+    struct CGroupSets {
+        uint64_t nLastUse;
+        std::map<uint256, CConvertedSet> sets;
+    };
+
+    typedef std::tuple<sigma::CoinDenomination, int, bool> GroupKey;
+    std::map<GroupKey, CGroupSets> groups;
+    uint64_t nUses = 0;
+};
+
+extern CSigmaToLelantusSetCache sigmaToLelantusSetCache;
+
+} // namespace lelantus
+
+#endif // FIRO_COINSETCACHE_H
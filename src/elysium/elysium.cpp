@@ -14,7 +14,9 @@
 #include "persistence.h"
 #include "rules.h"
 #include "script.h"
+#include "sigma.h"
 #include "sigmadb.h"
+#include "snapshot.h"
 #include "sp.h"
 #include "tally.h"
 #include "tx.h"
@@ -42,6 +44,7 @@
 #include "../script/standard.h"
 #include "../sync.h"
 #include "../tinyformat.h"
+#include "../txdb.h"
 #include "../uint256.h"
 #include "../ui_interface.h"
 #include "../util.h"
@@ -69,8 +72,11 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <array>
 #include <fstream>
+#include <future>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -119,6 +125,9 @@ static int64_t elysium_prev = 0;
 
 static boost::filesystem::path MPPersistencePath;
 
+//! Writes the state snapshots in the background
+static StateSnapshotWriter *snapshotWriter = nullptr;
+
 static int elysiumInitialized = 0;
 
 static int reorgRecoveryMode = 0;
@@ -243,15 +252,11 @@ CMPSPInfo *elysium::_my_sps;
 CrowdMap elysium::my_crowds;
 
 // this is the master list of all amounts for all addresses for all properties, map is unsorted
-std::unordered_map<std::string, CMPTally> elysium::mp_tally_map;
+CMPTallyMap elysium::mp_tally_map;
 
-CMPTally* elysium::getTally(const std::string& address)
+const CMPTally* elysium::getTally(const std::string& address)
 {
-    std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.find(address);
-
-    if (it != mp_tally_map.end()) return &(it->second);
-
-    return (CMPTally *) NULL;
+    return mp_tally_map.find(address);
 }
 
 // look at balance for an address
@@ -267,9 +272,9 @@ int64_t getMPbalance(const std::string& address, uint32_t propertyId, TallyType
     }
 
     LOCK(cs_main);
-    const std::unordered_map<std::string, CMPTally>::iterator my_it = mp_tally_map.find(address);
-    if (my_it != mp_tally_map.end()) {
-        balance = (my_it->second).getMoney(propertyId, ttype);
+    const CMPTally* tally = mp_tally_map.find(address);
+    if (tally) {
+        balance = tally->getMoney(propertyId, ttype);
     }
 
     return balance;
@@ -430,8 +435,9 @@ int64_t elysium::getTotalTokens(uint32_t propertyId, int64_t* n_owners_total)
     }
 
     if (!property.fixed || n_owners_total) {
-        for (std::unordered_map<std::string, CMPTally>::const_iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-            const CMPTally& tally = it->second;
+        // only holders of the property can contribute
+        for (CMPTallyMap::AddressId id : mp_tally_map.getHolders(propertyId)) {
+            const CMPTally& tally = mp_tally_map.get(id).second;
 
             totalTokens += tally.getMoney(propertyId, BALANCE);
             totalTokens += tally.getMoney(propertyId, SELLOFFER_RESERVE);
@@ -480,14 +486,8 @@ bool elysium::update_tally_map(const std::string& who, uint32_t propertyId, int6
 
     before = getMPbalance(who, propertyId, ttype);
 
-    std::unordered_map<std::string, CMPTally>::iterator my_it = mp_tally_map.find(who);
-    if (my_it == mp_tally_map.end()) {
-        // insert an empty element
-        my_it = (mp_tally_map.insert(std::make_pair(who, CMPTally()))).first;
-    }
-
-    CMPTally& tally = my_it->second;
-    bRet = tally.updateMoney(propertyId, amount, ttype);
+    // inserts an empty element, if there is none yet
+    bRet = mp_tally_map.updateMoney(who, propertyId, amount, ttype);
 
     after = getMPbalance(who, propertyId, ttype);
     if (!bRet) {
@@ -597,15 +597,14 @@ void CheckWalletUpdate(bool forceUpdate)
     global_balance_reserved.clear();
 
     // populate global balance totals and wallet property list - note global balances do not include additional balances from watch-only addresses
-    for (std::unordered_map<std::string, CMPTally>::iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
+    for (CMPTallyMap::const_iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
         // check if the address is a wallet address (including watched addresses)
         std::string address = my_it->first;
         int addressIsMine = IsMyAddress(address);
         if (!addressIsMine) continue;
         // iterate only those properties in the TokenMap for this address
-        my_it->second.init();
-        uint32_t propertyId;
-        while (0 != (propertyId = (my_it->second).next())) {
+        for (CMPTally::const_iterator token = my_it->second.begin(); token != my_it->second.end(); ++token) {
+            uint32_t propertyId = token->first;
             // add to the global wallet property list
             global_wallet_property_list.insert(propertyId);
             // check if the address is spendable (only spendable balances are included in totals)
@@ -1125,6 +1124,51 @@ public:
     }
 };
 
+/**
+ * Reads the transactions of a block recorded in the marker index via the transaction index.
+ *
+ * The given iterator is advanced past the entries of the block, even if reading fails.
+ *
+ * @param pblockindex[in]  The block to read the transactions of
+ * @param count[in]        The number of entries recorded for the block
+ * @param it[in,out]       The first marker index entry, which is not above the block
+ * @param end[in]          The end of the marker index entries
+ * @param txs[out]         The transactions together with their position in the block
+ * @return True, if all recorded transactions could be read and belong to the block
+ */
+static bool ReadMarkedTransactions(const CBlockIndex *pblockindex, uint32_t count,
+    std::vector<std::pair<CElysiumMarkerIndexKey, uint256>>::const_iterator& it,
+    std::vector<std::pair<CElysiumMarkerIndexKey, uint256>>::const_iterator end,
+    std::vector<std::pair<unsigned, CTransactionRef>>& txs)
+{
+    bool success = true;
+
+    // entries of skipped blocks
+    while (it != end && it->first.blockHeight < pblockindex->nHeight) {
+        it++;
+    }
+
+    for (; it != end && it->first.blockHeight == pblockindex->nHeight; it++) {
+        CTransactionRef tx;
+        uint256 hashBlock;
+
+        if (!success) {
+            continue;
+        }
+
+        // entries of a block that was disconnected by an older version may still be there
+        if (!GetTransaction(it->second, tx, Params().GetConsensus(), hashBlock, true) || hashBlock != pblockindex->GetBlockHash()) {
+            PrintToLog("Marker index entry %s of block %d could not be read\n", it->second.GetHex(), pblockindex->nHeight);
+            success = false;
+            continue;
+        }
+
+        txs.push_back(std::make_pair(it->first.txIndex, tx));
+    }
+
+    return success && txs.size() == count;
+}
+
 /**
  * Scans the blockchain for meta transactions.
  *
@@ -1133,12 +1177,17 @@ public:
  *
  * Every 30 seconds the progress of the scan is reported.
  *
+ * Blocks covered by the marker index are not read from the disk as a whole, only the
+ * transactions recorded in the index are. Other transactions can not carry a packet.
+ * Blocks connected without the index, by an older version or without the transaction
+ * index, have no record of the index and are read as a whole.
+ *
  * In case the current block being processed is not part of the active chain, or
  * if a block could not be retrieved from the disk, then the scan stops early.
  * Likewise, global shutdown requests are honored, and stop the scan progress.
  *
  * @see elysium_handler_block_begin()
- * @see elysium_handler_tx()
+ * @see elysium_handler_block_txs()
  * @see elysium_handler_block_end()
  *
  * @param nFirstBlock[in]  The index of the first block to scan
@@ -1159,6 +1208,18 @@ static int elysium_initial_scan(int nFirstBlock)
     // used to print the progress to the console and notifies the UI
     ProgressReporter progressReporter(chainActive[nFirstBlock], chainActive[nLastBlock]);
 
+    // transactions with markers of the scanned blocks, only valid for the blocks covered by the marker index
+    std::vector<std::pair<CElysiumMarkerIndexKey, uint256>> markers;
+    bool fMarkerIndex = fTxIndex && pblocktree->ReadElysiumMarkerIndex(nFirstBlock, nLastBlock, markers);
+
+    if (fMarkerIndex) {
+        PrintToLog("Using marker index, %zu transactions with markers\n", markers.size());
+    } else {
+        markers.clear();
+    }
+
+    auto marker = markers.cbegin();
+
     for (nBlock = nFirstBlock; nBlock <= nLastBlock; ++nBlock)
     {
         if (ShutdownRequested()) {
@@ -1178,29 +1239,36 @@ static int elysium_initial_scan(int nFirstBlock)
             nNow = GetTime();
         }
 
-        // Get block to parse.
-        CBlock block;
+        // Get transactions to parse, either from the marker index or from the block itself.
+        std::vector<std::pair<unsigned, CTransactionRef>> txs;
 
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus())) {
-            break;
-        }
+        uint32_t nMarkers;
 
-        // Parse block.
-        unsigned parsed = 0;
+        if (!fMarkerIndex || !pblocktree->ReadElysiumMarkerIndexCount(pblockindex->GetBlockHash(), nMarkers) ||
+            !ReadMarkedTransactions(pblockindex, nMarkers, marker, markers.cend(), txs)) {
+            CBlock block;
 
-        elysium_handler_block_begin(nBlock, pblockindex);
+            if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus())) {
+                break;
+            }
+
+            txs.clear();
 
-        for (unsigned i = 0; i < block.vtx.size(); i++) {
-            if (elysium_handler_tx(*block.vtx[i], nBlock, i, pblockindex)) {
-                parsed++;
+            for (unsigned i = 0; i < block.vtx.size(); i++) {
+                txs.push_back(std::make_pair(i, block.vtx[i]));
             }
         }
 
+        // Parse block.
+        elysium_handler_block_begin(nBlock, pblockindex);
+
+        unsigned parsed = elysium_handler_block_txs(txs, nBlock, pblockindex);
+
         elysium_handler_block_end(nBlock, pblockindex, parsed);
 
         // Sum total parsed.
         nTxsFoundTotal += parsed;
-        nTxsTotal += block.vtx.size();
+        nTxsTotal += pblockindex->nTx;
     }
 
     if (nBlock < nLastBlock) {
@@ -1544,10 +1612,171 @@ static char const * const statePrefix[NUM_FILETYPES] = {
     "mdexorders",
 };
 
+//! Tally types which are part of the persisted state, in the order of the bits of the balance masks
+static const std::array<TallyType, 4> PERSISTED_TALLY_TYPES = {
+    BALANCE,
+    SELLOFFER_RESERVE,
+    ACCEPT_RESERVE,
+    METADEX_RESERVE,
+};
+
+static void read_elysium_balances(CDataStream& ss, CMPTallyMap& tallies)
+{
+    auto holders = ReadCompactSize(ss);
+
+    for (uint64_t i = 0; i < holders; i++) {
+        std::string address;
+        ss >> address;
+
+        auto properties = ReadCompactSize(ss);
+        for (uint64_t j = 0; j < properties; j++) {
+            uint32_t propertyId;
+            uint8_t mask;
+
+            ss >> VARINT(propertyId);
+            ss >> mask;
+
+            for (size_t k = 0; k < PERSISTED_TALLY_TYPES.size(); k++) {
+                if (!(mask & (1 << k))) {
+                    continue;
+                }
+
+                uint64_t amount;
+                ss >> VARINT(amount);
+
+                if (!tallies.updateMoney(address, propertyId, amount, PERSISTED_TALLY_TYPES[k])) {
+                    throw std::ios_base::failure("invalid balance");
+                }
+            }
+        }
+    }
+}
+
+static void read_mp_metadex(CDataStream& ss, std::vector<CMPMetaDEx>& trades)
+{
+    auto count = ReadCompactSize(ss);
+    trades.reserve(count);
+
+    for (uint64_t i = 0; i < count; i++) {
+        trades.emplace_back();
+        ss >> trades.back();
+    }
+}
+
+/**
+ * Verifies the checksum of a snapshot section and decodes it.
+ *
+ * @return True, if the section exists, is intact and was decoded entirely
+ */
+template<typename Decoder>
+static bool read_snapshot_section(StateSnapshot& snapshot, int what, Decoder decoder)
+{
+    CDataStream *ss = snapshot.FindSection(what);
+    if (!ss || !snapshot.VerifySection(what)) {
+        PrintToLog("Section %s of state snapshot %s is missing or corrupted\n", statePrefix[what], snapshot.GetBlock().ToString());
+        return false;
+    }
+
+    try {
+        decoder(*ss);
+    } catch (const std::exception& e) {
+        PrintToLog("Failed to decode section %s of state snapshot %s: %s\n", statePrefix[what], snapshot.GetBlock().ToString(), e.what());
+        return false;
+    }
+
+    return ss->empty();
+}
+
+/**
+ * Loads the state from a binary snapshot.
+ *
+ * All sections are verified and decoded in parallel, and only if every one of them
+ * succeeds and the orders form a valid book, the in-memory state is replaced.
+ */
+static int elysium_snapshot_load(const boost::filesystem::path& path)
+{
+  int64_t nStart = GetTimeMillis();
+
+  StateSnapshot snapshot;
+  if (!snapshot.ReadFromFile(path)) {
+    return -1;
+  }
+
+  CMPTallyMap tallies;
+  OfferMap offers;
+  AcceptMap accepts;
+  CrowdMap crowds;
+  std::vector<CMPMetaDEx> trades;
+  int64_t elysiumPrev = 0;
+  uint32_t nextSPID = 0, nextTestSPID = 0;
+
+  std::vector<std::future<bool>> sections;
+
+  sections.push_back(std::async(std::launch::async, [&] {
+    return read_snapshot_section(snapshot, FILETYPE_BALANCES, [&](CDataStream& ss) { read_elysium_balances(ss, tallies); });
+  }));
+  sections.push_back(std::async(std::launch::async, [&] {
+    return read_snapshot_section(snapshot, FILETYPE_OFFERS, [&](CDataStream& ss) { ss >> offers; });
+  }));
+  sections.push_back(std::async(std::launch::async, [&] {
+    return read_snapshot_section(snapshot, FILETYPE_ACCEPTS, [&](CDataStream& ss) { ss >> accepts; });
+  }));
+  sections.push_back(std::async(std::launch::async, [&] {
+    return read_snapshot_section(snapshot, FILETYPE_GLOBALS, [&](CDataStream& ss) {
+      ss >> elysiumPrev;
+      ss >> VARINT(nextSPID);
+      ss >> VARINT(nextTestSPID);
+    });
+  }));
+  sections.push_back(std::async(std::launch::async, [&] {
+    return read_snapshot_section(snapshot, FILETYPE_CROWDSALES, [&](CDataStream& ss) { ss >> crowds; });
+  }));
+  sections.push_back(std::async(std::launch::async, [&] {
+    return read_snapshot_section(snapshot, FILETYPE_MDEXORDERS, [&](CDataStream& ss) { read_mp_metadex(ss, trades); });
+  }));
+
+  bool success = true;
+  for (auto& section : sections) {
+    success = section.get() && success;
+  }
+
+  if (!success) {
+    PrintToLog("%s(%s), failed to load state snapshot\n", __FUNCTION__, path.string());
+    return -1;
+  }
+
+  // the order book is built aside as well, so a failure leaves the whole state untouched
+  MetaDExBook book;
+  for (auto& trade : trades) {
+    if (!book.insert(trade)) {
+      PrintToLog("%s(%s), failed to insert trade %s\n", __FUNCTION__, path.string(), trade.getHash().GetHex());
+      return -1;
+    }
+  }
+
+  mp_tally_map.swap(tallies);
+  my_offers.swap(offers);
+  my_accepts.swap(accepts);
+  my_crowds.swap(crowds);
+  metadex.swap(book);
+
+  elysium_prev = elysiumPrev;
+  _my_sps->init(nextSPID, nextTestSPID);
+
+  PrintToLog("%s(%s), loaded %d balances, %d offers, %d accepts, %d crowdsales, %d trades in %dms\n", __FUNCTION__, path.string(),
+      mp_tally_map.size(), my_offers.size(), my_accepts.size(), my_crowds.size(), trades.size(), GetTimeMillis() - nStart);
+
+  return 0;
+}
+
 // returns the height of the state loaded
 static int load_most_relevant_state()
 {
   int res = -1;
+
+  // make sure the state of the latest blocks is on disk
+  snapshotWriter->Flush();
+
   // check the SP database and roll it back to its latest valid state
   // according to the active chain
   uint256 spWatermark;
@@ -1591,7 +1820,7 @@ static int load_most_relevant_state()
     std::vector<std::string> vstr;
     boost::split(vstr, fName, boost::is_any_of("-."), token_compress_on);
     if (  vstr.size() == 3 &&
-          boost::equals(vstr[2], "dat")) {
+          (boost::equals(vstr[2], "dat") || boost::equals(vstr[2], "bin"))) {
       uint256 blockHash;
       blockHash.SetHex(vstr[1]);
       CBlockIndex *pBlockIndex = GetBlockIndex(blockHash);
@@ -1612,14 +1841,20 @@ static int load_most_relevant_state()
   int abortRollBackBlock;
   if (curTip != NULL) abortRollBackBlock = curTip->nHeight - (MAX_STATE_HISTORY+1);
   while (NULL != curTip && persistedBlocks.size() > 0 && curTip->nHeight > abortRollBackBlock) {
-    if (persistedBlocks.find(spBlockIndex->GetBlockHash()) != persistedBlocks.end()) {
+    if (persistedBlocks.find(curTip->GetBlockHash()) != persistedBlocks.end()) {
       int success = -1;
-      for (int i = 0; i < NUM_FILETYPES; ++i) {
-        boost::filesystem::path path = MPPersistencePath / strprintf("%s-%s.dat", statePrefix[i], curTip->GetBlockHash().ToString());
-        const std::string strFile = path.string();
-        success = elysium_file_load(strFile, i, true);
-        if (success < 0) {
-          break;
+      boost::filesystem::path snapshotPath = MPPersistencePath / GetSnapshotFileName(curTip->GetBlockHash());
+      if (boost::filesystem::exists(snapshotPath)) {
+        success = elysium_snapshot_load(snapshotPath);
+      } else {
+        // fall back to the text files written by earlier versions
+        for (int i = 0; i < NUM_FILETYPES; ++i) {
+          boost::filesystem::path path = MPPersistencePath / strprintf("%s-%s.dat", statePrefix[i], curTip->GetBlockHash().ToString());
+          const std::string strFile = path.string();
+          success = elysium_file_load(strFile, i, true);
+          if (success < 0) {
+            break;
+          }
         }
       }
 
@@ -1629,7 +1864,7 @@ static int load_most_relevant_state()
       }
 
       // remove this from the persistedBlock Set
-      persistedBlocks.erase(spBlockIndex->GetBlockHash());
+      persistedBlocks.erase(curTip->GetBlockHash());
     }
 
     // go to the previous block
@@ -1652,177 +1887,76 @@ static int load_most_relevant_state()
   return res;
 }
 
-static int write_elysium_balances(std::ofstream& file, SHA256_CTX* shaCtx)
+static void write_elysium_balances(CDataStream& ss)
 {
-    std::unordered_map<std::string, CMPTally>::iterator iter;
-    for (iter = mp_tally_map.begin(); iter != mp_tally_map.end(); ++iter) {
-        bool emptyWallet = true;
+    // "address, [propertyid, mask of non-zero balances, balances...]"
+    CDataStream records(SER_DISK, CLIENT_VERSION);
+    uint64_t count = 0;
+
+    for (CMPTallyMap::const_iterator iter = mp_tally_map.begin(); iter != mp_tally_map.end(); ++iter) {
+        const CMPTally& curAddr = (*iter).second;
+        std::vector<std::pair<CMPTally::const_iterator, uint8_t>> tokens;
 
-        std::string lineOut = (*iter).first;
-        lineOut.append("=");
-        CMPTally& curAddr = (*iter).second;
-        curAddr.init();
-        uint32_t propertyId = 0;
-        while (0 != (propertyId = curAddr.next())) {
-            int64_t balance = (*iter).second.getMoney(propertyId, BALANCE);
-            int64_t sellReserved = (*iter).second.getMoney(propertyId, SELLOFFER_RESERVE);
-            int64_t acceptReserved = (*iter).second.getMoney(propertyId, ACCEPT_RESERVE);
-            int64_t metadexReserved = (*iter).second.getMoney(propertyId, METADEX_RESERVE);
+        for (CMPTally::const_iterator token = curAddr.begin(); token != curAddr.end(); ++token) {
+            uint8_t mask = 0;
+            for (size_t i = 0; i < PERSISTED_TALLY_TYPES.size(); i++) {
+                if (token->second.balance[PERSISTED_TALLY_TYPES[i]]) mask |= (1 << i);
+            }
 
             // we don't allow 0 balances to read in, so if we don't write them
             // it makes things match up better between persisted state and processed state
-            if (0 == balance && 0 == sellReserved && 0 == acceptReserved && 0 == metadexReserved) {
-                continue;
+            if (mask) {
+                tokens.emplace_back(token, mask);
             }
-
-            emptyWallet = false;
-
-            lineOut.append(strprintf("%d:%d,%d,%d,%d;",
-                    propertyId,
-                    balance,
-                    sellReserved,
-                    acceptReserved,
-                    metadexReserved));
         }
 
-        if (false == emptyWallet) {
-            // add the line to the hash
-            SHA256_Update(shaCtx, lineOut.c_str(), lineOut.length());
-
-            // write the line
-            file << lineOut << endl;
+        if (tokens.empty()) {
+            continue;
         }
-    }
 
-    return 0;
-}
+        records << (*iter).first;
+        WriteCompactSize(records, tokens.size());
 
-static int write_mp_offers(ofstream &file, SHA256_CTX *shaCtx)
-{
-  OfferMap::const_iterator iter;
-  for (iter = my_offers.begin(); iter != my_offers.end(); ++iter) {
-    // decompose the key for address
-    std::vector<std::string> vstr;
-    boost::split(vstr, (*iter).first, boost::is_any_of("-"), token_compress_on);
-    CMPOffer const &offer = (*iter).second;
-    offer.saveOffer(file, shaCtx, vstr[0]);
-  }
+        for (auto& token : tokens) {
+            records << VARINT(token.first->first);
+            records << token.second;
 
+            for (size_t i = 0; i < PERSISTED_TALLY_TYPES.size(); i++) {
+                if (token.second & (1 << i)) {
+                    uint64_t amount = token.first->second.balance[PERSISTED_TALLY_TYPES[i]];
+                    records << VARINT(amount);
+                }
+            }
+        }
 
-  return 0;
-}
-
-static int write_mp_metadex(ofstream &file, SHA256_CTX *shaCtx)
-{
-  for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it)
-  {
-    md_PricesMap & prices = my_it->second;
-    for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it)
-    {
-      md_Set & indexes = (it->second);
-      for (md_Set::iterator it = indexes.begin(); it != indexes.end(); ++it)
-      {
-        CMPMetaDEx meta = *it;
-        meta.saveOffer(file, shaCtx);
-      }
+        ++count;
     }
-  }
-
-  return 0;
-}
-
-static int write_mp_accepts(ofstream &file, SHA256_CTX *shaCtx)
-{
-  AcceptMap::const_iterator iter;
-  for (iter = my_accepts.begin(); iter != my_accepts.end(); ++iter) {
-    // decompose the key for address
-    std::vector<std::string> vstr;
-    boost::split(vstr, (*iter).first, boost::is_any_of("-+"), token_compress_on);
-    CMPAccept const &accept = (*iter).second;
-    accept.saveAccept(file, shaCtx, vstr[0], vstr[1]);
-  }
 
-  return 0;
+    WriteCompactSize(ss, count);
+    ss.write(records.data(), records.size());
 }
 
-static int write_globals_state(ofstream &file, SHA256_CTX *shaCtx)
+static void write_mp_metadex(CDataStream& ss)
 {
-  unsigned int nextSPID = _my_sps->peekNextSPID(ELYSIUM_PROPERTY_ELYSIUM);
-  unsigned int nextTestSPID = _my_sps->peekNextSPID(ELYSIUM_PROPERTY_TELYSIUM);
-  std::string lineOut = strprintf("%d,%d,%d",
-    elysium_prev,
-    nextSPID,
-    nextTestSPID);
-
-  // add the line to the hash
-  SHA256_Update(shaCtx, lineOut.c_str(), lineOut.length());
-
-  // write the line
-  file << lineOut << endl;
+    WriteCompactSize(ss, metadex.size());
 
-  return 0;
-}
-
-static int write_mp_crowdsales(std::ofstream& file, SHA256_CTX* shaCtx)
-{
-    for (CrowdMap::const_iterator it = my_crowds.begin(); it != my_crowds.end(); ++it) {
-        // decompose the key for address
-        const CMPCrowd& crowd = it->second;
-        crowd.saveCrowdSale(file, shaCtx, it->first);
+    for (auto& prices : metadex) {
+        for (auto& indexes : prices.second) {
+            for (auto& meta : indexes.second) {
+                ss << meta;
+            }
+        }
     }
-
-    return 0;
 }
 
-static int write_state_file( CBlockIndex const *pBlockIndex, int what )
+static void write_globals_state(CDataStream& ss)
 {
-  boost::filesystem::path path = MPPersistencePath / strprintf("%s-%s.dat", statePrefix[what], pBlockIndex->GetBlockHash().ToString());
-  const std::string strFile = path.string();
-
-  std::ofstream file;
-  file.open(strFile.c_str());
-
-  SHA256_CTX shaCtx;
-  SHA256_Init(&shaCtx);
-
-  int result = 0;
-
-  switch(what) {
-  case FILETYPE_BALANCES:
-    result = write_elysium_balances(file, &shaCtx);
-    break;
-
-  case FILETYPE_OFFERS:
-    result = write_mp_offers(file, &shaCtx);
-    break;
-
-  case FILETYPE_ACCEPTS:
-    result = write_mp_accepts(file, &shaCtx);
-    break;
+    uint32_t nextSPID = _my_sps->peekNextSPID(ELYSIUM_PROPERTY_ELYSIUM);
+    uint32_t nextTestSPID = _my_sps->peekNextSPID(ELYSIUM_PROPERTY_TELYSIUM);
 
-  case FILETYPE_GLOBALS:
-    result = write_globals_state(file, &shaCtx);
-    break;
-
-  case FILETYPE_CROWDSALES:
-      result = write_mp_crowdsales(file, &shaCtx);
-      break;
-
-  case FILETYPE_MDEXORDERS:
-      result = write_mp_metadex(file, &shaCtx);
-      break;
-  }
-
-  // generate and wite the double hash of all the contents written
-  uint256 hash1;
-  SHA256_Final((unsigned char*)&hash1, &shaCtx);
-  uint256 hash2;
-  SHA256((unsigned char*)&hash1, sizeof(hash1), (unsigned char*)&hash2);
-  file << "!" << hash2.ToString() << endl;
-
-  file.flush();
-  file.close();
-  return result;
+    ss << elysium_prev;
+    ss << VARINT(nextSPID);
+    ss << VARINT(nextTestSPID);
 }
 
 static bool is_state_prefix( std::string const &str )
@@ -1836,11 +1970,14 @@ static bool is_state_prefix( std::string const &str )
   return false;
 }
 
-static void prune_state_files( CBlockIndex const *topIndex )
+/**
+ * Registers the state files, which are already in the persistence directory, with the
+ * snapshot writer, so that they are pruned once they fall out of the state history.
+ *
+ * Files of blocks, which are not in the block index, are removed right away.
+ */
+static void track_state_files()
 {
-  // build a set of blockHashes for which we have any state files
-  std::set<uint256> statefulBlockHashes;
-
   boost::filesystem::directory_iterator dIter(MPPersistencePath);
   boost::filesystem::directory_iterator endIter;
   for (; dIter != endIter; ++dIter) {
@@ -1854,57 +1991,45 @@ static void prune_state_files( CBlockIndex const *topIndex )
     std::vector<std::string> vstr;
     boost::split(vstr, fName, boost::is_any_of("-."), token_compress_on);
     if (  vstr.size() == 3 &&
-          is_state_prefix(vstr[0]) &&
-          boost::equals(vstr[2], "dat")) {
+          ((is_state_prefix(vstr[0]) && boost::equals(vstr[2], "dat")) ||
+           (boost::equals(vstr[0], "state") && boost::equals(vstr[2], "bin")))) {
       uint256 blockHash;
       blockHash.SetHex(vstr[1]);
-      statefulBlockHashes.insert(blockHash);
-    } else {
-      PrintToLog("None state file found in persistence directory : %s\n", fName);
-    }
-  }
 
-  // for each blockHash in the set, determine the distance from the given block
-  std::set<uint256>::const_iterator iter;
-  for (iter = statefulBlockHashes.begin(); iter != statefulBlockHashes.end(); ++iter) {
-    // look up the CBlockIndex for height info
-    CBlockIndex const *curIndex = GetBlockIndex(*iter);
-
-    // if we have nothing int the index, or this block is too old..
-    if (NULL == curIndex || (topIndex->nHeight - curIndex->nHeight) > MAX_STATE_HISTORY ) {
-     if (elysium_debug_persistence)
-     {
-      if (curIndex) {
-        PrintToLog("State from Block:%s is no longer need, removing files (age-from-tip: %d)\n", (*iter).ToString(), topIndex->nHeight - curIndex->nHeight);
-      } else {
-        PrintToLog("State from Block:%s is no longer need, removing files (not in index)\n", (*iter).ToString());
+      CBlockIndex const *curIndex = GetBlockIndex(blockHash);
+      if (NULL == curIndex) {
+        if (elysium_debug_persistence) {
+          PrintToLog("State from Block:%s is no longer need, removing files (not in index)\n", blockHash.ToString());
+        }
+        boost::filesystem::remove(dIter->path());
+        continue;
       }
-     }
 
-      // destroy the associated files!
-      std::string strBlockHash = iter->ToString();
-      for (int i = 0; i < NUM_FILETYPES; ++i) {
-        boost::filesystem::path path = MPPersistencePath / strprintf("%s-%s.dat", statePrefix[i], strBlockHash);
-        boost::filesystem::remove(path);
-      }
+      snapshotWriter->Track(blockHash, curIndex->nHeight, dIter->path());
+    } else {
+      PrintToLog("None state file found in persistence directory : %s\n", fName);
     }
   }
 }
 
 int elysium_save_state( CBlockIndex const *pBlockIndex )
 {
-    // write the new state as of the given block
-    write_state_file(pBlockIndex, FILETYPE_BALANCES);
-    write_state_file(pBlockIndex, FILETYPE_OFFERS);
-    write_state_file(pBlockIndex, FILETYPE_ACCEPTS);
-    write_state_file(pBlockIndex, FILETYPE_GLOBALS);
-    write_state_file(pBlockIndex, FILETYPE_CROWDSALES);
-    write_state_file(pBlockIndex, FILETYPE_MDEXORDERS);
+    // take the state as of the given block, writing it out and cleaning up the
+    // directory is left to the background writer
+    auto snapshot = std::make_shared<StateSnapshot>(pBlockIndex->GetBlockHash(), pBlockIndex->nHeight);
 
-    // clean-up the directory
-    prune_state_files(pBlockIndex);
+    write_elysium_balances(snapshot->GetSection(FILETYPE_BALANCES));
+    snapshot->GetSection(FILETYPE_OFFERS) << my_offers;
+    snapshot->GetSection(FILETYPE_ACCEPTS) << my_accepts;
+    write_globals_state(snapshot->GetSection(FILETYPE_GLOBALS));
+    snapshot->GetSection(FILETYPE_CROWDSALES) << my_crowds;
+    write_mp_metadex(snapshot->GetSection(FILETYPE_MDEXORDERS));
 
-    _my_sps->setWatermark(pBlockIndex->GetBlockHash());
+    // the watermark only moves once the state it refers to is on disk, a crash before leaves it at an older snapshot
+    uint256 blockHash = pBlockIndex->GetBlockHash();
+    snapshotWriter->Write(std::move(snapshot), [blockHash] {
+        _my_sps->setWatermark(blockHash);
+    });
 
     return 0;
 }
@@ -1932,6 +2057,7 @@ void clear_all_state()
     _my_sps->Clear();
     p_txlistdb->Clear();
     sigmaDb->Clear();
+    if (sigmaGroupCache) sigmaGroupCache->Clear();
     s_stolistdb->Clear();
     t_tradelistdb->Clear();
     p_ElysiumTXDB->Clear();
@@ -2007,6 +2133,7 @@ int elysium_init()
     s_stolistdb = new CMPSTOList(GetDataDir() / "MP_stolist", fReindex);
     p_txlistdb = new CMPTxList(GetDataDir() / "MP_txlist", fReindex);
     sigmaDb = new SigmaDatabase(GetDataDir() / "MP_sigma", fReindex);
+    sigmaGroupCache = new SigmaGroupCache(*sigmaDb);
     _my_sps = new CMPSPInfo(GetDataDir() / "MP_spinfo", fReindex);
     p_ElysiumTXDB = new CElysiumTransactionDB(GetDataDir() / "Exodus_TXDB", fReindex);
     p_feecache = new CElysiumFeeCache(GetDataDir() / "EXODUS_feecache", fReindex);
@@ -2015,6 +2142,9 @@ int elysium_init()
     MPPersistencePath = GetDataDir() / "MP_persist";
     TryCreateDirectory(MPPersistencePath);
 
+    snapshotWriter = new StateSnapshotWriter(MPPersistencePath, MAX_STATE_HISTORY);
+    track_state_files();
+
     txProcessor = new TxProcessor();
 
 #ifdef ENABLE_WALLET
@@ -2117,7 +2247,9 @@ int elysium_shutdown()
 #ifdef ENABLE_WALLET
     delete wallet; wallet = nullptr;
 #endif
+    delete snapshotWriter; snapshotWriter = nullptr;
     delete txProcessor; txProcessor = nullptr;
+    delete sigmaGroupCache; sigmaGroupCache = nullptr;
     delete sigmaDb; sigmaDb = nullptr;
     delete p_txlistdb; p_txlistdb = nullptr;
     delete t_tradelistdb; t_tradelistdb = nullptr;
@@ -2135,6 +2267,39 @@ int elysium_shutdown()
     return 0;
 }
 
+/**
+ * Processes a transaction which was parsed by parseTransaction() with the given result.
+ *
+ * @return True, if the transaction was an Elysium purchase, DEx payment or a valid Elysium transaction
+ */
+static bool elysium_process_tx(const CTransaction& tx, int nBlock, unsigned int idx, CMPTransaction& mp_obj, int pop_ret)
+{
+    bool fFoundTx = false;
+
+    if (0 == pop_ret) {
+        int interp_ret = txProcessor->ProcessTx(mp_obj);
+        if (interp_ret) {
+            PrintToLog("!!! interpretPacket() returned %d !!!\n", interp_ret);
+        }
+
+        // Only structurally valid transactions get recorded in levelDB
+        // PKT_ERROR - 2 = interpret_Transaction failed, structurally invalid payload
+        if (interp_ret != PKT_ERROR - 2) {
+            bool bValid = (0 <= interp_ret);
+            p_txlistdb->recordTX(tx.GetHash(), bValid, nBlock, mp_obj.getType(), mp_obj.getNewAmount());
+            p_ElysiumTXDB->RecordTransaction(tx.GetHash(), idx, interp_ret);
+        }
+        fFoundTx |= (interp_ret == 0);
+    }
+
+    if (fFoundTx && elysium_debug_consensus_hash_every_transaction) {
+        uint256 consensusHash = GetConsensusHash();
+        PrintToLog("Consensus hash for transaction %s: %s\n", tx.GetHash().GetHex(), consensusHash.GetHex());
+    }
+
+    return fFoundTx;
+}
+
 /**
  * This handler is called for every new transaction that comes in (actually in block parsing loop).
  *
@@ -2161,31 +2326,60 @@ bool elysium_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx, co
     CMPTransaction mp_obj;
     mp_obj.unlockLogic();
 
-    bool fFoundTx = false;
     int pop_ret = parseTransaction(false, tx, nBlock, idx, mp_obj, nBlockTime);
 
-    if (0 == pop_ret) {
-        int interp_ret = txProcessor->ProcessTx(mp_obj);
-        if (interp_ret) {
-            PrintToLog("!!! interpretPacket() returned %d !!!\n", interp_ret);
-        }
+    return elysium_process_tx(tx, nBlock, idx, mp_obj, pop_ret);
+}
 
-        // Only structurally valid transactions get recorded in levelDB
-        // PKT_ERROR - 2 = interpret_Transaction failed, structurally invalid payload
-        if (interp_ret != PKT_ERROR - 2) {
-            bool bValid = (0 <= interp_ret);
-            p_txlistdb->recordTX(tx.GetHash(), bValid, nBlock, mp_obj.getType(), mp_obj.getNewAmount());
-            p_ElysiumTXDB->RecordTransaction(tx.GetHash(), idx, interp_ret);
+/**
+ * This handler is called for the transactions of a new block, which are given with their positions in the block.
+ *
+ * Each transaction is parsed once, and the Sigma spends of the block are verified in batches before the
+ * transactions are processed in order.
+ *
+ * @return The number of Elysium purchases, DEx payments and valid Elysium transactions
+ */
+unsigned elysium_handler_block_txs(const std::vector<std::pair<unsigned, CTransactionRef>>& txs, int nBlock, const CBlockIndex* pBlockIndex)
+{
+    LOCK(cs_main);
+
+    if (!elysiumInitialized) {
+        elysium_init();
+    }
+
+    // see elysium_handler_tx()
+    for (auto& tx : txs) {
+        PendingDelete(tx.second->GetHash());
+    }
+
+    if (nBlock < nWaterlineBlock) return 0;
+    int64_t nBlockTime = pBlockIndex->GetBlockTime();
+
+    std::vector<CMPTransaction> mp_objs(txs.size());
+    std::vector<int> pop_rets(txs.size());
+    std::vector<CMPTransaction*> parsed;
+
+    for (size_t i = 0; i < txs.size(); i++) {
+        mp_objs[i].unlockLogic();
+        pop_rets[i] = parseTransaction(false, *txs[i].second, nBlock, txs[i].first, mp_objs[i], nBlockTime);
+
+        if (0 == pop_rets[i]) {
+            parsed.push_back(&mp_objs[i]);
         }
-        fFoundTx |= (interp_ret == 0);
     }
 
-    if (fFoundTx && elysium_debug_consensus_hash_every_transaction) {
-        uint256 consensusHash = GetConsensusHash();
-        PrintToLog("Consensus hash for transaction %s: %s\n", tx.GetHash().GetHex(), consensusHash.GetHex());
+    BatchVerifySigmaSpends(parsed, nBlock);
+
+    unsigned found = 0;
+
+    for (size_t i = 0; i < txs.size(); i++) {
+        LogPrint("handler", "Elysium handler: new confirmed transaction [height: %d, idx: %u]\n", nBlock, txs[i].first);
+        if (elysium_process_tx(*txs[i].second, nBlock, txs[i].first, mp_objs[i], pop_rets[i])) {
+            found++;
+        }
     }
 
-    return fFoundTx;
+    return found;
 }
 
 /**
@@ -3763,6 +3957,9 @@ int elysium_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
         elysium_init();
     }
 
+    // spends which passed batch verification belong to this block only
+    ClearVerifiedSigmaSpends();
+
     // for every new received block must do:
     // 1) remove expired entries from the accept list (per spec accept entries are
     //    valid until their blocklimit expiration; because the customer can keep
@@ -3806,6 +4003,7 @@ int elysium_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
         const std::string& msg = strprintf("Shutting down due to failed checkpoint for block %d (hash %s)\n", nBlockNow, pBlockIndex->GetBlockHash().GetHex());
         PrintToLog(msg);
         if (!GetBoolArg("-overrideforcedshutdown", false)) {
+            snapshotWriter->Flush();
             boost::filesystem::path persistPath = GetDataDir() / "MP_persist";
             if (boost::filesystem::exists(persistPath)) boost::filesystem::remove_all(persistPath); // prevent the node being restarted without a reparse after forced shutdown
             AbortNode(msg, msg);
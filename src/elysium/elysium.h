@@ -13,6 +13,7 @@ class CTransaction;
 #include "sigmadb.h"
 
 #include "../base58.h"
+#include "../primitives/transaction.h"
 #include "../sync.h"
 #include "../uint256.h"
 #include "../util.h"
@@ -27,6 +28,7 @@ class CTransaction;
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <inttypes.h>
@@ -264,11 +266,12 @@ int elysium_handler_disc_end(int nBlockNow, CBlockIndex const * pBlockIndex);
 int elysium_handler_block_begin(int nBlockNow, CBlockIndex const * pBlockIndex);
 int elysium_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex, unsigned int);
 bool elysium_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx, const CBlockIndex* pBlockIndex);
+unsigned elysium_handler_block_txs(const std::vector<std::pair<unsigned, CTransactionRef>>& txs, int nBlock, const CBlockIndex* pBlockIndex);
 int elysium_save_state( CBlockIndex const *pBlockIndex );
 
 namespace elysium
 {
-extern std::unordered_map<std::string, CMPTally> mp_tally_map;
+extern CMPTallyMap mp_tally_map;
 extern CMPTxList *p_txlistdb;
 extern CMPTradeList *t_tradelistdb;
 extern CMPSTOList *s_stolistdb;
@@ -299,7 +302,7 @@ bool isTestEcosystemProperty(uint32_t propertyId);
 bool isMainEcosystemProperty(uint32_t propertyId);
 uint32_t GetNextPropertyId(bool maineco); // maybe move into sp
 
-CMPTally* getTally(const std::string& address);
+const CMPTally* getTally(const std::string& address);
 
 int64_t getTotalTokens(uint32_t propertyId, int64_t* n_owners_total = NULL);
 
@@ -25,11 +25,13 @@
 #include <assert.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 typedef boost::multiprecision::cpp_dec_float_100 dec_float;
 typedef boost::multiprecision::checked_int128_t int128_t;
@@ -40,24 +42,112 @@ using namespace elysium;
 #define DISPLAY_PRECISION_LEN  50
 
 //! Global map for price and order data
-md_PropertiesMap elysium::metadex;
+MetaDExBook elysium::metadex;
 
-md_PricesMap* elysium::get_Prices(uint32_t prop)
+void MetaDExBook::clear()
 {
-    md_PropertiesMap::iterator it = metadex.find(prop);
+    pairs.clear();
+    orders.clear();
+    senders.clear();
+}
+
+void MetaDExBook::swap(MetaDExBook& other)
+{
+    pairs.swap(other.pairs);
+    orders.swap(other.orders);
+    senders.swap(other.senders);
+}
+
+const md_PricesMap* MetaDExBook::getPrices(uint32_t property, uint32_t desiredProperty) const
+{
+    md_PropertiesMap::const_iterator it = pairs.find(md_PropertyPair(property, desiredProperty));
+
+    if (it != pairs.end()) return &(it->second);
+
+    return NULL;
+}
+
+bool MetaDExBook::hasProperty(uint32_t property) const
+{
+    md_PropertiesMap::const_iterator it = pairs.lower_bound(md_PropertyPair(property, 0));
+
+    return it != pairs.end() && it->first.first == property;
+}
+
+const CMPMetaDEx* MetaDExBook::find(const uint256& txid) const
+{
+    auto it = orders.find(txid);
 
-    if (it != metadex.end()) return &(it->second);
+    if (it != orders.end()) return it->second;
 
-    return (md_PricesMap*) NULL;
+    return NULL;
 }
 
-md_Set* elysium::get_Indexes(md_PricesMap* p, rational_t price)
+std::vector<const CMPMetaDEx*> MetaDExBook::getOrders(const std::string& address) const
 {
-    md_PricesMap::iterator it = p->find(price);
+    std::vector<const CMPMetaDEx*> result;
+    auto it = senders.find(address);
 
-    if (it != p->end()) return &(it->second);
+    if (it != senders.end()) {
+        result.reserve(it->second.size());
+        for (const uint256& txid : it->second) {
+            result.push_back(orders.at(txid));
+        }
+    }
 
-    return (md_Set*) NULL;
+    return result;
+}
+
+bool MetaDExBook::insert(const CMPMetaDEx& order)
+{
+    if (orders.count(order.getHash())) return false;
+
+    md_PricesMap& prices = pairs[md_PropertyPair(order.getProperty(), order.getDesProperty())];
+    md_Set& indexes = prices[order.unitPrice()];
+
+    std::pair<md_Set::iterator, bool> ret = indexes.insert(order);
+    if (!ret.second) return false;
+
+    orders.emplace(order.getHash(), &(*ret.first));
+    senders[order.getAddr()].insert(order.getHash());
+
+    return true;
+}
+
+bool MetaDExBook::erase(const uint256& txid)
+{
+    auto orderIt = orders.find(txid);
+    if (orderIt == orders.end()) return false;
+
+    const CMPMetaDEx* order = orderIt->second;
+
+    md_PropertiesMap::iterator pairIt = pairs.find(md_PropertyPair(order->getProperty(), order->getDesProperty()));
+    assert(pairIt != pairs.end());
+    md_PricesMap::iterator priceIt = pairIt->second.find(order->unitPrice());
+    assert(priceIt != pairIt->second.end());
+    md_Set::iterator it = priceIt->second.find(*order);
+    assert(it != priceIt->second.end());
+
+    auto senderIt = senders.find(order->getAddr());
+    assert(senderIt != senders.end());
+    senderIt->second.erase(txid);
+    if (senderIt->second.empty()) senders.erase(senderIt);
+
+    orders.erase(orderIt);
+
+    priceIt->second.erase(it);
+    if (priceIt->second.empty()) pairIt->second.erase(priceIt);
+    if (pairIt->second.empty()) pairs.erase(pairIt);
+
+    return true;
+}
+
+/** Sorts orders by property for sale, unit price and position in the chain, which is the order cancellations are processed in. */
+static bool MetaDEx_compare_book(const CMPMetaDEx* lhs, const CMPMetaDEx* rhs)
+{
+    if (lhs->getProperty() != rhs->getProperty()) return lhs->getProperty() < rhs->getProperty();
+    if (lhs->unitPrice() != rhs->unitPrice()) return lhs->unitPrice() < rhs->unitPrice();
+    return MetaDEx_compare()(*lhs, *rhs);
 }
 
 enum MatchReturnType
@@ -142,7 +232,7 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
     if (elysium_debug_metadex1) PrintToLog("%s(%s: prop=%d, desprop=%d, desprice= %s);newo: %s\n",
         __FUNCTION__, pnew->getAddr(), propertyForSale, propertyDesired, xToString(pnew->inversePrice()), pnew->ToString());
 
-    md_PricesMap* const ppriceMap = get_Prices(propertyDesired);
+    const md_PricesMap* ppriceMap = metadex.getPrices(propertyDesired, propertyForSale);
 
     // nothing for the desired property exists in the market, sorry!
     if (!ppriceMap) {
@@ -150,35 +240,36 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
         return NewReturn;
     }
 
-    // within the desired property map (given one property) iterate over the items looking at prices
-    for (md_PricesMap::iterator priceIt = ppriceMap->begin(); priceIt != ppriceMap->end(); ++priceIt) { // check all prices
+    // within the map of the pair iterate over the items looking at prices, starting with the best one
+    // note: the price levels are looked up again for each price, as matched orders are removed from the book
+    md_PricesMap::const_iterator priceIt = ppriceMap->begin();
+    while (priceIt != ppriceMap->end()) { // check all prices
         const rational_t sellersPrice = priceIt->first;
 
         if (elysium_debug_metadex2) PrintToLog("comparing prices: desprice %s needs to be GREATER THAN OR EQUAL TO %s\n",
             xToString(pnew->inversePrice()), xToString(sellersPrice));
 
         // Is the desired price check satisfied? The buyer's inverse price must be larger than that of the seller.
+        // Prices are ascending, so none of the remaining price levels can be satisfied either.
         if (pnew->inversePrice() < sellersPrice) {
-            continue;
+            break;
         }
 
-        md_Set* const pofferSet = &(priceIt->second);
+        // orders at this price level, in the order they were placed
+        std::vector<uint256> offers;
+        for (const CMPMetaDEx& offer : priceIt->second) {
+            offers.push_back(offer.getHash());
+        }
 
-        // at good (single) price level and property iterate over offers looking at all parameters to find the match
-        md_Set::iterator offerIt = pofferSet->begin();
-        while (offerIt != pofferSet->end()) { // specific price, check all properties
-            const CMPMetaDEx* const pold = &(*offerIt);
+        // at good (single) price level and pair iterate over offers looking at all parameters to find the match
+        for (const uint256& offer : offers) {
+            const CMPMetaDEx* const pold = metadex.find(offer);
+            assert(pold != NULL);
             assert(pold->unitPrice() == sellersPrice);
 
             if (elysium_debug_metadex1) PrintToLog("Looking at existing: %s (its prop= %d, its des prop= %d) = %s\n",
                 xToString(sellersPrice), pold->getProperty(), pold->getDesProperty(), pold->ToString());
 
-            // does the desired property match?
-            if (pold->getDesProperty() != propertyForSale) {
-                ++offerIt;
-                continue;
-            }
-
             if (elysium_debug_metadex1) PrintToLog("MATCH FOUND, Trade: %s = %s\n", xToString(sellersPrice), pold->ToString());
 
             // match found, execute trade now!
@@ -219,7 +310,6 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
             if (nCouldBuy == 0) {
                 if (elysium_debug_metadex1) PrintToLog(
                         "-- buyer has not enough tokens for sale to purchase one unit!\n");
-                ++offerIt;
                 continue;
             }
 
@@ -237,7 +327,6 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
             if (xEffectivePrice > pnew->inversePrice()) {
                 if (elysium_debug_metadex1) PrintToLog(
                         "-- effective price is too expensive: %s\n", xToString(xEffectivePrice));
-                ++offerIt;
                 continue;
             }
 
@@ -313,23 +402,28 @@ static MatchReturnType x_Trade(CMPMetaDEx* const pnew)
             t_tradelistdb->recordMatchedTrade(pold->getHash(), pnew->getHash(), // < might just pass pold, pnew
                 pold->getAddr(), pnew->getAddr(), pold->getDesProperty(), pnew->getDesProperty(), seller_amountGot, buyer_amountGotAfterFee, pnew->getBlock(), tradingFee);
 
-            if (elysium_debug_metadex1) PrintToLog("++ erased old: %s\n", offerIt->ToString());
+            if (elysium_debug_metadex1) PrintToLog("++ erased old: %s\n", pold->ToString());
             // erase the old seller element
-            pofferSet->erase(offerIt++);
+            metadex.erase(offer);
 
             // insert the updated one in place of the old
             if (0 < seller_replacement.getAmountRemaining()) {
                 PrintToLog("++ inserting seller_replacement: %s\n", seller_replacement.ToString());
-                pofferSet->insert(seller_replacement);
+                metadex.insert(seller_replacement);
             }
 
             if (bBuyerSatisfied) {
                 assert(buyer_amountLeft == 0);
                 break;
             }
-        } // specific price, check all properties
+        } // specific price, check all offers
 
         if (bBuyerSatisfied) break;
+
+        // the price level and even the whole pair may be gone, if all of its orders were filled
+        ppriceMap = metadex.getPrices(propertyDesired, propertyForSale);
+        if (!ppriceMap) break;
+        priceIt = ppriceMap->upper_bound(sellersPrice);
     } // check all prices
 
     PrintToLog("%s()=%d:%s\n", __FUNCTION__, NewReturn, getTradeReturnType(NewReturn));
@@ -426,28 +520,6 @@ std::string CMPMetaDEx::ToString() const
         property, FormatMP(property, amount_forsale), desired_property, FormatMP(desired_property, amount_desired));
 }
 
-void CMPMetaDEx::saveOffer(std::ofstream& file, SHA256_CTX* shaCtx) const
-{
-    std::string lineOut = strprintf("%s,%d,%d,%d,%d,%d,%d,%d,%s,%d",
-        addr,
-        block,
-        amount_forsale,
-        property,
-        amount_desired,
-        desired_property,
-        subaction,
-        idx,
-        txid.ToString(),
-        amount_remaining
-    );
-
-    // add the line to the hash
-    SHA256_Update(shaCtx, lineOut.c_str(), lineOut.length());
-
-    // write the line
-    file << lineOut << std::endl;
-}
-
 bool MetaDEx_compare::operator()(const CMPMetaDEx &lhs, const CMPMetaDEx &rhs) const
 {
     if (lhs.getBlock() == rhs.getBlock()) return lhs.getIdx() < rhs.getIdx();
@@ -456,37 +528,7 @@ bool MetaDEx_compare::operator()(const CMPMetaDEx &lhs, const CMPMetaDEx &rhs) c
 
 bool elysium::MetaDEx_INSERT(const CMPMetaDEx& objMetaDEx)
 {
-    // Create an empty price map (to use in case price map for this property does not already exist)
-    md_PricesMap temp_prices;
-    // Attempt to obtain the price map for the property
-    md_PricesMap *p_prices = get_Prices(objMetaDEx.getProperty());
-
-    // Create an empty set of metadex objects (to use in case no set currently exists at this price)
-    md_Set temp_indexes;
-    md_Set *p_indexes = NULL;
-
-    // Prepare for return code
-    std::pair <md_Set::iterator, bool> ret;
-
-    // Attempt to obtain a set of metadex objects for this price from the price map
-    if (p_prices) p_indexes = get_Indexes(p_prices, objMetaDEx.unitPrice());
-    // See if the set was populated, if not no set exists at this price level, use the empty set that we created earlier
-    if (!p_indexes) p_indexes = &temp_indexes;
-
-    // Attempt to insert the metadex object into the set
-    ret = p_indexes->insert(objMetaDEx);
-    if (false == ret.second) return false;
-
-    // If a prices map did not exist for this property, set p_prices to the temp empty price map
-    if (!p_prices) p_prices = &temp_prices;
-
-    // Update the prices map with the new set at this price
-    (*p_prices)[objMetaDEx.unitPrice()] = *p_indexes;
-
-    // Set the metadex map for the property to the updated (or new if it didn't exist) price map
-    metadex[objMetaDEx.getProperty()] = *p_prices;
-
-    return true;
+    return metadex.insert(objMetaDEx);
 }
 
 // pretty much directly linked to the ADD TX21 command off the wire
@@ -529,49 +571,40 @@ int elysium::MetaDEx_CANCEL_AT_PRICE(const uint256& txid, unsigned int block, co
 {
     int rc = METADEX_ERROR -20;
     CMPMetaDEx mdex(sender_addr, 0, prop, amount, property_desired, amount_desired, uint256(), 0, CMPTransaction::CANCEL_AT_PRICE);
-    md_PricesMap* prices = get_Prices(prop);
-    const CMPMetaDEx* p_mdex = NULL;
 
     if (elysium_debug_metadex1) PrintToLog("%s():%s\n", __FUNCTION__, mdex.ToString());
 
     if (elysium_debug_metadex2) MetaDEx_debug_print();
 
-    if (!prices) {
+    if (!metadex.hasProperty(prop)) {
         PrintToLog("%s() NOTHING FOUND for %s\n", __FUNCTION__, mdex.ToString());
         return rc -1;
     }
 
-    // within the desired property map (given one property) iterate over the items
-    for (md_PricesMap::iterator my_it = prices->begin(); my_it != prices->end(); ++my_it) {
-        rational_t sellers_price = my_it->first;
-
-        if (mdex.unitPrice() != sellers_price) continue;
-
-        md_Set* indexes = &(my_it->second);
+    std::vector<const CMPMetaDEx*> orders;
+    for (const CMPMetaDEx* p_mdex : metadex.getOrders(sender_addr)) {
+        if (elysium_debug_metadex3) PrintToLog("%s(): %s\n", __FUNCTION__, p_mdex->ToString());
 
-        for (md_Set::iterator iitt = indexes->begin(); iitt != indexes->end();) {
-            p_mdex = &(*iitt);
+        if (p_mdex->getProperty() != prop || p_mdex->getDesProperty() != property_desired) continue;
+        if (p_mdex->unitPrice() != mdex.unitPrice()) continue;
 
-            if (elysium_debug_metadex3) PrintToLog("%s(): %s\n", __FUNCTION__, p_mdex->ToString());
-
-            if ((p_mdex->getDesProperty() != property_desired) || (p_mdex->getAddr() != sender_addr)) {
-                ++iitt;
-                continue;
-            }
+        orders.push_back(p_mdex);
+    }
+    std::sort(orders.begin(), orders.end(), MetaDEx_compare_book);
 
-            rc = 0;
-            PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, p_mdex->ToString());
+    for (const CMPMetaDEx* p_mdex : orders) {
+        rc = 0;
+        PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, p_mdex->ToString());
 
-            // move from reserve to main
-            assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), -p_mdex->getAmountRemaining(), METADEX_RESERVE));
-            assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), p_mdex->getAmountRemaining(), BALANCE));
+        // move from reserve to main
+        assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), -p_mdex->getAmountRemaining(), METADEX_RESERVE));
+        assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), p_mdex->getAmountRemaining(), BALANCE));
 
-            // record the cancellation
-            bool bValid = true;
-            p_txlistdb->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
+        // record the cancellation
+        bool bValid = true;
+        p_txlistdb->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
 
-            indexes->erase(iitt++);
-        }
+        metadex.erase(p_mdex->getHash());
     }
 
     if (elysium_debug_metadex2) MetaDEx_debug_print();
@@ -582,45 +615,39 @@ int elysium::MetaDEx_CANCEL_AT_PRICE(const uint256& txid, unsigned int block, co
 int elysium::MetaDEx_CANCEL_ALL_FOR_PAIR(const uint256& txid, unsigned int block, const std::string& sender_addr, uint32_t prop, uint32_t property_desired)
 {
     int rc = METADEX_ERROR -30;
-    md_PricesMap* prices = get_Prices(prop);
-    const CMPMetaDEx* p_mdex = NULL;
 
     PrintToLog("%s(%d,%d)\n", __FUNCTION__, prop, property_desired);
 
     if (elysium_debug_metadex3) MetaDEx_debug_print();
 
-    if (!prices) {
+    if (!metadex.hasProperty(prop)) {
         PrintToLog("%s() NOTHING FOUND\n", __FUNCTION__);
         return rc -1;
     }
 
-    // within the desired property map (given one property) iterate over the items
-    for (md_PricesMap::iterator my_it = prices->begin(); my_it != prices->end(); ++my_it) {
-        md_Set* indexes = &(my_it->second);
-
-        for (md_Set::iterator iitt = indexes->begin(); iitt != indexes->end();) {
-            p_mdex = &(*iitt);
+    std::vector<const CMPMetaDEx*> orders;
+    for (const CMPMetaDEx* p_mdex : metadex.getOrders(sender_addr)) {
+        if (elysium_debug_metadex3) PrintToLog("%s(): %s\n", __FUNCTION__, p_mdex->ToString());
 
-            if (elysium_debug_metadex3) PrintToLog("%s(): %s\n", __FUNCTION__, p_mdex->ToString());
+        if (p_mdex->getProperty() != prop || p_mdex->getDesProperty() != property_desired) continue;
 
-            if ((p_mdex->getDesProperty() != property_desired) || (p_mdex->getAddr() != sender_addr)) {
-                ++iitt;
-                continue;
-            }
+        orders.push_back(p_mdex);
+    }
+    std::sort(orders.begin(), orders.end(), MetaDEx_compare_book);
 
-            rc = 0;
-            PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, p_mdex->ToString());
+    for (const CMPMetaDEx* p_mdex : orders) {
+        rc = 0;
+        PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, p_mdex->ToString());
 
-            // move from reserve to main
-            assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), -p_mdex->getAmountRemaining(), METADEX_RESERVE));
-            assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), p_mdex->getAmountRemaining(), BALANCE));
+        // move from reserve to main
+        assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), -p_mdex->getAmountRemaining(), METADEX_RESERVE));
+        assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), p_mdex->getAmountRemaining(), BALANCE));
 
-            // record the cancellation
-            bool bValid = true;
-            p_txlistdb->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
+        // record the cancellation
+        bool bValid = true;
+        p_txlistdb->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
 
-            indexes->erase(iitt++);
-        }
+        metadex.erase(p_mdex->getHash());
     }
 
     if (elysium_debug_metadex3) MetaDEx_debug_print();
@@ -641,44 +668,31 @@ int elysium::MetaDEx_CANCEL_EVERYTHING(const uint256& txid, unsigned int block,
 
     PrintToLog("<<<<<<\n");
 
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        unsigned int prop = my_it->first;
+    std::vector<const CMPMetaDEx*> orders;
+    for (const CMPMetaDEx* p_mdex : metadex.getOrders(sender_addr)) {
+        uint32_t prop = p_mdex->getProperty();
 
         // skip property, if it is not in the expected ecosystem
         if (isMainEcosystemProperty(ecosystem) && !isMainEcosystemProperty(prop)) continue;
         if (isTestEcosystemProperty(ecosystem) && !isTestEcosystemProperty(prop)) continue;
 
-        PrintToLog(" ## property: %u\n", prop);
-        md_PricesMap& prices = my_it->second;
-
-        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) {
-            rational_t price = it->first;
-            md_Set& indexes = it->second;
-
-            PrintToLog("  # Price Level: %s\n", xToString(price));
-
-            for (md_Set::iterator it = indexes.begin(); it != indexes.end();) {
-                PrintToLog("%s= %s\n", xToString(price), it->ToString());
-
-                if (it->getAddr() != sender_addr) {
-                    ++it;
-                    continue;
-                }
+        orders.push_back(p_mdex);
+    }
+    std::sort(orders.begin(), orders.end(), MetaDEx_compare_book);
 
-                rc = 0;
-                PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, it->ToString());
+    for (const CMPMetaDEx* p_mdex : orders) {
+        rc = 0;
+        PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, p_mdex->ToString());
 
-                // move from reserve to balance
-                assert(update_tally_map(it->getAddr(), it->getProperty(), -it->getAmountRemaining(), METADEX_RESERVE));
-                assert(update_tally_map(it->getAddr(), it->getProperty(), it->getAmountRemaining(), BALANCE));
+        // move from reserve to balance
+        assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), -p_mdex->getAmountRemaining(), METADEX_RESERVE));
+        assert(update_tally_map(p_mdex->getAddr(), p_mdex->getProperty(), p_mdex->getAmountRemaining(), BALANCE));
 
-                // record the cancellation
-                bool bValid = true;
-                p_txlistdb->recordMetaDExCancelTX(txid, it->getHash(), bValid, block, it->getProperty(), it->getAmountRemaining());
+        // record the cancellation
+        bool bValid = true;
+        p_txlistdb->recordMetaDExCancelTX(txid, p_mdex->getHash(), bValid, block, p_mdex->getProperty(), p_mdex->getAmountRemaining());
 
-                indexes.erase(it++);
-            }
-        }
+        metadex.erase(p_mdex->getHash());
     }
     PrintToLog(">>>>>>\n");
 
@@ -694,21 +708,25 @@ int elysium::MetaDEx_SHUTDOWN_ALLPAIR()
 {
     int rc = 0;
     PrintToLog("%s()\n", __FUNCTION__);
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        md_PricesMap& prices = my_it->second;
-        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) {
-            md_Set& indexes = it->second;
-            for (md_Set::iterator it = indexes.begin(); it != indexes.end();) {
-                if (it->getDesProperty() > ELYSIUM_PROPERTY_TELYSIUM && it->getProperty() > ELYSIUM_PROPERTY_TELYSIUM) { // no ELYSIUM/TELYSIUM side to the trade
-                    PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, it->ToString());
-                    // move from reserve to balance
-                    assert(update_tally_map(it->getAddr(), it->getProperty(), -it->getAmountRemaining(), METADEX_RESERVE));
-                    assert(update_tally_map(it->getAddr(), it->getProperty(), it->getAmountRemaining(), BALANCE));
-                    indexes.erase(it++);
-                }
+    std::vector<uint256> orders;
+    for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
+        const md_PropertyPair& pair = my_it->first;
+        if (pair.first <= ELYSIUM_PROPERTY_TELYSIUM || pair.second <= ELYSIUM_PROPERTY_TELYSIUM) continue; // ELYSIUM/TELYSIUM side to the trade
+        const md_PricesMap& prices = my_it->second;
+        for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
+            const md_Set& indexes = it->second;
+            for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
+                PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, it->ToString());
+                // move from reserve to balance
+                assert(update_tally_map(it->getAddr(), it->getProperty(), -it->getAmountRemaining(), METADEX_RESERVE));
+                assert(update_tally_map(it->getAddr(), it->getProperty(), it->getAmountRemaining(), BALANCE));
+                orders.push_back(it->getHash());
             }
         }
     }
+    for (const uint256& order : orders) {
+        metadex.erase(order);
+    }
     return rc;
 }
 
@@ -719,19 +737,19 @@ int elysium::MetaDEx_SHUTDOWN()
 {
     int rc = 0;
     PrintToLog("%s()\n", __FUNCTION__);
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        md_PricesMap& prices = my_it->second;
-        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) {
-            md_Set& indexes = it->second;
-            for (md_Set::iterator it = indexes.begin(); it != indexes.end();) {
+    for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
+        const md_PricesMap& prices = my_it->second;
+        for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
+            const md_Set& indexes = it->second;
+            for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
                 PrintToLog("%s(): REMOVING %s\n", __FUNCTION__, it->ToString());
                 // move from reserve to balance
                 assert(update_tally_map(it->getAddr(), it->getProperty(), -it->getAmountRemaining(), METADEX_RESERVE));
                 assert(update_tally_map(it->getAddr(), it->getProperty(), it->getAmountRemaining(), BALANCE));
-                indexes.erase(it++);
             }
         }
     }
+    metadex.clear();
     return rc;
 }
 
@@ -739,18 +757,9 @@ int elysium::MetaDEx_SHUTDOWN()
 // allows search to be optimized if propertyIdForSale is specified
 bool elysium::MetaDEx_isOpen(const uint256& txid, uint32_t propertyIdForSale)
 {
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        if (propertyIdForSale != 0 && propertyIdForSale != my_it->first) continue;
-        md_PricesMap & prices = my_it->second;
-        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) {
-            md_Set & indexes = (it->second);
-            for (md_Set::iterator it = indexes.begin(); it != indexes.end(); ++it) {
-                CMPMetaDEx obj = *it;
-                if( obj.getHash().GetHex() == txid.GetHex() ) return true;
-            }
-        }
-    }
-    return false;
+    const CMPMetaDEx* obj = metadex.find(txid);
+    if (!obj) return false;
+    return propertyIdForSale == 0 || propertyIdForSale == obj->getProperty();
 }
 
 /**
@@ -808,19 +817,19 @@ int elysium::MetaDEx_getStatus(const uint256& txid, uint32_t propertyIdForSale,
 void elysium::MetaDEx_debug_print(bool bShowPriceLevel, bool bDisplay)
 {
     PrintToLog("<<<\n");
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        uint32_t prop = my_it->first;
+    for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
+        const md_PropertyPair& pair = my_it->first;
 
-        PrintToLog(" ## property: %u\n", prop);
-        md_PricesMap& prices = my_it->second;
+        PrintToLog(" ## property: %u, desired property: %u\n", pair.first, pair.second);
+        const md_PricesMap& prices = my_it->second;
 
-        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) {
+        for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
             rational_t price = it->first;
-            md_Set& indexes = it->second;
+            const md_Set& indexes = it->second;
 
             if (bShowPriceLevel) PrintToLog("  # Price Level: %s\n", xToString(price));
 
-            for (md_Set::iterator it = indexes.begin(); it != indexes.end(); ++it) {
+            for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
                 const CMPMetaDEx& obj = *it;
 
                 if (bDisplay) PrintToLog("%s= %s\n", xToString(price), obj.ToString());
@@ -837,14 +846,5 @@ void elysium::MetaDEx_debug_print(bool bShowPriceLevel, bool bDisplay)
  */
 const CMPMetaDEx* elysium::MetaDEx_RetrieveTrade(const uint256& txid)
 {
-    for (md_PropertiesMap::iterator propIter = metadex.begin(); propIter != metadex.end(); ++propIter) {
-        md_PricesMap & prices = propIter->second;
-        for (md_PricesMap::iterator pricesIter = prices.begin(); pricesIter != prices.end(); ++pricesIter) {
-            md_Set & indexes = pricesIter->second;
-            for (md_Set::iterator tradesIter = indexes.begin(); tradesIter != indexes.end(); ++tradesIter) {
-                if (txid == (*tradesIter).getHash()) return &(*tradesIter);
-            }
-        }
-    }
-    return (CMPMetaDEx*) NULL;
+    return metadex.find(txid);
 }
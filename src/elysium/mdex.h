@@ -3,6 +3,8 @@
 
 #include "elysium/tx.h"
 
+#include "saltedhasher.h"
+#include "serialize.h"
 #include "uint256.h"
 
 #include <boost/lexical_cast.hpp>
@@ -18,6 +20,9 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 typedef boost::rational<boost::multiprecision::checked_int128_t> rational_t;
 
@@ -99,7 +104,22 @@ public:
     /** Used for display of unit prices with 50 decimal places at RPC layer. */
     std::string displayFullUnitPrice() const;
 
-    void saveOffer(std::ofstream& file, SHA256_CTX* shaCtx) const;
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(addr);
+        READWRITE(VARINT(block));
+        READWRITE(amount_forsale);
+        READWRITE(VARINT(property));
+        READWRITE(amount_desired);
+        READWRITE(VARINT(desired_property));
+        READWRITE(subaction);
+        READWRITE(VARINT(idx));
+        READWRITE(txid);
+        READWRITE(amount_remaining);
+    }
 };
 
 namespace elysium
@@ -114,15 +134,56 @@ struct MetaDEx_compare
 typedef std::set<CMPMetaDEx, MetaDEx_compare> md_Set;
 //! Map of prices; there is a set of sorted objects for each price
 typedef std::map<rational_t, md_Set> md_PricesMap;
-//! Map of properties; there is a map of prices for each property
-typedef std::map<uint32_t, md_PricesMap> md_PropertiesMap;
+//! Property for sale and desired property of an order
+typedef std::pair<uint32_t, uint32_t> md_PropertyPair;
+//! Map of property pairs; there is a map of prices for each pair
+typedef std::map<md_PropertyPair, md_PricesMap> md_PropertiesMap;
+
+/** The order book of the distributed exchange.
+ *
+ * Orders are kept in price levels per pair of property for sale and desired property, so the
+ * best offers of a pair are found without looking at other markets. Orders are additionally
+ * indexed by transaction and by sender, which keeps lookups and cancellations independent of
+ * the size of the whole book.
+ */
+class MetaDExBook
+{
+public:
+    typedef md_PropertiesMap::const_iterator const_iterator;
+
+    //! Iterates over the pairs, ordered by property for sale and desired property
+    const_iterator begin() const { return pairs.begin(); }
+    const_iterator end() const { return pairs.end(); }
+
+    //! Returns the number of open orders
+    size_t size() const { return orders.size(); }
+    bool empty() const { return orders.empty(); }
+    void clear();
+    //! Exchanges the orders with another book, the orders keep their addresses
+    void swap(MetaDExBook& other);
+
+    //! Returns the price levels of a pair, or NULL if there are no orders for it
+    const md_PricesMap* getPrices(uint32_t property, uint32_t desiredProperty) const;
+    //! Checks whether there are orders selling the property
+    bool hasProperty(uint32_t property) const;
+    //! Returns the order created by the transaction, or NULL if it is not open
+    const CMPMetaDEx* find(const uint256& txid) const;
+    //! Returns the open orders of the address, in no particular order
+    std::vector<const CMPMetaDEx*> getOrders(const std::string& address) const;
+
+    //! Adds an order, fails if the order or one at the same position in the chain exists
+    bool insert(const CMPMetaDEx& order);
+    //! Removes the order created by the transaction, and price levels which become empty
+    bool erase(const uint256& txid);
 
-//! Global map for price and order data
-extern md_PropertiesMap metadex;
+private:
+    md_PropertiesMap pairs;
+    std::unordered_map<uint256, const CMPMetaDEx*, StaticSaltedHasher> orders;
+    std::unordered_map<std::string, std::set<uint256>> senders;
+};
 
-// TODO: explore a property-pair, instead of a single property as map's key........
-md_PricesMap* get_Prices(uint32_t prop);
-md_Set* get_Indexes(md_PricesMap* p, rational_t price);
+//! Global map for price and order data
+extern MetaDExBook metadex;
 // ---------------
 
 int MetaDEx_ADD(const std::string& sender_addr, uint32_t, int64_t, int block, uint32_t property_desired, int64_t amount_desired, const uint256& txid, unsigned int idx);
@@ -106,6 +106,37 @@ boost::optional<PacketClass> DeterminePacketClass(const CTransaction& tx, int he
     return boost::none;
 }
 
+bool HasMarker(const CTransaction& tx)
+{
+    auto sysDest = GetSystemAddress().Get();
+
+    for (auto& output : tx.vout) {
+        txnouttype type;
+
+        if (!GetOutputType(output.scriptPubKey, type)) {
+            continue;
+        }
+
+        if (type == TX_PUBKEYHASH) {
+            CTxDestination dest;
+
+            if (ExtractDestination(output.scriptPubKey, dest) && dest == sysDest) {
+                return true;
+            }
+        } else if (type == TX_NULL_DATA) {
+            std::vector<std::vector<unsigned char>> pushes;
+
+            GetPushedValues(output.scriptPubKey, std::back_inserter(pushes));
+
+            if (!pushes.empty() && pushes[0].size() >= magic.size() && std::equal(magic.begin(), magic.end(), pushes[0].begin())) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 } // namespace elysium
 
 namespace std {
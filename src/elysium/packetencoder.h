@@ -137,6 +137,14 @@ extern const std::array<unsigned char, 6> magic;
 const CBitcoinAddress& GetSystemAddress();
 boost::optional<PacketClass> DeterminePacketClass(const CTransaction& tx, int height);
 
+/**
+ * Checks whether a transaction has an output with the class C marker or an output to the system
+ * address, regardless of the output types allowed at any particular height.
+ *
+ * Every transaction with a packet passes this check, so it can be used to pre-select transactions.
+ **/
+bool HasMarker(const CTransaction& tx);
+
 /**
  * Embedds a payload in obfuscated multisig outputs, then adds P2PKH output to system address.
  *
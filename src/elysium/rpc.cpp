@@ -676,7 +676,7 @@ UniValue elysiumrpc(const JSONRPCRequest& request)
             LOCK(cs_main);
             int64_t total = 0;
             // display all balances
-            for (std::unordered_map<std::string, CMPTally>::iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
+            for (CMPTallyMap::const_iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
                 PrintToLog("%34s => ", my_it->first);
                 total += (my_it->second).print(extra2, bDivisible);
             }
@@ -701,14 +701,12 @@ UniValue elysiumrpc(const JSONRPCRequest& request)
         case 3:
         {
             LOCK(cs_main);
-            uint32_t id = 0;
             // for each address display all currencies it holds
-            for (std::unordered_map<std::string, CMPTally>::iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
+            for (CMPTallyMap::const_iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
                 PrintToLog("%34s => ", my_it->first);
                 (my_it->second).print(extra2);
-                (my_it->second).init();
-                while (0 != (id = (my_it->second).next())) {
-                    PrintToLog("Id: %u=0x%X ", id, id);
+                for (CMPTally::const_iterator token = (my_it->second).begin(); token != (my_it->second).end(); ++token) {
+                    PrintToLog("Id: %u=0x%X ", token->first, token->first);
                 }
                 PrintToLog("\n");
             }
@@ -865,20 +863,9 @@ UniValue elysium_getallbalancesforid(const JSONRPCRequest& request)
 
     LOCK(cs_main);
 
-    for (std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-        uint32_t id = 0;
-        bool includeAddress = false;
-        std::string address = it->first;
-        (it->second).init();
-        while (0 != (id = (it->second).next())) {
-            if (id == propertyId) {
-                includeAddress = true;
-                break;
-            }
-        }
-        if (!includeAddress) {
-            continue; // ignore this address, has never transacted in this propertyId
-        }
+    // only addresses which have transacted in this propertyId
+    for (CMPTallyMap::AddressId id : mp_tally_map.getHolders(propertyId)) {
+        const std::string& address = mp_tally_map.get(id).first;
         UniValue balanceObj(UniValue::VOBJ);
         balanceObj.push_back(Pair("address", address));
         bool nonEmptyBalance = BalanceToJSON(address, propertyId, balanceObj, isDivisible);
@@ -919,16 +906,14 @@ UniValue elysium_getallbalancesforaddress(const JSONRPCRequest& request)
 
     LOCK(cs_main);
 
-    CMPTally* addressTally = getTally(address);
+    const CMPTally* addressTally = getTally(address);
 
     if (NULL == addressTally) { // addressTally object does not exist
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Address not found");
     }
 
-    addressTally->init();
-
-    uint32_t propertyId = 0;
-    while (0 != (propertyId = addressTally->next())) {
+    for (CMPTally::const_iterator token = addressTally->begin(); token != addressTally->end(); ++token) {
+        uint32_t propertyId = token->first;
         UniValue balanceObj(UniValue::VOBJ);
         balanceObj.push_back(Pair("propertyid", (uint64_t) propertyId));
         bool nonEmptyBalance = BalanceToJSON(address, propertyId, balanceObj, isPropertyDivisible(propertyId));
@@ -1427,13 +1412,13 @@ UniValue elysium_getorderbook(const JSONRPCRequest& request)
     {
         LOCK(cs_main);
         for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
+            if (my_it->first.first != propertyIdForSale) continue;
+            if (filterDesired && my_it->first.second != propertyIdDesired) continue;
             const md_PricesMap& prices = my_it->second;
             for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
                 const md_Set& indexes = it->second;
                 for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
-                    const CMPMetaDEx& obj = *it;
-                    if (obj.getProperty() != propertyIdForSale) continue;
-                    if (!filterDesired || obj.getDesProperty() == propertyIdDesired) vecMetaDexObjects.push_back(obj);
+                    vecMetaDexObjects.push_back(*it);
                 }
             }
         }
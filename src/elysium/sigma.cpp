@@ -1,16 +1,153 @@
 #include "sigma.h"
 
+#include "log.h"
 #include "sigmadb.h"
 #include "sigmaprimitives.h"
+#include "tx.h"
 
+#include "../chainparams.h"
 #include "../validation.h"
 #include "../sync.h"
 
+#include <algorithm>
+#include <functional>
 #include <iterator>
+#include <map>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace elysium {
 
+namespace {
+
+struct VerifiedSpend
+{
+    PropertyId property;
+    SigmaDenomination denomination;
+    SigmaMintGroup group;
+    size_t groupSize;
+    secp_primitives::Scalar serial;
+    bool fPadding;
+    SigmaProof proof;
+};
+
+// spends of the block being processed which passed batch verification, guarded by cs_main
+std::multimap<uint160, VerifiedSpend> verifiedSpends;
+
+bool IsVerifiedSpend(
+    PropertyId property,
+    SigmaDenomination denomination,
+    SigmaMintGroup group,
+    size_t groupSize,
+    const SigmaProof& proof,
+    const secp_primitives::Scalar& serial,
+    bool fPadding)
+{
+    auto range = verifiedSpends.equal_range(GetSerialId(serial));
+
+    for (auto it = range.first; it != range.second; it++) {
+        auto& spend = it->second;
+
+        if (spend.property == property && spend.denomination == denomination && spend.group == group &&
+            spend.groupSize == groupSize && spend.serial == serial && spend.fPadding == fPadding && spend.proof == proof) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // unnamed namespace
+
+SigmaGroupCache *sigmaGroupCache;
+
+SigmaGroupCache::SigmaGroupCache(SigmaDatabase& db) : db(db)
+{
+    using std::placeholders::_1;
+    using std::placeholders::_2;
+    using std::placeholders::_3;
+    using std::placeholders::_4;
+    using std::placeholders::_5;
+    using std::placeholders::_6;
+
+    {
+        auto h = std::bind(&SigmaGroupCache::OnMintAdded, this, _1, _2, _3, _4, _5, _6);
+        eventConnections.emplace_front(db.MintAdded.connect(h));
+    }
+    {
+        auto h = std::bind(&SigmaGroupCache::OnMintRemoved, this, _1, _2, _3);
+        eventConnections.emplace_front(db.MintRemoved.connect(h));
+    }
+}
+
+std::vector<SigmaPublicKey> SigmaGroupCache::GetGroup(
+    PropertyId property, SigmaDenomination denomination, SigmaMintGroup group, size_t count)
+{
+    GroupKey key(property, denomination, group);
+    auto it = groups.find(key);
+
+    if (it == groups.end()) {
+        std::vector<SigmaPublicKey> pubs;
+        db.GetAnonimityGroup(property, denomination, group, std::back_inserter(pubs));
+
+        // don't keep groups which do not exist, any group id can be requested by a spend
+        if (pubs.empty()) {
+            return pubs;
+        }
+
+        it = groups.emplace(key, std::move(pubs)).first;
+    }
+
+    auto& pubs = it->second;
+    return std::vector<SigmaPublicKey>(pubs.begin(), pubs.begin() + std::min(count, pubs.size()));
+}
+
+void SigmaGroupCache::Clear()
+{
+    groups.clear();
+}
+
+void SigmaGroupCache::OnMintAdded(
+    PropertyId property, SigmaDenomination denomination, SigmaMintGroup group, SigmaMintIndex index, const SigmaPublicKey& pubKey, int height)
+{
+    auto it = groups.find(GroupKey(property, denomination, group));
+
+    if (it == groups.end()) {
+        return;
+    }
+
+    if (index == it->second.size()) {
+        it->second.push_back(pubKey);
+    } else {
+        groups.erase(it);
+    }
+}
+
+void SigmaGroupCache::OnMintRemoved(PropertyId property, SigmaDenomination denomination, const SigmaPublicKey& pubKey)
+{
+    // the signal does not tell the group of the mint, so look for the cached group which holds it
+    auto it = groups.lower_bound(GroupKey(property, denomination, 0));
+
+    for (; it != groups.end() && std::get<0>(it->first) == property && std::get<1>(it->first) == denomination; it++) {
+        auto& pubs = it->second;
+        auto pub = std::find(pubs.begin(), pubs.end(), pubKey);
+
+        if (pub == pubs.end()) {
+            continue;
+        }
+
+        // mints are removed from the newest one, anything else is read again when the group is needed
+        if (std::next(pub) == pubs.end() && pubs.size() > 1) {
+            pubs.pop_back();
+        } else {
+            groups.erase(it);
+        }
+
+        return;
+    }
+}
+
 bool VerifySigmaSpend(
     PropertyId property,
     SigmaDenomination denomination,
@@ -24,7 +161,16 @@ bool VerifySigmaSpend(
 
     {
         LOCK(cs_main);
-        sigmaDb->GetAnonimityGroup(property, denomination, group, groupSize, std::back_inserter(anonimitySet));
+
+        if (IsVerifiedSpend(property, denomination, group, groupSize, proof, serial, fPadding)) {
+            return true;
+        }
+
+        if (sigmaGroupCache) {
+            anonimitySet = sigmaGroupCache->GetGroup(property, denomination, group, groupSize);
+        } else {
+            sigmaDb->GetAnonimityGroup(property, denomination, group, groupSize, std::back_inserter(anonimitySet));
+        }
     }
 
     // If the size of anonimity set is not the expected once then no need to verify the proof.
@@ -35,4 +181,98 @@ bool VerifySigmaSpend(
     return proof.Verify(serial, anonimitySet.begin(), anonimitySet.end(), fPadding);
 }
 
+void BatchVerifySigmaSpends(const std::vector<CMPTransaction*>& txs, int block)
+{
+    typedef std::tuple<PropertyId, SigmaDenomination, SigmaMintGroup, size_t> BatchKey;
+
+    LOCK(cs_main);
+
+    verifiedSpends.clear();
+
+    bool const fPadding = block >= ::Params().GetConsensus().nSigmaPaddingBlock;
+    std::map<BatchKey, std::vector<VerifiedSpend>> batches;
+
+    for (auto ptx : txs) {
+        auto& tx = *ptx;
+
+        if (!tx.interpret_Transaction()) {
+            continue;
+        }
+
+        if (tx.getType() != ELYSIUM_TYPE_SIMPLE_SPEND || !tx.getSpend() || !tx.getSerial()) {
+            continue;
+        }
+
+        BatchKey key(tx.getProperty(), tx.getDenomination(), tx.getGroup(), tx.getGroupSize());
+        batches[key].push_back(VerifiedSpend{
+            tx.getProperty(), tx.getDenomination(), tx.getGroup(), tx.getGroupSize(), *tx.getSerial(), fPadding, *tx.getSpend()});
+    }
+
+    auto& params = DefaultSigmaParams;
+    sigma::SigmaPlusVerifier<secp_primitives::Scalar, secp_primitives::GroupElement> verifier(
+        params.g,
+        params.h,
+        params.n,
+        params.m
+    );
+
+    for (auto& batch : batches) {
+        auto& spends = batch.second;
+        auto& first = spends.front();
+
+        std::vector<SigmaPublicKey> anonimitySet;
+        if (sigmaGroupCache) {
+            anonimitySet = sigmaGroupCache->GetGroup(first.property, first.denomination, first.group, first.groupSize);
+        } else {
+            sigmaDb->GetAnonimityGroup(first.property, first.denomination, first.group, first.groupSize, std::back_inserter(anonimitySet));
+        }
+
+        // the group may be completed by mints of this block, leave the spends to be verified when they are processed
+        if (anonimitySet.empty() || anonimitySet.size() != first.groupSize) {
+            continue;
+        }
+
+        std::vector<secp_primitives::GroupElement> commits;
+        commits.reserve(anonimitySet.size());
+        for (auto& pub : anonimitySet) {
+            commits.push_back(pub.commitment);
+        }
+
+        std::vector<secp_primitives::Scalar> serials;
+        std::vector<bool> paddings;
+        std::vector<size_t> setSizes;
+        std::vector<sigma::SigmaPlusProof<secp_primitives::Scalar, secp_primitives::GroupElement>> proofs;
+
+        for (auto& spend : spends) {
+            serials.push_back(spend.serial);
+            paddings.push_back(spend.fPadding);
+            setSizes.push_back(spend.groupSize);
+            proofs.push_back(spend.proof.proof);
+        }
+
+        bool valid;
+        try {
+            valid = verifier.batch_verify(commits, serials, paddings, setSizes, proofs);
+        } catch (...) {
+            valid = false;
+        }
+
+        // at least one of the proofs is invalid, leave them to be verified one by one
+        if (!valid) {
+            PrintToLog("%s(): batch of %d spends of property %d failed to verify\n", __func__, spends.size(), first.property);
+            continue;
+        }
+
+        for (auto& spend : spends) {
+            verifiedSpends.emplace(GetSerialId(spend.serial), spend);
+        }
+    }
+}
+
+void ClearVerifiedSigmaSpends()
+{
+    LOCK(cs_main);
+    verifiedSpends.clear();
+}
+
 } // namespace elysium
@@ -4,10 +4,54 @@
 #include "property.h"
 #include "sigmaprimitives.h"
 
+#include <boost/signals2/connection.hpp>
+
+#include <forward_list>
+#include <map>
+#include <tuple>
+#include <vector>
+
 #include <stddef.h>
 
+class CMPTransaction;
+
 namespace elysium {
 
+class SigmaDatabase;
+
+/**
+ * In-memory copy of the anonymity groups which are used by spends.
+ *
+ * A group is read from the database the first time it is needed and then kept up to date through
+ * the MintAdded and MintRemoved signals of the database, so its public keys are not read and
+ * decoded again for every spend.
+ */
+class SigmaGroupCache
+{
+public:
+    explicit SigmaGroupCache(SigmaDatabase& db);
+
+public:
+    /** Returns the first count public keys of a group, or less if the group does not have as many. */
+    std::vector<SigmaPublicKey> GetGroup(PropertyId property, SigmaDenomination denomination, SigmaMintGroup group, size_t count);
+
+    /** Drops all groups, which is required if the database is cleared without signals. */
+    void Clear();
+
+private:
+    typedef std::tuple<PropertyId, SigmaDenomination, SigmaMintGroup> GroupKey;
+
+    void OnMintAdded(PropertyId property, SigmaDenomination denomination, SigmaMintGroup group, SigmaMintIndex index, const SigmaPublicKey& pubKey, int height);
+    void OnMintRemoved(PropertyId property, SigmaDenomination denomination, const SigmaPublicKey& pubKey);
+
+private:
+    SigmaDatabase& db;
+    std::map<GroupKey, std::vector<SigmaPublicKey>> groups;
+    std::forward_list<boost::signals2::scoped_connection> eventConnections;
+};
+
+extern SigmaGroupCache *sigmaGroupCache;
+
 bool VerifySigmaSpend(
     PropertyId property,
     SigmaDenomination denomination,
@@ -17,6 +61,16 @@ bool VerifySigmaSpend(
     const secp_primitives::Scalar& serial,
     bool fPadding);
 
+/**
+ * Verifies the proofs of the Sigma spends in the parsed transactions of a block, with one batch for
+ * each anonymity set. Spends which pass are remembered, so VerifySigmaSpend() accepts them without
+ * verifying their proofs again while the transactions are processed.
+ */
+void BatchVerifySigmaSpends(const std::vector<CMPTransaction*>& txs, int block);
+
+/** Forgets the spends which were verified by BatchVerifySigmaSpends(). */
+void ClearVerifiedSigmaSpends();
+
 } // namespace elysium
 
 #endif // FIRO_ELYSIUM_SIGMA_H
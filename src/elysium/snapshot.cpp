@@ -0,0 +1,236 @@
+#include "snapshot.h"
+
+#include "log.h"
+
+#include "../clientversion.h"
+#include "../hash.h"
+#include "../serialize.h"
+#include "../tinyformat.h"
+#include "../util.h"
+
+#include <boost/filesystem.hpp>
+
+#include <stdexcept>
+#include <utility>
+
+#include <stdio.h>
+
+namespace elysium {
+
+namespace {
+
+// maximum number of snapshots waiting for the writer before new ones have to wait for it
+constexpr size_t MAX_PENDING_SNAPSHOTS = 8;
+
+CDataStream MakeSectionStream()
+{
+    return CDataStream(SER_DISK, CLIENT_VERSION);
+}
+
+} // unnamed namespace
+
+StateSnapshot::StateSnapshot() : height(-1)
+{
+}
+
+StateSnapshot::StateSnapshot(const uint256& block, int height) : block(block), height(height)
+{
+}
+
+CDataStream& StateSnapshot::GetSection(int type)
+{
+    auto it = sections.find(type);
+
+    if (it == sections.end()) {
+        it = sections.emplace(type, MakeSectionStream()).first;
+    }
+
+    return it->second;
+}
+
+CDataStream* StateSnapshot::FindSection(int type)
+{
+    auto it = sections.find(type);
+    return it != sections.end() ? &it->second : nullptr;
+}
+
+bool StateSnapshot::VerifySection(int type) const
+{
+    auto section = sections.find(type);
+    auto checksum = checksums.find(type);
+
+    if (section == sections.end() || checksum == checksums.end()) {
+        return false;
+    }
+
+    return Hash(section->second.begin(), section->second.end()) == checksum->second;
+}
+
+bool StateSnapshot::WriteToFile(const boost::filesystem::path& path) const
+{
+    boost::filesystem::path tmp = path;
+    tmp += ".new";
+
+    try {
+        CAutoFile file(fopen(tmp.string().c_str(), "wb"), SER_DISK, CLIENT_VERSION);
+        if (file.IsNull()) {
+            PrintToLog("%s(): failed to open %s for writing\n", __func__, tmp.string());
+            return false;
+        }
+
+        file << MAGIC;
+        file << VARINT(VERSION);
+        file << block;
+        file << VARINT(height);
+
+        WriteCompactSize(file, sections.size());
+
+        for (auto& section : sections) {
+            auto& payload = section.second;
+
+            file << static_cast<uint8_t>(section.first);
+            file << Hash(payload.begin(), payload.end());
+            file << static_cast<uint64_t>(payload.size());
+            file.write(payload.data(), payload.size());
+        }
+
+        FileCommit(file.Get());
+        file.fclose();
+    } catch (const std::exception& e) {
+        PrintToLog("%s(): failed to write %s: %s\n", __func__, tmp.string(), e.what());
+        return false;
+    }
+
+    return RenameOver(tmp, path);
+}
+
+bool StateSnapshot::ReadFromFile(const boost::filesystem::path& path)
+{
+    sections.clear();
+    checksums.clear();
+
+    try {
+        CAutoFile file(fopen(path.string().c_str(), "rb"), SER_DISK, CLIENT_VERSION);
+        if (file.IsNull()) {
+            return false;
+        }
+
+        uint32_t magic, version;
+
+        file >> magic;
+        file >> VARINT(version);
+
+        if (magic != MAGIC || version != VERSION) {
+            PrintToLog("%s(): %s is not a supported state snapshot\n", __func__, path.string());
+            return false;
+        }
+
+        file >> block;
+        file >> VARINT(height);
+
+        auto count = ReadCompactSize(file);
+
+        for (uint64_t i = 0; i < count; i++) {
+            uint8_t type;
+            uint256 checksum;
+            uint64_t size;
+
+            file >> type;
+            file >> checksum;
+            file >> size;
+
+            auto& payload = GetSection(type);
+            payload.resize(size);
+            file.read(payload.data(), size);
+
+            checksums[type] = checksum;
+        }
+    } catch (const std::exception& e) {
+        PrintToLog("%s(): failed to read %s: %s\n", __func__, path.string(), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+std::string GetSnapshotFileName(const uint256& block)
+{
+    return strprintf("state-%s.bin", block.ToString());
+}
+
+StateSnapshotWriter::StateSnapshotWriter(const boost::filesystem::path& directory, int history)
+    : directory(directory), history(history), pending(0), worker(1)
+{
+    RenameThreadPool(worker, "elysium-persist");
+}
+
+StateSnapshotWriter::~StateSnapshotWriter()
+{
+    worker.stop(true);
+}
+
+void StateSnapshotWriter::Track(const uint256& block, int height, const boost::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    files.emplace(height, std::make_pair(block, path));
+}
+
+void StateSnapshotWriter::Write(std::shared_ptr<const StateSnapshot> snapshot, std::function<void()> onWritten)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        written.wait(lock, [this] { return pending < MAX_PENDING_SNAPSHOTS; });
+        pending++;
+    }
+
+    worker.push([this, snapshot, onWritten](int) {
+        auto path = directory / GetSnapshotFileName(snapshot->GetBlock());
+
+        if (snapshot->WriteToFile(path)) {
+            Track(snapshot->GetBlock(), snapshot->GetHeight(), path);
+            if (onWritten) {
+                onWritten();
+            }
+        }
+
+        Prune(snapshot->GetHeight());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        written.notify_all();
+    });
+}
+
+void StateSnapshotWriter::Flush()
+{
+    worker.push([](int) {}).wait();
+}
+
+size_t StateSnapshotWriter::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+void StateSnapshotWriter::Prune(int tipHeight)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto end = files.lower_bound(tipHeight - history);
+
+    for (auto it = files.begin(); it != end; it++) {
+        if (elysium_debug_persistence) {
+            PrintToLog("State from Block:%s is no longer need, removing %s (age-from-tip: %d)\n",
+                it->second.first.ToString(), it->second.second.filename().string(), tipHeight - it->first);
+        }
+
+        boost::system::error_code ec;
+        boost::filesystem::remove(it->second.second, ec);
+    }
+
+    files.erase(files.begin(), end);
+}
+
+} // namespace elysium
@@ -0,0 +1,114 @@
+#ifndef FIRO_ELYSIUM_SNAPSHOT_H
+#define FIRO_ELYSIUM_SNAPSHOT_H
+
+#include "../ctpl.h"
+#include "../streams.h"
+#include "../uint256.h"
+
+#include <boost/filesystem/path.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <inttypes.h>
+
+namespace elysium {
+
+/**
+ * Binary snapshot of the in-memory state as of a given block.
+ *
+ * A snapshot is made of independent sections, one for each kind of state (see FILETYPES). On disk
+ * each section is stored as a length-prefixed payload together with the double SHA256 of that
+ * payload, so sections can be verified and decoded separately and in parallel.
+ */
+class StateSnapshot
+{
+public:
+    static constexpr uint32_t MAGIC = 0x736c7965; // "elys"
+    static constexpr uint32_t VERSION = 1;
+
+public:
+    StateSnapshot();
+    StateSnapshot(const uint256& block, int height);
+
+public:
+    const uint256& GetBlock() const { return block; }
+    int GetHeight() const { return height; }
+
+    /** Returns the stream of the given section, creating an empty one if it does not exist. */
+    CDataStream& GetSection(int type);
+
+    /** Returns the stream of the given section, or nullptr if the snapshot has no such section. */
+    CDataStream* FindSection(int type);
+
+    /** Checks the payload of the given section against the checksum stored with it. */
+    bool VerifySection(int type) const;
+
+    /** Writes the snapshot to a temporary file, syncs it and moves it over the given path. */
+    bool WriteToFile(const boost::filesystem::path& path) const;
+
+    /** Reads a snapshot without verifying the section checksums. */
+    bool ReadFromFile(const boost::filesystem::path& path);
+
+private:
+    uint256 block;
+    int height;
+    std::map<int, CDataStream> sections;
+    std::map<int, uint256> checksums;
+};
+
+/** Returns the name of the snapshot file of the given block. */
+std::string GetSnapshotFileName(const uint256& block);
+
+/**
+ * Writes state snapshots on a background thread and prunes the ones which fall out of the history.
+ *
+ * Snapshots are written in the order they are queued. The writer keeps track of the files it knows
+ * about, so pruning does not need to list the persistence directory or to look up block indexes.
+ */
+class StateSnapshotWriter
+{
+public:
+    StateSnapshotWriter(const boost::filesystem::path& directory, int history);
+    ~StateSnapshotWriter();
+
+public:
+    /** Registers an existing file with state of the given block, so it is pruned eventually. */
+    void Track(const uint256& block, int height, const boost::filesystem::path& path);
+
+    /**
+     * Queues a snapshot to be written and prunes files which are too old relative to it.
+     *
+     * The callback runs on the writer thread once the snapshot is on disk, it is not called if the write fails.
+     */
+    void Write(std::shared_ptr<const StateSnapshot> snapshot, std::function<void()> onWritten = nullptr);
+
+    /** Blocks until all queued snapshots are written. */
+    void Flush();
+
+    /** Returns the number of snapshots which are queued, but not yet written. */
+    size_t GetPendingCount() const;
+
+private:
+    void Prune(int tipHeight);
+
+private:
+    const boost::filesystem::path directory;
+    const int history;
+
+    mutable std::mutex mutex;
+    std::condition_variable written;
+    std::multimap<int, std::pair<uint256, boost::filesystem::path>> files;
+    size_t pending;
+
+    ctpl::thread_pool worker;
+};
+
+} // namespace elysium
+
+#endif // FIRO_ELYSIUM_SNAPSHOT_H
@@ -41,11 +41,10 @@ OwnerAddrType STO_GetReceivers(const std::string& sender, uint32_t property, int
 
     {
         LOCK(cs_main);
-        std::unordered_map<std::string, CMPTally>::iterator it;
-
-        for (it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-            const std::string& address = it->first;
-            const CMPTally& tally = it->second;
+        // Only holders of the property can receive
+        for (CMPTallyMap::AddressId id : mp_tally_map.getHolders(property)) {
+            const std::string& address = mp_tally_map.get(id).first;
+            const CMPTally& tally = mp_tally_map.get(id).second;
 
             int64_t tokens = 0;
             tokens += tally.getMoney(property, BALANCE);
@@ -3,15 +3,15 @@
 #include "elysium/log.h"
 #include "elysium/elysium.h"
 
+#include <algorithm>
 #include <stdint.h>
-#include <map>
+#include <string.h>
 
 /**
  * Creates an empty tally.
  */
-CMPTally::CMPTally()
+CMPTally::CMPTally() : my_pos(0)
 {
-    my_it = mp_token.begin();
 }
 
 /**
@@ -22,9 +22,9 @@ CMPTally::CMPTally()
 uint32_t CMPTally::init()
 {
     uint32_t propertyId = 0;
-    my_it = mp_token.begin();
-    if (my_it != mp_token.end()) {
-        propertyId = my_it->first;
+    my_pos = 0;
+    if (my_pos < mp_token.size()) {
+        propertyId = mp_token[my_pos].first;
     }
     return propertyId;
 }
@@ -37,13 +37,35 @@ uint32_t CMPTally::init()
 uint32_t CMPTally::next()
 {
     uint32_t ret = 0;
-    if (my_it != mp_token.end()) {
-        ret = my_it->first;
-        ++my_it;
+    if (my_pos < mp_token.size()) {
+        ret = mp_token[my_pos].first;
+        ++my_pos;
     }
     return ret;
 }
 
+static bool comparePropertyId(const std::pair<uint32_t, CMPTally::BalanceRecord>& record, uint32_t propertyId)
+{
+    return record.first < propertyId;
+}
+
+/**
+ * Looks up the balance record of a token.
+ *
+ * @param propertyId  The identifier of the tally to lookup
+ * @return The balance record, or NULL, if there is none
+ */
+const CMPTally::BalanceRecord* CMPTally::findRecord(uint32_t propertyId) const
+{
+    TokenVector::const_iterator it = std::lower_bound(mp_token.begin(), mp_token.end(), propertyId, comparePropertyId);
+
+    if (it != mp_token.end() && it->first == propertyId) {
+        return &it->second;
+    }
+
+    return NULL;
+}
+
 /**
  * Checks whether the addition of a + b overflows.
  *
@@ -73,7 +95,25 @@ bool CMPTally::updateMoney(uint32_t propertyId, int64_t amount, TallyType ttype)
         return false;
     }
     bool fUpdated = false;
-    int64_t now64 = mp_token[propertyId].balance[ttype];
+
+    // records are created even if the update fails, so the token shows up when iterating
+    TokenVector::iterator it = std::lower_bound(mp_token.begin(), mp_token.end(), propertyId, comparePropertyId);
+    if (it == mp_token.end() || it->first != propertyId) {
+        BalanceRecord record;
+        memset(&record, 0, sizeof(record));
+
+        size_t offset = it - mp_token.begin();
+        mp_token.insert(it, std::make_pair(propertyId, record));
+        it = mp_token.begin() + offset;
+
+        // keep the internal iterator on the same record
+        if (offset < my_pos) {
+            ++my_pos;
+        }
+    }
+
+    BalanceRecord& record = it->second;
+    int64_t now64 = record.balance[ttype];
 
     if (isOverflow(now64, amount)) {
         PrintToLog("%s(): ERROR: arithmetic overflow [%d + %d]\n", __func__, now64, amount);
@@ -86,7 +126,7 @@ bool CMPTally::updateMoney(uint32_t propertyId, int64_t amount, TallyType ttype)
     } else {
 
         now64 += amount;
-        mp_token[propertyId].balance[ttype] = now64;
+        record.balance[ttype] = now64;
 
         fUpdated = true;
     }
@@ -107,11 +147,10 @@ int64_t CMPTally::getMoney(uint32_t propertyId, TallyType ttype) const
         return 0;
     }
     int64_t money = 0;
-    TokenMap::const_iterator it = mp_token.find(propertyId);
+    const BalanceRecord* record = findRecord(propertyId);
 
-    if (it != mp_token.end()) {
-        const BalanceRecord& record = it->second;
-        money = record.balance[ttype];
+    if (record) {
+        money = record->balance[ttype];
     }
 
     return money;
@@ -128,14 +167,13 @@ int64_t CMPTally::getMoney(uint32_t propertyId, TallyType ttype) const
  */
 int64_t CMPTally::getMoneyAvailable(uint32_t propertyId) const
 {
-    TokenMap::const_iterator it = mp_token.find(propertyId);
+    const BalanceRecord* record = findRecord(propertyId);
 
-    if (it != mp_token.end()) {
-        const BalanceRecord& record = it->second;
-        if (record.balance[PENDING] < 0) {
-            return record.balance[BALANCE] + record.balance[PENDING];
+    if (record) {
+        if (record->balance[PENDING] < 0) {
+            return record->balance[BALANCE] + record->balance[PENDING];
         } else {
-            return record.balance[BALANCE];
+            return record->balance[BALANCE];
         }
     }
 
@@ -154,13 +192,12 @@ int64_t CMPTally::getMoneyAvailable(uint32_t propertyId) const
 int64_t CMPTally::getMoneyReserved(uint32_t propertyId) const
 {
     int64_t money = 0;
-    TokenMap::const_iterator it = mp_token.find(propertyId);
+    const BalanceRecord* record = findRecord(propertyId);
 
-    if (it != mp_token.end()) {
-        const BalanceRecord& record = it->second;
-        money += record.balance[SELLOFFER_RESERVE];
-        money += record.balance[ACCEPT_RESERVE];
-        money += record.balance[METADEX_RESERVE];
+    if (record) {
+        money += record->balance[SELLOFFER_RESERVE];
+        money += record->balance[ACCEPT_RESERVE];
+        money += record->balance[METADEX_RESERVE];
     }
 
     return money;
@@ -177,8 +214,8 @@ bool CMPTally::operator==(const CMPTally& rhs) const
     if (mp_token.size() != rhs.mp_token.size()) {
         return false;
     }
-    TokenMap::const_iterator pc1 = mp_token.begin();
-    TokenMap::const_iterator pc2 = rhs.mp_token.begin();
+    TokenVector::const_iterator pc1 = mp_token.begin();
+    TokenVector::const_iterator pc2 = rhs.mp_token.begin();
 
     for (unsigned int i = 0; i < mp_token.size(); ++i) {
         if (pc1->first != pc2->first) {
@@ -228,15 +265,14 @@ int64_t CMPTally::print(uint32_t propertyId, bool bDivisible) const
     int64_t pending = 0;
     int64_t metadex_reserve = 0;
 
-    TokenMap::const_iterator it = mp_token.find(propertyId);
+    const BalanceRecord* record = findRecord(propertyId);
 
-    if (it != mp_token.end()) {
-        const BalanceRecord& record = it->second;
-        balance = record.balance[BALANCE];
-        selloffer_reserve = record.balance[SELLOFFER_RESERVE];
-        accept_reserve = record.balance[ACCEPT_RESERVE];
-        pending = record.balance[PENDING];
-        metadex_reserve = record.balance[METADEX_RESERVE];
+    if (record) {
+        balance = record->balance[BALANCE];
+        selloffer_reserve = record->balance[SELLOFFER_RESERVE];
+        accept_reserve = record->balance[ACCEPT_RESERVE];
+        pending = record->balance[PENDING];
+        metadex_reserve = record->balance[METADEX_RESERVE];
     }
 
     if (bDivisible) {
@@ -251,3 +287,128 @@ int64_t CMPTally::print(uint32_t propertyId, bool bDivisible) const
 
     return (balance + selloffer_reserve + accept_reserve + metadex_reserve);
 }
+
+/**
+ * Removes all addresses and tallies.
+ */
+void CMPTallyMap::clear()
+{
+    entries.clear();
+    ids.clear();
+    holders.clear();
+    sorted.clear();
+}
+
+/**
+ * Exchanges the content with another map.
+ *
+ * @param other  The other map
+ */
+void CMPTallyMap::swap(CMPTallyMap& other)
+{
+    entries.swap(other.entries);
+    ids.swap(other.ids);
+    holders.swap(other.holders);
+    sorted.swap(other.sorted);
+}
+
+/**
+ * Returns the tally of an address.
+ *
+ * @param address  The address to lookup
+ * @return The tally, or NULL, if the address is unknown
+ */
+const CMPTally* CMPTallyMap::find(const std::string& address) const
+{
+    std::unordered_map<std::string, AddressId>::const_iterator it = ids.find(address);
+
+    if (it != ids.end()) {
+        return &entries[it->second].second;
+    }
+
+    return NULL;
+}
+
+/**
+ * Updates the number of tokens of an address for the given tally type.
+ *
+ * The address is added, even if the update fails.
+ *
+ * @param address     The address to update
+ * @param propertyId  The identifier of the tally to update
+ * @param amount      The amount to add
+ * @param ttype       The tally type
+ * @return True, if the update was successful
+ */
+bool CMPTallyMap::updateMoney(const std::string& address, uint32_t propertyId, int64_t amount, TallyType ttype)
+{
+    std::pair<std::unordered_map<std::string, AddressId>::iterator, bool> inserted = ids.insert(std::make_pair(address, static_cast<AddressId>(entries.size())));
+    AddressId id = inserted.first->second;
+
+    if (inserted.second) {
+        entries.push_back(std::make_pair(address, CMPTally()));
+    }
+
+    CMPTally& tally = entries[id].second;
+    size_t tokens = tally.size();
+    bool fUpdated = tally.updateMoney(propertyId, amount, ttype);
+
+    if (tally.size() != tokens) {
+        holders[propertyId].push_back(id);
+    }
+
+    return fUpdated;
+}
+
+/**
+ * Returns the addresses with a balance record of the given property.
+ *
+ * @param propertyId  The identifier of the property
+ * @return The identifiers of the addresses, in the order they got a balance record
+ */
+const std::vector<CMPTallyMap::AddressId>& CMPTallyMap::getHolders(uint32_t propertyId) const
+{
+    static const std::vector<AddressId> none;
+
+    std::unordered_map<uint32_t, std::vector<AddressId> >::const_iterator it = holders.find(propertyId);
+
+    return it != holders.end() ? it->second : none;
+}
+
+/**
+ * Returns all addresses ordered by address.
+ *
+ * Addresses are never removed, so only the ones added since the last call are sorted
+ * and merged into the existing view.
+ *
+ * @return The identifiers of all addresses
+ */
+const std::vector<CMPTallyMap::AddressId>& CMPTallyMap::getSorted() const
+{
+    size_t known = sorted.size();
+
+    if (known < entries.size()) {
+        for (size_t id = known; id < entries.size(); id++) {
+            sorted.push_back(static_cast<AddressId>(id));
+        }
+
+        auto compare = [this] (AddressId a, AddressId b) { return entries[a].first < entries[b].first; };
+
+        std::sort(sorted.begin() + known, sorted.end(), compare);
+        std::inplace_merge(sorted.begin(), sorted.begin() + known, sorted.end(), compare);
+    }
+
+    return sorted;
+}
+
+/**
+ * Orders the given address identifiers by address.
+ *
+ * @param addressIds  The identifiers to sort
+ */
+void CMPTallyMap::sortByAddress(std::vector<AddressId>& addressIds) const
+{
+    std::sort(addressIds.begin(), addressIds.end(), [this] (AddressId a, AddressId b) {
+        return entries[a].first < entries[b].first;
+    });
+}
@@ -2,7 +2,11 @@
 #define ELYSIUM_TALLY_H
 
 #include <stdint.h>
-#include <map>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 //! Balance record types
 enum TallyType {
@@ -18,17 +22,20 @@ enum TallyType {
  */
 class CMPTally
 {
-private:
+public:
     typedef struct {
         int64_t balance[TALLY_TYPE_COUNT];
     } BalanceRecord;
 
-    //! Map of balance records
-    typedef std::map<uint32_t, BalanceRecord> TokenMap;
+    //! Balance records for different tokens, ordered by property identifier
+    typedef std::vector<std::pair<uint32_t, BalanceRecord> > TokenVector;
+    typedef TokenVector::const_iterator const_iterator;
+
+private:
     //! Balance records for different tokens
-    TokenMap mp_token;
-    //! Internal iterator pointing to a balance record
-    TokenMap::iterator my_it;
+    TokenVector mp_token;
+    //! Position of the internal iterator
+    size_t my_pos;
 
 public:
     /** Creates an empty tally. */
@@ -40,6 +47,15 @@ public:
     /** Advances the internal iterator. */
     uint32_t next();
 
+    /** Returns an iterator to the first balance record, which does not affect the internal iterator. */
+    const_iterator begin() const { return mp_token.begin(); }
+
+    /** Returns an iterator past the last balance record. */
+    const_iterator end() const { return mp_token.end(); }
+
+    /** Returns the number of tokens with a balance record. */
+    size_t size() const { return mp_token.size(); }
+
     /** Updates the number of tokens for the given tally type. */
     bool updateMoney(uint32_t propertyId, int64_t amount, TallyType ttype);
 
@@ -60,7 +76,65 @@ public:
 
     /** Prints a balance record to the console. */
     int64_t print(uint32_t propertyId = 1, bool bDivisible = true) const;
+
+private:
+    const BalanceRecord* findRecord(uint32_t propertyId) const;
 };
 
+/** Balance records of all entities.
+ *
+ * Addresses are interned into compact identifiers, which refer to tallies in insertion order.
+ * References to tallies stay valid until the map is cleared, and the map keeps track of the
+ * holders of each property, so per property queries don't have to visit every address.
+ */
+class CMPTallyMap
+{
+public:
+    typedef uint32_t AddressId;
+    typedef std::pair<std::string, CMPTally> value_type;
+    typedef std::deque<value_type>::const_iterator const_iterator;
+
+private:
+    //! Addresses and their tallies, indexed by address identifier
+    std::deque<value_type> entries;
+    //! Address identifiers by address
+    std::unordered_map<std::string, AddressId> ids;
+    //! Addresses with a balance record of a property
+    std::unordered_map<uint32_t, std::vector<AddressId> > holders;
+    //! Address identifiers ordered by address, updated lazily
+    mutable std::vector<AddressId> sorted;
+
+public:
+    /** Iterates over all addresses in the order they were added. */
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    /** Returns the number of addresses. */
+    size_t size() const { return entries.size(); }
+
+    /** Removes all addresses and tallies. */
+    void clear();
+
+    /** Exchanges the content with another map. */
+    void swap(CMPTallyMap& other);
+
+    /** Returns the tally of an address, or NULL, if the address is unknown. */
+    const CMPTally* find(const std::string& address) const;
+
+    /** Returns the address and tally with the given identifier. */
+    const value_type& get(AddressId id) const { return entries[id]; }
+
+    /** Updates the number of tokens of an address for the given tally type, adding the address if needed. */
+    bool updateMoney(const std::string& address, uint32_t propertyId, int64_t amount, TallyType ttype);
+
+    /** Returns the addresses with a balance record of the given property, in the order they got one. */
+    const std::vector<AddressId>& getHolders(uint32_t propertyId) const;
+
+    /** Returns all addresses ordered by address, as used for consensus hashing. */
+    const std::vector<AddressId>& getSorted() const;
+
+    /** Orders the given address identifiers by address. */
+    void sortByAddress(std::vector<AddressId>& addressIds) const;
+};
 
 #endif // ELYSIUM_TALLY_H
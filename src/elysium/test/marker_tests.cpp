@@ -230,6 +230,50 @@ BOOST_AUTO_TEST_CASE(class_class_c)
     }
 }
 
+BOOST_AUTO_TEST_CASE(has_marker)
+{
+    {
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(OpReturn_Unrelated());
+        mutableTx.vout.push_back(PayToPubKeyHash_Unrelated());
+        mutableTx.vout.push_back(NonStandardOutput());
+        mutableTx.vout.push_back(OpReturn_UnrelatedShort());
+        mutableTx.vout.push_back(OpReturn_Empty());
+        mutableTx.vout.push_back(PayToPubKey_Unrelated());
+        mutableTx.vout.push_back(PayToScriptHash_Unrelated());
+        mutableTx.vout.push_back(PayToBareMultisig_3of5());
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK(!HasMarker(tx));
+    }
+    {
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(PayToPubKeyHash_Unrelated());
+        mutableTx.vout.push_back(OpReturn_PlainMarker());
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK(HasMarker(tx));
+    }
+    {
+        // not a valid class B transaction, but the system address is involved
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(PayToScriptHash_Unrelated());
+        mutableTx.vout.push_back(PayToPubKeyHash_Elysium());
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK_EQUAL(DeterminePacketClass(tx, std::numeric_limits<int>::max()), boost::none);
+        BOOST_CHECK(HasMarker(tx));
+    }
+    {
+        CMutableTransaction mutableTx;
+        mutableTx.vout.push_back(PayToBareMultisig_1of3());
+        mutableTx.vout.push_back(PayToPubKeyHash_Elysium());
+
+        CTransaction tx(mutableTx);
+        BOOST_CHECK(HasMarker(tx));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace elysium
@@ -0,0 +1,145 @@
+#include "elysium/mdex.h"
+
+#include "test/test_bitcoin.h"
+
+#include "uint256.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace elysium;
+
+namespace {
+
+uint256 MakeTxid(unsigned char n)
+{
+    uint256 txid;
+    *txid.begin() = n;
+    return txid;
+}
+
+CMPMetaDEx MakeOrder(const std::string& address, int block, uint32_t property, int64_t amount,
+    uint32_t desiredProperty, int64_t desiredAmount, unsigned char n)
+{
+    return CMPMetaDEx(address, block, property, amount, desiredProperty, desiredAmount, MakeTxid(n), n, CMPTransaction::ADD);
+}
+
+} // unnamed namespace
+
+BOOST_FIXTURE_TEST_SUITE(elysium_mdex_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(book_pairs)
+{
+    MetaDExBook book;
+    BOOST_CHECK(book.empty());
+
+    BOOST_CHECK(book.insert(MakeOrder("a", 10, 3, 100, 4, 300, 1)));
+    BOOST_CHECK(book.insert(MakeOrder("a", 10, 3, 100, 4, 200, 2)));
+    BOOST_CHECK(book.insert(MakeOrder("b", 11, 3, 100, 4, 200, 3)));
+    BOOST_CHECK(book.insert(MakeOrder("b", 11, 3, 100, 5, 100, 4)));
+    BOOST_CHECK_EQUAL(book.size(), 4);
+
+    // the same order can not be added twice
+    BOOST_CHECK(!book.insert(MakeOrder("a", 10, 3, 100, 4, 300, 1)));
+    BOOST_CHECK_EQUAL(book.size(), 4);
+
+    BOOST_CHECK(book.hasProperty(3));
+    BOOST_CHECK(!book.hasProperty(4));
+    BOOST_CHECK(book.getPrices(4, 3) == NULL);
+
+    // price levels of a pair are ordered by unit price, orders of a level by position in the chain
+    const md_PricesMap* prices = book.getPrices(3, 4);
+    BOOST_REQUIRE(prices != NULL);
+    BOOST_CHECK_EQUAL(prices->size(), 2);
+    BOOST_CHECK(prices->begin()->first == rational_t(2, 1));
+    BOOST_CHECK_EQUAL(prices->begin()->second.size(), 2);
+    BOOST_CHECK(prices->begin()->second.begin()->getHash() == MakeTxid(2));
+    BOOST_CHECK(prices->rbegin()->first == rational_t(3, 1));
+
+    prices = book.getPrices(3, 5);
+    BOOST_REQUIRE(prices != NULL);
+    BOOST_CHECK_EQUAL(prices->size(), 1);
+
+    size_t pairs = 0;
+    for (MetaDExBook::const_iterator it = book.begin(); it != book.end(); ++it) {
+        BOOST_CHECK_EQUAL(it->first.first, 3);
+        BOOST_CHECK_EQUAL(it->first.second, pairs == 0 ? 4 : 5);
+        pairs++;
+    }
+    BOOST_CHECK_EQUAL(pairs, 2);
+
+    book.clear();
+    BOOST_CHECK(book.empty());
+    BOOST_CHECK(book.begin() == book.end());
+    BOOST_CHECK(book.find(MakeTxid(1)) == NULL);
+    BOOST_CHECK(book.getOrders("a").empty());
+}
+
+BOOST_AUTO_TEST_CASE(book_indexes)
+{
+    MetaDExBook book;
+    BOOST_CHECK(book.insert(MakeOrder("a", 10, 3, 100, 4, 300, 1)));
+    BOOST_CHECK(book.insert(MakeOrder("a", 10, 3, 100, 4, 200, 2)));
+    BOOST_CHECK(book.insert(MakeOrder("b", 11, 3, 100, 4, 200, 3)));
+
+    const CMPMetaDEx* order = book.find(MakeTxid(3));
+    BOOST_REQUIRE(order != NULL);
+    BOOST_CHECK_EQUAL(order->getAddr(), "b");
+    BOOST_CHECK(book.find(MakeTxid(4)) == NULL);
+
+    BOOST_CHECK_EQUAL(book.getOrders("a").size(), 2);
+    BOOST_CHECK_EQUAL(book.getOrders("b").size(), 1);
+    BOOST_CHECK(book.getOrders("c").empty());
+
+    // replacing an order keeps the indexes in sync
+    CMPMetaDEx replacement = *book.find(MakeTxid(2));
+    replacement.setAmountRemaining(50);
+    BOOST_CHECK(book.erase(MakeTxid(2)));
+    BOOST_CHECK(book.insert(replacement));
+    BOOST_CHECK_EQUAL(book.find(MakeTxid(2))->getAmountRemaining(), 50);
+    BOOST_CHECK_EQUAL(book.getOrders("a").size(), 2);
+
+    // empty price levels and pairs are removed
+    BOOST_CHECK(book.erase(MakeTxid(1)));
+    BOOST_CHECK(!book.erase(MakeTxid(1)));
+    BOOST_CHECK_EQUAL(book.getPrices(3, 4)->size(), 1);
+
+    BOOST_CHECK(book.erase(MakeTxid(2)));
+    BOOST_CHECK(book.erase(MakeTxid(3)));
+    BOOST_CHECK(book.getPrices(3, 4) == NULL);
+    BOOST_CHECK(!book.hasProperty(3));
+    BOOST_CHECK(book.getOrders("a").empty());
+    BOOST_CHECK(book.empty());
+}
+
+BOOST_AUTO_TEST_CASE(book_swap)
+{
+    MetaDExBook book, other;
+    BOOST_CHECK(book.insert(MakeOrder("a", 10, 3, 100, 4, 300, 1)));
+    BOOST_CHECK(other.insert(MakeOrder("b", 11, 5, 100, 6, 200, 2)));
+    BOOST_CHECK(other.insert(MakeOrder("b", 11, 5, 100, 6, 100, 3)));
+    const CMPMetaDEx* order = other.find(MakeTxid(2));
+
+    book.swap(other);
+
+    // the orders and their indexes move with the book
+    BOOST_CHECK_EQUAL(book.size(), 2);
+    BOOST_CHECK(book.find(MakeTxid(2)) == order);
+    BOOST_CHECK(book.find(MakeTxid(1)) == NULL);
+    BOOST_CHECK_EQUAL(book.getOrders("b").size(), 2);
+    BOOST_CHECK(book.getPrices(5, 6) != NULL);
+    BOOST_CHECK(!book.hasProperty(3));
+
+    BOOST_CHECK_EQUAL(other.size(), 1);
+    BOOST_CHECK(other.find(MakeTxid(1)) != NULL);
+    BOOST_CHECK_EQUAL(other.getOrders("a").size(), 1);
+    BOOST_CHECK(other.getOrders("b").empty());
+
+    BOOST_CHECK(book.erase(MakeTxid(2)));
+    BOOST_CHECK_EQUAL(book.getOrders("b").size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
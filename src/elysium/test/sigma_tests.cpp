@@ -6,6 +6,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <iterator>
 #include <stddef.h>
 #include <vector>
 
@@ -17,10 +18,12 @@ struct SigmaDatabaseFixture : TestingSetup
     SigmaDatabaseFixture()
     {
         sigmaDb = new SigmaDatabase(pathTemp / "elysium-sigmadb", true, 10);
+        sigmaGroupCache = new SigmaGroupCache(*sigmaDb);
     }
 
     ~SigmaDatabaseFixture()
     {
+        delete sigmaGroupCache; sigmaGroupCache = nullptr;
         delete sigmaDb; sigmaDb = nullptr;
     }
 };
@@ -100,6 +103,81 @@ BOOST_FIXTURE_TEST_CASE(verify_spend, SigmaDatabaseFixture)
     BOOST_CHECK_EQUAL(VerifySigmaSpend(3, 0, 1, sigmaDb->groupSize, proof, key.serial, false), false);
 }
 
+BOOST_FIXTURE_TEST_CASE(group_cache, SigmaDatabaseFixture)
+{
+    auto mints = CreateMints(3);
+
+    BOOST_CHECK(sigmaGroupCache->GetGroup(3, 0, 0, sigmaDb->groupSize).empty());
+
+    sigmaDb->RecordMint(3, 0, mints[0], 100);
+    sigmaDb->RecordMint(3, 0, mints[1], 100);
+
+    auto group = sigmaGroupCache->GetGroup(3, 0, 0, sigmaDb->groupSize);
+    BOOST_CHECK(group == std::vector<SigmaPublicKey>({mints[0], mints[1]}));
+    BOOST_CHECK(sigmaGroupCache->GetGroup(3, 0, 0, 1) == std::vector<SigmaPublicKey>({mints[0]}));
+
+    // new mints are appended to the cached group
+    sigmaDb->RecordMint(3, 0, mints[2], 101);
+
+    group = sigmaGroupCache->GetGroup(3, 0, 0, sigmaDb->groupSize);
+    BOOST_CHECK(group == std::vector<SigmaPublicKey>({mints[0], mints[1], mints[2]}));
+
+    // removed mints are not returned anymore
+    sigmaDb->DeleteAll(101);
+
+    group = sigmaGroupCache->GetGroup(3, 0, 0, sigmaDb->groupSize);
+    BOOST_CHECK(group == std::vector<SigmaPublicKey>({mints[0], mints[1]}));
+}
+
+BOOST_FIXTURE_TEST_CASE(group_cache_block, SigmaDatabaseFixture)
+{
+    auto checkGroups = [] {
+        for (SigmaDenomination denomination = 0; denomination < 2; denomination++) {
+            for (SigmaMintGroup group = 0; group < 3; group++) {
+                std::vector<SigmaPublicKey> expected;
+                sigmaDb->GetAnonimityGroup(3, denomination, group, std::back_inserter(expected));
+
+                BOOST_CHECK(sigmaGroupCache->GetGroup(3, denomination, group, sigmaDb->groupSize) == expected);
+            }
+        }
+    };
+
+    // a full group and a partial one, both cached
+    for (auto& mint : CreateMints(sigmaDb->groupSize + 3)) {
+        sigmaDb->RecordMint(3, 0, mint, 100);
+    }
+
+    for (auto& mint : CreateMints(2)) {
+        sigmaDb->RecordMint(3, 1, mint, 100);
+    }
+
+    checkGroups();
+
+    // connect a block with mints of several groups and denominations
+    for (auto& mint : CreateMints(sigmaDb->groupSize)) {
+        sigmaDb->RecordMint(3, 0, mint, 101);
+    }
+
+    for (auto& mint : CreateMints(4)) {
+        sigmaDb->RecordMint(3, 1, mint, 101);
+    }
+
+    checkGroups();
+
+    // disconnect it
+    sigmaDb->DeleteAll(101);
+
+    checkGroups();
+
+    // and connect another one
+    for (auto& mint : CreateMints(5)) {
+        sigmaDb->RecordMint(3, 0, mint, 101);
+        sigmaDb->RecordMint(3, 1, mint, 101);
+    }
+
+    checkGroups();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace elysium
@@ -0,0 +1,176 @@
+#include "../dex.h"
+#include "../mdex.h"
+#include "../snapshot.h"
+#include "../sp.h"
+
+#include "../../test/test_bitcoin.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <stdio.h>
+
+namespace elysium {
+
+BOOST_FIXTURE_TEST_SUITE(elysium_snapshot_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(roundtrip)
+{
+    uint256 block = uint256S("b7c0c8a5a3c8f1d0f6e8bb1e1ad2e6ecdb4c2a5d7ee2b4e2a5d7e4c2c8a5a3c8");
+    uint256 txid = uint256S("1f7c0c8a5a3c8f1d0f6e8bb1e1ad2e6ecdb4c2a5d7ee2b4e2a5d7e4c2c8a5a3c");
+
+    std::map<std::string, CMPOffer> offers;
+    offers.emplace("a-3", CMPOffer(200, 50000, 3, 100000, 10000, 10, txid));
+
+    CMPMetaDEx trade("a", 201, 3, 1000, 4, 2000, txid, 5, 1, 500);
+
+    StateSnapshot snapshot(block, 201);
+    snapshot.GetSection(FILETYPE_OFFERS) << offers;
+    snapshot.GetSection(FILETYPE_MDEXORDERS) << trade;
+
+    auto path = pathTemp / GetSnapshotFileName(block);
+    BOOST_CHECK(snapshot.WriteToFile(path));
+
+    StateSnapshot loaded;
+    BOOST_CHECK(loaded.ReadFromFile(path));
+    BOOST_CHECK_EQUAL(loaded.GetBlock().GetHex(), block.GetHex());
+    BOOST_CHECK_EQUAL(loaded.GetHeight(), 201);
+    BOOST_CHECK(loaded.VerifySection(FILETYPE_OFFERS));
+    BOOST_CHECK(loaded.VerifySection(FILETYPE_MDEXORDERS));
+    BOOST_CHECK(!loaded.VerifySection(FILETYPE_BALANCES));
+    BOOST_CHECK(loaded.FindSection(FILETYPE_BALANCES) == nullptr);
+
+    std::map<std::string, CMPOffer> loadedOffers;
+    *loaded.FindSection(FILETYPE_OFFERS) >> loadedOffers;
+    BOOST_CHECK_EQUAL(loadedOffers.size(), 1);
+    BOOST_CHECK_EQUAL(loadedOffers["a-3"].getHash().GetHex(), txid.GetHex());
+    BOOST_CHECK_EQUAL(loadedOffers["a-3"].getOfferAmountOriginal(), 50000);
+    BOOST_CHECK_EQUAL(loadedOffers["a-3"].getXZCDesiredOriginal(), 100000);
+    BOOST_CHECK_EQUAL(loadedOffers["a-3"].getMinFee(), 10000);
+
+    CMPMetaDEx loadedTrade;
+    *loaded.FindSection(FILETYPE_MDEXORDERS) >> loadedTrade;
+    BOOST_CHECK_EQUAL(loadedTrade.getAddr(), "a");
+    BOOST_CHECK_EQUAL(loadedTrade.getBlock(), 201);
+    BOOST_CHECK_EQUAL(loadedTrade.getProperty(), 3);
+    BOOST_CHECK_EQUAL(loadedTrade.getAmountForSale(), 1000);
+    BOOST_CHECK_EQUAL(loadedTrade.getDesProperty(), 4);
+    BOOST_CHECK_EQUAL(loadedTrade.getAmountDesired(), 2000);
+    BOOST_CHECK_EQUAL(loadedTrade.getHash().GetHex(), txid.GetHex());
+    BOOST_CHECK_EQUAL(loadedTrade.getIdx(), 5);
+    BOOST_CHECK_EQUAL(loadedTrade.getAction(), 1);
+    BOOST_CHECK_EQUAL(loadedTrade.getAmountRemaining(), 500);
+}
+
+BOOST_AUTO_TEST_CASE(corrupted_section)
+{
+    uint256 block = uint256S("b7c0c8a5a3c8f1d0f6e8bb1e1ad2e6ecdb4c2a5d7ee2b4e2a5d7e4c2c8a5a3c8");
+
+    StateSnapshot snapshot(block, 10);
+    snapshot.GetSection(FILETYPE_GLOBALS) << std::string("globals");
+    snapshot.GetSection(FILETYPE_MDEXORDERS) << std::string("trades");
+
+    auto path = pathTemp / GetSnapshotFileName(block);
+    BOOST_CHECK(snapshot.WriteToFile(path));
+
+    // the last section is stored at the end of the file
+    auto size = boost::filesystem::file_size(path);
+    FILE *file = fopen(path.string().c_str(), "r+b");
+    BOOST_REQUIRE(file != nullptr);
+    fseek(file, size - 1, SEEK_SET);
+    fputc('x', file);
+    fclose(file);
+
+    StateSnapshot loaded;
+    BOOST_CHECK(loaded.ReadFromFile(path));
+    BOOST_CHECK(loaded.VerifySection(FILETYPE_GLOBALS));
+    BOOST_CHECK(!loaded.VerifySection(FILETYPE_MDEXORDERS));
+}
+
+BOOST_AUTO_TEST_CASE(truncated_file)
+{
+    uint256 block = uint256S("b7c0c8a5a3c8f1d0f6e8bb1e1ad2e6ecdb4c2a5d7ee2b4e2a5d7e4c2c8a5a3c8");
+
+    StateSnapshot snapshot(block, 10);
+    snapshot.GetSection(FILETYPE_GLOBALS) << std::string("globals");
+
+    auto path = pathTemp / GetSnapshotFileName(block);
+    BOOST_CHECK(snapshot.WriteToFile(path));
+
+    boost::filesystem::resize_file(path, boost::filesystem::file_size(path) - 1);
+
+    StateSnapshot loaded;
+    BOOST_CHECK(!loaded.ReadFromFile(path));
+}
+
+BOOST_AUTO_TEST_CASE(writer_prunes_history)
+{
+    auto directory = pathTemp / "MP_persist_test";
+    boost::filesystem::create_directories(directory);
+
+    {
+        StateSnapshotWriter writer(directory, 2);
+
+        for (int height = 0; height < 6; height++) {
+            uint256 block;
+            *block.begin() = height;
+
+            auto snapshot = std::make_shared<StateSnapshot>(block, height);
+            snapshot->GetSection(FILETYPE_GLOBALS) << height;
+            writer.Write(snapshot);
+        }
+
+        writer.Flush();
+        BOOST_CHECK_EQUAL(writer.GetPendingCount(), 0);
+    }
+
+    for (int height = 0; height < 6; height++) {
+        uint256 block;
+        *block.begin() = height;
+
+        BOOST_CHECK_EQUAL(boost::filesystem::exists(directory / GetSnapshotFileName(block)), height >= 3);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(writer_callback_after_write)
+{
+    auto directory = pathTemp / "MP_persist_callback_test";
+    boost::filesystem::create_directories(directory);
+
+    uint256 block;
+    *block.begin() = 1;
+    auto path = directory / GetSnapshotFileName(block);
+
+    bool existed = false;
+    int calls = 0;
+    {
+        StateSnapshotWriter writer(directory, 2);
+
+        auto snapshot = std::make_shared<StateSnapshot>(block, 1);
+        snapshot->GetSection(FILETYPE_GLOBALS) << 1;
+        writer.Write(snapshot, [&] {
+            existed = boost::filesystem::exists(path);
+            calls++;
+        });
+
+        // a snapshot which can't be written doesn't run its callback
+        auto missing = std::make_shared<StateSnapshot>(block, 2);
+        StateSnapshotWriter failing(directory / "missing", 2);
+        failing.Write(missing, [&] { calls++; });
+        failing.Flush();
+
+        writer.Flush();
+        BOOST_CHECK_EQUAL(writer.GetPendingCount(), 0);
+    }
+
+    BOOST_CHECK(existed);
+    BOOST_CHECK_EQUAL(calls, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace elysium
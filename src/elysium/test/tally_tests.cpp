@@ -3,6 +3,8 @@
 #include "test/test_bitcoin.h"
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -318,5 +320,95 @@ BOOST_AUTO_TEST_CASE(tally_overflow)
     BOOST_CHECK_EQUAL(tally.getMoneyReserved(3), int64_t(9223372036854775807LL));
 }
 
+BOOST_AUTO_TEST_CASE(reentrant_iteration)
+{
+    CMPTally tally;
+    BOOST_CHECK(tally.updateMoney(9, 1, BALANCE));
+    BOOST_CHECK(tally.updateMoney(3, 1, BALANCE));
+    BOOST_CHECK(tally.updateMoney(5, 1, BALANCE));
+
+    std::vector<uint32_t> outer, inner;
+    for (CMPTally::const_iterator it = tally.begin(); it != tally.end(); ++it) {
+        outer.push_back(it->first);
+        for (CMPTally::const_iterator it2 = tally.begin(); it2 != tally.end(); ++it2) {
+            inner.push_back(it2->first);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(tally.size(), 3);
+    BOOST_CHECK(outer == std::vector<uint32_t>({3, 5, 9}));
+    BOOST_CHECK_EQUAL(inner.size(), 9);
+    BOOST_CHECK_EQUAL(inner[3], 3);
+    BOOST_CHECK_EQUAL(inner[8], 9);
+
+    // const iteration leaves the internal iterator alone
+    BOOST_CHECK_EQUAL(3, tally.init());
+    BOOST_CHECK_EQUAL(3, tally.next());
+    BOOST_CHECK(tally.updateMoney(1, 1, BALANCE));
+    BOOST_CHECK_EQUAL(5, tally.next());
+    BOOST_CHECK(tally.updateMoney(7, 1, BALANCE));
+    BOOST_CHECK_EQUAL(7, tally.next());
+    BOOST_CHECK_EQUAL(9, tally.next());
+    BOOST_CHECK_EQUAL(0, tally.next());
+}
+
+BOOST_AUTO_TEST_CASE(tally_map)
+{
+    CMPTallyMap tallies;
+    BOOST_CHECK(tallies.find("b") == NULL);
+    BOOST_CHECK(tallies.getHolders(3).empty());
+
+    BOOST_CHECK(tallies.updateMoney("c", 3, 10, BALANCE));
+    BOOST_CHECK(tallies.updateMoney("a", 3, 20, SELLOFFER_RESERVE));
+    BOOST_CHECK(tallies.updateMoney("b", 4, 30, BALANCE));
+    BOOST_CHECK(tallies.updateMoney("a", 3, 5, BALANCE));
+
+    // failed updates still add the address and the token
+    BOOST_CHECK(!tallies.updateMoney("d", 3, -1, BALANCE));
+
+    BOOST_CHECK_EQUAL(tallies.size(), 4);
+    BOOST_REQUIRE(tallies.find("a") != NULL);
+    BOOST_CHECK_EQUAL(tallies.find("a")->getMoney(3, BALANCE), 5);
+    BOOST_CHECK_EQUAL(tallies.find("a")->getMoney(3, SELLOFFER_RESERVE), 20);
+
+    const std::vector<CMPTallyMap::AddressId>& holders = tallies.getHolders(3);
+    BOOST_REQUIRE_EQUAL(holders.size(), 3);
+    BOOST_CHECK_EQUAL(tallies.get(holders[0]).first, "c");
+    BOOST_CHECK_EQUAL(tallies.get(holders[1]).first, "a");
+    BOOST_CHECK_EQUAL(tallies.get(holders[2]).first, "d");
+
+    std::vector<CMPTallyMap::AddressId> sortedHolders = holders;
+    tallies.sortByAddress(sortedHolders);
+    BOOST_CHECK_EQUAL(tallies.get(sortedHolders[0]).first, "a");
+    BOOST_CHECK_EQUAL(tallies.get(sortedHolders[1]).first, "c");
+    BOOST_CHECK_EQUAL(tallies.get(sortedHolders[2]).first, "d");
+
+    // the sorted view is extended as addresses are added
+    const CMPTally* tally = tallies.find("c");
+    BOOST_CHECK_EQUAL(tallies.getSorted().size(), 4);
+    BOOST_CHECK(tallies.updateMoney("bb", 4, 1, BALANCE));
+    BOOST_CHECK(tallies.updateMoney("0", 4, 1, BALANCE));
+
+    std::vector<std::string> sorted;
+    for (CMPTallyMap::AddressId id : tallies.getSorted()) {
+        sorted.push_back(tallies.get(id).first);
+    }
+    BOOST_CHECK(sorted == std::vector<std::string>({"0", "a", "b", "bb", "c", "d"}));
+
+    // tallies don't move when addresses are added
+    BOOST_CHECK(tally == tallies.find("c"));
+
+    CMPTallyMap other;
+    other.swap(tallies);
+    BOOST_CHECK_EQUAL(tallies.size(), 0);
+    BOOST_CHECK_EQUAL(other.size(), 6);
+    BOOST_CHECK_EQUAL(other.getHolders(4).size(), 3);
+
+    other.clear();
+    BOOST_CHECK(other.find("a") == NULL);
+    BOOST_CHECK(other.getHolders(3).empty());
+    BOOST_CHECK(other.getSorted().empty());
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
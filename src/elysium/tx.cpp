@@ -1405,16 +1405,18 @@ int CMPTransaction::logicMath_SendAll()
         receiver = sender;
     }
 
-    CMPTally* ptally = getTally(sender);
+    const CMPTally* ptally = getTally(sender);
     if (ptally == NULL) {
         PrintToLog("%s(): rejected: sender %s has no tokens to send\n", __func__, sender);
         return (PKT_ERROR_SEND_ALL -54);
     }
 
-    uint32_t propertyId = ptally->init();
     int numberOfPropertiesSent = 0;
 
-    while (0 != (propertyId = ptally->next())) {
+    // the updates below only change existing records of the sender, so the iterator stays valid
+    for (CMPTally::const_iterator token = ptally->begin(); token != ptally->end(); ++token) {
+        uint32_t propertyId = token->first;
+
         // only transfer tokens in the specified ecosystem
         if (ecosystem == ELYSIUM_PROPERTY_ELYSIUM && isTestEcosystemProperty(propertyId)) {
             continue;
@@ -83,7 +83,7 @@ int WalletCacheUpdate()
 
     LOCK(cs_main);
 
-    for (std::unordered_map<string, CMPTally>::iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
+    for (CMPTallyMap::const_iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
         const std::string& address = my_it->first;
 
         // determine if this address is in the wallet
@@ -93,9 +93,8 @@ int WalletCacheUpdate()
             continue; // ignore this address, not in wallet
         }
 
-        // obtain & init the tally
-        CMPTally& tally = my_it->second;
-        tally.init();
+        // obtain the tally
+        const CMPTally& tally = my_it->second;
 
         // check cache for miss on address
         std::map<std::string, CMPTally>::iterator search_it = walletBalancesCache.find(address);
@@ -109,8 +108,8 @@ int WalletCacheUpdate()
 
         // check cache for miss on balance - TODO TRY AND OPTIMIZE THIS
         CMPTally &cacheTally = search_it->second;
-        uint32_t propertyId;
-        while (0 != (propertyId = (tally.next()))) {
+        for (CMPTally::const_iterator token = tally.begin(); token != tally.end(); ++token) {
+            uint32_t propertyId = token->first;
             if (tally.getMoney(propertyId, BALANCE) != cacheTally.getMoney(propertyId, BALANCE) ||
                     tally.getMoney(propertyId, PENDING) != cacheTally.getMoney(propertyId, PENDING) ||
                     tally.getMoney(propertyId, SELLOFFER_RESERVE) != cacheTally.getMoney(propertyId, SELLOFFER_RESERVE) ||
@@ -171,4 +171,48 @@ BOOST_AUTO_TEST_CASE(regenerate_mint)
         entry1.ecdsaSecretKey.begin(), entry1.ecdsaSecretKey.end());
 }
 
+BOOST_AUTO_TEST_CASE(tracker_write_back)
+{
+    lelantus::PrivateCoin coin(params, 1);
+
+    CHDMint mint;
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+    uint160 seedID;
+    BOOST_CHECK(pwalletMain->zwallet->GenerateLelantusMint(walletdb, coin, mint, seedID));
+
+    auto& tracker = pwalletMain->zwallet->GetTracker();
+    tracker.AddLelantus(walletdb, mint, true);
+
+    CLelantusMintMeta meta;
+    BOOST_CHECK(tracker.GetLelantusMetaFromPubcoin(mint.GetPubCoinHash(), meta));
+    meta.nHeight = 10;
+    meta.nId = 1;
+    meta.isUsed = true;
+
+    // updated in memory only
+    BOOST_CHECK(tracker.UpdateState(meta, false));
+
+    CHDMint stored, cached;
+    BOOST_CHECK(walletdb.ReadHDMint(mint.GetPubCoinHash(), true, stored));
+    BOOST_CHECK(!stored.IsUsed());
+    BOOST_CHECK(tracker.GetHDMint(mint.GetPubCoinHash(), true, cached));
+    BOOST_CHECK(cached.IsUsed());
+    BOOST_CHECK_EQUAL(10, cached.GetHeight());
+
+    // reloading the entry of the database keeps the update
+    tracker.AddLelantus(walletdb, stored);
+    BOOST_CHECK(tracker.GetHDMint(mint.GetPubCoinHash(), true, cached));
+    BOOST_CHECK(cached.IsUsed());
+    BOOST_CHECK(tracker.GetLelantusMetaFromPubcoin(mint.GetPubCoinHash(), meta));
+    BOOST_CHECK(meta.isUsed);
+    BOOST_CHECK_EQUAL(10, meta.nHeight);
+
+    // and written back by the flush
+    BOOST_CHECK(tracker.Flush());
+    BOOST_CHECK(walletdb.ReadHDMint(mint.GetPubCoinHash(), true, stored));
+    BOOST_CHECK(stored.IsUsed());
+    BOOST_CHECK_EQUAL(10, stored.GetHeight());
+    BOOST_CHECK_EQUAL(1, stored.GetId());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -78,12 +78,13 @@ bool CHDMintTracker::Archive(CMintMeta& meta)
     if (HasSerialHash(meta.hashSerial))
         mapSerialHashes.at(meta.hashSerial).isArchived = true;
 
-   CWalletDB walletdb(strWalletFile);
+    CWalletDB walletdb(strWalletFile);
     CHDMint dMint;
-    if (!walletdb.ReadHDMint(hashPubcoin, false, dMint))
+    if (!GetHDMint(hashPubcoin, false, dMint))
         return error("%s: could not find pubcoinhash %s in db", __func__, hashPubcoin.GetHex());
     if (!walletdb.ArchiveDeterministicOrphan(dMint))
         return error("%s: failed to archive deterministic ophaned mint", __func__);
+    UncacheHDMint(hashPubcoin, false);
 
     LogPrintf("%s: archived pubcoinhash %s\n", __func__, hashPubcoin.GetHex());
     return true;
@@ -98,10 +99,11 @@ bool CHDMintTracker::Archive(CLelantusMintMeta& meta)
 
     CWalletDB walletdb(strWalletFile);
     CHDMint dMint;
-    if (!walletdb.ReadHDMint(hashPubcoin, true, dMint))
+    if (!GetHDMint(hashPubcoin, true, dMint))
         return error("%s: could not find pubcoinhash %s in db", __func__, hashPubcoin.GetHex());
     if (!walletdb.ArchiveDeterministicOrphan(dMint))
         return error("%s: failed to archive deterministic ophaned mint", __func__);
+    UncacheHDMint(hashPubcoin, true);
 
     LogPrintf("%s: archived pubcoinhash %s\n", __func__, hashPubcoin.GetHex());
     return true;
@@ -223,15 +225,7 @@ bool CHDMintTracker::HasPubcoinHash(const uint256& hashPubcoin, CWalletDB& walle
             return true;
     }
 
-    for (auto const & it : mapLelantusSerialHashes) {
-        CLelantusMintMeta meta = it.second;
-        uint256 reducedHash;
-        walletdb.ReadPubcoinHashes(meta.GetPubCoinValueHash(), reducedHash);
-        if (reducedHash == hashPubcoin)
-            return true;
-    }
-
-    return false;
+    return setLelantusReducedHashes.count(hashPubcoin) > 0;
 }
 
 /**
@@ -261,14 +255,14 @@ bool CHDMintTracker::HasLelantusSerialHash(const uint256& hashSerial) const
  * @param meta the CMintMeta object used to update
  * @return success
  */
-bool CHDMintTracker::UpdateState(const CMintMeta& meta)
+bool CHDMintTracker::UpdateState(const CMintMeta& meta, bool fFlush)
 {
     uint256 hashPubcoin = meta.GetPubCoinValueHash();
     CWalletDB walletdb(strWalletFile);
 
     if (meta.isDeterministic) {
         CHDMint dMint;
-        if (!walletdb.ReadHDMint(hashPubcoin, false, dMint)) {
+        if (!GetHDMint(hashPubcoin, false, dMint)) {
             // Check archive just in case
             if (!meta.isArchived)
                 return error("%s: failed to read deterministic mint from database", __func__);
@@ -297,8 +291,8 @@ bool CHDMintTracker::UpdateState(const CMintMeta& meta)
         DenominationToInteger(meta.denom, amount);
         dMint.SetAmount(amount);
 
-        if (!walletdb.WriteHDMint(dMint.GetPubCoinHash(), dMint, false))
-            return error("%s: failed to update deterministic mint when writing to db", __func__);
+        CacheHDMint(dMint, false);
+        setDirtyHDMints.insert(dMint.GetPubCoinHash());
 
         pwalletMain->NotifyZerocoinChanged(
             pwalletMain,
@@ -327,16 +321,19 @@ bool CHDMintTracker::UpdateState(const CMintMeta& meta)
 
     mapSerialHashes[meta.hashSerial] = meta;
 
+    if (fFlush)
+        return Flush();
+
     return true;
 }
 
-bool CHDMintTracker::UpdateState(const CLelantusMintMeta& meta)
+bool CHDMintTracker::UpdateState(const CLelantusMintMeta& meta, bool fFlush)
 {
     uint256 hashPubcoin = meta.GetPubCoinValueHash();
     CWalletDB walletdb(strWalletFile);
 
     CHDMint dMint;
-    if (!walletdb.ReadHDMint(hashPubcoin, true, dMint)) {
+    if (!GetHDMint(hashPubcoin, true, dMint)) {
         // Check archive just in case
         if (!meta.isArchived)
             return error("%s: failed to read Lelantus mint from database", __func__);
@@ -361,11 +358,12 @@ bool CHDMintTracker::UpdateState(const CLelantusMintMeta& meta)
     dMint.SetUsed(meta.isUsed);
     dMint.SetAmount(meta.amount);
 
-    if (!walletdb.WriteHDMint(meta.GetPubCoinValueHash(), dMint, true))
-        return error("%s: failed to update Lelantus mint when writing to db", __func__);
-
     auto pubcoin = dMint.GetPubcoinValue() + lelantus::Params::get_default()->get_h1() * Scalar(meta.amount).negate();
-    walletdb.WritePubcoinHashes(hashPubcoin, primitives::GetPubCoinValueHash(pubcoin));
+    uint256 reducedHash = primitives::GetPubCoinValueHash(pubcoin);
+
+    CacheHDMint(dMint, true);
+    mapDirtyLelantusHDMints[hashPubcoin] = reducedHash;
+    setLelantusReducedHashes.insert(reducedHash);
 
 
     pwalletMain->NotifyZerocoinChanged(
@@ -376,6 +374,86 @@ bool CHDMintTracker::UpdateState(const CLelantusMintMeta& meta)
 
     mapLelantusSerialHashes[meta.hashSerial] = meta;
 
+    if (fFlush)
+        return Flush();
+
+    return true;
+}
+
+/**
+ * Get a CHDMint object from memory, or from the database if it isn't loaded
+ *
+ * @param hashPubcoin mint pubcoin hash
+ * @param isLelantus if the mint is a Lelantus one
+ * @param dMint reference to CHDMint object
+ * @return success
+ */
+bool CHDMintTracker::GetHDMint(const uint256& hashPubcoin, bool isLelantus, CHDMint& dMint) const
+{
+    const auto& mints = isLelantus ? mapLelantusHDMints : mapHDMints;
+    auto it = mints.find(hashPubcoin);
+    if (it != mints.end()) {
+        dMint = it->second;
+        return true;
+    }
+
+    CWalletDB walletdb(strWalletFile);
+    return walletdb.ReadHDMint(hashPubcoin, isLelantus, dMint);
+}
+
+void CHDMintTracker::CacheHDMint(const CHDMint& dMint, bool isLelantus)
+{
+    (isLelantus ? mapLelantusHDMints : mapHDMints)[dMint.GetPubCoinHash()] = dMint;
+}
+
+void CHDMintTracker::UncacheHDMint(const uint256& hashPubcoin, bool isLelantus)
+{
+    if (isLelantus) {
+        mapLelantusHDMints.erase(hashPubcoin);
+        mapDirtyLelantusHDMints.erase(hashPubcoin);
+    } else {
+        mapHDMints.erase(hashPubcoin);
+        setDirtyHDMints.erase(hashPubcoin);
+    }
+}
+
+/**
+ * Write the mints updated in memory to the database.
+ *
+ * All of them are written in one database transaction, so updating the mints of a block costs a single commit.
+ *
+ * @return success
+ */
+bool CHDMintTracker::Flush()
+{
+    if (setDirtyHDMints.empty() && mapDirtyLelantusHDMints.empty())
+        return true;
+
+    CWalletDB walletdb(strWalletFile);
+    bool fTxn = walletdb.TxnBegin();
+
+    for (const uint256& hashPubcoin : setDirtyHDMints) {
+        if (!walletdb.WriteHDMint(hashPubcoin, mapHDMints.at(hashPubcoin), false)) {
+            if (fTxn)
+                walletdb.TxnAbort();
+            return error("%s: failed to update deterministic mint when writing to db", __func__);
+        }
+    }
+
+    for (const auto& it : mapDirtyLelantusHDMints) {
+        if (!walletdb.WriteHDMint(it.first, mapLelantusHDMints.at(it.first), true)
+            || !walletdb.WritePubcoinHashes(it.first, it.second)) {
+            if (fTxn)
+                walletdb.TxnAbort();
+            return error("%s: failed to update Lelantus mint when writing to db", __func__);
+        }
+    }
+
+    if (fTxn && !walletdb.TxnCommit())
+        return error("%s: failed to commit mint updates to db", __func__);
+
+    setDirtyHDMints.clear();
+    mapDirtyLelantusHDMints.clear();
     return true;
 }
 
@@ -386,13 +464,17 @@ bool CHDMintTracker::UpdateState(const CLelantusMintMeta& meta)
  * Also notifies Qt that a Sigma mint has been added so as to update the balance display correctly.
  * This is used to populate memory on startup.
  *
- * @param dMint CHDMint object to add
+ * @param dbMint CHDMint object to add, an update of it which is not flushed yet is kept instead
  * @param isNew set to true if this mint has just been created, also adds mint to database
  * @param isArchived set to true if this mint is archived, used to set meta object correctly
  * @return success
  */
-void CHDMintTracker::Add(CWalletDB& walletdb, const CHDMint& dMint, bool isNew, bool isArchived)
+void CHDMintTracker::Add(CWalletDB& walletdb, const CHDMint& dbMint, bool isNew, bool isArchived)
 {
+    // a mint updated in memory and not flushed yet is newer than the one read from the database
+    auto dirty = setDirtyHDMints.find(dbMint.GetPubCoinHash());
+    const CHDMint dMint = !isNew && dirty != setDirtyHDMints.end() ? mapHDMints.at(*dirty) : dbMint;
+
     CMintMeta meta;
     meta.SetPubCoinValue(dMint.GetPubcoinValue());
     meta.nHeight = dMint.GetHeight();
@@ -408,18 +490,28 @@ void CHDMintTracker::Add(CWalletDB& walletdb, const CHDMint& dMint, bool isNew,
     meta.isSeedCorrect = true;
     mapSerialHashes[meta.hashSerial] = meta;
 
+    CacheHDMint(dMint, false);
+
     pwalletMain->NotifyZerocoinChanged(
         pwalletMain,
         dMint.GetPubcoinValue().GetHex(),
         std::string("Update (") + std::to_string((double)dMint.GetAmount() / COIN) + "mint)",
         CT_UPDATED);
 
-    if (isNew)
-        walletdb.WriteHDMint(meta.GetPubCoinValueHash(), dMint, false);
+    if (isNew) {
+        if (walletdb.WriteHDMint(meta.GetPubCoinValueHash(), dMint, false))
+            setDirtyHDMints.erase(meta.GetPubCoinValueHash());
+        else
+            setDirtyHDMints.insert(meta.GetPubCoinValueHash());
+    }
 }
 
-void CHDMintTracker::AddLelantus(CWalletDB& walletdb, const CHDMint& dMint, bool isNew, bool isArchived)
+void CHDMintTracker::AddLelantus(CWalletDB& walletdb, const CHDMint& dbMint, bool isNew, bool isArchived)
 {
+    // a mint updated in memory and not flushed yet is newer than the one read from the database
+    auto dirty = mapDirtyLelantusHDMints.find(dbMint.GetPubCoinHash());
+    const CHDMint dMint = !isNew && dirty != mapDirtyLelantusHDMints.end() ? mapLelantusHDMints.at(dirty->first) : dbMint;
+
     CLelantusMintMeta meta;
     meta.SetPubCoinValue(dMint.GetPubcoinValue());
     meta.nHeight = dMint.GetHeight();
@@ -438,10 +530,23 @@ void CHDMintTracker::AddLelantus(CWalletDB& walletdb, const CHDMint& dMint, bool
             std::string("Update (") + std::to_string((double)dMint.GetAmount() / COIN) + "mint)",
             CT_UPDATED);
 
+    CacheHDMint(dMint, true);
+
     if (isNew) {
-        walletdb.WriteHDMint(meta.GetPubCoinValueHash(), dMint, true);
         auto pubcoin = dMint.GetPubcoinValue() + lelantus::Params::get_default()->get_h1() * Scalar(meta.amount).negate();
-        walletdb.WritePubcoinHashes(meta.GetPubCoinValueHash(), primitives::GetPubCoinValueHash(pubcoin));
+        uint256 reducedHash = primitives::GetPubCoinValueHash(pubcoin);
+        if (walletdb.WriteHDMint(meta.GetPubCoinValueHash(), dMint, true)
+            && walletdb.WritePubcoinHashes(meta.GetPubCoinValueHash(), reducedHash))
+            mapDirtyLelantusHDMints.erase(meta.GetPubCoinValueHash());
+        else
+            mapDirtyLelantusHDMints[meta.GetPubCoinValueHash()] = reducedHash;
+        setLelantusReducedHashes.insert(reducedHash);
+    } else if (dirty != mapDirtyLelantusHDMints.end()) {
+        setLelantusReducedHashes.insert(dirty->second);
+    } else {
+        uint256 reducedHash;
+        if (walletdb.ReadPubcoinHashes(meta.GetPubCoinValueHash(), reducedHash))
+            setLelantusReducedHashes.insert(reducedHash);
     }
 }
 
@@ -792,7 +897,9 @@ void CHDMintTracker::UpdateFromBlock(const std::list<std::pair<uint256, MintPool
 
     //overwrite any updates
     for (CMintMeta meta : updatedMeta)
-        UpdateState(meta);
+        UpdateState(meta, false);
+    if (!Flush())
+        LogPrintf("%s: updated mints are kept in memory until the next flush\n", __func__);
 }
 
 void CHDMintTracker::UpdateFromBlock(const std::list<std::pair<uint256, MintPoolEntry>>& mintPoolEntries, const std::vector<CLelantusMintMeta>& updatedMeta){
@@ -802,7 +909,9 @@ void CHDMintTracker::UpdateFromBlock(const std::list<std::pair<uint256, MintPool
 
     //overwrite any updates
     for (CLelantusMintMeta meta : updatedMeta)
-        UpdateState(meta);
+        UpdateState(meta, false);
+    if (!Flush())
+        LogPrintf("%s: updated mints are kept in memory until the next flush\n", __func__);
 }
 
 /**
@@ -1207,7 +1316,9 @@ std::vector<CMintMeta> CHDMintTracker::ListMints(bool fUnusedOnly, bool fMatureO
 
     //overwrite any updates
     for (CMintMeta& meta : vOverWrite)
-        UpdateState(meta);
+        UpdateState(meta, false);
+    if (!Flush())
+        LogPrintf("%s: updated mints are kept in memory until the next flush\n", __func__);
 
     return setMints;
 }
@@ -1264,7 +1375,9 @@ std::vector<CLelantusMintMeta> CHDMintTracker::ListLelantusMints(bool fUnusedOnl
 
     //overwrite any updates
     for (CLelantusMintMeta& meta : vOverWrite)
-        UpdateState(meta);
+        UpdateState(meta, false);
+    if (!Flush())
+        LogPrintf("%s: updated mints are kept in memory until the next flush\n", __func__);
 
     return setMints;
 }
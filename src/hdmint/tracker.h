@@ -6,11 +6,13 @@
 #define FIRO_HDMINTTRACKER_H
 
 #include "primitives/mint_spend.h"
+#include "hdmint/hdmint.h"
 #include "hdmint/mintpool.h"
 #include "wallet/walletdb.h"
 #include <list>
+#include <map>
+#include <set>
 
-class CHDMint;
 class CHDMintWallet;
 
 class CHDMintTracker
@@ -21,6 +23,14 @@ private:
     std::map<uint256, CMintMeta> mapSerialHashes;
     std::map<uint256, CLelantusMintMeta> mapLelantusSerialHashes;
     std::map<uint256, uint256> mapPendingSpends; //serialhash, txid of spend
+    // HD mints of the database by pubcoin hash, the updates are written back by Flush()
+    std::map<uint256, CHDMint> mapHDMints;
+    std::map<uint256, CHDMint> mapLelantusHDMints;
+    std::set<uint256> setDirtyHDMints;
+    std::map<uint256, uint256> mapDirtyLelantusHDMints; //pubcoin hash, reduced pubcoin hash
+    std::set<uint256> setLelantusReducedHashes;
+    void CacheHDMint(const CHDMint& dMint, bool isLelantus);
+    void UncacheHDMint(const uint256& hashPubcoin, bool isLelantus);
     bool IsMempoolSpendOurs(const std::set<uint256>& setMempool, const uint256& hashSerial);
     bool UpdateMetaStatus(const std::set<uint256>& setMempool, CMintMeta& mint, bool fSpend=false);
     bool UpdateLelantusMetaStatus(const std::set<uint256>& setMempool, CLelantusMintMeta& mint, bool fSpend=false);
@@ -64,8 +74,10 @@ public:
     void SetLelantusPubcoinUsed(const uint256& hashPubcoin, const uint256& txid);
     void SetLelantusPubcoinNotUsed(const uint256& hashPubcoin);
     bool UnArchive(const uint256& hashPubcoin, bool isDeterministic);
-    bool UpdateState(const CMintMeta& meta);
-    bool UpdateState(const CLelantusMintMeta& meta);
+    bool UpdateState(const CMintMeta& meta, bool fFlush = true);
+    bool UpdateState(const CLelantusMintMeta& meta, bool fFlush = true);
+    bool GetHDMint(const uint256& hashPubcoin, bool isLelantus, CHDMint& dMint) const;
+    bool Flush();
     void Clear();
 };
 
@@ -19,6 +19,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <atomic>
 #include <future>
 
 #include <event2/event.h>
@@ -27,6 +28,7 @@
 #include <event2/buffer.h>
 #include <event2/util.h>
 #include <event2/keyvalq_struct.h>
+#include <event2/bufferevent.h>
 
 #ifdef EVENT__HAVE_NETINET_IN_H
 #include <netinet/in.h>
@@ -38,6 +40,9 @@
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
+/** Amount of chunked reply data not yet written to the client at which WriteReplyChunk waits */
+static const size_t MAX_PENDING_CHUNKS_SIZE = 4 * 1024 * 1024;
+
 /** HTTP request work item */
 class HTTPWorkItem : public HTTPClosure
 {
@@ -545,7 +550,9 @@ HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
 }
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (chunkedReply && !replySent) {
+        WriteReplyEnd();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -610,6 +617,105 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     req = 0; // transferred back to main thread
 }
 
+/** State of a chunked reply, shared between the worker thread writing it and the main http thread.
+ * The evhttp request is freed by libevent if the client disconnects, so the main thread
+ * must not touch it anymore once closed is set.
+ */
+struct HTTPChunkedReply
+{
+    std::atomic<bool> closed;
+    /** Amount of data in the output buffer of the connection, updated by the main thread */
+    std::atomic<size_t> pending;
+
+    HTTPChunkedReply() : closed(false), pending(0) {}
+};
+
+static void http_chunked_reply_closed_cb(struct evhttp_connection*, void* arg)
+{
+    static_cast<HTTPChunkedReply*>(arg)->closed = true;
+}
+
+/** Update the amount of data not yet written to the client, call in the main thread only */
+static void http_chunked_reply_update_pending(struct evhttp_request* req, HTTPChunkedReply& reply)
+{
+    if (reply.closed)
+        return;
+    evhttp_connection* con = evhttp_request_get_connection(req);
+    struct bufferevent* bev = con ? evhttp_connection_get_bufferevent(con) : NULL;
+    reply.pending = bev ? evbuffer_get_length(bufferevent_get_output(bev)) : 0;
+}
+
+void HTTPRequest::WriteReplyStart(int nStatus)
+{
+    assert(!replySent && !chunkedReply && req);
+    chunkedReply = std::make_shared<HTTPChunkedReply>();
+    // Events are activated in order, so the chunks follow the start of the reply in the main thread
+    struct evhttp_request* r = req;
+    std::shared_ptr<HTTPChunkedReply> reply = chunkedReply;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [r, reply, nStatus]() {
+        evhttp_connection* con = evhttp_request_get_connection(r);
+        if (!con) {
+            reply->closed = true;
+            return;
+        }
+        evhttp_connection_set_closecb(con, http_chunked_reply_closed_cb, reply.get());
+        evhttp_send_reply_start(r, nStatus, NULL);
+    });
+    ev->trigger(0);
+}
+
+bool HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(!replySent && chunkedReply && req);
+    // Wait for the client to read the data sent before, so that a slow client does not make
+    // the whole reply pile up in memory. A stalled client is disconnected by the server timeout.
+    struct evhttp_request* r = req;
+    std::shared_ptr<HTTPChunkedReply> reply = chunkedReply;
+    while (!reply->closed && reply->pending > MAX_PENDING_CHUNKS_SIZE) {
+        MilliSleep(10);
+        HTTPEvent* ev = new HTTPEvent(eventBase, true, [r, reply]() {
+            http_chunked_reply_update_pending(r, *reply);
+        });
+        ev->trigger(0);
+    }
+    if (reply->closed)
+        return false;
+    if (strChunk.empty())
+        return true;
+
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    reply->pending += strChunk.size();
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [r, reply, evb]() {
+        if (!reply->closed) {
+            evhttp_send_reply_chunk(r, evb);
+            http_chunked_reply_update_pending(r, *reply);
+        }
+        evbuffer_free(evb);
+    });
+    ev->trigger(0);
+    return true;
+}
+
+void HTTPRequest::WriteReplyEnd()
+{
+    assert(!replySent && chunkedReply && req);
+    struct evhttp_request* r = req;
+    std::shared_ptr<HTTPChunkedReply> reply = chunkedReply;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [r, reply]() {
+        if (reply->closed)
+            return;
+        evhttp_connection* con = evhttp_request_get_connection(r);
+        if (con)
+            evhttp_connection_set_closecb(con, NULL, NULL);
+        evhttp_send_reply_end(r);
+    });
+    ev->trigger(0);
+    replySent = true;
+    req = 0; // transferred back to main thread
+}
+
 CService HTTPRequest::GetPeer()
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
@@ -8,6 +8,7 @@
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <memory>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
@@ -17,6 +18,7 @@ struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPChunkedReply;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -55,6 +57,7 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    std::shared_ptr<HTTPChunkedReply> chunkedReply;
 
 public:
     HTTPRequest(struct evhttp_request* req);
@@ -110,6 +113,29 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply, for replies which are too large to be built in memory first.
+     * nStatus is the HTTP status code to send, the body is then sent by WriteReplyChunk
+     * and finished by WriteReplyEnd.
+     *
+     * @note Can be called instead of WriteReply, after writing the headers. Do not call
+     * any HTTPRequest methods other than WriteReplyChunk and WriteReplyEnd after calling this.
+     */
+    void WriteReplyStart(int nStatus);
+
+    /**
+     * Send the next part of the body of a chunked reply. Blocks while the client
+     * has not read a large amount of the data sent before.
+     * Returns false if the client disconnected, then the reply can only be ended.
+     */
+    bool WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Finish a chunked reply. As this will give the request back to the main thread,
+     * do not call any other HTTPRequest methods after calling this.
+     */
+    void WriteReplyEnd();
 };
 
 /** Event handler closure.
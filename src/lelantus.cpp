@@ -17,6 +17,8 @@
 #include "policy/policy.h"
 #include "coins.h"
 #include "batchproof_container.h"
+#include "coinsetcache.h"
+#include "spendproofcache.h"
 
 #include <atomic>
 #include <sstream>
@@ -443,6 +445,7 @@ bool CheckLelantusJoinSplitTransaction(
     }
 
     std::vector<std::vector<unsigned char>> anonymity_set_hashes;
+    CSpendProofCacheEntry proofCacheEntry(tx.GetHash());
 
     for (auto& idAndHash : joinsplit->getIdAndBlockHashes()) {
         auto& anonymity_set = anonymity_sets[idAndHash.first];
@@ -465,25 +468,14 @@ bool CheckLelantusJoinSplitTransaction(
             while (index != coinGroup.firstBlock && index->GetBlockHash() != idAndHash.second)
                 index = index->pprev;
 
-            std::pair<sigma::CoinDenomination, int> denominationAndId = std::make_pair(denomination, coinGroupId);
+            proofCacheEntry << idAndHash.first << index->GetBlockHash();
 
-            auto lelantusParams = lelantus::Params::get_default();
-            while (true) {
-                if (index->sigmaMintedPubCoins.count(denominationAndId) > 0) {
-                    BOOST_FOREACH(
-                    const sigma::PublicCoin &pubCoinValue,
-                    index->sigmaMintedPubCoins[denominationAndId]) {
-                        if (::Params().GetConsensus().sigmaBlacklist.count(pubCoinValue.getValue()) > 0) {
-                            continue;
-                        }
-                        lelantus::PublicCoin publicCoin(pubCoinValue.getValue() + lelantusParams->get_h1() * intDenom);
-                        anonymity_set.push_back(publicCoin);
-                    }
-                }
-                if (index == coinGroup.firstBlock)
-                    break;
-                index = index->pprev;
-            }
+            // the converted sets are shared by all the spends from the group
+            auto convertedSet = sigmaToLelantusSetCache.GetAnonymitySet(denomination, coinGroupId, coinGroup.firstBlock, index, true);
+            if (!convertedSet)
+                return state.DoS(100, false, NO_MINT_ZEROCOIN,
+                                 "CheckLelantusJoinSplitTransaction: Error: invalid sigma denomination");
+            anonymity_set = *convertedSet;
         } else {
             CLelantusState::LelantusCoinGroupInfo coinGroup;
             if (!lelantusState.GetCoinGroupInfo(idAndHash.first, coinGroup))
@@ -497,6 +489,8 @@ bool CheckLelantusJoinSplitTransaction(
             while (index != coinGroup.firstBlock && index->GetBlockHash() != idAndHash.second)
                 index = index->pprev;
 
+            proofCacheEntry << idAndHash.first << index->GetBlockHash();
+
             // take the hash from last block of anonymity set, it is used at challenge generation if nLelantusFixesStartBlock is passed
             if (nHeight >= params.nLelantusFixesStartBlock) {
                 std::vector<unsigned char> set_hash = GetAnonymitySetHash(index, idAndHash.first);
@@ -537,22 +531,35 @@ bool CheckLelantusJoinSplitTransaction(
         anonymity_sets[idAndHash.first] = anonymity_set;
     }
 
-    BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
-    bool useBatching = batchProofContainer->fCollectProofs && !isVerifyDB && !isCheckWallet && lelantusTxInfo && !lelantusTxInfo->fInfoIsComplete;
+    // the blocks ending the sets and the blacklists determine the sets, the rest is fixed by the transaction
+    for (const auto& anonymity_set : anonymity_sets)
+        proofCacheEntry << anonymity_set.first << (uint64_t)anonymity_set.second.size();
+    proofCacheEntry << anonymity_set_hashes << (chainActive.Height() >= params.nLelantusFixesStartBlock);
+    uint256 proofCacheHash = proofCacheEntry.GetHash();
 
-    Scalar challenge;
-    // if we are collecting proofs, skip verification and collect proofs
-    passVerify = joinsplit->Verify(anonymity_sets, anonymity_set_hashes, Cout, Vout, txHashForMetadata, challenge, useBatching);
+    if (IsSpendProofCached(proofCacheHash)) {
+        // already verified against the same anonymity sets, when it entered the mempool or a block template
+        passVerify = true;
+    } else {
+        BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
+        bool useBatching = batchProofContainer->fCollectProofs && !isVerifyDB && !isCheckWallet && lelantusTxInfo && !lelantusTxInfo->fInfoIsComplete;
 
-    // add proofs into container
-    if(useBatching) {
-        std::map<uint32_t, size_t> idAndSizes;
+        Scalar challenge;
+        // if we are collecting proofs, skip verification and collect proofs
+        passVerify = joinsplit->Verify(anonymity_sets, anonymity_set_hashes, Cout, Vout, txHashForMetadata, challenge, useBatching);
 
-        for(auto itr : anonymity_sets)
-            idAndSizes[itr.first] = itr.second.size();
+        // add proofs into container
+        if(useBatching) {
+            std::map<uint32_t, size_t> idAndSizes;
 
-        batchProofContainer->add(joinsplit.get(), idAndSizes, challenge, nHeight >= params.nLelantusFixesStartBlock);
-        batchProofContainer->add(joinsplit.get(), Cout);
+            for(auto itr : anonymity_sets)
+                idAndSizes[itr.first] = itr.second.size();
+
+            batchProofContainer->add(joinsplit.get(), idAndSizes, challenge, nHeight >= params.nLelantusFixesStartBlock);
+            batchProofContainer->add(joinsplit.get(), Cout);
+        } else if (passVerify) {
+            AddSpendProofToCache(proofCacheHash);
+        }
     }
 
     if (passVerify) {
@@ -812,9 +819,47 @@ void RemoveLelantusJoinSplitReferencingBlock(CTxMemPool& pool, CBlockIndex* bloc
     }
 }
 
-void DisconnectTipLelantus(CBlock& block, CBlockIndex *pindexDelete) {
+// Collects the mints and spends of a block the state counts, the block is the last one of the groups it has coins in
+static CLelantusBlockUpdate GetBlockUpdate(const CBlockIndex *pindex, bool fConnected) {
+    CLelantusBlockUpdate update;
+    update.blockHash = pindex->GetBlockHash();
+    update.nHeight = pindex->nHeight;
+    update.fConnected = fConnected;
+
+    for (const auto& groupCoins : pindex->lelantusMintedPubCoins) {
+        CLelantusState::LelantusCoinGroupInfo coinGroup;
+        if (groupCoins.second.empty() || !lelantusState.GetCoinGroupInfo(groupCoins.first, coinGroup))
+            continue;
+
+        int index = coinGroup.nCoins - groupCoins.second.size();
+        for (const auto& coin : groupCoins.second)
+            update.mints.push_back({groupCoins.first, index++, coin.first, coin.second});
+    }
+
+    update.spentSerials.assign(pindex->lelantusSpentSerials.begin(), pindex->lelantusSpentSerials.end());
+    return update;
+}
+
+CLelantusBlockUpdate GetConnectedBlockUpdate(const CBlockIndex *pindex, int previousLatestCoinId) {
+    CLelantusBlockUpdate update = GetBlockUpdate(pindex, true);
+    for (int id = previousLatestCoinId + 1; id <= lelantusState.GetLatestCoinID(); id++)
+        update.newCoinGroups.push_back(id);
+    return update;
+}
+
+void DisconnectTipLelantus(CBlock& block, CBlockIndex *pindexDelete, CLelantusBlockUpdate *update) {
+    // the positions of the coins are taken from the state which still has the block
+    if (update)
+        *update = GetBlockUpdate(pindexDelete, false);
+    int latestCoinId = lelantusState.GetLatestCoinID();
+
     lelantusState.RemoveBlock(pindexDelete);
 
+    if (update) {
+        for (int id = lelantusState.GetLatestCoinID() + 1; id <= latestCoinId; id++)
+            update->newCoinGroups.push_back(id);
+    }
+
     // Also remove from mempool lelantus joinsplits that reference given block hash.
     RemoveLelantusJoinSplitReferencingBlock(mempool, pindexDelete);
     RemoveLelantusJoinSplitReferencingBlock(txpools.getStemTxPool(), pindexDelete);
@@ -1472,6 +1517,79 @@ int CLelantusState::GetCoinSetForSpend(
     return numberOfCoins;
 }
 
+int CLelantusState::GetCoinsSince(
+    CChain *chain,
+    int maxHeight,
+    int coinGroupID,
+    CBlockIndex const *startBlock,
+    uint256& blockHash_out,
+    std::vector<std::pair<lelantus::PublicCoin, uint256>>& coins_out,
+    std::vector<unsigned char>& setHash_out) {
+
+    coins_out.clear();
+
+    if (coinGroups.count(coinGroupID) == 0) {
+        return 0;
+    }
+
+    LelantusCoinGroupInfo &coinGroup = coinGroups[coinGroupID];
+    int startHeight = startBlock ? startBlock->nHeight : -1;
+    bool found = false;
+
+    // blocks with coins newer than startBlock, from the latest one
+    std::vector<std::pair<CBlockIndex *, int>> blocks;
+    for (CBlockIndex *block = coinGroup.lastBlock;; block = block->pprev) {
+
+        // same rule as GetCoinSetForSpend() for coins of the previous group, blocks above max height are ignored
+        int id = 0;
+        if (block->nHeight <= maxHeight) {
+            if (CountCoinInBlock(block, coinGroupID)) {
+                id = coinGroupID;
+            } else if (CountCoinInBlock(block, coinGroupID - 1)) {
+                id = coinGroupID - 1;
+            }
+        }
+
+        if (id) {
+            if (!found) {
+                // latest block satisfying given conditions, even if the caller already has its coins
+                // remember block hash and set hash
+                blockHash_out = block->GetBlockHash();
+                setHash_out = GetAnonymitySetHash(block, id);
+                found = true;
+            }
+
+            if (block->nHeight <= startHeight) {
+                break;
+            }
+
+            blocks.emplace_back(block, id);
+        }
+
+        if (block == coinGroup.firstBlock) {
+            break;
+        }
+    }
+
+    bool skipBlacklisted = chainActive.Height() >= ::Params().GetConsensus().nLelantusFixesStartBlock;
+    int numberOfCoins = 0;
+
+    for (auto it = blocks.rbegin(); it != blocks.rend(); it++) {
+        for (const auto &coin : it->first->lelantusMintedPubCoins[it->second]) {
+            numberOfCoins++;
+
+            // skip mints from blacklist if nLelantusFixesStartBlock is passed
+            if (skipBlacklisted && ::Params().GetConsensus().lelantusBlacklist.count(coin.first.getValue()) > 0) {
+                continue;
+            }
+
+            coins_out.push_back(coin);
+        }
+    }
+
+    return numberOfCoins;
+}
+
 void CLelantusState::GetAnonymitySet(
         int coinGroupID,
         bool fStartLelantusBlacklist,
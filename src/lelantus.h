@@ -39,6 +39,37 @@ public:
     void Complete();
 };
 
+// Changes of the Lelantus state made by a block connected to or disconnected from the tip, for notifications
+struct CLelantusBlockUpdate {
+    struct Mint {
+        int coinGroupId;
+        // position of the coin in its group
+        int index;
+        PublicCoin coin;
+        uint256 txHash;
+
+        ADD_SERIALIZE_METHODS;
+
+        template <typename Stream, typename Operation>
+        inline void SerializationOp(Stream& s, Operation ser_action) {
+            READWRITE(coinGroupId);
+            READWRITE(index);
+            READWRITE(coin);
+            READWRITE(txHash);
+        }
+    };
+
+    uint256 blockHash;
+    int nHeight;
+    // false if the block was disconnected, the changes are reverted then
+    bool fConnected;
+
+    std::vector<Mint> mints;
+    std::vector<std::pair<Scalar, int>> spentSerials;
+    // groups started by the block, which are removed again when it's disconnected
+    std::vector<int> newCoinGroups;
+};
+
 bool IsLelantusAllowed();
 bool IsLelantusAllowed(int height);
 
@@ -69,7 +100,15 @@ bool CheckLelantusTransaction(
     sigma::CSigmaTxInfo* sigmaTxInfo,
 	CLelantusTxInfo* lelantusTxInfo);
 
-void DisconnectTipLelantus(CBlock &block, CBlockIndex *pindexDelete);
+/*
+ * Changes the block made to the state once it's connected, previousLatestCoinId is the latest coin group id before.
+ */
+CLelantusBlockUpdate GetConnectedBlockUpdate(const CBlockIndex *pindex, int previousLatestCoinId);
+
+/*
+ * Removes the block from the state, update receives the changes it reverts if not null.
+ */
+void DisconnectTipLelantus(CBlock &block, CBlockIndex *pindexDelete, CLelantusBlockUpdate *update = nullptr);
 
 bool ConnectBlockLelantus(
   CValidationState& state,
@@ -191,6 +230,18 @@ public:
         std::vector<lelantus::PublicCoin>& coins_out,
         std::vector<unsigned char>& setHash_out);
 
+    // Same set as GetCoinSetForSpend() but only coins minted after startBlock (all of them if it is null),
+    // in the order they were minted and together with the hashes of their transactions
+    // Returns number of coins satisfying conditions
+    int GetCoinsSince(
+        CChain *chain,
+        int maxHeight,
+        int id,
+        CBlockIndex const *startBlock,
+        uint256& blockHash_out,
+        std::vector<std::pair<lelantus::PublicCoin, uint256>>& coins_out,
+        std::vector<unsigned char>& setHash_out);
+
     void GetAnonymitySet(
             int coinGroupID,
             bool fStartLelantusBlacklist,
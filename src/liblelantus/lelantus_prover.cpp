@@ -109,27 +109,32 @@ void LelantusProver::generate_sigma_proofs(
     parallelTasks.reserve(threadsMaxCount);
     ParallelOpThreadPool<bool> threadPool(threadsMaxCount);
 
-    std::vector<std::vector<GroupElement>> C_;
-    C_.resize(N);
+    // The inputs spending from a set share its values, the serial of each input is added by the prover
+    // as an offset, so the set isn't copied and shifted for every input.
+    std::map<uint32_t, std::vector<GroupElement>> setValues;
+    for (std::size_t i = 0; i < N; ++i) {
+        if (setValues.count(Cin[i].second))
+            continue;
+
+        const auto& set = c.find(Cin[i].second);
+        if (set == c.end())
+            throw std::invalid_argument("No such anonymity set or id is not correct");
+
+        auto& values = setValues[Cin[i].second];
+        values.reserve(set->second.size());
+        for (auto const &coin : set->second)
+            values.emplace_back(coin.getValue());
+    }
+
+    std::vector<GroupElement> offsets;
+    offsets.resize(N);
     DoNotDisturb dnd;
     for (std::size_t j = 0; j < N; j += threadsMaxCount) {
         for (std::size_t i = j; i < j + threadsMaxCount; ++i) {
             if (i < N) {
-                if (!c.count(Cin[i].second))
-                    throw std::invalid_argument("No such anonymity set or id is not correct");
-
-                GroupElement gs = (params->get_g() * Cin[i].first.getSerialNumber().negate());
+                offsets[i] = params->get_g() * Cin[i].first.getSerialNumber().negate();
                 serialNumbers.emplace_back(Cin[i].first.getSerialNumber());
 
-                C_[i].reserve(c.size());
-
-                const auto& set = c.find(Cin[i].second);
-                if (set == c.end())
-                    throw std::invalid_argument("No such anonymity set");
-
-                for (auto const &coin : set->second)
-                    C_[i].emplace_back(coin.getValue() + gs);
-
                 rA[i].randomize();
                 rB[i].randomize();
                 rC[i].randomize();
@@ -149,12 +154,13 @@ void LelantusProver::generate_sigma_proofs(
                 auto& Pk_i = Pk[i];
                 auto& Yk_i = Yk[i];
                 auto& prover = sigmaProver;
-                auto& commits = C_[i];
+                auto& commits = setValues[Cin[i].second];
+                auto& offset = offsets[i];
                 auto& index = indexes[i];
                 auto& proof = sigma_proofs[i];
                 parallelTasks.emplace_back(threadPool.PostTask([&]() {
                     try {
-                        prover.sigma_commit(commits, index, rA_i, rB_i, rC_i, rD_i, a_i, Tk_i, Pk_i, Yk_i, sigma_i, proof);
+                        prover.sigma_commit(commits, offset, index, rA_i, rB_i, rC_i, rD_i, a_i, Tk_i, Pk_i, Yk_i, sigma_i, proof);
                     } catch (...) {
                         return false;
                     }
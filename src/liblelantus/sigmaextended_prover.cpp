@@ -28,6 +28,23 @@ void SigmaExtendedProver::sigma_commit(
         std::vector<Scalar>& Yk,
         std::vector<Scalar>& sigma,
         SigmaExtendedProof& proof_out) {
+    sigma_commit(commits, GroupElement(), l, rA, rB, rC, rD, a, Tk, Pk, Yk, sigma, proof_out);
+}
+
+void SigmaExtendedProver::sigma_commit(
+        const std::vector<GroupElement>& commits,
+        const GroupElement& offset,
+        std::size_t l,
+        const Scalar& rA,
+        const Scalar& rB,
+        const Scalar& rC,
+        const Scalar& rD,
+        std::vector<Scalar>& a,
+        std::vector<Scalar>& Tk,
+        std::vector<Scalar>& Pk,
+        std::vector<Scalar>& Yk,
+        std::vector<Scalar>& sigma,
+        SigmaExtendedProof& proof_out) {
     // Sanity checks
     if (n_ < 2 || m_ < 2) {
         throw std::invalid_argument("Prover parameters are invalid");
@@ -157,11 +174,16 @@ void SigmaExtendedProver::sigma_commit(
     {
         std::vector<Scalar> P_i;
         P_i.reserve(setSize);
+        Scalar P_sum(uint64_t(0));
         for (std::size_t i = 0; i < setSize; ++i){
             P_i.emplace_back(P_i_k[i][k]);
+            P_sum += P_i_k[i][k];
         }
         secp_primitives::MultiExponent mult(commits, P_i);
         GroupElement c_k = mult.get_multiple();
+        // \sum_i p_{i,k}(commits_i + offset) = \sum_i p_{i,k}commits_i + offset\sum_i p_{i,k}
+        if (!offset.isInfinity())
+            c_k += offset * P_sum;
         proof_out.Gk_.emplace_back(c_k + h_[0] * Yk[k].negate());
         proof_out.Qk.emplace_back(LelantusPrimitives::double_commit(g_, Scalar(uint64_t(0)), h_[1], Pk[k], h_[0], Tk[k]) + h_[0] * Yk[k]);
 
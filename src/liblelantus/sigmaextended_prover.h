@@ -25,6 +25,22 @@ public:
             std::vector<Scalar>& sigma,
             SigmaExtendedProof& proof_out);
 
+    // Same as above for the commitments commits[i] + offset, which don't have to be computed for every prover
+    void sigma_commit(
+            const std::vector<GroupElement>& commits,
+            const GroupElement& offset,
+            std::size_t l,
+            const Scalar& rA,
+            const Scalar& rB,
+            const Scalar& rC,
+            const Scalar& rD,
+            std::vector<Scalar>& a,
+            std::vector<Scalar>& Tk,
+            std::vector<Scalar>& Pk,
+            std::vector<Scalar>& Yk,
+            std::vector<Scalar>& sigma,
+            SigmaExtendedProof& proof_out);
+
     void sigma_response(
             const std::vector<Scalar>& sigma,
             const std::vector<Scalar>& a,
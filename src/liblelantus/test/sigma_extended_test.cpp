@@ -191,6 +191,50 @@ BOOST_AUTO_TEST_CASE(one_out_of_N_batch)
     BOOST_CHECK(verifier.batchverify(commits, x, serials, proofs));
 }
 
+BOOST_AUTO_TEST_CASE(one_out_of_N_offset)
+{
+    GenerateParams(64, 4);
+
+    // the set isn't shifted by the serials, they are passed as offsets
+    auto commits = RandomizeGroupElements(60);
+
+    std::vector<Secret> secrets;
+    for (auto index : {0, 7, 59}) {
+        secrets.emplace_back(index);
+
+        auto &s = secrets.back();
+
+        commits[index] = Primitives::double_commit(
+            g, s.s, h_gens[1], s.v, h_gens[0], s.r);
+    }
+
+    Prover prover(g, h_gens, n, m);
+    Verifier verifier(g, h_gens, n, m);
+
+    for (auto const &s : secrets) {
+        Scalar rA, rB, rC, rD;
+        rA.randomize();
+        rB.randomize();
+        rC.randomize();
+        rD.randomize();
+
+        std::vector<Scalar> sigma;
+        std::vector<Scalar> Tk(m), Pk(m), Yk(m);
+        std::vector<Scalar> a(n * m);
+
+        Scalar x;
+        x.randomize();
+
+        Proof proof;
+        prover.sigma_commit(
+            commits, g * s.s.negate(), s.l, rA, rB, rC, rD, a, Tk, Pk, Yk, sigma, proof);
+        prover.sigma_response(
+            sigma, a, rA, rB, rC, rD, s.v, s.r, Tk, Pk, x, proof);
+
+        BOOST_CHECK(verifier.singleverify(commits, x, s.s, proof));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(one_out_of_N_batch_with_some_invalid_proof)
 {
     GenerateParams(16, 4);
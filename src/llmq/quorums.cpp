@@ -164,6 +164,8 @@ CQuorumManager::CQuorumManager(CEvoDB& _evoDb, CBLSWorker& _blsWorker, CDKGSessi
 
 void CQuorumManager::UpdatedBlockTip(const CBlockIndex* pindexNew, bool fInitialDownload)
 {
+    tip = pindexNew;
+
     if (!masternodeSync.IsBlockchainSynced()) {
         return;
     }
@@ -302,8 +304,9 @@ bool CQuorumManager::HasQuorum(Consensus::LLMQType llmqType, const uint256& quor
 
 std::vector<CQuorumCPtr> CQuorumManager::ScanQuorums(Consensus::LLMQType llmqType, size_t maxCount)
 {
-    const CBlockIndex* pindex;
-    {
+    // the tip of the last notification avoids waiting for cs_main while blocks are validated
+    const CBlockIndex* pindex = tip;
+    if (!pindex) {
         LOCK(cs_main);
         pindex = chainActive.Tip();
     }
@@ -360,6 +363,18 @@ std::vector<CQuorumCPtr> CQuorumManager::ScanQuorums(Consensus::LLMQType llmqTyp
 
 CQuorumCPtr CQuorumManager::GetQuorum(Consensus::LLMQType llmqType, const uint256& quorumHash)
 {
+    // quorums which were built before don't need the block index lookup under cs_main
+    if (!HasQuorum(llmqType, quorumHash)) {
+        return nullptr;
+    }
+    {
+        LOCK(quorumsCacheCs);
+        auto it = quorumsCache.find(std::make_pair(llmqType, quorumHash));
+        if (it != quorumsCache.end()) {
+            return it->second;
+        }
+    }
+
     CBlockIndex* pindexQuorum;
     {
         LOCK(cs_main);
@@ -17,6 +17,8 @@
 #include "bls/bls.h"
 #include "bls/bls_worker.h"
 
+#include <atomic>
+
 namespace llmq
 {
 
@@ -89,6 +91,9 @@ private:
     std::map<std::pair<Consensus::LLMQType, uint256>, CQuorumPtr> quorumsCache;
     unordered_lru_cache<std::pair<Consensus::LLMQType, uint256>, std::vector<CQuorumCPtr>, StaticSaltedHasher, 32> scanQuorumsCache;
 
+    // the tip of the last UpdatedBlockTip(), so scanning from the tip doesn't wait for cs_main
+    std::atomic<const CBlockIndex*> tip{nullptr};
+
 public:
     CQuorumManager(CEvoDB& _evoDb, CBLSWorker& _blsWorker, CDKGSessionManager& _dkgManager);
 
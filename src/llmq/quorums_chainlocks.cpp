@@ -29,7 +29,7 @@ std::string CChainLockSig::ToString() const
 }
 
 CChainLocksHandler::CChainLocksHandler(CScheduler* _scheduler) :
-    scheduler(_scheduler)
+    scheduler(_scheduler, CScheduler::PRIORITY_HIGH, "chainlocks")
 {
 }
 
@@ -45,7 +45,7 @@ void CChainLocksHandler::Start()
             isChainlocksEnabled = CSporkManager::GetSporkManager()->IsFeatureEnabled(CSporkAction::featureChainlocks, chainActive.Tip());
     }
     quorumSigningManager->RegisterRecoveredSigsListener(this);
-    scheduler->scheduleEvery([&]() {
+    scheduler.scheduleEvery([&]() {
         CheckActiveState();
         EnforceBestChainLock();
         // regularly retry signing the current chaintip as it might have failed before due to missing ixlocks
@@ -158,7 +158,7 @@ void CChainLocksHandler::ProcessNewChainLock(NodeId from, const llmq::CChainLock
         bestChainLockBlockIndex = pindex;
     }
 
-    scheduler->scheduleFromNow([&]() {
+    scheduler.scheduleFromNow([&]() {
         CheckActiveState();
         EnforceBestChainLock();
     }, 0);
@@ -201,7 +201,7 @@ void CChainLocksHandler::UpdatedBlockTip(const CBlockIndex* pindexNew)
         return;
     }
     tryLockChainTipScheduled = true;
-    scheduler->scheduleFromNow([&]() {
+    scheduler.scheduleFromNow([&]() {
         CheckActiveState();
         EnforceBestChainLock();
         TrySignChainTip();
@@ -10,12 +10,12 @@
 
 #include "net.h"
 #include "chainparams.h"
+#include "scheduler.h"
 
 #include <atomic>
 #include <unordered_set>
 
 class CBlockIndex;
-class CScheduler;
 
 namespace llmq
 {
@@ -50,7 +50,8 @@ class CChainLocksHandler : public CRecoveredSigsListener
     static const int64_t WAIT_FOR_ISLOCK_TIMEOUT = 10 * 60;
 
 private:
-    CScheduler* scheduler;
+    // the scheduled tasks must not run in parallel, they are kept in their own domain on the scheduler
+    SingleThreadedSchedulerClient scheduler;
     CCriticalSection cs;
     bool tryLockChainTipScheduled{false};
     bool isChainLocksActive{false};
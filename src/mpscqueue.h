@@ -0,0 +1,97 @@
+#ifndef FIRO_MPSCQUEUE_H
+#define FIRO_MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/**
+ * Bounded lock-free queue for many producers and a single consumer.
+ *
+ * The slots form a ring, each of them has a sequence number telling whether it's free for the producer at a
+ * position or filled for the consumer. Producers claim positions with a CAS and never wait for each other,
+ * Push() fails instead of blocking when the ring is full.
+ */
+template <typename T>
+class CBoundedMPSCQueue
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit CBoundedMPSCQueue(size_t capacity) : slots(RoundUpToPowerOfTwo(capacity)), mask(slots.size() - 1), enqueuePos(0), dequeuePos(0)
+    {
+        for (size_t i = 0; i < slots.size(); i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    CBoundedMPSCQueue(const CBoundedMPSCQueue&) = delete;
+    CBoundedMPSCQueue& operator=(const CBoundedMPSCQueue&) = delete;
+
+    size_t Capacity() const { return mask + 1; }
+
+    // Can be called from any thread, returns false if the queue is full
+    bool Push(T&& value)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[pos & mask];
+            intptr_t diff = (intptr_t)slot->sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // the consumer hasn't taken the value pushed a round before
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = std::move(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // To be called from the consumer thread only, returns false if the queue is empty
+    bool Pop(T& value)
+    {
+        Slot& slot = slots[dequeuePos & mask];
+        if ((intptr_t)slot.sequence.load(std::memory_order_acquire) - (intptr_t)(dequeuePos + 1) < 0) {
+            return false;
+        }
+
+        value = std::move(slot.value);
+        slot.value = T();
+        slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+
+private:
+    static size_t RoundUpToPowerOfTwo(size_t n)
+    {
+        size_t size = 2;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask;
+
+    std::atomic<size_t> enqueuePos;
+    // only touched by the consumer
+    size_t dequeuePos;
+};
+
+#endif // FIRO_MPSCQUEUE_H
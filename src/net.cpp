@@ -52,6 +52,12 @@
 // We add a random period time (0 to 1 seconds) to feeler connections to prevent synchronization.
 #define FEELER_SLEEP_WINDOW 1
 
+// How long the socket handler waits for socket events, which is also how often it polls pnode->vSend with select()
+#define SELECT_TIMEOUT_MILLISECONDS 50
+
+// Maximum number of socket events handled after each epoll_wait()
+#define MAX_EPOLL_EVENTS 128
+
 #if !defined(HAVE_MSG_NOSIGNAL) && !defined(MSG_NOSIGNAL)
 #define MSG_NOSIGNAL 0
 #endif
@@ -413,7 +419,7 @@ CNode* CConnman::ConnectNode(CAddress addrConnect, const char *pszDest, bool fCo
     if (pszDest ? ConnectSocketByName(addrConnect, hSocket, pszDest, Params().GetDefaultPort(), nConnectTimeout, &proxyConnectionFailed) :
                   ConnectSocket(addrConnect, hSocket, nConnectTimeout, &proxyConnectionFailed))
     {
-        if (!IsSelectableSocket(hSocket)) {
+        if (socketEventsMode == SOCKETEVENTS_SELECT && !IsSelectableSocket(hSocket)) {
             LogPrintf("Cannot create connection: non-selectable socket created (fd >= FD_SETSIZE ?)\n");
             CloseSocket(hSocket);
             return NULL;
@@ -809,6 +815,39 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete
     return true;
 }
 
+void CNode::QueueReceivedMessages(bool fConcurrent, size_t nReceiveFloodSize, bool& fAdded, bool& fConcurrentAdded)
+{
+    fAdded = fConcurrentAdded = false;
+    LOCK(cs_vProcessMsg);
+    auto it(vRecvMsg.begin());
+    while (it != vRecvMsg.end() && it->complete()) {
+        auto next = std::next(it);
+        nProcessQueueSize += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
+        if (fConcurrent && IsConcurrentNetMessageType(it->hdr.GetCommand())) {
+            vProcessConcurrentMsg.splice(vProcessConcurrentMsg.end(), vRecvMsg, it);
+            fConcurrentAdded = true;
+        } else {
+            vProcessMsg.splice(vProcessMsg.end(), vRecvMsg, it);
+            fAdded = true;
+        }
+        it = next;
+    }
+    fPauseRecv = nProcessQueueSize > nReceiveFloodSize;
+}
+
+bool CNode::PopConcurrentMessage(std::list<CNetMessage>& msgs, size_t nReceiveFloodSize, bool& fResumeRecv, bool& fMoreWork)
+{
+    LOCK(cs_vProcessMsg);
+    if (vProcessConcurrentMsg.empty())
+        return false;
+    msgs.splice(msgs.begin(), vProcessConcurrentMsg, vProcessConcurrentMsg.begin());
+    nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
+    fResumeRecv = fPauseRecv && nProcessQueueSize <= nReceiveFloodSize;
+    fPauseRecv = nProcessQueueSize > nReceiveFloodSize;
+    fMoreWork = !vProcessConcurrentMsg.empty();
+    return true;
+}
+
 void CNode::SetSendVersion(int nVersionIn)
 {
     // Send version may only be changed in the version message, and
@@ -1224,7 +1263,7 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
         return;
     }
 
-    if (!IsSelectableSocket(hSocket))
+    if (socketEventsMode == SOCKETEVENTS_SELECT && !IsSelectableSocket(hSocket))
     {
         LogPrintf("connection from %s dropped: non-selectable socket\n", addr.ToString());
         CloseSocket(hSocket);
@@ -1270,6 +1309,7 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
+        RegisterEvents(pnode);
         // Dandelion: new inbound connection
         CNode::vDandelionInbound.push_back(pnode);
         CNode* pto = CNode::SelectFromDandelionDestinations();
@@ -1359,64 +1399,311 @@ void CNode::CloseDandelionConnections(const CNode* const pnode)
     }
 }
 
-void CConnman::ThreadSocketHandler()
+void CConnman::DisconnectNodes()
 {
-    unsigned int nPrevNodeCount = 0;
-    while (!interruptNet)
     {
-        //
-        // Disconnect nodes
-        //
+        LOCK(cs_vNodes);
+        // Disconnect unused nodes
+        std::vector<CNode*> vNodesCopy = vNodes;
+        BOOST_FOREACH(CNode* pnode, vNodesCopy)
         {
-            LOCK(cs_vNodes);
-            // Disconnect unused nodes
-            std::vector<CNode*> vNodesCopy = vNodes;
-            BOOST_FOREACH(CNode* pnode, vNodesCopy)
+            if (pnode->fDisconnect)
             {
-                if (pnode->fDisconnect)
-                {
-                    // remove from vNodes
-                    vNodes.erase(remove(vNodes.begin(), vNodes.end(), pnode), vNodes.end());
+                // remove from vNodes
+                vNodes.erase(remove(vNodes.begin(), vNodes.end(), pnode), vNodes.end());
 
-                    // release outbound grant (if any)
-                    pnode->grantOutbound.Release();
-                    pnode->grantMasternodeOutbound.Release();
+                // release outbound grant (if any)
+                pnode->grantOutbound.Release();
+                pnode->grantMasternodeOutbound.Release();
 
-                    // close socket and cleanup
-                    pnode->CloseSocketDisconnect();
+                // close socket and cleanup
+                pnode->CloseSocketDisconnect();
 
-                    // hold in disconnected pool until all refs are released
-                    pnode->Release();
-                    vNodesDisconnected.push_back(pnode);
-                }
+                // hold in disconnected pool until all refs are released
+                pnode->Release();
+                vNodesDisconnected.push_back(pnode);
             }
         }
+    }
+    {
+        // Delete disconnected nodes
+        std::list<CNode*> vNodesDisconnectedCopy = vNodesDisconnected;
+        BOOST_FOREACH(CNode* pnode, vNodesDisconnectedCopy)
         {
-            // Delete disconnected nodes
-            std::list<CNode*> vNodesDisconnectedCopy = vNodesDisconnected;
-            BOOST_FOREACH(CNode* pnode, vNodesDisconnectedCopy)
-            {
-                // wait until threads are done using it
-                if (pnode->GetRefCount() <= 0) {
-                    bool fDelete = false;
-                    {
-                        TRY_LOCK(pnode->cs_inventory, lockInv);
-                        if (lockInv) {
-                            TRY_LOCK(pnode->cs_vSend, lockSend);
-                            if (lockSend) {
-                                fDelete = true;
-                            }
+            // wait until threads are done using it
+            if (pnode->GetRefCount() <= 0) {
+                bool fDelete = false;
+                {
+                    TRY_LOCK(pnode->cs_inventory, lockInv);
+                    if (lockInv) {
+                        TRY_LOCK(pnode->cs_vSend, lockSend);
+                        if (lockSend) {
+                            fDelete = true;
                         }
                     }
-                    if (fDelete) {
-                        // Dandelion: close connection
-                        CNode::CloseDandelionConnections(pnode);
-                        vNodesDisconnected.remove(pnode);
-                        DeleteNode(pnode);
+                }
+                if (fDelete) {
+                    // Dandelion: close connection
+                    CNode::CloseDandelionConnections(pnode);
+                    vNodesDisconnected.remove(pnode);
+#ifdef USE_EPOLL
+                    setReceivableNodes.erase(pnode);
+                    {
+                        LOCK(cs_sendableNodes);
+                        setSendableNodes.erase(pnode);
                     }
+#endif
+                    DeleteNode(pnode);
                 }
             }
         }
+    }
+}
+
+bool CConnman::ReceiveFromNode(CNode *pnode)
+{
+    // typical socket buffer is 8K-64K
+    char pchBuf[0x10000];
+    int nBytes = 0;
+    {
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket == INVALID_SOCKET)
+            return false;
+        nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+    }
+    if (nBytes > 0)
+    {
+        bool notify = false;
+        if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
+            pnode->CloseSocketDisconnect();
+        RecordBytesRecv(nBytes);
+        if (notify) {
+            // the version handshake is processed in order by the message handler thread
+            bool fAdded = false, fConcurrentAdded = false;
+            pnode->QueueReceivedMessages(nMsgHandlerThreads > 0 && pnode->fSuccessfullyConnected, nReceiveFloodSize, fAdded, fConcurrentAdded);
+            if (fAdded)
+                WakeMessageHandler();
+            if (fConcurrentAdded)
+                WakeConcurrentMessageHandler();
+        }
+        return true;
+    }
+    else if (nBytes == 0)
+    {
+        // socket closed gracefully
+        if (!pnode->fDisconnect)
+            LogPrint("net", "socket closed\n");
+        pnode->CloseSocketDisconnect();
+    }
+    else if (nBytes < 0)
+    {
+        // error
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
+        {
+            if (!pnode->fDisconnect)
+                LogPrintf("socket recv error %s\n", NetworkErrorString(nErr));
+            pnode->CloseSocketDisconnect();
+        }
+    }
+    return false;
+}
+
+void CConnman::InactivityCheck(CNode *pnode)
+{
+    int64_t nTime = GetSystemTimeInSeconds();
+    if (nTime - pnode->nTimeConnected > 60)
+    {
+        if (pnode->nLastRecv == 0 || pnode->nLastSend == 0)
+        {
+            LogPrint("net", "socket no message in first 60 seconds, %d %d from %d\n", pnode->nLastRecv != 0, pnode->nLastSend != 0, pnode->id);
+            pnode->fDisconnect = true;
+        }
+        else if (nTime - pnode->nLastSend > TIMEOUT_INTERVAL)
+        {
+            LogPrintf("socket sending timeout: %is\n", nTime - pnode->nLastSend);
+            pnode->fDisconnect = true;
+        }
+        else if (nTime - pnode->nLastRecv > (pnode->nVersion > BIP0031_VERSION ? TIMEOUT_INTERVAL : 90*60))
+        {
+            LogPrintf("socket receive timeout: %is\n", nTime - pnode->nLastRecv);
+            pnode->fDisconnect = true;
+        }
+        else if (pnode->nPingNonceSent && pnode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
+        {
+            LogPrintf("ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pnode->nPingUsecStart));
+            pnode->fDisconnect = true;
+        }
+        else if (!pnode->fSuccessfullyConnected)
+        {
+            LogPrintf("version handshake timeout from %d\n", pnode->id);
+            pnode->fDisconnect = true;
+        }
+    }
+}
+
+void CConnman::RegisterEvents(CNode *pnode)
+{
+#ifdef USE_EPOLL
+    if (socketEventsMode != SOCKETEVENTS_EPOLL || epollfd == -1)
+        return;
+
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket == INVALID_SOCKET)
+        return;
+
+    // Edge triggered, the registration lasts until the socket is closed. New messages
+    // are sent by the socket handler after PushMessage wakes it, sends which could not
+    // complete are retried on the EPOLLOUT event once the socket is writable again.
+    epoll_event e;
+    e.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    e.data.ptr = pnode;
+    if (epoll_ctl(epollfd, EPOLL_CTL_ADD, pnode->hSocket, &e) != 0) {
+        LogPrintf("Failed to register events for peer=%d: %s\n", pnode->id, NetworkErrorString(WSAGetLastError()));
+        pnode->fDisconnect = true;
+    }
+#endif
+}
+
+void CConnman::WakeSocketHandler()
+{
+#ifdef USE_EPOLL
+    if (wakeupPipe[1] == -1)
+        return;
+
+    char buf = 0;
+    if (write(wakeupPipe[1], &buf, sizeof(buf)) != 1 && errno != EAGAIN) {
+        LogPrint("net", "write to wakeup pipe failed: %s\n", NetworkErrorString(errno));
+    }
+#endif
+}
+
+#ifdef USE_EPOLL
+void CConnman::SocketHandlerEpoll(int64_t& nLastInactivityCheck)
+{
+    // Nodes which have data left from an earlier event or new messages to send are served
+    // without waiting, as their sockets may not report another edge.
+    bool fPending = false;
+    for (CNode* pnode : setReceivableNodes) {
+        if (!pnode->fPauseRecv) {
+            fPending = true;
+            break;
+        }
+    }
+    {
+        LOCK(cs_sendableNodes);
+        if (!setSendableNodes.empty())
+            fPending = true;
+    }
+
+    epoll_event events[MAX_EPOLL_EVENTS];
+    int nEvents = epoll_wait(epollfd, events, MAX_EPOLL_EVENTS, fPending ? 0 : SELECT_TIMEOUT_MILLISECONDS);
+    if (interruptNet)
+        return;
+
+    if (nEvents < 0) {
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEINTR) {
+            LogPrintf("socket epoll_wait error %s\n", NetworkErrorString(nErr));
+            if (!interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS)))
+                return;
+        }
+        nEvents = 0;
+    }
+
+    // Nodes with new messages are tried first, their sockets may not report EPOLLOUT again
+    std::set<CNode*> setSendNodes;
+    {
+        LOCK(cs_sendableNodes);
+        setSendNodes.swap(setSendableNodes);
+    }
+
+    for (int i = 0; i < nEvents; i++) {
+        void* ptr = events[i].data.ptr;
+
+        if (ptr == nullptr) {
+            char buf[128];
+            while (read(wakeupPipe[0], buf, sizeof(buf)) > 0) {}
+            continue;
+        }
+
+        const ListenSocket* pListenSocket = nullptr;
+        for (const ListenSocket& hListenSocket : vhListenSocket) {
+            if (&hListenSocket == ptr) {
+                pListenSocket = &hListenSocket;
+                break;
+            }
+        }
+        if (pListenSocket) {
+            AcceptConnection(*pListenSocket);
+            continue;
+        }
+
+        // Nodes are only deleted by this thread after their sockets were closed,
+        // so nodes of reported events are still alive
+        CNode* pnode = static_cast<CNode*>(ptr);
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            setReceivableNodes.insert(pnode);
+        if (events[i].events & EPOLLOUT)
+            setSendNodes.insert(pnode);
+    }
+
+    //
+    // Send
+    //
+    for (CNode* pnode : setSendNodes) {
+        LOCK(pnode->cs_vSend);
+        if (pnode->vSendMsg.empty())
+            continue;
+        size_t nBytes = SocketSendData(pnode);
+        if (nBytes) {
+            RecordBytesSent(nBytes);
+        }
+    }
+
+    //
+    // Receive, once for each node in turn like select() does
+    //
+    for (auto it = setReceivableNodes.begin(); it != setReceivableNodes.end();) {
+        if (interruptNet)
+            return;
+
+        CNode* pnode = *it;
+        if (pnode->fPauseRecv) {
+            ++it;
+        } else if (ReceiveFromNode(pnode)) {
+            ++it;
+        } else {
+            it = setReceivableNodes.erase(it);
+        }
+    }
+
+    //
+    // Inactivity checking, not more often than once a second instead of after every event
+    //
+    int64_t nTime = GetSystemTimeInSeconds();
+    if (nTime != nLastInactivityCheck) {
+        nLastInactivityCheck = nTime;
+        LOCK(cs_vNodes);
+        BOOST_FOREACH(CNode* pnode, vNodes)
+            InactivityCheck(pnode);
+    }
+}
+#endif
+
+void CConnman::ThreadSocketHandler()
+{
+    unsigned int nPrevNodeCount = 0;
+#ifdef USE_EPOLL
+    int64_t nLastInactivityCheck = 0;
+#endif
+    while (!interruptNet)
+    {
+        //
+        // Disconnect nodes
+        //
+        DisconnectNodes();
+
         size_t vNodesSize;
         {
             LOCK(cs_vNodes);
@@ -1428,12 +1715,19 @@ void CConnman::ThreadSocketHandler()
                 clientInterface->NotifyNumConnectionsChanged(nPrevNodeCount);
         }
 
+#ifdef USE_EPOLL
+        if (socketEventsMode == SOCKETEVENTS_EPOLL) {
+            SocketHandlerEpoll(nLastInactivityCheck);
+            continue;
+        }
+#endif
+
         //
         // Find which sockets have data to receive
         //
         struct timeval timeout;
         timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000; // frequency to poll pnode->vSend
+        timeout.tv_usec = SELECT_TIMEOUT_MILLISECONDS * 1000; // frequency to poll pnode->vSend
 
         fd_set fdsetRecv;
         fd_set fdsetSend;
@@ -1552,60 +1846,7 @@ void CConnman::ThreadSocketHandler()
             }
             if (recvSet || errorSet)
             {
-                {
-                    {
-                        // typical socket buffer is 8K-64K
-                        char pchBuf[0x10000];
-                        int nBytes = 0;
-                        {
-                            LOCK(pnode->cs_hSocket);
-                            if (pnode->hSocket == INVALID_SOCKET)
-                                continue;
-                            nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-                        }
-                        if (nBytes > 0)
-                        {
-                            bool notify = false;
-                            if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
-                                pnode->CloseSocketDisconnect();
-                            RecordBytesRecv(nBytes);
-                            if (notify) {
-                                size_t nSizeAdded = 0;
-                                auto it(pnode->vRecvMsg.begin());
-                                for (; it != pnode->vRecvMsg.end(); ++it) {
-                                    if (!it->complete())
-                                        break;
-                                    nSizeAdded += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
-                                }
-                                {
-                                    LOCK(pnode->cs_vProcessMsg);
-                                    pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
-                                    pnode->nProcessQueueSize += nSizeAdded;
-                                    pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
-                                }
-                                WakeMessageHandler();
-                            }
-                        }
-                        else if (nBytes == 0)
-                        {
-                            // socket closed gracefully
-                            if (!pnode->fDisconnect)
-                                LogPrint("net", "socket closed\n");
-                            pnode->CloseSocketDisconnect();
-                        }
-                        else if (nBytes < 0)
-                        {
-                            // error
-                            int nErr = WSAGetLastError();
-                            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
-                            {
-                                if (!pnode->fDisconnect)
-                                    LogPrintf("socket recv error %s\n", NetworkErrorString(nErr));
-                                pnode->CloseSocketDisconnect();
-                            }
-                        }
-                    }
-                }
+                ReceiveFromNode(pnode);
             }
 
             //
@@ -1623,35 +1864,7 @@ void CConnman::ThreadSocketHandler()
             //
             // Inactivity checking
             //
-            int64_t nTime = GetSystemTimeInSeconds();
-            if (nTime - pnode->nTimeConnected > 60)
-            {
-                if (pnode->nLastRecv == 0 || pnode->nLastSend == 0)
-                {
-                    LogPrint("net", "socket no message in first 60 seconds, %d %d from %d\n", pnode->nLastRecv != 0, pnode->nLastSend != 0, pnode->id);
-                    pnode->fDisconnect = true;
-                }
-                else if (nTime - pnode->nLastSend > TIMEOUT_INTERVAL)
-                {
-                    LogPrintf("socket sending timeout: %is\n", nTime - pnode->nLastSend);
-                    pnode->fDisconnect = true;
-                }
-                else if (nTime - pnode->nLastRecv > (pnode->nVersion > BIP0031_VERSION ? TIMEOUT_INTERVAL : 90*60))
-                {
-                    LogPrintf("socket receive timeout: %is\n", nTime - pnode->nLastRecv);
-                    pnode->fDisconnect = true;
-                }
-                else if (pnode->nPingNonceSent && pnode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
-                {
-                    LogPrintf("ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pnode->nPingUsecStart));
-                    pnode->fDisconnect = true;
-                }
-                else if (!pnode->fSuccessfullyConnected)
-                {
-                    LogPrintf("version handshake timeout from %d\n", pnode->id);
-                    pnode->fDisconnect = true;
-                }
-            }
+            InactivityCheck(pnode);
         }
         {
             LOCK(cs_vNodes);
@@ -1670,6 +1883,15 @@ void CConnman::WakeMessageHandler()
     condMsgProc.notify_one();
 }
 
+void CConnman::WakeConcurrentMessageHandler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutexConcurrentMsgProc);
+        fConcurrentMsgProcWake = true;
+    }
+    condConcurrentMsgProc.notify_one();
+}
+
 
 
 
@@ -2323,6 +2545,7 @@ bool CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
+        RegisterEvents(pnode);
     }
 
     return true;
@@ -2381,6 +2604,50 @@ void CConnman::ThreadMessageHandler()
     }
 }
 
+void CConnman::ThreadConcurrentMessageHandler()
+{
+    while (!flagInterruptMsgProc)
+    {
+        std::vector<CNode*> vNodesCopy;
+        {
+            LOCK(cs_vNodes);
+            vNodesCopy = vNodes;
+            BOOST_FOREACH(CNode* pnode, vNodesCopy) {
+                pnode->AddRef();
+            }
+        }
+
+        bool fMoreWork = false;
+
+        BOOST_FOREACH(CNode* pnode, vNodesCopy)
+        {
+            if (pnode->fDisconnect)
+                continue;
+
+            // another thread is processing the messages of this node
+            TRY_LOCK(pnode->cs_concurrentProcessing, lockProcessing);
+            if (!lockProcessing)
+                continue;
+
+            fMoreWork |= GetNodeSignals().ProcessConcurrentMessages(pnode, *this, flagInterruptMsgProc);
+            if (flagInterruptMsgProc)
+                return;
+        }
+
+        {
+            LOCK(cs_vNodes);
+            BOOST_FOREACH(CNode* pnode, vNodesCopy)
+                pnode->Release();
+        }
+
+        std::unique_lock<std::mutex> lock(mutexConcurrentMsgProc);
+        if (!fMoreWork) {
+            condConcurrentMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this] { return fConcurrentMsgProcWake; });
+        }
+        fConcurrentMsgProcWake = false;
+    }
+}
+
 
 
 
@@ -2652,6 +2919,13 @@ CConnman::CConnman(uint64_t nSeed0In, uint64_t nSeed1In) : nSeed0(nSeed0In), nSe
     nBestHeight = 0;
     clientInterface = NULL;
     flagInterruptMsgProc = false;
+    nMsgHandlerThreads = 0;
+    fConcurrentMsgProcWake = false;
+    socketEventsMode = SOCKETEVENTS_SELECT;
+#ifdef USE_EPOLL
+    epollfd = -1;
+    wakeupPipe[0] = wakeupPipe[1] = -1;
+#endif
 }
 
 NodeId CConnman::GetNewNodeId()
@@ -2681,6 +2955,9 @@ bool CConnman::Start(CScheduler& scheduler, std::string& strNodeError, Options c
 
     SetBestHeight(connOptions.nBestHeight);
 
+    socketEventsMode = connOptions.socketEventsMode;
+    nMsgHandlerThreads = connOptions.nMsgHandlerThreads;
+
     clientInterface = connOptions.uiInterface;
     if (clientInterface)
         clientInterface->InitMessage(_("Loading addresses..."));
@@ -2743,6 +3020,41 @@ bool CConnman::Start(CScheduler& scheduler, std::string& strNodeError, Options c
         std::unique_lock<std::mutex> lock(mutexMsgProc);
         fMsgProcWake = false;
     }
+    {
+        std::unique_lock<std::mutex> lock(mutexConcurrentMsgProc);
+        fConcurrentMsgProcWake = false;
+    }
+
+#ifdef USE_EPOLL
+    if (socketEventsMode == SOCKETEVENTS_EPOLL) {
+        epollfd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollfd == -1) {
+            strNodeError = strprintf("Failed to create epoll instance: %s", NetworkErrorString(WSAGetLastError()));
+            return false;
+        }
+
+        // listen sockets and the wakeup pipe are level triggered, they are only read once for each event
+        epoll_event e;
+        e.events = EPOLLIN;
+        BOOST_FOREACH(ListenSocket& hListenSocket, vhListenSocket) {
+            e.data.ptr = &hListenSocket;
+            if (epoll_ctl(epollfd, EPOLL_CTL_ADD, hListenSocket.socket, &e) != 0) {
+                strNodeError = strprintf("Failed to register listen socket: %s", NetworkErrorString(WSAGetLastError()));
+                return false;
+            }
+        }
+
+        if (pipe2(wakeupPipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+            strNodeError = strprintf("Failed to create wakeup pipe: %s", NetworkErrorString(WSAGetLastError()));
+            return false;
+        }
+        e.data.ptr = nullptr;
+        if (epoll_ctl(epollfd, EPOLL_CTL_ADD, wakeupPipe[0], &e) != 0) {
+            strNodeError = strprintf("Failed to register wakeup pipe: %s", NetworkErrorString(WSAGetLastError()));
+            return false;
+        }
+    }
+#endif
 
     // Send and receive from sockets, accept connections
     threadSocketHandler = std::thread(&TraceThread<std::function<void()> >, "net", std::function<void()>(std::bind(&CConnman::ThreadSocketHandler, this)));
@@ -2764,12 +3076,15 @@ bool CConnman::Start(CScheduler& scheduler, std::string& strNodeError, Options c
 
     // Process messages
     threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
+    for (int i = 0; i < nMsgHandlerThreads; i++) {
+        threadConcurrentMessageHandlers.emplace_back(&TraceThread<std::function<void()> >, "msgconc", std::function<void()>(std::bind(&CConnman::ThreadConcurrentMessageHandler, this)));
+    }
 
     // Dandelion shuffle
     threadDandelionShuffle = std::thread(TraceThread<std::function<void()> >, "dandelion", std::function<void()>(std::bind(&CConnman::ThreadDandelionShuffle, this)));
 
     // Dump network addresses
-    scheduler.scheduleEvery(boost::bind(&CConnman::DumpData, this), DUMP_ADDRESSES_INTERVAL);
+    scheduler.scheduleEvery(boost::bind(&CConnman::DumpData, this), DUMP_ADDRESSES_INTERVAL, CScheduler::PRIORITY_LOW, "dumpdata");
 
     return true;
 }
@@ -2796,8 +3111,14 @@ void CConnman::Interrupt()
         flagInterruptMsgProc = true;
     }
     condMsgProc.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(mutexConcurrentMsgProc);
+        fConcurrentMsgProcWake = true;
+    }
+    condConcurrentMsgProc.notify_all();
 
     interruptNet();
+    WakeSocketHandler();
     InterruptSocks5(true);
 
     if (semOutbound) {
@@ -2824,6 +3145,11 @@ void CConnman::Stop()
 {
     if (threadMessageHandler.joinable())
         threadMessageHandler.join();
+    for (std::thread& thread : threadConcurrentMessageHandlers) {
+        if (thread.joinable())
+            thread.join();
+    }
+    threadConcurrentMessageHandlers.clear();
     if (threadOpenMasternodeConnections.joinable())
         threadOpenMasternodeConnections.join();
     if (threadOpenConnections.joinable())
@@ -2861,6 +3187,21 @@ void CConnman::Stop()
     vNodes.clear();
     vNodesDisconnected.clear();
     vhListenSocket.clear();
+#ifdef USE_EPOLL
+    setReceivableNodes.clear();
+    {
+        LOCK(cs_sendableNodes);
+        setSendableNodes.clear();
+    }
+    if (epollfd != -1)
+        close(epollfd);
+    epollfd = -1;
+    for (int& fd : wakeupPipe) {
+        if (fd != -1)
+            close(fd);
+        fd = -1;
+    }
+#endif
     delete semOutbound;
     semOutbound = NULL;
     delete semAddnode;
@@ -3546,6 +3887,21 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg, bool allowOpti
     }
     if (nBytesSent)
         RecordBytesSent(nBytesSent);
+
+#ifdef USE_EPOLL
+    // An edge triggered socket which stays writable reports no new EPOLLOUT event,
+    // so the socket handler is told about the queued message
+    if (socketEventsMode == SOCKETEVENTS_EPOLL) {
+        bool fWake = false;
+        {
+            LOCK2(pnode->cs_vSend, cs_sendableNodes);
+            if (!pnode->vSendMsg.empty())
+                fWake = setSendableNodes.insert(pnode).second;
+        }
+        if (fWake)
+            WakeSocketHandler();
+    }
+#endif
 }
 
 bool CConnman::ForNode(const CService& addr, std::function<bool(const CNode* pnode)> cond, std::function<bool(CNode* pnode)> func)
@@ -114,6 +114,23 @@ static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
 
 static const ServiceFlags REQUIRED_SERVICES = NODE_NETWORK;
 
+/** How the socket handler waits for socket events, see -socketevents */
+enum SocketEventsMode {
+    SOCKETEVENTS_SELECT = 0,
+    SOCKETEVENTS_EPOLL = 1,
+};
+
+#ifdef USE_EPOLL
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_EPOLL;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_SELECT;
+#endif
+
+/** -msghandlerthreads default, the number of threads processing the messages of IsConcurrentNetMessageType() */
+static const int DEFAULT_MSGHANDLER_THREADS = 2;
+/** Maximum number of concurrent message handler threads */
+static const int MAX_MSGHANDLER_THREADS = 16;
+
 // NOTE: When adjusting this, update rpcnet:setban's help ("24h")
 static const unsigned int DEFAULT_MISBEHAVING_BANTIME = 60 * 60 * 24;  // Default 24-hour ban
 unsigned int ReceiveFloodSize();
@@ -172,6 +189,8 @@ public:
         unsigned int nReceiveFloodSize = 0;
         uint64_t nMaxOutboundTimeframe = 0;
         uint64_t nMaxOutboundLimit = 0;
+        SocketEventsMode socketEventsMode = SOCKETEVENTS_SELECT;
+        int nMsgHandlerThreads = 0;
     };
     CConnman(uint64_t seed0, uint64_t seed1);
     ~CConnman();
@@ -416,6 +435,9 @@ public:
     unsigned int GetReceiveFloodSize() const;
 
     void WakeMessageHandler();
+    void WakeConcurrentMessageHandler();
+    /** Wake the socket handler, e.g. when a node may receive again */
+    void WakeSocketHandler();
 private:
     struct ListenSocket {
         SOCKET socket;
@@ -428,7 +450,17 @@ private:
     void ProcessOneShot();
     void ThreadOpenConnections();
     void ThreadMessageHandler();
+    void ThreadConcurrentMessageHandler();
     void AcceptConnection(const ListenSocket& hListenSocket);
+    void DisconnectNodes();
+    /** Receive once from the socket of a node, returns false if nothing was received */
+    bool ReceiveFromNode(CNode *pnode);
+    void InactivityCheck(CNode *pnode);
+    /** Register the socket of a node added to vNodes for socket events */
+    void RegisterEvents(CNode *pnode);
+#ifdef USE_EPOLL
+    void SocketHandlerEpoll(int64_t& nLastInactivityCheck);
+#endif
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
     void ThreadOpenMasternodeConnections();
@@ -538,14 +570,33 @@ private:
     std::mutex mutexMsgProc;
     std::atomic<bool> flagInterruptMsgProc;
 
+    /** Messages of IsConcurrentNetMessageType() are queued separately for these threads if there are any */
+    int nMsgHandlerThreads;
+    bool fConcurrentMsgProcWake;
+    std::condition_variable condConcurrentMsgProc;
+    std::mutex mutexConcurrentMsgProc;
+
     CThreadInterrupt interruptNet;
 
+    SocketEventsMode socketEventsMode;
+#ifdef USE_EPOLL
+    int epollfd;
+    /** Pipe registered with epoll to wake the socket handler */
+    int wakeupPipe[2];
+    /** Nodes which may have data left to receive since their last EPOLLIN event, only used by the socket handler */
+    std::set<CNode*> setReceivableNodes;
+    /** Nodes with messages queued by PushMessage which the socket handler hasn't tried to send yet */
+    std::set<CNode*> setSendableNodes;
+    CCriticalSection cs_sendableNodes;
+#endif
+
     std::thread threadDNSAddressSeed;
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
     std::thread threadOpenMasternodeConnections;
     std::thread threadMessageHandler;
+    std::vector<std::thread> threadConcurrentMessageHandlers;
     std::thread threadDandelionShuffle;
 };
 extern std::unique_ptr<CConnman> g_connman;
@@ -574,6 +625,7 @@ struct CNodeSignals
 {
     boost::signals2::signal<bool (CNode*, CConnman&, std::atomic<bool>&), CombinerAll> ProcessMessages;
     boost::signals2::signal<bool (CNode*, CConnman&, std::atomic<bool>&), CombinerAll> SendMessages;
+    boost::signals2::signal<bool (CNode*, CConnman&, std::atomic<bool>&), CombinerAll> ProcessConcurrentMessages;
     boost::signals2::signal<void (CNode*, CConnman&)> InitializeNode;
     boost::signals2::signal<void (NodeId, bool&)> FinalizeNode;
 };
@@ -723,7 +775,11 @@ public:
 
     CCriticalSection cs_vProcessMsg;
     std::list<CNetMessage> vProcessMsg;
-    size_t nProcessQueueSize;
+    std::list<CNetMessage> vProcessConcurrentMsg;
+    size_t nProcessQueueSize; // total size of vProcessMsg and vProcessConcurrentMsg
+
+    // held by the concurrent message handler thread processing vProcessConcurrentMsg, so the messages keep their order
+    CCriticalSection cs_concurrentProcessing;
 
     CCriticalSection cs_sendProcessing;
 
@@ -909,6 +965,11 @@ public:
     }
 
     bool ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete);
+    /** Moves the complete received messages to vProcessMsg, or to vProcessConcurrentMsg if fConcurrent and they are
+     *  IsConcurrentNetMessageType(), and pauses receiving if the queues exceed nReceiveFloodSize */
+    void QueueReceivedMessages(bool fConcurrent, size_t nReceiveFloodSize, bool& fAdded, bool& fConcurrentAdded);
+    /** Moves the first message of vProcessConcurrentMsg to msgs, returns false if there is none */
+    bool PopConcurrentMessage(std::list<CNetMessage>& msgs, size_t nReceiveFloodSize, bool& fResumeRecv, bool& fMoreWork);
 
     void SetRecvVersion(int nVersionIn)
     {
@@ -597,6 +597,7 @@ void RegisterNodeSignals(CNodeSignals& nodeSignals)
 {
     nodeSignals.ProcessMessages.connect(&ProcessMessages);
     nodeSignals.SendMessages.connect(&SendMessages);
+    nodeSignals.ProcessConcurrentMessages.connect(&ProcessConcurrentMessages);
     nodeSignals.InitializeNode.connect(&InitializeNode);
     nodeSignals.FinalizeNode.connect(&FinalizeNode);
 }
@@ -605,6 +606,7 @@ void UnregisterNodeSignals(CNodeSignals& nodeSignals)
 {
     nodeSignals.ProcessMessages.disconnect(&ProcessMessages);
     nodeSignals.SendMessages.disconnect(&SendMessages);
+    nodeSignals.ProcessConcurrentMessages.disconnect(&ProcessConcurrentMessages);
     nodeSignals.InitializeNode.disconnect(&InitializeNode);
     nodeSignals.FinalizeNode.disconnect(&FinalizeNode);
 }
@@ -1017,6 +1019,36 @@ static void RelayAddress(const CAddress& addr, bool fReachable, CConnman& connma
     connman.ForEachNodeThen(std::move(sortfunc), std::move(pushfunc));
 }
 
+// Sends a block of the active chain the way it is stored in the block file, which saves deserializing it
+// and serializing it again for every peer downloading it. Returns false if the block has to be loaded and
+// sent the usual way.
+static bool SendRawBlock(CNode* pfrom, const CInv& inv, const CBlockIndex* pindex, const Consensus::Params& consensusParams, CConnman& connman)
+{
+    AssertLockHeld(cs_main);
+
+    bool fFullBlock = inv.type == MSG_BLOCK || inv.type == MSG_WITNESS_BLOCK ||
+        (inv.type == MSG_CMPCT_BLOCK && !(CanDirectFetch(consensusParams) && pindex->nHeight >= chainActive.Height() - MAX_CMPCTBLOCK_DEPTH));
+    if (!fFullBlock || !chainActive.Contains(pindex))
+        return false;
+
+    // Stored blocks have no witness data as long as witness is disabled, so they are the same with and without it
+    if (IsWitnessEnabled(pindex->pprev, consensusParams))
+        return false;
+
+    // MTP data may have to be stripped before the block is sent
+    CBlockHeader header = pindex->GetBlockHeader();
+    if (!header.IsProgPow() && header.IsMTP() && GetTime() >= consensusParams.nMTPStripDataTime)
+        return false;
+
+    CSerializedNetMsg msg;
+    msg.command = NetMsgType::BLOCK;
+    if (!ReadRawBlockFromDisk(msg.data, pindex, Params().MessageStart()))
+        return false;
+
+    connman.PushMessage(pfrom, std::move(msg));
+    return true;
+}
+
 void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParams, CConnman& connman, const std::atomic<bool>& interruptMsgProc)
 {
     std::deque<CInv>::iterator it = pfrom->vRecvGetData.begin();
@@ -1087,25 +1119,32 @@ void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParam
                 // it's available before trying to send.
                 if (send && (mi->second->nStatus & BLOCK_HAVE_DATA))
                 {
+                    bool fRawBlockSent = SendRawBlock(pfrom, inv, mi->second, consensusParams, connman);
+
                     // Send block from disk
                     CBlock block;
-                    if (!ReadBlockFromDisk(block, (*mi).second, consensusParams))
-                        assert(!"cannot load block from disk");
-                    // Strip MTP data if past specific point of time
-                    if (!block.IsProgPow() && block.IsMTP() && GetTime() >= consensusParams.nMTPStripDataTime) {
-                        if (pfrom->nVersion >= MTPDATA_STRIPPED_VERSION) {
-                            if (block.mtpHashData)
-                                block.mtpHashData->StripMTPData();
-                        }
-                        else {
-                            // node is not ready for a block with stripped MTP data. Skip the block if MTP
-                            // data has already been stripped locally
-                            if (!block.mtpHashData || block.mtpHashData->IsMTPDataStripped())
-                                continue;
+                    if (!fRawBlockSent) {
+                        if (!ReadBlockFromDisk(block, (*mi).second, consensusParams))
+                            assert(!"cannot load block from disk");
+                        // Strip MTP data if past specific point of time
+                        if (!block.IsProgPow() && block.IsMTP() && GetTime() >= consensusParams.nMTPStripDataTime) {
+                            if (pfrom->nVersion >= MTPDATA_STRIPPED_VERSION) {
+                                if (block.mtpHashData)
+                                    block.mtpHashData->StripMTPData();
+                            }
+                            else {
+                                // node is not ready for a block with stripped MTP data. Skip the block if MTP
+                                // data has already been stripped locally
+                                if (!block.mtpHashData || block.mtpHashData->IsMTPDataStripped())
+                                    continue;
+                            }
                         }
                     }
 
-                    if (inv.type == MSG_BLOCK)
+                    if (fRawBlockSent) {
+                        // already sent as it is stored
+                    }
+                    else if (inv.type == MSG_BLOCK)
                         connman.PushMessage(pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, block));
                     else if (inv.type == MSG_WITNESS_BLOCK)
                         connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, block));
@@ -1333,6 +1372,14 @@ inline void static SendBlockTransactions(const CBlock& block, const BlockTransac
     connman.PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::BLOCKTXN, resp));
 }
 
+// Processes the messages of IsConcurrentNetMessageType(), which may run on any of the concurrent message handler
+// threads while the message handler thread is busy with other peers. Must not take cs_main except to punish the
+// peer, and must not rely on the order relative to the serially processed messages of the peer.
+static void ProcessConcurrentMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, CConnman& connman)
+{
+    llmq::quorumSigSharesManager->ProcessMessage(pfrom, strCommand, vRecv, connman);
+}
+
 bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, const CChainParams& chainparams, CConnman& connman, const std::atomic<bool>& interruptMsgProc)
 {
     LogPrint("net", "received: %s (%u bytes) peer=%d\n", SanitizeString(strCommand), vRecv.size(), pfrom->id);
@@ -2882,6 +2929,12 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
     }
 
 
+    else if (IsConcurrentNetMessageType(strCommand))
+    {
+        // processed here until the handshake is complete or if there are no concurrent message handler threads
+        ProcessConcurrentMessage(pfrom, strCommand, vRecv, connman);
+    }
+
     else if (strCommand == NetMsgType::FILTERLOAD)
     {
         CBloomFilter filter;
@@ -3045,6 +3098,38 @@ static bool SendRejectsAndCheckIfBanned(CNode* pnode, CConnman& connman)
     return false;
 }
 
+static bool CheckMessageHeader(CNode* pfrom, CNetMessage& msg, const CChainParams& chainparams)
+{
+    msg.SetVersion(pfrom->GetRecvVersion());
+    // Scan for message start
+    if (memcmp(msg.hdr.pchMessageStart, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE) != 0) {
+        LogPrintf("PROCESSMESSAGE: INVALID MESSAGESTART %s peer=%d\n", SanitizeString(msg.hdr.GetCommand()), pfrom->id);
+        pfrom->fDisconnect = true;
+        return false;
+    }
+
+    // Read header
+    CMessageHeader& hdr = msg.hdr;
+    if (!hdr.IsValid(chainparams.MessageStart()))
+    {
+        LogPrintf("PROCESSMESSAGE: ERRORS IN HEADER %s peer=%d\n", SanitizeString(hdr.GetCommand()), pfrom->id);
+        return false;
+    }
+
+    // Checksum
+    const uint256& hash = msg.GetMessageHash();
+    if (memcmp(hash.begin(), hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) != 0)
+    {
+        LogPrintf("%s(%s, %u bytes): CHECKSUM ERROR expected %s was %s\n", __func__,
+           SanitizeString(hdr.GetCommand()), hdr.nMessageSize,
+           HexStr(hash.begin(), hash.begin()+CMessageHeader::CHECKSUM_SIZE),
+           HexStr(hdr.pchChecksum, hdr.pchChecksum+CMessageHeader::CHECKSUM_SIZE));
+        return false;
+    }
+
+    return true;
+}
+
 bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& interruptMsgProc)
 {
     const CChainParams& chainparams = Params();
@@ -3072,6 +3157,7 @@ bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& i
             return false;
 
         std::list<CNetMessage> msgs;
+        bool fResumeRecv;
         {
             LOCK(pfrom->cs_vProcessMsg);
             if (pfrom->vProcessMsg.empty())
@@ -3079,42 +3165,25 @@ bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& i
             // Just take one message
             msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
             pfrom->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
+            fResumeRecv = pfrom->fPauseRecv && pfrom->nProcessQueueSize <= connman.GetReceiveFloodSize();
             pfrom->fPauseRecv = pfrom->nProcessQueueSize > connman.GetReceiveFloodSize();
             fMoreWork = !pfrom->vProcessMsg.empty();
         }
+        // data left on the socket is not reported again, so let the socket handler know
+        if (fResumeRecv)
+            connman.WakeSocketHandler();
         CNetMessage& msg(msgs.front());
 
-        msg.SetVersion(pfrom->GetRecvVersion());
-        // Scan for message start
-        if (memcmp(msg.hdr.pchMessageStart, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE) != 0) {
-            LogPrintf("PROCESSMESSAGE: INVALID MESSAGESTART %s peer=%d\n", SanitizeString(msg.hdr.GetCommand()), pfrom->id);
-            pfrom->fDisconnect = true;
-            return false;
-        }
+        if (!CheckMessageHeader(pfrom, msg, chainparams))
+            return pfrom->fDisconnect ? false : fMoreWork;
 
-        // Read header
         CMessageHeader& hdr = msg.hdr;
-        if (!hdr.IsValid(chainparams.MessageStart()))
-        {
-            LogPrintf("PROCESSMESSAGE: ERRORS IN HEADER %s peer=%d\n", SanitizeString(hdr.GetCommand()), pfrom->id);
-            return fMoreWork;
-        }
         std::string strCommand = hdr.GetCommand();
 
         // Message size
         unsigned int nMessageSize = hdr.nMessageSize;
 
-        // Checksum
         CDataStream& vRecv = msg.vRecv;
-        const uint256& hash = msg.GetMessageHash();
-        if (memcmp(hash.begin(), hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) != 0)
-        {
-            LogPrintf("%s(%s, %u bytes): CHECKSUM ERROR expected %s was %s\n", __func__,
-               SanitizeString(strCommand), nMessageSize,
-               HexStr(hash.begin(), hash.begin()+CMessageHeader::CHECKSUM_SIZE),
-               HexStr(hdr.pchChecksum, hdr.pchChecksum+CMessageHeader::CHECKSUM_SIZE));
-            return fMoreWork;
-        }
 
         // Process message
         bool fRet = false;
@@ -3163,6 +3232,40 @@ bool ProcessMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& i
     return fMoreWork;
 }
 
+bool ProcessConcurrentMessages(CNode* pfrom, CConnman& connman, const std::atomic<bool>& interruptMsgProc)
+{
+    const CChainParams& chainparams = Params();
+    bool fMoreWork = false;
+
+    std::list<CNetMessage> msgs;
+    bool fResumeRecv = false;
+    if (!pfrom->PopConcurrentMessage(msgs, connman.GetReceiveFloodSize(), fResumeRecv, fMoreWork))
+        return false;
+    if (fResumeRecv)
+        connman.WakeSocketHandler();
+    CNetMessage& msg(msgs.front());
+
+    if (!CheckMessageHeader(pfrom, msg, chainparams))
+        return pfrom->fDisconnect ? false : fMoreWork;
+
+    std::string strCommand = msg.hdr.GetCommand();
+    LogPrint("net", "received: %s (%u bytes) peer=%d\n", SanitizeString(strCommand), msg.vRecv.size(), pfrom->id);
+
+    // misbehaving peers are disconnected by SendMessages(), unlike ProcessMessages() this doesn't take cs_main to check for bans
+    try {
+        ProcessConcurrentMessage(pfrom, strCommand, msg.vRecv, connman);
+    }
+    catch (const std::ios_base::failure& e) {
+        connman.PushMessage(pfrom, CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::REJECT, strCommand, REJECT_MALFORMED, std::string("error parsing message")));
+        LogPrintf("%s(%s, %u bytes): Exception '%s' caught\n", __func__, SanitizeString(strCommand), msg.hdr.nMessageSize, e.what());
+    }
+    catch (...) {
+        PrintExceptionContinue(std::current_exception(), "ProcessConcurrentMessages()");
+    }
+
+    return fMoreWork && !interruptMsgProc;
+}
+
 class CompareInvMempoolOrder
 {
     CTxMemPool *mp;
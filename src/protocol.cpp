@@ -8,6 +8,8 @@
 #include "util.h"
 #include "utilstrencodings.h"
 
+#include <set>
+
 #ifndef WIN32
 # include <arpa/inet.h>
 #endif
@@ -113,6 +115,16 @@ const static std::string allNetMessageTypes[] = {
 };
 const static std::vector<std::string> allNetMessageTypesVec(allNetMessageTypes, allNetMessageTypes+ARRAYLEN(allNetMessageTypes));
 
+/** Message types which don't need cs_main unless the peer misbehaves, so they don't have to wait for blocks being
+ *  validated. The LLMQ signing session announcements, invs and shares depend on each other, so they all have to be in
+ *  the same queue to keep their order. */
+const static std::set<std::string> concurrentNetMessageTypes = {
+    NetMsgType::QSIGSESANN,
+    NetMsgType::QSIGSHARESINV,
+    NetMsgType::QGETSIGSHARES,
+    NetMsgType::QBSIGSHARES,
+};
+
 CMessageHeader::CMessageHeader(const MessageStartChars& pchMessageStartIn)
 {
     memcpy(pchMessageStart, pchMessageStartIn, MESSAGE_START_SIZE);
@@ -242,3 +254,8 @@ const std::vector<std::string> &getAllNetMessageTypes()
 {
     return allNetMessageTypesVec;
 }
+
+bool IsConcurrentNetMessageType(const std::string& msgType)
+{
+    return concurrentNetMessageTypes.count(msgType) != 0;
+}
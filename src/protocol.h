@@ -270,6 +270,9 @@ extern const char *MNAUTH;
 /* Get a vector of all valid message types (see above) */
 const std::vector<std::string> &getAllNetMessageTypes();
 
+/* Whether a message type is processed by the concurrent message handlers (see -msghandlerthreads) */
+bool IsConcurrentNetMessageType(const std::string& msgType);
+
 /** nServices flags */
 enum ServiceFlags : uint64_t {
     // Nothing
@@ -207,21 +207,12 @@ void ElyAssetsDialog::PopulateBalances(unsigned int propertyId)
         ui->balancesTable->setHorizontalHeaderItem(1, new QTableWidgetItem("Address"));
         bool propertyIsDivisible = isPropertyDivisible(propertyId); // only fetch the SP once, not for every address
 
-        // iterate mp_tally_map looking for addresses that hold a balance in propertyId
-        for(std::unordered_map<string, CMPTally>::iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
-            const std::string& address = my_it->first;
-            CMPTally& tally = my_it->second;
-            tally.init();
-
-            uint32_t id;
-            bool watchAddress = false, includeAddress = false;
-            while (0 != (id = (tally.next()))) {
-                if (id == propertyId) {
-                    includeAddress = true;
-                    break;
-                }
-            }
-            if (!includeAddress) continue; //ignore this address, has never transacted in this propertyId
+        // iterate the addresses that have transacted in propertyId
+        for (CMPTallyMap::AddressId id : mp_tally_map.getHolders(propertyId)) {
+            const std::string& address = mp_tally_map.get(id).first;
+            const CMPTally& tally = mp_tally_map.get(id).second;
+
+            bool watchAddress = false;
 
             // determine if this address is in the wallet
             int addressIsMine = IsMyAddress(address);
@@ -247,9 +238,9 @@ void ElyAssetsDialog::PopulateBalances(unsigned int propertyId)
 
             // add the row
             if (!watchAddress) {
-                AddRow(GetAddressLabel(my_it->first), address, reservedStr, availableStr);
+                AddRow(GetAddressLabel(address), address, reservedStr, availableStr);
             } else {
-                AddRow(GetAddressLabel(my_it->first), address + " (watch-only)", reservedStr, availableStr);
+                AddRow(GetAddressLabel(address), address + " (watch-only)", reservedStr, availableStr);
             }
         }
     }
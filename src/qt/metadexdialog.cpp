@@ -137,16 +137,10 @@ void MetaDExDialog::PopulateAddresses()
         uint32_t propertyId = GetPropForSale();
         QString currentSetAddress = ui->comboAddress->currentText();
         ui->comboAddress->clear();
-        for (std::unordered_map<string, CMPTally>::iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
-            string address = (my_it->first).c_str();
-            uint32_t id;
-            (my_it->second).init();
-            while (0 != (id = (my_it->second).next())) {
-                if (id == propertyId) {
-                    if (!getUserAvailableMPbalance(address, propertyId)) continue; // ignore this address, has no available balance to spend
-                    if (IsMyAddress(address)) ui->comboAddress->addItem((my_it->first).c_str()); // only include wallet addresses
-                }
-            }
+        for (CMPTallyMap::AddressId id : mp_tally_map.getHolders(propertyId)) {
+            string address = mp_tally_map.get(id).first;
+            if (!getUserAvailableMPbalance(address, propertyId)) continue; // ignore this address, has no available balance to spend
+            if (IsMyAddress(address)) ui->comboAddress->addItem(address.c_str()); // only include wallet addresses
         }
         int idx = ui->comboAddress->findText(currentSetAddress);
         if (idx != -1) { ui->comboAddress->setCurrentIndex(idx); }
@@ -163,8 +157,11 @@ void MetaDExDialog::UpdateProperties()
     ui->comboPairTokenA->clear();
     ui->comboPairTokenB->clear();
 
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        uint32_t propertyId = my_it->first;
+    uint32_t lastPropertyId = 0;
+    for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
+        uint32_t propertyId = my_it->first.first;
+        if (propertyId == lastPropertyId) continue; // pairs are ordered by property for sale, list each property once
+        lastPropertyId = propertyId;
         if ((testEco && !isTestEcosystemProperty(propertyId)) || (!testEco && isTestEcosystemProperty(propertyId))) continue;
         string spName;
         spName = getPropertyName(propertyId).c_str();
@@ -347,16 +344,14 @@ void MetaDExDialog::UpdateOffers()
     bool divisSale = isPropertyDivisible(GetPropForSale());
     bool divisDes = isPropertyDivisible(GetPropDesired());
 
-    for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
-        if ((my_it->first != GetPropForSale())) continue; // not the property we're looking for, don't waste any more work
-        md_PricesMap & prices = my_it->second;
-        for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it) { // loop through the sell prices for the property
+    const md_PricesMap* prices = metadex.getPrices(GetPropForSale(), GetPropDesired());
+    if (prices) {
+        for (md_PricesMap::const_iterator it = prices->begin(); it != prices->end(); ++it) { // loop through the sell prices for the pair
             std::string unitPriceStr;
             bool includesMe = false;
-            md_Set & indexes = (it->second);
-            for (md_Set::iterator it = indexes.begin(); it != indexes.end(); ++it) { // multiple sell offers can exist at the same price, sum them for the UI
+            const md_Set & indexes = (it->second);
+            for (md_Set::const_iterator it = indexes.begin(); it != indexes.end(); ++it) { // multiple sell offers can exist at the same price, sum them for the UI
                 const CMPMetaDEx& obj = *it;
-                if ((obj.getDesProperty() != GetPropDesired())) continue; // not the property we're interested in
                 if (IsMyAddress(obj.getAddr())) includesMe = true;
                 std::string strAvail;
                 if (divisSale) {
@@ -187,15 +187,9 @@ void SendMPDialog::updateProperty()
     QString spId = ui->propertyComboBox->itemData(ui->propertyComboBox->currentIndex()).toString();
     uint32_t propertyId = spId.toUInt();
     LOCK(cs_main);
-    for (std::unordered_map<string, CMPTally>::iterator my_it = mp_tally_map.begin(); my_it != mp_tally_map.end(); ++my_it) {
-        string address = (my_it->first).c_str();
-        uint32_t id = 0;
-        bool includeAddress=false;
-        (my_it->second).init();
-        while (0 != (id = (my_it->second).next())) {
-            if(id == propertyId) { includeAddress=true; break; }
-        }
-        if (!includeAddress) continue; //ignore this address, has never transacted in this propertyId
+    // only addresses which have transacted in this propertyId
+    for (CMPTallyMap::AddressId id : mp_tally_map.getHolders(propertyId)) {
+        string address = mp_tally_map.get(id).first;
         if (IsMyAddress(address) != ISMINE_SPENDABLE) continue; // ignore this address, it's not spendable
         if (!getUserAvailableMPbalance(address, propertyId)) continue; // ignore this address, has no available balance to spend
         ui->sendFromComboBox->addItem(QString::fromStdString(address + " \t" + FormatMP(propertyId, getUserAvailableMPbalance(address, propertyId)) + getTokenLabel(propertyId)));
@@ -3,10 +3,13 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "base58.h"
 #include "chain.h"
 #include "chainparams.h"
+#include "coinsetcache.h"
 #include "primitives/block.h"
 #include "primitives/transaction.h"
+#include "spentindex.h"
 #include "validation.h"
 #include "httpserver.h"
 #include "rpc/server.h"
@@ -21,6 +24,7 @@
 #include <univalue.h>
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const size_t ADDRESS_INDEX_PAGE_SIZE = 1000; //number of address index entries read and sent at once
 
 enum RetFormat {
     RF_UNDEF,
@@ -64,6 +68,10 @@ extern UniValue mempoolInfoToJSON();
 extern UniValue mempoolToJSON(bool fVerbose = false);
 extern void ScriptPubKeyToJSON(const CScript& scriptPubKey, UniValue& out, bool fIncludeHex);
 extern UniValue blockheaderToJSON(const CBlockIndex* blockindex);
+extern UniValue AnonymitySetUpdateToJSON(const lelantus::CAnonymitySetUpdate& update);
+extern UniValue UsedSerialsUpdateToJSON(const lelantus::CUsedSerialsUpdate& update);
+extern UniValue AddressDeltaToJSON(const std::pair<CAddressIndexKey, CAmount>& entry);
+extern UniValue AddressUtxoToJSON(const std::pair<CAddressUnspentKey, CAddressUnspentValue>& entry);
 
 static bool RESTERR(HTTPRequest* req, enum HTTPStatusCode status, std::string message)
 {
@@ -591,6 +599,204 @@ static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
     return true; // continue to process further HTTP reqs on this cxn
 }
 
+template <typename Update>
+static bool rest_coinset_reply(HTTPRequest* req, enum RetFormat rf, const Update& update, UniValue (*toJSON)(const Update&))
+{
+    switch (rf) {
+    case RF_BINARY: {
+        // coins are written as raw 34 byte points and serials as raw 32 byte scalars
+        CDataStream ssUpdate(SER_NETWORK, PROTOCOL_VERSION);
+        ssUpdate << update;
+        std::string binaryUpdate = ssUpdate.str();
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, binaryUpdate);
+        return true;
+    }
+
+    case RF_HEX: {
+        CDataStream ssUpdate(SER_NETWORK, PROTOCOL_VERSION);
+        ssUpdate << update;
+        std::string strHex = HexStr(ssUpdate.begin(), ssUpdate.end()) + "\n";
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, strHex);
+        return true;
+    }
+
+    case RF_JSON: {
+        std::string strJSON = toJSON(update).write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+
+    // not reached
+    return true; // continue to process further HTTP reqs on this cxn
+}
+
+static bool rest_lelantus_anonymityset(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() < 1 || path.size() > 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No group specified. Use /rest/lelantus/anonymityset/<group>/<starthash>.<ext>.");
+
+    int32_t coinGroupId;
+    if (!ParseInt32(path[0], &coinGroupId))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid group: " + path[0]);
+
+    uint256 startBlockHash;
+    if (path.size() > 1 && !ParseHashStr(path[1], startBlockHash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + path[1]);
+
+    std::shared_ptr<const lelantus::CAnonymitySetUpdate> update;
+    {
+        LOCK(cs_main);
+        update = lelantus::coinSetCache.GetAnonymitySet(coinGroupId, startBlockHash);
+    }
+
+    if (!update)
+        return RESTERR(req, HTTP_NOT_FOUND, path[1] + " not found in the active chain");
+
+    return rest_coinset_reply(req, rf, *update, AnonymitySetUpdateToJSON);
+}
+
+static bool rest_lelantus_usedcoinserials(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    uint256 startBlockHash;
+    if (param.length() > 1 && !ParseHashStr(param.substr(1), startBlockHash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + param.substr(1));
+
+    std::shared_ptr<const lelantus::CUsedSerialsUpdate> update;
+    {
+        LOCK(cs_main);
+        update = lelantus::coinSetCache.GetUsedSerials(startBlockHash);
+    }
+
+    if (!update)
+        return RESTERR(req, HTTP_NOT_FOUND, param.substr(1) + " not found in the active chain");
+
+    return rest_coinset_reply(req, rf, *update, UsedSerialsUpdateToJSON);
+}
+
+/**
+ * Sends the index entries of an address as a JSON array, one page of entries at a time,
+ * so that the entries of large addresses are never all held in memory.
+ * read(entries, after) appends the page after the given entry, toJSON returns null for entries to skip.
+ */
+template <typename Key, typename Value, typename Reader, typename Formatter>
+static bool rest_address_stream(HTTPRequest* req, std::vector<std::pair<Key, Value> >& entries, Reader read, Formatter toJSON)
+{
+    if (!read(entries, nullptr))
+        return RESTERR(req, HTTP_NOT_FOUND, "No information available for address (requires addressindex to be enabled)");
+
+    req->WriteHeader("Content-Type", "application/json");
+    req->WriteReplyStart(HTTP_OK);
+
+    std::string strJSON = "[";
+    bool fFirst = true;
+    while (true) {
+        for (const auto& entry : entries) {
+            UniValue item = toJSON(entry);
+            if (item.isNull())
+                continue;
+            if (!fFirst)
+                strJSON += ",";
+            strJSON += item.write();
+            fFirst = false;
+        }
+
+        if (entries.size() < ADDRESS_INDEX_PAGE_SIZE)
+            break;
+
+        if (!req->WriteReplyChunk(strJSON)) {
+            // client has gone away
+            req->WriteReplyEnd();
+            return true;
+        }
+
+        Key cursor = entries.back().first;
+        strJSON.clear();
+        entries.clear();
+        if (!read(entries, &cursor)) {
+            // the status has been sent already, leave the array open so that the client notices the failure
+            LogPrint("http", "%s: failed to read address index\n", __func__);
+            req->WriteReplyEnd();
+            return true;
+        }
+    }
+
+    strJSON += "]\n";
+    req->WriteReplyChunk(strJSON);
+    req->WriteReplyEnd();
+    return true;
+}
+
+static bool rest_address(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Use /rest/address/<txids|deltas|utxos>/<address>.json.");
+
+    if (rf != RF_JSON)
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+
+    CBitcoinAddress address(path[1]);
+    uint160 hashBytes;
+    AddressType type = AddressType::unknown;
+    if (!address.GetIndexKey(hashBytes, type))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + path[1]);
+
+    if (path[0] == "txids" || path[0] == "deltas") {
+        std::vector<std::pair<CAddressIndexKey, CAmount> > entries;
+        auto read = [hashBytes, type](std::vector<std::pair<CAddressIndexKey, CAmount> >& page, const CAddressIndexKey* after) {
+            return GetAddressIndex(hashBytes, type, page, 0, 0, after, ADDRESS_INDEX_PAGE_SIZE);
+        };
+
+        if (path[0] == "deltas")
+            return rest_address_stream(req, entries, read, AddressDeltaToJSON);
+
+        // entries of a transaction are next to each other, also across pages
+        uint256 lastTxid;
+        return rest_address_stream(req, entries, read, [&lastTxid](const std::pair<CAddressIndexKey, CAmount>& entry) {
+            if (entry.first.txhash == lastTxid)
+                return UniValue(UniValue::VNULL);
+            lastTxid = entry.first.txhash;
+            return UniValue(lastTxid.GetHex());
+        });
+    }
+
+    if (path[0] == "utxos") {
+        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > entries;
+        auto read = [hashBytes, type](std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >& page, const CAddressUnspentKey* after) {
+            return GetAddressUnspent(hashBytes, type, page, after, ADDRESS_INDEX_PAGE_SIZE);
+        };
+        return rest_address_stream(req, entries, read, AddressUtxoToJSON);
+    }
+
+    return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Use /rest/address/<txids|deltas|utxos>/<address>.json.");
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(HTTPRequest* req, const std::string& strReq);
@@ -603,6 +809,9 @@ static const struct {
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
+      {"/rest/lelantus/anonymityset/", rest_lelantus_anonymityset},
+      {"/rest/lelantus/usedcoinserials", rest_lelantus_usedcoinserials},
+      {"/rest/address/", rest_address},
 };
 
 bool StartREST()
@@ -187,6 +187,10 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "joinsplit", 0 },
     { "joinsplit", 1 },
     { "joinsplit", 2 },
+    { "joinsplit", 3 },
+    { "simulatejoinsplit", 0 },
+    { "simulatejoinsplit", 1 },
+    { "simulatejoinsplit", 2 },
     { "spendallzerocoin", 0 },
     { "remintzerocointosigma", 0 },
     { "getanonymityset", 0},
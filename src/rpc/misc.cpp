@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "base58.h"
+#include "chainsnapshot.h"
 #include "clientversion.h"
 #include "init.h"
 #include "validation.h"
@@ -20,6 +21,8 @@
 #include "wallet/walletdb.h"
 #endif
 #include "txdb.h"
+#include "coinsetcache.h"
+#include "lelantus.h"
 
 #include "masternode-sync.h"
 
@@ -640,6 +643,105 @@ bool timestampSort(std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> a,
     return a.second.time < b.second.time;
 }
 
+UniValue AddressDeltaToJSON(const std::pair<CAddressIndexKey, CAmount>& entry)
+{
+    std::string address;
+    if (!getAddressFromIndex(entry.first.type, entry.first.hashBytes, address)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
+    }
+
+    UniValue delta(UniValue::VOBJ);
+    delta.push_back(Pair("satoshis", entry.second));
+    delta.push_back(Pair("txid", entry.first.txhash.GetHex()));
+    delta.push_back(Pair("index", (int)entry.first.index));
+    delta.push_back(Pair("blockindex", (int)entry.first.txindex));
+    delta.push_back(Pair("height", entry.first.blockHeight));
+    delta.push_back(Pair("address", address));
+    return delta;
+}
+
+UniValue AddressUtxoToJSON(const std::pair<CAddressUnspentKey, CAddressUnspentValue>& entry)
+{
+    std::string address;
+    if (!getAddressFromIndex(entry.first.type, entry.first.hashBytes, address)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
+    }
+
+    UniValue output(UniValue::VOBJ);
+    output.push_back(Pair("address", address));
+    output.push_back(Pair("txid", entry.first.txhash.GetHex()));
+    output.push_back(Pair("outputIndex", (int)entry.first.index));
+    output.push_back(Pair("script", HexStr(entry.second.script.begin(), entry.second.script.end())));
+    output.push_back(Pair("satoshis", entry.second.satoshis));
+    output.push_back(Pair("height", entry.second.blockHeight));
+    return output;
+}
+
+namespace {
+
+size_t getPageLimitFromParams(const UniValue& params)
+{
+    if (!params[0].isObject())
+        return 0;
+
+    UniValue limitValue = find_value(params[0].get_obj(), "limit");
+    if (limitValue.isNull())
+        return 0;
+
+    int limit = limitValue.get_int();
+    if (limit <= 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Limit is expected to be positive");
+    }
+    return limit;
+}
+
+/**
+ * Reads at most limit index entries of the addresses, in the order the addresses are given and then
+ * in the order of the index, starting after the entry encoded in the cursor parameter.
+ * Returns the cursor of the next page, or null if there are no more entries.
+ */
+template<typename Key, typename Value, typename Reader>
+UniValue readAddressIndexPage(const UniValue& params, const std::vector<std::pair<uint160, AddressType> >& addresses,
+                              size_t limit, Key& cursor, bool& fCursor, std::vector<std::pair<Key, Value> >& entries, Reader read)
+{
+    UniValue cursorValue = find_value(params[0].get_obj(), "cursor");
+    size_t first = 0;
+
+    fCursor = !cursorValue.isNull();
+    if (fCursor) {
+        std::vector<unsigned char> data(ParseHexV(cursorValue, "cursor"));
+        CDataStream ssCursor(data, SER_DISK, CLIENT_VERSION);
+        try {
+            ssCursor >> cursor;
+        } catch (const std::exception&) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+
+        while (first < addresses.size() && (addresses[first].first != cursor.hashBytes || addresses[first].second != cursor.type))
+            first++;
+        if (first == addresses.size()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor does not belong to any of the addresses");
+        }
+    }
+
+    // one entry more than the limit is read to know whether there is a next page
+    for (size_t i = first; i < addresses.size() && entries.size() <= limit; i++) {
+        if (!read(addresses[i].first, addresses[i].second, entries, fCursor && i == first ? &cursor : nullptr, limit + 1 - entries.size())) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+    }
+
+    if (entries.size() <= limit)
+        return NullUniValue;
+
+    entries.resize(limit);
+    CDataStream ssNext(SER_DISK, CLIENT_VERSION);
+    ssNext << entries.back().first;
+    return HexStr(ssNext.begin(), ssNext.end());
+}
+
+}
+
 UniValue getaddressmempool(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -722,7 +824,10 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
                         "    [\n"
                         "      \"address\"  (string) The base58check encoded address\n"
                         "      ,...\n"
-                        "    ]\n"
+                        "    ],\n"
+                        "  \"countOnly\" (boolean, optional) Only return the number of unspent outputs\n"
+                        "  \"limit\" (number, optional) Return at most this number of outputs, ordered by address and txid\n"
+                        "  \"cursor\" (string, optional) The cursor returned with the previous page\n"
                         "}\n"
                         "\nResult\n"
                         "[\n"
@@ -735,6 +840,15 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
                         "    \"height\"  (number) The block height\n"
                         "  }\n"
                         "]\n"
+                        "\nResult (countOnly)\n"
+                        "{\n"
+                        "  \"count\"  (number) The number of unspent outputs\n"
+                        "}\n"
+                        "\nResult (limit)\n"
+                        "{\n"
+                        "  \"utxos\"  (array) The unspent outputs as above\n"
+                        "  \"cursor\"  (string) The cursor of the next page, null if there are no more outputs\n"
+                        "}\n"
                         "\nExamples:\n"
                 + HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
                 + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
@@ -746,8 +860,52 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    bool fCountOnly = false;
+    if (request.params[0].isObject()) {
+        UniValue countOnly = find_value(request.params[0].get_obj(), "countOnly");
+        if (countOnly.isBool())
+            fCountOnly = countOnly.get_bool();
+    }
+
+    if (fCountOnly) {
+        int64_t count = 0;
+
+        for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            CAddressBalanceValue balance;
+            if (!GetAddressBalance((*it).first, (*it).second, balance)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
+            count += balance.unspentCount;
+        }
+
+        UniValue result(UniValue::VOBJ);
+        result.push_back(Pair("count", count));
+        return result;
+    }
+
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
 
+    size_t limit = getPageLimitFromParams(request.params);
+    if (limit > 0) {
+        CAddressUnspentKey cursor;
+        bool fCursor;
+        UniValue next = readAddressIndexPage(request.params, addresses, limit, cursor, fCursor, unspentOutputs,
+            [](uint160 hash, AddressType type, std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >& entries,
+               const CAddressUnspentKey *after, size_t count) {
+                return GetAddressUnspent(hash, type, entries, after, count);
+            });
+
+        UniValue utxos(UniValue::VARR);
+        for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=unspentOutputs.begin(); it!=unspentOutputs.end(); it++) {
+            utxos.push_back(AddressUtxoToJSON(*it));
+        }
+
+        UniValue result(UniValue::VOBJ);
+        result.push_back(Pair("utxos", utxos));
+        result.push_back(Pair("cursor", next));
+        return result;
+    }
+
     for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
@@ -759,19 +917,7 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
     UniValue result(UniValue::VARR);
 
     for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=unspentOutputs.begin(); it!=unspentOutputs.end(); it++) {
-        UniValue output(UniValue::VOBJ);
-        std::string address;
-        if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
-        }
-
-        output.push_back(Pair("address", address));
-        output.push_back(Pair("txid", it->first.txhash.GetHex()));
-        output.push_back(Pair("outputIndex", (int)it->first.index));
-        output.push_back(Pair("script", HexStr(it->second.script.begin(), it->second.script.end())));
-        output.push_back(Pair("satoshis", it->second.satoshis));
-        output.push_back(Pair("height", it->second.blockHeight));
-        result.push_back(output);
+        result.push_back(AddressUtxoToJSON(*it));
     }
 
     return result;
@@ -792,6 +938,8 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
                         "    ]\n"
                         "  \"start\" (number) The start block height\n"
                         "  \"end\" (number) The end block height\n"
+                        "  \"limit\" (number, optional) Return at most this number of deltas, ordered by address and height\n"
+                        "  \"cursor\" (string, optional) The cursor returned with the previous page\n"
                         "}\n"
                         "\nResult:\n"
                         "[\n"
@@ -804,6 +952,11 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
                         "    \"address\"  (string) The base58check encoded address\n"
                         "  }\n"
                         "]\n"
+                        "\nResult (limit)\n"
+                        "{\n"
+                        "  \"deltas\"  (array) The deltas as above\n"
+                        "  \"cursor\"  (string) The cursor of the next page, null if there are no more deltas\n"
+                        "}\n"
                         "\nExamples:\n"
                 + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
                 + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
@@ -832,6 +985,27 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
+    size_t limit = getPageLimitFromParams(request.params);
+    if (limit > 0) {
+        CAddressIndexKey cursor;
+        bool fCursor;
+        UniValue next = readAddressIndexPage(request.params, addresses, limit, cursor, fCursor, addressIndex,
+            [start, end](uint160 hash, AddressType type, std::vector<std::pair<CAddressIndexKey, CAmount> >& entries,
+                         const CAddressIndexKey *after, size_t count) {
+                return GetAddressIndex(hash, type, entries, start, end, after, count);
+            });
+
+        UniValue deltas(UniValue::VARR);
+        for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
+            deltas.push_back(AddressDeltaToJSON(*it));
+        }
+
+        UniValue result(UniValue::VOBJ);
+        result.push_back(Pair("deltas", deltas));
+        result.push_back(Pair("cursor", next));
+        return result;
+    }
+
     for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (start > 0 && end > 0) {
             if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
@@ -847,19 +1021,7 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
     UniValue result(UniValue::VARR);
 
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        std::string address;
-        if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
-        }
-
-        UniValue delta(UniValue::VOBJ);
-        delta.push_back(Pair("satoshis", it->second));
-        delta.push_back(Pair("txid", it->first.txhash.GetHex()));
-        delta.push_back(Pair("index", (int)it->first.index));
-        delta.push_back(Pair("blockindex", (int)it->first.txindex));
-        delta.push_back(Pair("height", it->first.blockHeight));
-        delta.push_back(Pair("address", address));
-        result.push_back(delta);
+        result.push_back(AddressDeltaToJSON(*it));
     }
 
     return result;
@@ -895,22 +1057,16 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
-    }
-
     CAmount balance = 0;
     CAmount received = 0;
 
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        if (it->second > 0) {
-            received += it->second;
+    for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+        CAddressBalanceValue addressBalance;
+        if (!GetAddressBalance((*it).first, (*it).second, addressBalance)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
-        balance += it->second;
+        balance += addressBalance.balance;
+        received += addressBalance.received;
     }
 
     UniValue result(UniValue::VOBJ);
@@ -1080,12 +1236,8 @@ UniValue getlatestcoinids(const JSONRPCRequest& request)
                 "}\n"
         );
 
-    sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
-    std::unordered_map<sigma::CoinDenomination, int> latestCoinIds;
-    {
-        LOCK(cs_main);
-        latestCoinIds = sigmaState->GetLatestCoinIds();
-    }
+    std::shared_ptr<const CChainSnapshot> chain = GetChainSnapshot();
+    const std::unordered_map<sigma::CoinDenomination, int>& latestCoinIds = chain->SigmaLatestCoinIds();
 
     UniValue ret(UniValue::VARR);
     for (const auto& it : latestCoinIds ) {
@@ -1102,6 +1254,131 @@ UniValue getlatestcoinids(const JSONRPCRequest& request)
     return ret;
 }
 
+UniValue AnonymitySetUpdateToJSON(const lelantus::CAnonymitySetUpdate& update)
+{
+    UniValue coins(UniValue::VARR);
+    for (const auto& coin : update.coins) {
+        std::vector<unsigned char> vch = coin.first.getValue().getvch();
+        UniValue data(UniValue::VARR);
+        data.push_back(HexStr(vch.begin(), vch.end()));
+        data.push_back(coin.second.GetHex());
+        coins.push_back(data);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("blockHash", update.blockHash.GetHex()));
+    ret.push_back(Pair("setHash", HexStr(update.setHash.begin(), update.setHash.end())));
+    ret.push_back(Pair("coins", coins));
+
+    return ret;
+}
+
+UniValue UsedSerialsUpdateToJSON(const lelantus::CUsedSerialsUpdate& update)
+{
+    UniValue serials(UniValue::VARR);
+    for (const auto& serial : update.serials)
+        serials.push_back(serial.GetHex());
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("blockHash", update.blockHash.GetHex()));
+    ret.push_back(Pair("serials", serials));
+
+    return ret;
+}
+
+UniValue getlelantusanonymityset(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+                "getlelantusanonymityset\n"
+                        "\nReturns the coins of a Lelantus anonymity set which were minted after the given block.\n"
+                        "\nArguments:\n"
+                        "{\n"
+                        "      \"coinGroupId\"     (int)\n"
+                        "      \"startBlockHash\"  (string, optional) blockHash of the previous response, the whole set is returned if omitted\n"
+                        "}\n"
+                        "\nResult:\n"
+                        "{\n"
+                        "  \"blockHash\"   (string) Latest block hash for anonymity set, the start of the next request\n"
+                        "  \"setHash\"     (string) Hash of the whole anonymity set\n"
+                        "  \"coins\"       (std::string[][]) Serialized GroupElements paired with the hashes of their transactions\n"
+                        "}\n"
+                + HelpExampleCli("getlelantusanonymityset", "1 \"b476ed2b374bb081ea51d111f68f0136252521214e213d119b8dc67b92f5a390\"")
+                + HelpExampleRpc("getlelantusanonymityset", "\"1\", \"b476ed2b374bb081ea51d111f68f0136252521214e213d119b8dc67b92f5a390\"")
+        );
+
+    int coinGroupId;
+    uint256 startBlockHash;
+    try {
+        if (request.params[0].isNum())
+            coinGroupId = request.params[0].get_int();
+        else
+            coinGroupId = std::stol(request.params[0].get_str());
+    } catch (std::logic_error const & e) {
+        throw std::runtime_error(std::string("An exception occurred while parsing parameters: ") + e.what());
+    }
+
+    if (request.params.size() > 1 && !request.params[1].get_str().empty())
+        startBlockHash = ParseHashV(request.params[1], "startBlockHash");
+
+    std::shared_ptr<const lelantus::CAnonymitySetUpdate> update;
+    {
+        LOCK(cs_main);
+        update = lelantus::coinSetCache.GetAnonymitySet(coinGroupId, startBlockHash);
+    }
+
+    if (!update)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Start block is not in the active chain");
+
+    return AnonymitySetUpdateToJSON(*update);
+}
+
+UniValue getlelantususedcoinserials(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+                "getlelantususedcoinserials\n"
+                "\nReturns the Lelantus serials which were spent after the given block.\n"
+                "\nArguments:\n"
+                "{\n"
+                "      \"startBlockHash\"  (string, optional) blockHash of the previous response, all serials are returned if omitted\n"
+                "}\n"
+                "\nResult:\n"
+                "{\n"
+                "  \"blockHash\" (string) Chain tip, the start of the next request\n"
+                "  \"serials\"   (std::string[]) array of Serialized Scalars\n"
+                "}\n"
+        );
+
+    uint256 startBlockHash;
+    if (request.params.size() > 0 && !request.params[0].get_str().empty())
+        startBlockHash = ParseHashV(request.params[0], "startBlockHash");
+
+    std::shared_ptr<const lelantus::CUsedSerialsUpdate> update;
+    {
+        LOCK(cs_main);
+        update = lelantus::coinSetCache.GetUsedSerials(startBlockHash);
+    }
+
+    if (!update)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Start block is not in the active chain");
+
+    return UsedSerialsUpdateToJSON(*update);
+}
+
+UniValue getlelantuslatestcoinid(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+                "getlelantuslatestcoinid\n"
+                "\nReturns the id of the latest Lelantus anonymity set.\n"
+                "\nResult:\n"
+                "  \"coinGroupId\" (int) The latest group id\n"
+        );
+
+    return GetChainSnapshot()->LelantusLatestCoinId();
+}
+
 UniValue getaddresstxids(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -1117,12 +1394,20 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
                         "    ]\n"
                         "  \"start\" (number) The start block height\n"
                         "  \"end\" (number) The end block height\n"
+                        "  \"limit\" (number, optional) Read at most this number of index entries, the txids are then\n"
+                        "            ordered by address and height and not merged between addresses\n"
+                        "  \"cursor\" (string, optional) The cursor returned with the previous page\n"
                         "}\n"
                         "\nResult:\n"
                         "[\n"
                         "  \"transactionid\"  (string) The transaction id\n"
                         "  ,...\n"
                         "]\n"
+                        "\nResult (limit)\n"
+                        "{\n"
+                        "  \"txids\"  (array) The transaction ids\n"
+                        "  \"cursor\"  (string) The cursor of the next page, null if there are no more txids\n"
+                        "}\n"
                         "\nExamples:\n"
                 + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
                 + HelpExampleRpc("getaddresstxids", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
@@ -1147,6 +1432,33 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
+    size_t limit = getPageLimitFromParams(request.params);
+    if (limit > 0) {
+        CAddressIndexKey cursor;
+        bool fCursor;
+        UniValue next = readAddressIndexPage(request.params, addresses, limit, cursor, fCursor, addressIndex,
+            [start, end](uint160 hash, AddressType type, std::vector<std::pair<CAddressIndexKey, CAmount> >& entries,
+                         const CAddressIndexKey *after, size_t count) {
+                return GetAddressIndex(hash, type, entries, start, end, after, count);
+            });
+
+        // entries of a transaction are next to each other, the ones of the transaction
+        // at the end of the previous page have already been returned with it
+        CAddressIndexKey last = fCursor ? cursor : CAddressIndexKey();
+        UniValue txids(UniValue::VARR);
+        for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
+            if (it->first.txhash != last.txhash || it->first.hashBytes != last.hashBytes || it->first.type != last.type) {
+                txids.push_back(it->first.txhash.GetHex());
+            }
+            last = it->first;
+        }
+
+        UniValue result(UniValue::VOBJ);
+        result.push_back(Pair("txids", txids));
+        result.push_back(Pair("cursor", next));
+        return result;
+    }
+
     for (std::vector<std::pair<uint160, AddressType> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (start > 0 && end > 0) {
             if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
@@ -1389,6 +1701,9 @@ static const CRPCCommand commands[] =
     { "mobile",             "getmintmetadata",        &getmintmetadata,        true  },
     { "mobile",             "getusedcoinserials",     &getusedcoinserials,     true  },
     { "mobile",             "getlatestcoinids",       &getlatestcoinids,       true  },
+    { "mobile",             "getlelantusanonymityset",    &getlelantusanonymityset,    true  },
+    { "mobile",             "getlelantususedcoinserials", &getlelantususedcoinserials, true  },
+    { "mobile",             "getlelantuslatestcoinid",    &getlelantuslatestcoinid,    true  },
 
     { "hidden",             "setmocktime",            &setmocktime,            true,  {"timestamp"}},
     { "hidden",             "echo",                   &echo,                   true,  {"arg0","arg1","arg2","arg3","arg4","arg5","arg6","arg7","arg8","arg9"}},
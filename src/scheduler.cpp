@@ -5,11 +5,16 @@
 #include "scheduler.h"
 
 #include "reverselock.h"
+#include "util.h"
 
 #include <assert.h>
+#include <atomic>
 #include <boost/bind/bind.hpp>
 #include <utility>
 
+// tasks starting later than this are logged
+static const int64_t SCHEDULER_LOG_DELAY_MICROS = 1000000;
+
 CScheduler::CScheduler() : nThreadsServicingQueue(0), stopRequested(false), stopWhenEmpty(false)
 {
 }
@@ -27,6 +32,28 @@ static boost::system_time toPosixTime(const boost::chrono::system_clock::time_po
 }
 #endif
 
+CScheduler::TaskQueue::iterator CScheduler::selectTask(boost::chrono::system_clock::time_point now, boost::chrono::system_clock::time_point& next, bool& fHaveNext)
+{
+    TaskQueue::iterator best = taskQueue.end();
+    std::set<int> seenDomains;
+    fHaveNext = false;
+
+    for (TaskQueue::iterator it = taskQueue.begin(); it != taskQueue.end(); ++it) {
+        const Task& task = it->second;
+        // only the first task of a domain can run, and only if none of its tasks is running
+        if (task.domain != 0 && (runningDomains.count(task.domain) || !seenDomains.insert(task.domain).second))
+            continue;
+        if (it->first > now) {
+            next = it->first;
+            fHaveNext = true;
+            break;
+        }
+        if (best == taskQueue.end() || task.priority < best->second.priority)
+            best = it;
+    }
+    return best;
+}
+
 void CScheduler::serviceQueue()
 {
     boost::unique_lock<boost::mutex> lock(newTaskMutex);
@@ -37,42 +64,66 @@ void CScheduler::serviceQueue()
     // is called.
     while (!shouldStop()) {
         try {
-            while (!shouldStop() && taskQueue.empty()) {
-                // Wait until there is something to do.
-                newTaskScheduled.wait(lock);
-            }
-
-            // Wait until either there is a new task, or until
-            // the time of the first item on the queue:
-
+            boost::chrono::system_clock::time_point now = boost::chrono::system_clock::now();
+            boost::chrono::system_clock::time_point next;
+            bool fHaveNext;
+            TaskQueue::iterator it = selectTask(now, next, fHaveNext);
+
+            if (it == taskQueue.end()) {
+                // Wait until there is a new task, a domain becomes free
+                // or until the time of the next task that can run:
+                if (!fHaveNext) {
+                    newTaskScheduled.wait(lock);
+                } else {
 // wait_until needs boost 1.50 or later; older versions have timed_wait:
 #if BOOST_VERSION < 105000
-            while (!shouldStop() && !taskQueue.empty() &&
-                   newTaskScheduled.timed_wait(lock, toPosixTime(taskQueue.begin()->first))) {
-                // Keep waiting until timeout
-            }
+                    newTaskScheduled.timed_wait(lock, toPosixTime(next));
 #else
-            // Some boost versions have a conflicting overload of wait_until that returns void.
-            // Explicitly use a template here to avoid hitting that overload.
-            while (!shouldStop() && !taskQueue.empty()) {
-                boost::chrono::system_clock::time_point timeToWaitFor = taskQueue.begin()->first;
-                if (newTaskScheduled.wait_until<>(lock, timeToWaitFor) == boost::cv_status::timeout)
-                    break; // Exit loop after timeout, it means we reached the time of the event
-            }
+                    // Some boost versions have a conflicting overload of wait_until that returns void.
+                    // Explicitly use a template here to avoid hitting that overload.
+                    newTaskScheduled.wait_until<>(lock, next);
 #endif
-            // If there are multiple threads, the queue can empty while we're waiting (another
-            // thread may service the task we were waiting on).
-            if (shouldStop() || taskQueue.empty())
+                }
                 continue;
+            }
 
-            Function f = taskQueue.begin()->second;
-            taskQueue.erase(taskQueue.begin());
+            Task task = it->second;
+            int64_t nDelayMicros = boost::chrono::duration_cast<boost::chrono::microseconds>(now - it->first).count();
+            taskQueue.erase(it);
+            if (task.domain != 0)
+                runningDomains.insert(task.domain);
 
+            int64_t nRunMicros;
             {
                 // Unlock before calling f, so it can reschedule itself or another task
                 // without deadlocking:
                 reverse_lock<boost::unique_lock<boost::mutex> > rlock(lock);
-                f();
+                if (nDelayMicros > SCHEDULER_LOG_DELAY_MICROS)
+                    LogPrint("scheduler", "%s: task %s started %dms late\n", __func__, task.name.empty() ? "(unnamed)" : task.name, nDelayMicros / 1000);
+
+                int64_t nStart = GetTimeMicros();
+                try {
+                    task.f();
+                } catch (...) {
+                    boost::unique_lock<boost::mutex> relock(newTaskMutex);
+                    if (task.domain != 0)
+                        runningDomains.erase(task.domain);
+                    newTaskScheduled.notify_all();
+                    throw;
+                }
+                nRunMicros = GetTimeMicros() - nStart;
+            }
+
+            TaskStats& stats = taskStats[task.name];
+            stats.nRuns++;
+            stats.nTotalDelayMicros += nDelayMicros;
+            stats.nMaxDelayMicros = std::max(stats.nMaxDelayMicros, nDelayMicros);
+            stats.nTotalRunMicros += nRunMicros;
+
+            if (task.domain != 0) {
+                // threads may be waiting for the next task of the domain
+                runningDomains.erase(task.domain);
+                newTaskScheduled.notify_all();
             }
         } catch (...) {
             --nThreadsServicingQueue;
@@ -95,29 +146,37 @@ void CScheduler::stop(bool drain)
     newTaskScheduled.notify_all();
 }
 
-void CScheduler::schedule(CScheduler::Function f, boost::chrono::system_clock::time_point t)
+void CScheduler::scheduleTask(CScheduler::Function f, boost::chrono::system_clock::time_point t, Priority priority, const std::string& name, int domain)
 {
     {
         boost::unique_lock<boost::mutex> lock(newTaskMutex);
-        taskQueue.insert(std::make_pair(t, f));
+        taskQueue.insert(std::make_pair(t, Task{f, priority, name, domain}));
     }
     newTaskScheduled.notify_one();
 }
 
-void CScheduler::scheduleFromNow(CScheduler::Function f, int64_t deltaSeconds)
+void CScheduler::schedule(CScheduler::Function f, boost::chrono::system_clock::time_point t, Priority priority, const std::string& name)
 {
-    schedule(f, boost::chrono::system_clock::now() + boost::chrono::seconds(deltaSeconds));
+    scheduleTask(f, t, priority, name, 0);
 }
 
-static void Repeat(CScheduler* s, CScheduler::Function f, int64_t deltaSeconds)
+void CScheduler::scheduleFromNow(CScheduler::Function f, int64_t deltaSeconds, Priority priority, const std::string& name)
 {
-    f();
-    s->scheduleFromNow(boost::bind(&Repeat, s, f, deltaSeconds), deltaSeconds);
+    schedule(f, boost::chrono::system_clock::now() + boost::chrono::seconds(deltaSeconds), priority, name);
 }
 
-void CScheduler::scheduleEvery(CScheduler::Function f, int64_t deltaSeconds)
+void CScheduler::scheduleEveryTask(CScheduler::Function f, int64_t deltaSeconds, Priority priority, const std::string& name, int domain)
 {
-    scheduleFromNow(boost::bind(&Repeat, this, f, deltaSeconds), deltaSeconds);
+    Function repeat = [this, f, deltaSeconds, priority, name, domain]() {
+        f();
+        scheduleEveryTask(f, deltaSeconds, priority, name, domain);
+    };
+    scheduleTask(repeat, boost::chrono::system_clock::now() + boost::chrono::seconds(deltaSeconds), priority, name, domain);
+}
+
+void CScheduler::scheduleEvery(CScheduler::Function f, int64_t deltaSeconds, Priority priority, const std::string& name)
+{
+    scheduleEveryTask(f, deltaSeconds, priority, name, 0);
 }
 
 size_t CScheduler::getQueueInfo(boost::chrono::system_clock::time_point &first,
@@ -131,3 +190,47 @@ size_t CScheduler::getQueueInfo(boost::chrono::system_clock::time_point &first,
     }
     return result;
 }
+
+std::map<std::string, CScheduler::TaskStats> CScheduler::getTaskStats() const
+{
+    boost::unique_lock<boost::mutex> lock(newTaskMutex);
+    return taskStats;
+}
+
+void CScheduler::logTaskStats() const
+{
+    for (const auto& entry : getTaskStats()) {
+        const TaskStats& stats = entry.second;
+        if (stats.nRuns == 0)
+            continue;
+        LogPrint("scheduler", "%s: task %s ran %u times, delay avg %.3fms max %.3fms, run time avg %.3fms\n", __func__,
+            entry.first.empty() ? "(unnamed)" : entry.first, stats.nRuns,
+            stats.nTotalDelayMicros / 1000.0 / stats.nRuns, stats.nMaxDelayMicros / 1000.0,
+            stats.nTotalRunMicros / 1000.0 / stats.nRuns);
+    }
+}
+
+static std::atomic<int> nLastSchedulerDomain(0);
+
+SingleThreadedSchedulerClient::SingleThreadedSchedulerClient(CScheduler* pschedulerIn, CScheduler::Priority priorityIn, const std::string& nameIn)
+    : pscheduler(pschedulerIn), priority(priorityIn), name(nameIn), domain(++nLastSchedulerDomain)
+{
+}
+
+void SingleThreadedSchedulerClient::AddToProcessQueue(CScheduler::Function func)
+{
+    assert(pscheduler);
+    pscheduler->scheduleTask(func, boost::chrono::system_clock::now(), priority, name, domain);
+}
+
+void SingleThreadedSchedulerClient::scheduleFromNow(CScheduler::Function f, int64_t deltaSeconds)
+{
+    assert(pscheduler);
+    pscheduler->scheduleTask(f, boost::chrono::system_clock::now() + boost::chrono::seconds(deltaSeconds), priority, name, domain);
+}
+
+void SingleThreadedSchedulerClient::scheduleEvery(CScheduler::Function f, int64_t deltaSeconds)
+{
+    assert(pscheduler);
+    pscheduler->scheduleEveryTask(f, deltaSeconds, priority, name, domain);
+}
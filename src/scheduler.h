@@ -14,6 +14,13 @@
 #include <boost/chrono/chrono.hpp>
 #include <boost/thread.hpp>
 #include <map>
+#include <set>
+#include <string>
+
+static const int DEFAULT_SCHEDULER_THREADS = 2;
+static const int MAX_SCHEDULER_THREADS = 8;
+// Interval of the task statistics logged with -debug=scheduler
+static const int64_t SCHEDULER_STATS_INTERVAL = 10 * 60;
 
 //
 // Simple class for background tasks that should be run
@@ -32,6 +39,10 @@
 // delete t;
 // delete s; // Must be done after thread is interrupted/joined.
 //
+// Any number of threads can service the queue. Of the tasks that are due the
+// one with the highest priority runs first, tasks which must not run in
+// parallel or out of order are scheduled through a SingleThreadedSchedulerClient.
+//
 
 class CScheduler
 {
@@ -41,18 +52,32 @@ public:
 
     typedef boost::function<void(void)> Function;
 
+    enum Priority {
+        PRIORITY_HIGH = 0,
+        PRIORITY_NORMAL,
+        PRIORITY_LOW
+    };
+
+    // Queue delays and run times of the tasks with the same name
+    struct TaskStats {
+        uint64_t nRuns = 0;
+        int64_t nTotalDelayMicros = 0;
+        int64_t nMaxDelayMicros = 0;
+        int64_t nTotalRunMicros = 0;
+    };
+
     // Call func at/after time t
-    void schedule(Function f, boost::chrono::system_clock::time_point t);
+    void schedule(Function f, boost::chrono::system_clock::time_point t, Priority priority = PRIORITY_NORMAL, const std::string& name = "");
 
     // Convenience method: call f once deltaSeconds from now
-    void scheduleFromNow(Function f, int64_t deltaSeconds);
+    void scheduleFromNow(Function f, int64_t deltaSeconds, Priority priority = PRIORITY_NORMAL, const std::string& name = "");
 
     // Another convenience method: call f approximately
     // every deltaSeconds forever, starting deltaSeconds from now.
     // To be more precise: every time f is finished, it
     // is rescheduled to run deltaSeconds later. If you
     // need more accurate scheduling, don't use this method.
-    void scheduleEvery(Function f, int64_t deltaSeconds);
+    void scheduleEvery(Function f, int64_t deltaSeconds, Priority priority = PRIORITY_NORMAL, const std::string& name = "");
 
     // To keep things as simple as possible, there is no unschedule.
 
@@ -70,14 +95,67 @@ public:
     size_t getQueueInfo(boost::chrono::system_clock::time_point &first,
                         boost::chrono::system_clock::time_point &last) const;
 
+    // Returns the statistics of the serviced tasks by name, unnamed tasks are counted together
+    std::map<std::string, TaskStats> getTaskStats() const;
+
+    // Logs the statistics of the serviced tasks under the "scheduler" debug category
+    void logTaskStats() const;
+
 private:
-    std::multimap<boost::chrono::system_clock::time_point, Function> taskQueue;
+    friend class SingleThreadedSchedulerClient;
+
+    struct Task {
+        Function f;
+        Priority priority;
+        std::string name;
+        // tasks of the same serial domain run one at a time in the order of their times, 0 means none
+        int domain;
+    };
+
+    typedef std::multimap<boost::chrono::system_clock::time_point, Task> TaskQueue;
+
+    TaskQueue taskQueue;
     boost::condition_variable newTaskScheduled;
     mutable boost::mutex newTaskMutex;
     int nThreadsServicingQueue;
     bool stopRequested;
     bool stopWhenEmpty;
+    std::set<int> runningDomains;
+    std::map<std::string, TaskStats> taskStats;
+
     bool shouldStop() { return stopRequested || (stopWhenEmpty && taskQueue.empty()); }
+
+    void scheduleTask(Function f, boost::chrono::system_clock::time_point t, Priority priority, const std::string& name, int domain);
+    void scheduleEveryTask(Function f, int64_t deltaSeconds, Priority priority, const std::string& name, int domain);
+
+    // Returns the due task to run next or taskQueue.end() if there is none, in which case next is set to the time
+    // of the next task that can run unless all of them wait for their domains
+    TaskQueue::iterator selectTask(boost::chrono::system_clock::time_point now, boost::chrono::system_clock::time_point& next, bool& fHaveNext);
+};
+
+/**
+ * Serial ordering domain on a scheduler: the callbacks scheduled through the
+ * same client never run in parallel and run in the order they are due, while
+ * other tasks can be serviced by the remaining threads in the meantime.
+ *
+ * The client only holds the domain, so it can go away before its callbacks run.
+ */
+class SingleThreadedSchedulerClient
+{
+public:
+    explicit SingleThreadedSchedulerClient(CScheduler* pschedulerIn, CScheduler::Priority priorityIn = CScheduler::PRIORITY_NORMAL, const std::string& nameIn = "");
+
+    // Runs func on the scheduler after the callbacks of this client which are already due
+    void AddToProcessQueue(CScheduler::Function func);
+
+    void scheduleFromNow(CScheduler::Function f, int64_t deltaSeconds);
+    void scheduleEvery(CScheduler::Function f, int64_t deltaSeconds);
+
+private:
+    CScheduler* pscheduler;
+    CScheduler::Priority priority;
+    std::string name;
+    int domain;
 };
 
 #endif
@@ -13,6 +13,8 @@
 #include "sigma/coin.h"
 #include "primitives/mint_spend.h"
 #include "batchproof_container.h"
+#include "coinsetcache.h"
+#include "spendproofcache.h"
 
 #include <atomic>
 #include <sstream>
@@ -265,6 +267,7 @@ bool CheckSigmaSpendTransaction(
         // find index for block with hash of accumulatorBlockHash or set index to the coinGroup.firstBlock if not found
         while (index != coinGroup.firstBlock && index->GetBlockHash() != accumulatorBlockHash)
             index = index->pprev;
+        uint256 setEndBlockHash = index->GetBlockHash();
 
         // Build a vector with all the public coins with given denomination and accumulator id before
         // the block on which the spend occured.
@@ -294,13 +297,23 @@ bool CheckSigmaSpendTransaction(
                 return state.DoS(1, error("Incorrect sigma spend transaction version"));
         }
 
-        BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
-        // if we are collecting proofs, skip verification and collect proofs
-        passVerify = spend->Verify(anonymity_set, newMetaData, fPadding, batchProofContainer->fCollectProofs);
-
-        // add proofs into container
-        if(batchProofContainer->fCollectProofs) {
-            batchProofContainer->add(spend.get(), fPadding, coinGroupId, anonymity_set.size(), nHeight >= params.nStartSigmaBlacklist);
+        CSpendProofCacheEntry proofCacheEntry(tx.GetHash());
+        proofCacheEntry << vinIndex << setEndBlockHash << (uint64_t)anonymity_set.size() << fPadding << (nHeight >= params.nStartSigmaBlacklist);
+        uint256 proofCacheHash = proofCacheEntry.GetHash();
+
+        if (IsSpendProofCached(proofCacheHash)) {
+            passVerify = true;
+        } else {
+            BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
+            // if we are collecting proofs, skip verification and collect proofs
+            passVerify = spend->Verify(anonymity_set, newMetaData, fPadding, batchProofContainer->fCollectProofs);
+
+            // add proofs into container
+            if(batchProofContainer->fCollectProofs) {
+                batchProofContainer->add(spend.get(), fPadding, coinGroupId, anonymity_set.size(), nHeight >= params.nStartSigmaBlacklist);
+            } else if (passVerify) {
+                AddSpendProofToCache(proofCacheHash);
+            }
         }
 
         if (passVerify) {
@@ -547,8 +560,57 @@ void RemoveSigmaSpendsReferencingBlock(CTxMemPool& pool, CBlockIndex* blockIndex
     }
 }
 
-void DisconnectTipSigma(CBlock& block, CBlockIndex *pindexDelete) {
+// Collects the mints and spends of a block the state counts, the block is the last one of the groups it has coins in
+static CSigmaBlockUpdate GetBlockUpdate(const CBlockIndex *pindex, bool fConnected) {
+    CSigmaBlockUpdate update;
+    update.blockHash = pindex->GetBlockHash();
+    update.nHeight = pindex->nHeight;
+    update.fConnected = fConnected;
+
+    for (const auto& groupCoins : pindex->sigmaMintedPubCoins) {
+        CSigmaState::SigmaCoinGroupInfo coinGroup;
+        if (groupCoins.second.empty() || !sigmaState.GetCoinGroupInfo(groupCoins.first.first, groupCoins.first.second, coinGroup))
+            continue;
+
+        int index = coinGroup.nCoins - groupCoins.second.size();
+        for (const auto& coin : groupCoins.second)
+            update.mints.push_back({groupCoins.first.second, index++, coin});
+    }
+
+    update.spentSerials.assign(pindex->sigmaSpentSerials.begin(), pindex->sigmaSpentSerials.end());
+    return update;
+}
+
+// Adds the groups having an id above the one in previousIds
+static void AddNewCoinGroups(
+        CSigmaBlockUpdate& update,
+        const std::unordered_map<CoinDenomination, int>& previousIds,
+        const std::unordered_map<CoinDenomination, int>& latestIds) {
+    for (const auto& latestId : latestIds) {
+        auto it = previousIds.find(latestId.first);
+        for (int id = (it == previousIds.end() ? 0 : it->second) + 1; id <= latestId.second; id++)
+            update.newCoinGroups.push_back(CSpendCoinInfo::make(latestId.first, id));
+    }
+}
+
+CSigmaBlockUpdate GetConnectedBlockUpdate(const CBlockIndex *pindex, const std::unordered_map<CoinDenomination, int>& previousLatestCoinIds) {
+    CSigmaBlockUpdate update = GetBlockUpdate(pindex, true);
+    AddNewCoinGroups(update, previousLatestCoinIds, sigmaState.GetLatestCoinIds());
+    return update;
+}
+
+void DisconnectTipSigma(CBlock& block, CBlockIndex *pindexDelete, CSigmaBlockUpdate *update) {
+    // the positions of the coins are taken from the state which still has the block
+    if (update)
+        *update = GetBlockUpdate(pindexDelete, false);
+    auto latestCoinIds = sigmaState.GetLatestCoinIds();
+
     sigmaState.RemoveBlock(pindexDelete);
+    // the group may start at another block once the chain is reorganized
+    lelantus::sigmaToLelantusSetCache.RemoveBlock(pindexDelete);
+
+    if (update)
+        AddNewCoinGroups(*update, sigmaState.GetLatestCoinIds(), latestCoinIds);
 
     // Also remove from mempool sigma spends that reference given block hash.
     RemoveSigmaSpendsReferencingBlock(mempool, pindexDelete);
@@ -1190,6 +1252,7 @@ void CSigmaState::Reset() {
     mempoolCoinSerials.clear();
     mempoolMints.clear();
     containers.Reset();
+    lelantus::sigmaToLelantusSetCache.Clear();
 }
 
 CSigmaState* CSigmaState::GetState() {
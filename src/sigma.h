@@ -44,6 +44,35 @@ public:
     void Complete();
 };
 
+// Changes of the Sigma state made by a block connected to or disconnected from the tip, for notifications
+struct CSigmaBlockUpdate {
+    struct Mint {
+        int coinGroupId;
+        // position of the coin in the group of its denomination
+        int index;
+        PublicCoin coin;
+
+        ADD_SERIALIZE_METHODS;
+
+        template <typename Stream, typename Operation>
+        inline void SerializationOp(Stream& s, Operation ser_action) {
+            READWRITE(coinGroupId);
+            READWRITE(index);
+            READWRITE(coin);
+        }
+    };
+
+    uint256 blockHash;
+    int nHeight;
+    // false if the block was disconnected, the changes are reverted then
+    bool fConnected;
+
+    std::vector<Mint> mints;
+    std::vector<std::pair<Scalar, CSpendCoinInfo>> spentSerials;
+    // denominations and ids of the groups started by the block, which are removed again when it's disconnected
+    std::vector<CSpendCoinInfo> newCoinGroups;
+};
+
 bool IsSigmaAllowed();
 bool IsSigmaAllowed(int height);
 
@@ -72,7 +101,15 @@ bool CheckSigmaTransaction(
   bool fStatefulSigmaCheck,
   CSigmaTxInfo *sigmaTxInfo);
 
-void DisconnectTipSigma(CBlock &block, CBlockIndex *pindexDelete);
+/*
+ * Changes the block made to the state once it's connected, previousLatestCoinIds are the latest coin group ids before.
+ */
+CSigmaBlockUpdate GetConnectedBlockUpdate(const CBlockIndex *pindex, const std::unordered_map<CoinDenomination, int>& previousLatestCoinIds);
+
+/*
+ * Removes the block from the state, update receives the changes it reverts if not null.
+ */
+void DisconnectTipSigma(CBlock &block, CBlockIndex *pindexDelete, CSigmaBlockUpdate *update = nullptr);
 
 bool ConnectBlockSigma(
   CValidationState& state,
@@ -0,0 +1,84 @@
+#include "spendproofcache.h"
+
+#include "random.h"
+#include "util.h"
+#include "version.h"
+
+#include "cuckoocache.h"
+#include <boost/thread.hpp>
+
+namespace {
+
+// Entries are already hashed with a random nonce, so any 32 bits of them can be used as a hash
+class SpendProofCacheHasher
+{
+public:
+    template <uint8_t hash_select>
+    uint32_t operator()(const uint256& key) const
+    {
+        static_assert(hash_select < 8, "SpendProofCacheHasher only has 8 hashes available.");
+        uint32_t u;
+        std::memcpy(&u, key.begin() + 4 * hash_select, 4);
+        return u;
+    }
+};
+
+class CSpendProofCache
+{
+public:
+    CSpendProofCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    const uint256& GetNonce() const { return nonce; }
+
+    bool Get(const uint256& entry)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+        return setValid.contains(entry, false);
+    }
+
+    void Set(const uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        setValid.insert(entry);
+    }
+
+    uint32_t setup_bytes(size_t n)
+    {
+        return setValid.setup_bytes(n);
+    }
+
+private:
+    uint256 nonce;
+    CuckooCache::cache<uint256, SpendProofCacheHasher> setValid;
+    boost::shared_mutex cs_proofcache;
+};
+
+CSpendProofCache spendProofCache;
+
+} // unnamed namespace
+
+CSpendProofCacheEntry::CSpendProofCacheEntry(const uint256& txHash) : hasher(SER_GETHASH, PROTOCOL_VERSION)
+{
+    hasher << spendProofCache.GetNonce() << txHash;
+}
+
+bool IsSpendProofCached(const uint256& entry)
+{
+    return spendProofCache.Get(entry);
+}
+
+void AddSpendProofToCache(const uint256& entry)
+{
+    spendProofCache.Set(entry);
+}
+
+void InitSpendProofCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, GetArg("-maxspendproofcachesize", DEFAULT_MAX_SPEND_PROOF_CACHE_SIZE)), MAX_MAX_SPEND_PROOF_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = spendProofCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for spend proof cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
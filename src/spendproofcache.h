@@ -0,0 +1,48 @@
+#ifndef FIRO_SPENDPROOFCACHE_H
+#define FIRO_SPENDPROOFCACHE_H
+
+#include "hash.h"
+#include "uint256.h"
+
+// Limit the cache to 4MB (over 130000 entries)
+static const unsigned int DEFAULT_MAX_SPEND_PROOF_CACHE_SIZE = 4;
+// Maximum spend proof cache size allowed
+static const int64_t MAX_MAX_SPEND_PROOF_CACHE_SIZE = 1024;
+
+/**
+ * Entry of a Sigma or Lelantus spend proof in the cache of verified proofs.
+ *
+ * The entry starts with a random nonce and the transaction hash, the caller then adds everything else the
+ * verification depends on, that is the blocks ending the anonymity sets, their sizes and the consensus flags.
+ */
+class CSpendProofCacheEntry
+{
+public:
+    explicit CSpendProofCacheEntry(const uint256& txHash);
+
+    template <typename T>
+    CSpendProofCacheEntry& operator<<(const T& obj)
+    {
+        hasher << obj;
+        return *this;
+    }
+
+    // invalidates the object
+    uint256 GetHash() { return hasher.GetHash(); }
+
+private:
+    CHashWriter hasher;
+};
+
+/**
+ * Spend proofs are verified when the transaction enters the mempool, then again by TestBlockValidity() for
+ * every block template and once more when the block is connected. The proofs which passed are remembered so
+ * the later checks can skip them.
+ */
+bool IsSpendProofCached(const uint256& entry);
+void AddSpendProofToCache(const uint256& entry);
+
+// To be called once in AppInit2/TestingSetup
+void InitSpendProofCache();
+
+#endif // FIRO_SPENDPROOFCACHE_H
@@ -357,4 +357,59 @@ struct CAddressIndexIteratorHeightKey {
     }
 };
 
+struct CAddressBalanceValue {
+    CAmount balance;
+    CAmount received;
+    int64_t unspentCount;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(balance);
+        READWRITE(received);
+        READWRITE(unspentCount);
+    }
+
+    CAddressBalanceValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        balance = 0;
+        received = 0;
+        unspentCount = 0;
+    }
+};
+
+struct CElysiumMarkerIndexKey {
+    int blockHeight;
+    unsigned int txIndex;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata32be(s, blockHeight);
+        ser_writedata32be(s, txIndex);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        blockHeight = ser_readdata32be(s);
+        txIndex = ser_readdata32be(s);
+    }
+
+    CElysiumMarkerIndexKey(int height, unsigned int index) {
+        blockHeight = height;
+        txIndex = index;
+    }
+
+    CElysiumMarkerIndexKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        blockHeight = 0;
+        txIndex = 0;
+    }
+};
+
 #endif // BITCOIN_SPENTINDEX_H
@@ -322,6 +322,39 @@ BOOST_AUTO_TEST_CASE(address_match)
     }
 }
 
+BOOST_AUTO_TEST_CASE(address_index)
+{
+    bip47::CWallet wallet(GetRandHash());
+    bip47::CAccountReceiver & receiver = wallet.createReceivingAccount("index");
+    BOOST_CHECK(wallet.findReceiverByAddress(receiver.getMyNotificationAddress(), true) == &receiver);
+
+    CExtKey keyAlice; keyAlice.SetMaster(alice::bip32seed.data(), alice::bip32seed.size());
+    bip47::CAccountSender sender(keyAlice, 0, receiver.getMyPcode());
+    receiver.acceptPcode(sender.getMyPcode());
+
+    CBitcoinAddress first = sender.generateTheirNextSecretAddress();
+    BOOST_CHECK(wallet.findReceiverByAddress(first) == nullptr);
+    wallet.updateAddressIndex(receiver);
+    BOOST_CHECK(wallet.findReceiverByAddress(first) == &receiver);
+    BOOST_CHECK(wallet.findReceiverByAddress(first, true) == nullptr);
+
+    // the address after the lookahead window is indexed once the first one is used
+    std::vector<CBitcoinAddress> addrs(1, first);
+    for (size_t i = 0; i < bip47::AddressLookaheadNumber; ++i)
+        addrs.push_back(sender.generateTheirNextSecretAddress());
+    BOOST_CHECK(wallet.findReceiverByAddress(addrs.back()) == nullptr);
+
+    BOOST_CHECK(wallet.markAddressUsed(first) == &receiver);
+    BOOST_CHECK(wallet.findReceiverByAddress(first) == nullptr);
+    BOOST_CHECK(wallet.findReceiverByAddress(addrs.back()) == &receiver);
+
+    MyAddrContT used = receiver.getMyUsedAddresses();
+    BOOST_CHECK_EQUAL(used.size(), 1U);
+    BOOST_CHECK(used[0].first == first);
+
+    CKey other;
+    other.MakeNewKey(true);
+    BOOST_CHECK(wallet.markAddressUsed(CBitcoinAddress(other.GetPubKey().GetID())) == nullptr);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
-        
\ No newline at end of file
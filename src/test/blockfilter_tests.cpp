@@ -0,0 +1,116 @@
+#include "blockfilter.h"
+
+#include "primitives/block.h"
+#include "random.h"
+#include "script/standard.h"
+
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(blockfilter_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(gcsfilter_match)
+{
+    uint256 blockHash = GetRandHash();
+
+    std::vector<GCSFilter::Element> included, excluded;
+    for (int i = 0; i < 100; i++) {
+        included.push_back(GetFilterElement(GetRandHash()));
+    }
+    for (int i = 0; i < 10000; i++) {
+        excluded.push_back(GetFilterElement(GetRandHash()));
+    }
+
+    // duplicates are encoded once
+    std::vector<GCSFilter::Element> elements(included);
+    elements.push_back(included[0]);
+
+    GCSFilter filter(blockHash, elements);
+    BOOST_CHECK_EQUAL(filter.GetN(), included.size());
+
+    GCSFilter decoded(blockHash, filter.GetEncoded());
+    BOOST_CHECK_EQUAL(decoded.GetN(), filter.GetN());
+
+    for (const GCSFilter::Element& element : included) {
+        BOOST_CHECK(filter.Match(element));
+        BOOST_CHECK(decoded.Match(element));
+        BOOST_CHECK(decoded.MatchAny({excluded[0], element, excluded[1]}));
+    }
+
+    // the false positive rate is 1/M, so a few hits at most
+    int falsePositives = 0;
+    for (const GCSFilter::Element& element : excluded) {
+        if (decoded.Match(element)) {
+            falsePositives++;
+        }
+    }
+    BOOST_CHECK_LT(falsePositives, 5);
+
+    // the same elements are hashed differently for another block
+    GCSFilter other(GetRandHash(), filter.GetEncoded());
+    int otherMatches = 0;
+    for (const GCSFilter::Element& element : included) {
+        if (other.Match(element)) {
+            otherMatches++;
+        }
+    }
+    BOOST_CHECK_LT(otherMatches, 5);
+}
+
+BOOST_AUTO_TEST_CASE(gcsfilter_empty)
+{
+    uint256 blockHash = GetRandHash();
+    GCSFilter filter(blockHash, std::vector<GCSFilter::Element>());
+    BOOST_CHECK_EQUAL(filter.GetN(), 0U);
+    BOOST_CHECK(!filter.Match(GetFilterElement(GetRandHash())));
+
+    GCSFilter decoded(blockHash, filter.GetEncoded());
+    BOOST_CHECK(!decoded.MatchAny({GetFilterElement(GetRandHash())}));
+
+    BOOST_CHECK_THROW(GCSFilter(blockHash, std::vector<unsigned char>()), std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_CASE(block_filter)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CScript payee = GetScriptForDestination(key.GetPubKey().GetID());
+    CScript dataScript = CScript() << OP_RETURN << std::vector<unsigned char>(4, 0x01);
+    COutPoint spent(GetRandHash(), 1);
+
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << 1 << OP_0;
+    coinbase.vout.resize(1);
+    coinbase.vout[0].nValue = 50 * COIN;
+    coinbase.vout[0].scriptPubKey = CScript() << OP_TRUE;
+
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = spent;
+    tx.vout.resize(2);
+    tx.vout[0].nValue = COIN;
+    tx.vout[0].scriptPubKey = payee;
+    tx.vout[1].nValue = 0;
+    tx.vout[1].scriptPubKey = dataScript;
+
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    block.vtx.push_back(MakeTransactionRef(tx));
+
+    GCSFilter filter = BuildBlockFilter(block);
+    BOOST_CHECK_EQUAL(filter.GetN(), 3U);
+
+    GCSFilter decoded(block.GetHash(), filter.GetEncoded());
+    BOOST_CHECK(decoded.Match(GetFilterElement(payee)));
+    BOOST_CHECK(decoded.Match(GetFilterElement(spent)));
+    BOOST_CHECK(decoded.Match(GetFilterElement(coinbase.vout[0].scriptPubKey)));
+    BOOST_CHECK(!decoded.Match(GetFilterElement(dataScript)));
+    BOOST_CHECK(!decoded.Match(GetFilterElement(coinbase.vin[0].prevout)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,183 @@
+#include "blockfilter.h"
+
+#include "chainparams.h"
+#include "hash.h"
+#include "lelantus.h"
+#include "primitives/mint_spend.h"
+#include "script/sign.h"
+#include "script/standard.h"
+#include "validation.h"
+
+#include "test/fixtures.h"
+#include "test/testutil.h"
+
+#include "wallet/wallet.h"
+#include "wallet/walletdb.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+static bool HasElement(const std::vector<GCSFilter::Element>& elements, const GCSFilter::Element& element)
+{
+    return std::find(elements.begin(), elements.end(), element) != elements.end();
+}
+
+static CMutableTransaction CreateSpend(const CTransaction& prevTx, uint32_t n, const CKey& key, const CScript& scriptCode,
+    bool fPushPubKey, const CScript& payee)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = COutPoint(prevTx.GetHash(), n);
+    tx.vout.resize(1);
+    tx.vout[0].nValue = prevTx.vout[n].nValue - CENT;
+    tx.vout[0].scriptPubKey = payee;
+
+    uint256 hash = SignatureHash(scriptCode, tx, 0, SIGHASH_ALL, prevTx.vout[n].nValue, SIGVERSION_BASE);
+    std::vector<unsigned char> vchSig;
+    BOOST_CHECK(key.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    tx.vin[0].scriptSig << vchSig;
+    if (fPushPubKey)
+        tx.vin[0].scriptSig << ToByteVector(key.GetPubKey());
+    return tx;
+}
+
+BOOST_FIXTURE_TEST_SUITE(blockfilter_wallet_tests, LelantusTestingSetup)
+
+BOOST_AUTO_TEST_CASE(lelantus_elements)
+{
+    GenerateBlocks(1000);
+
+    pwalletMain->SetBroadcastTransactions(true);
+
+    std::vector<CMutableTransaction> mintTxs;
+    auto hdMints = GenerateMints({50 * COIN, 60 * COIN}, mintTxs);
+    CBlockIndex* mintIndex = GenerateBlock(mintTxs);
+    BOOST_REQUIRE(mintIndex);
+
+    CBlock mintBlock;
+    BOOST_REQUIRE(ReadBlockFromDisk(mintBlock, mintIndex, Params().GetConsensus()));
+    std::vector<GCSFilter::Element> elements = GetBlockFilterElements(mintBlock);
+    GCSFilter mintFilter = BuildBlockFilter(mintBlock);
+
+    // the mint tag is the hash of the pubcoin without the value and the seed of the mint
+    for (const CHDMint& hdMint : hdMints) {
+        auto pubcoin = hdMint.GetPubcoinValue() +
+                       lelantus::Params::get_default()->get_h1() * Scalar(hdMint.GetAmount()).negate();
+        CDataStream ss(SER_GETHASH, 0);
+        ss << primitives::GetPubCoinValueHash(pubcoin);
+        ss << hdMint.GetSeedId();
+        uint256 mintTag = Hash(ss.begin(), ss.end());
+
+        BOOST_CHECK(HasElement(elements, GetFilterElement(hdMint.GetPubCoinHash())));
+        BOOST_CHECK(HasElement(elements, GetFilterElement(mintTag)));
+        BOOST_CHECK(mintFilter.Match(GetFilterElement(hdMint.GetPubCoinHash())));
+        BOOST_CHECK(mintFilter.Match(GetFilterElement(mintTag)));
+    }
+
+    // the wallet recognizes its mints by the pubcoin hashes
+    GCSFilter::ElementSet query;
+    std::set<CKeyID> queryKeys;
+    {
+        LOCK2(cs_main, pwalletMain->cs_wallet);
+        pwalletMain->GetBlockFilterQuery(query, queryKeys);
+    }
+    for (const CHDMint& hdMint : hdMints) {
+        BOOST_CHECK(query.count(GetFilterElement(hdMint.GetPubCoinHash())));
+        BOOST_CHECK(query.count(GetFilterElement(hdMint.GetSerialHash())));
+    }
+    BOOST_CHECK(mintFilter.MatchAny(query));
+
+    GenerateBlock({});
+
+    CPubKey newKey;
+    BOOST_REQUIRE(pwalletMain->GetKeyFromPool(newKey));
+    std::vector<CRecipient> recipients = {
+        {GetScriptForDestination(newKey.GetID()), 30 * COIN, true},
+    };
+
+    CWalletTx wtx;
+    BOOST_CHECK_NO_THROW(pwalletMain->JoinSplitLelantus(recipients, {}, wtx));
+    CBlockIndex* joinSplitIndex = GenerateBlock({CMutableTransaction(*wtx.tx)});
+    BOOST_REQUIRE(joinSplitIndex);
+
+    CBlock joinSplitBlock;
+    BOOST_REQUIRE(ReadBlockFromDisk(joinSplitBlock, joinSplitIndex, Params().GetConsensus()));
+    elements = GetBlockFilterElements(joinSplitBlock);
+    GCSFilter joinSplitFilter = BuildBlockFilter(joinSplitBlock);
+
+    // the serials of the joinsplit are the serials of the spent mints
+    std::vector<Scalar> serials = lelantus::GetLelantusJoinSplitSerialNumbers(*wtx.tx, wtx.tx->vin[0]);
+    BOOST_CHECK(!serials.empty());
+    for (const Scalar& serial : serials) {
+        uint256 serialHash = primitives::GetSerialHash(serial);
+        BOOST_CHECK(HasElement(elements, GetFilterElement(serialHash)));
+        BOOST_CHECK(joinSplitFilter.Match(GetFilterElement(serialHash)));
+        BOOST_CHECK(std::any_of(hdMints.begin(), hdMints.end(), [&serialHash](const CHDMint& hdMint) {
+            return hdMint.GetSerialHash() == serialHash;
+        }));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rescan)
+{
+    pblockfilterdb = new CBlockFilterDB(1 << 20, true, true);
+
+    CKey key, otherKey;
+    key.MakeNewKey(true);
+    otherKey.MakeNewKey(true);
+    CScript payee = GetScriptForDestination(key.GetPubKey().GetID());
+    CScript otherPayee = GetScriptForDestination(otherKey.GetPubKey().GetID());
+
+    GenerateBlocks(10, &otherPayee);
+    CBlockIndex* start = chainActive.Tip();
+
+    // a payment to the key and a spend of it to someone else, which only the prevout commits to
+    CScript coinbaseScript = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction payment = CreateSpend(coinbaseTxns[0], 0, coinbaseKey, coinbaseScript, false, payee);
+    CBlockIndex* paymentIndex = GenerateBlock({payment}, &otherPayee);
+    BOOST_REQUIRE(paymentIndex);
+    GenerateBlocks(5, &otherPayee);
+
+    CMutableTransaction spend = CreateSpend(payment, 0, key, payee, true, otherPayee);
+    CBlockIndex* spendIndex = GenerateBlock({spend}, &otherPayee);
+    BOOST_REQUIRE(spendIndex);
+    GenerateBlocks(5, &otherPayee);
+
+    CWallet wallet("wallet_rescan_test.dat");
+    {
+        LOCK2(cs_main, wallet.cs_wallet);
+        BOOST_CHECK(wallet.AddKeyPubKey(key, key.GetPubKey()));
+    }
+
+    // the spend is only found after the outputs of the payment are added to the query
+    GCSFilter::ElementSet query;
+    std::set<CKeyID> queryKeys;
+    {
+        LOCK2(cs_main, wallet.cs_wallet);
+        wallet.GetBlockFilterQuery(query, queryKeys);
+    }
+    BOOST_CHECK_EQUAL(queryKeys.size(), 1U);
+    std::vector<unsigned char> encodedFilter;
+    BOOST_REQUIRE(pblockfilterdb->ReadFilter(paymentIndex->GetBlockHash(), encodedFilter));
+    BOOST_CHECK(GCSFilter(paymentIndex->GetBlockHash(), encodedFilter).MatchAny(query));
+    BOOST_REQUIRE(pblockfilterdb->ReadFilter(spendIndex->GetBlockHash(), encodedFilter));
+    BOOST_CHECK(!GCSFilter(spendIndex->GetBlockHash(), encodedFilter).MatchAny(query));
+
+    BOOST_CHECK_EQUAL(wallet.ScanForWalletTransactions(start), start);
+    {
+        LOCK2(cs_main, wallet.cs_wallet);
+        BOOST_CHECK_EQUAL(wallet.mapWallet.size(), 2U);
+        BOOST_CHECK(wallet.mapWallet.count(payment.GetHash()));
+        BOOST_CHECK(wallet.mapWallet.count(spend.GetHash()));
+        BOOST_CHECK(wallet.IsSpent(payment.GetHash(), 0));
+    }
+
+    delete pblockfilterdb;
+    pblockfilterdb = nullptr;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+#include "chainsnapshot.h"
+
+#include "chain.h"
+#include "chainparams.h"
+#include "consensus/validation.h"
+#include "validation.h"
+
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Appends count blocks to the chain ending at pindexPrev, the entries are kept in blocks
+CBlockIndex* BuildBranch(std::vector<std::unique_ptr<CBlockIndex>>& blocks, CBlockIndex* pindexPrev, int count)
+{
+    for (int i = 0; i < count; i++) {
+        std::unique_ptr<CBlockIndex> block(new CBlockIndex());
+        block->pprev = pindexPrev;
+        block->nHeight = pindexPrev ? pindexPrev->nHeight + 1 : 0;
+        block->BuildSkip();
+        pindexPrev = block.get();
+        blocks.push_back(std::move(block));
+    }
+    return pindexPrev;
+}
+
+void CheckSnapshot(const CChainSnapshot& snapshot, const CChain& chain)
+{
+    BOOST_CHECK_EQUAL(snapshot.Height(), chain.Height());
+    BOOST_CHECK(snapshot.Tip() == chain.Tip());
+    for (int height = 0; height <= chain.Height(); height++) {
+        BOOST_REQUIRE(snapshot[height] == chain[height]);
+        BOOST_CHECK(snapshot.Contains(chain[height]));
+        BOOST_CHECK(snapshot.Next(chain[height]) == chain.Next(chain[height]));
+    }
+    BOOST_CHECK(snapshot[-1] == nullptr);
+    BOOST_CHECK(snapshot[chain.Height() + 1] == nullptr);
+}
+
+} // unnamed namespace
+
+BOOST_FIXTURE_TEST_SUITE(chainsnapshot_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    CChainSnapshot snapshot;
+    BOOST_CHECK_EQUAL(snapshot.Height(), -1);
+    BOOST_CHECK(snapshot.Tip() == nullptr);
+    BOOST_CHECK(snapshot[0] == nullptr);
+    BOOST_CHECK(!snapshot.Contains(nullptr));
+}
+
+BOOST_AUTO_TEST_CASE(reorg)
+{
+    LOCK(cs_main);
+
+    std::vector<std::unique_ptr<CBlockIndex>> blocks;
+    CBlockIndex* tip = BuildBranch(blocks, nullptr, 3000);
+
+    CChain chain;
+    chain.SetTip(tip);
+    CChainSnapshot first(chain, nullptr);
+    CheckSnapshot(first, chain);
+
+    // extend the chain over a chunk boundary
+    tip = BuildBranch(blocks, tip, 100);
+    chain.SetTip(tip);
+    CChainSnapshot extended(chain, &first);
+    CheckSnapshot(extended, chain);
+
+    // replace the blocks after height 1500 by another branch, which is shorter
+    CBlockIndex* fork = chain[1500];
+    tip = BuildBranch(blocks, fork, 1000);
+    chain.SetTip(tip);
+    CChainSnapshot reorganized(chain, &extended);
+    CheckSnapshot(reorganized, chain);
+    BOOST_CHECK(!reorganized.Contains(extended.Tip()));
+    BOOST_CHECK(reorganized.Next(fork) == chain[1501]);
+
+    // older snapshots are not changed
+    BOOST_CHECK_EQUAL(first.Height(), 2999);
+    BOOST_CHECK_EQUAL(extended.Height(), 3099);
+    BOOST_CHECK(extended.Contains(extended[2000]));
+    BOOST_CHECK(!extended.Contains(chain[2000]));
+}
+
+BOOST_FIXTURE_TEST_CASE(best_header, TestChain100Setup)
+{
+    BOOST_CHECK(GetBestHeader() == chainActive.Tip());
+
+    // a header without its block is ahead of the snapshot
+    CBlock block = CreateBlock({}, coinbaseKey);
+    CValidationState state;
+    const CBlockIndex* pindex = nullptr;
+    BOOST_REQUIRE(ProcessNewBlockHeaders({block.GetBlockHeader()}, state, Params(), &pindex));
+
+    BOOST_REQUIRE(pindex);
+    BOOST_CHECK(GetBestHeader() == pindex);
+    BOOST_CHECK_EQUAL(GetBestHeader()->nHeight, GetChainSnapshot()->Height() + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
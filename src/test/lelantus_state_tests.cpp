@@ -1,3 +1,4 @@
+#include "../coinsetcache.h"
 #include "../lelantus.h"
 #include "../validation.h"
 
@@ -505,6 +506,133 @@ BOOST_AUTO_TEST_CASE(get_coin_group)
     lelantusState->Reset();
 }
 
+BOOST_AUTO_TEST_CASE(get_coins_since)
+{
+    GenerateBlocks(120);
+
+    std::vector<CAmount> amounts(8, COIN);
+    std::vector<CMutableTransaction> txs;
+
+    auto mints = GenerateMints(amounts, txs);
+
+    std::vector<std::pair<PublicCoin, uint256>> coins;
+    std::vector<CBlockIndex*> indexes;
+
+    CLelantusState state(6, 2);
+
+    for (size_t i = 0; i != mints.size(); i += 2) {
+        auto index = GenerateBlock({txs[i], txs[i + 1]});
+        auto block = GetCBlock(index);
+        coins.emplace_back(PublicCoin(mints[i].GetPubcoinValue()), txs[i].GetHash());
+        coins.emplace_back(PublicCoin(mints[i + 1].GetPubcoinValue()), txs[i + 1].GetHash());
+
+        PopulateLelantusTxInfo(
+            block,
+            {
+                {mints[i].GetPubcoinValue(), {1, txs[i].GetHash()}},
+                {mints[i + 1].GetPubcoinValue(), {1, txs[i + 1].GetHash()}}
+            }, {});
+
+        state.AddMintsToStateAndBlockIndex(index, &block);
+        indexes.push_back(index);
+
+        GenerateBlock({});
+    }
+
+    // 8 coins, 1(6), 2(4) with the last 2 coins of group 1
+    auto verifyCoins = [&](int id, CBlockIndex const *start, size_t i, size_t j, CBlockIndex const *expectedBlock) {
+        uint256 blockHash;
+        std::vector<std::pair<PublicCoin, uint256>> coinsOut;
+        std::vector<unsigned char> setHash;
+
+        BOOST_CHECK_EQUAL(int(j - i), state.GetCoinsSince(
+            &chainActive,
+            chainActive.Height(),
+            id,
+            start,
+            blockHash,
+            coinsOut,
+            setHash));
+
+        std::vector<std::pair<PublicCoin, uint256>> expected(coins.begin() + i, coins.begin() + j);
+        BOOST_CHECK(expected == coinsOut);
+        BOOST_CHECK(expectedBlock->GetBlockHash() == blockHash);
+    };
+
+    verifyCoins(1, nullptr, 0, 6, indexes[2]);
+    verifyCoins(1, indexes[0], 2, 6, indexes[2]);
+    verifyCoins(1, indexes[2], 6, 6, indexes[2]);
+
+    verifyCoins(2, nullptr, 4, 8, indexes[3]);
+    verifyCoins(2, indexes[2], 6, 8, indexes[3]);
+    verifyCoins(2, chainActive.Tip(), 8, 8, indexes[3]);
+
+    // blocks above max height are left out, group 2 starts above it
+    uint256 blockHash;
+    std::vector<std::pair<PublicCoin, uint256>> coinsOut;
+    std::vector<unsigned char> setHash;
+
+    BOOST_CHECK_EQUAL(4, state.GetCoinsSince(&chainActive, indexes[1]->nHeight, 1, nullptr, blockHash, coinsOut, setHash));
+    std::vector<std::pair<PublicCoin, uint256>> expected(coins.begin(), coins.begin() + 4);
+    BOOST_CHECK(expected == coinsOut);
+    BOOST_CHECK(indexes[1]->GetBlockHash() == blockHash);
+
+    BOOST_CHECK_EQUAL(0, state.GetCoinsSince(&chainActive, indexes[1]->nHeight, 2, nullptr, blockHash, coinsOut, setHash));
+    BOOST_CHECK(coinsOut.empty());
+}
+
+BOOST_AUTO_TEST_CASE(coin_set_cache)
+{
+    GenerateBlocks(400);
+
+    std::vector<CMutableTransaction> txs;
+    auto mints = GenerateMints({COIN, 2 * COIN}, txs);
+    auto index = GenerateBlock(txs);
+    BOOST_REQUIRE(index);
+
+    std::shared_ptr<const CAnonymitySetUpdate> anonymitySet;
+    {
+        LOCK(cs_main);
+        anonymitySet = coinSetCache.GetAnonymitySet(1, uint256());
+        BOOST_REQUIRE(anonymitySet);
+        BOOST_CHECK_EQUAL(anonymitySet->coins.size(), 2U);
+        BOOST_CHECK(anonymitySet->blockHash == index->GetBlockHash());
+
+        // the same response is served until the tip changes
+        BOOST_CHECK(coinSetCache.GetAnonymitySet(1, uint256()) == anonymitySet);
+
+        auto update = coinSetCache.GetAnonymitySet(1, index->GetBlockHash());
+        BOOST_REQUIRE(update);
+        BOOST_CHECK(update->coins.empty());
+        BOOST_CHECK(update->blockHash == index->GetBlockHash());
+
+        // start blocks which are not in the active chain are rejected
+        BOOST_CHECK(!coinSetCache.GetAnonymitySet(1, GetRandHash()));
+        BOOST_CHECK(!coinSetCache.GetUsedSerials(GetRandHash()));
+
+        auto usedSerials = coinSetCache.GetUsedSerials(uint256());
+        BOOST_REQUIRE(usedSerials);
+        BOOST_CHECK(usedSerials->serials.empty());
+        BOOST_CHECK(usedSerials->blockHash == chainActive.Tip()->GetBlockHash());
+    }
+
+    GenerateBlock({});
+
+    {
+        LOCK(cs_main);
+        auto newAnonymitySet = coinSetCache.GetAnonymitySet(1, uint256());
+        BOOST_REQUIRE(newAnonymitySet);
+        BOOST_CHECK(newAnonymitySet != anonymitySet);
+        BOOST_CHECK(newAnonymitySet->coins == anonymitySet->coins);
+
+        auto usedSerials = coinSetCache.GetUsedSerials(uint256());
+        BOOST_REQUIRE(usedSerials);
+        BOOST_CHECK(usedSerials->blockHash == chainActive.Tip()->GetBlockHash());
+
+        coinSetCache.Clear();
+    }
+}
+
 // Surge condition testing
 #define Undetected BOOST_CHECK(!state.IsSurgeConditionDetected())
 #define Detected BOOST_CHECK(state.IsSurgeConditionDetected())
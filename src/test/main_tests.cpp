@@ -5,6 +5,7 @@
 #include "chainparams.h"
 #include "validation.h"
 #include "net.h"
+#include "streams.h"
 
 #include "test/test_bitcoin.h"
 
@@ -93,4 +94,30 @@ BOOST_AUTO_TEST_CASE(test_combiner_all)
     Test.disconnect(&ReturnTrue);
     BOOST_CHECK(Test());
 }
+
+BOOST_FIXTURE_TEST_CASE(read_raw_block, TestChain100Setup)
+{
+    LOCK(cs_main);
+    const CChainParams& chainparams = Params();
+
+    for (int height : {0, 1, chainActive.Height()}) {
+        const CBlockIndex* pindex = chainActive[height];
+
+        CBlock block;
+        BOOST_CHECK(ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()));
+
+        CDataStream expected(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS);
+        expected << block;
+
+        std::vector<unsigned char> raw;
+        BOOST_CHECK(ReadRawBlockFromDisk(raw, pindex, chainparams.MessageStart()));
+        BOOST_CHECK(raw == std::vector<unsigned char>(expected.begin(), expected.end()));
+    }
+
+    // blocks are never read with the magic of another network
+    CMessageHeader::MessageStartChars otherMessageStart = {0x00, 0x01, 0x02, 0x03};
+    std::vector<unsigned char> raw;
+    BOOST_CHECK(!ReadRawBlockFromDisk(raw, chainActive.Tip(), otherMessageStart));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -172,4 +172,112 @@ BOOST_AUTO_TEST_CASE(cnode_simple_test)
     BOOST_CHECK(pnode2->fFeeler == false);
 }
 
+// Feeds a message with the given payload size to the node as if it was received from its socket
+static void ReceiveTestMessage(CNode& node, const std::string& command, size_t nPayloadSize)
+{
+    std::vector<unsigned char> payload(nPayloadSize, 0x55);
+    uint256 hash = Hash(payload.begin(), payload.end());
+    CMessageHeader hdr(Params().MessageStart(), command.c_str(), payload.size());
+    memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+
+    std::vector<unsigned char> data;
+    CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, data, 0, hdr};
+    data.insert(data.end(), payload.begin(), payload.end());
+
+    bool complete = false;
+    BOOST_CHECK(node.ReceiveMsgBytes((const char*)data.data(), data.size(), complete));
+    BOOST_CHECK(complete);
+}
+
+static std::vector<std::string> GetCommands(const std::list<CNetMessage>& msgs)
+{
+    std::vector<std::string> ret;
+    for (const CNetMessage& msg : msgs) {
+        ret.push_back(msg.hdr.GetCommand());
+    }
+    return ret;
+}
+
+BOOST_AUTO_TEST_CASE(cnode_concurrent_queue)
+{
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr = CAddress(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, "", true);
+    node.fSuccessfullyConnected = true;
+
+    const size_t nSize = 100 + CMessageHeader::HEADER_SIZE;
+    bool fAdded, fConcurrentAdded;
+
+    // the version handshake and nodes without concurrent message handlers use the serial queue only
+    ReceiveTestMessage(node, NetMsgType::QSIGSESANN, 100);
+    ReceiveTestMessage(node, NetMsgType::PING, 100);
+    node.QueueReceivedMessages(false, 10 * nSize, fAdded, fConcurrentAdded);
+    BOOST_CHECK(fAdded && !fConcurrentAdded);
+    BOOST_CHECK(GetCommands(node.vProcessMsg) == std::vector<std::string>({NetMsgType::QSIGSESANN, NetMsgType::PING}));
+    BOOST_CHECK(node.vProcessConcurrentMsg.empty());
+    BOOST_CHECK_EQUAL(node.nProcessQueueSize, 2 * nSize);
+    node.vProcessMsg.clear();
+    node.nProcessQueueSize = 0;
+
+    // the LLMQ signing messages keep their order in the concurrent queue, everything else stays serial
+    ReceiveTestMessage(node, NetMsgType::QSIGSESANN, 100);
+    ReceiveTestMessage(node, NetMsgType::PING, 100);
+    ReceiveTestMessage(node, NetMsgType::QSIGSHARESINV, 100);
+    ReceiveTestMessage(node, NetMsgType::MNAUTH, 100);
+    ReceiveTestMessage(node, NetMsgType::QGETSIGSHARES, 100);
+    ReceiveTestMessage(node, NetMsgType::QBSIGSHARES, 100);
+    ReceiveTestMessage(node, NetMsgType::QSIGREC, 100);
+    node.QueueReceivedMessages(true, 10 * nSize, fAdded, fConcurrentAdded);
+    BOOST_CHECK(fAdded && fConcurrentAdded);
+    BOOST_CHECK(GetCommands(node.vProcessMsg) == std::vector<std::string>({NetMsgType::PING, NetMsgType::MNAUTH, NetMsgType::QSIGREC}));
+    BOOST_CHECK(GetCommands(node.vProcessConcurrentMsg) == std::vector<std::string>({NetMsgType::QSIGSESANN, NetMsgType::QSIGSHARESINV, NetMsgType::QGETSIGSHARES, NetMsgType::QBSIGSHARES}));
+    BOOST_CHECK_EQUAL(node.nProcessQueueSize, 7 * nSize);
+    BOOST_CHECK(!node.fPauseRecv);
+
+    std::list<CNetMessage> msgs;
+    bool fResumeRecv, fMoreWork;
+    BOOST_CHECK(node.PopConcurrentMessage(msgs, 10 * nSize, fResumeRecv, fMoreWork));
+    BOOST_CHECK_EQUAL(msgs.front().hdr.GetCommand(), NetMsgType::QSIGSESANN);
+    BOOST_CHECK(!fResumeRecv && fMoreWork);
+    BOOST_CHECK_EQUAL(node.nProcessQueueSize, 6 * nSize);
+}
+
+BOOST_AUTO_TEST_CASE(cnode_concurrent_queue_flood)
+{
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr = CAddress(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, "", true);
+    node.fSuccessfullyConnected = true;
+
+    const size_t nSize = 100 + CMessageHeader::HEADER_SIZE;
+    const size_t nFloodSize = 2 * nSize;
+    bool fAdded, fConcurrentAdded;
+
+    // both queues count towards the receive flood limit
+    ReceiveTestMessage(node, NetMsgType::PING, 100);
+    ReceiveTestMessage(node, NetMsgType::QBSIGSHARES, 100);
+    node.QueueReceivedMessages(true, nFloodSize, fAdded, fConcurrentAdded);
+    BOOST_CHECK(!node.fPauseRecv);
+    ReceiveTestMessage(node, NetMsgType::QBSIGSHARES, 100);
+    node.QueueReceivedMessages(true, nFloodSize, fAdded, fConcurrentAdded);
+    BOOST_CHECK(!fAdded && fConcurrentAdded);
+    BOOST_CHECK(node.fPauseRecv);
+    BOOST_CHECK_EQUAL(node.nProcessQueueSize, 3 * nSize);
+
+    // processing a concurrent message resumes receiving once the queues are below the limit again
+    std::list<CNetMessage> msgs;
+    bool fResumeRecv, fMoreWork;
+    BOOST_CHECK(node.PopConcurrentMessage(msgs, nFloodSize, fResumeRecv, fMoreWork));
+    BOOST_CHECK(fResumeRecv && fMoreWork);
+    BOOST_CHECK(!node.fPauseRecv);
+    BOOST_CHECK(node.PopConcurrentMessage(msgs, nFloodSize, fResumeRecv, fMoreWork));
+    BOOST_CHECK(!fResumeRecv && !fMoreWork);
+    BOOST_CHECK_EQUAL(msgs.size(), 2U);
+    BOOST_CHECK(!node.PopConcurrentMessage(msgs, nFloodSize, fResumeRecv, fMoreWork));
+    BOOST_CHECK_EQUAL(node.nProcessQueueSize, nSize);
+    BOOST_CHECK_EQUAL(node.vProcessMsg.size(), 1U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
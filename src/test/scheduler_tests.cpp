@@ -13,6 +13,9 @@
 #include <boost/thread.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(scheduler_tests)
 
 static void microTask(CScheduler& s, boost::mutex& mutex, int& counter, int delta, boost::chrono::system_clock::time_point rescheduleTime)
@@ -114,4 +117,67 @@ BOOST_AUTO_TEST_CASE(manythreads)
     BOOST_CHECK_EQUAL(counterSum, 200);
 }
 
+BOOST_AUTO_TEST_CASE(priorities)
+{
+    CScheduler scheduler;
+    std::vector<int> order;
+
+    // all the tasks are due, so they run by priority and then by time
+    boost::chrono::system_clock::time_point past = boost::chrono::system_clock::now() - boost::chrono::seconds(1);
+    scheduler.schedule([&order]() { order.push_back(3); }, past, CScheduler::PRIORITY_LOW, "low");
+    scheduler.schedule([&order]() { order.push_back(1); }, past + boost::chrono::milliseconds(2), CScheduler::PRIORITY_HIGH, "high");
+    scheduler.schedule([&order]() { order.push_back(2); }, past + boost::chrono::milliseconds(1), CScheduler::PRIORITY_NORMAL);
+    scheduler.schedule([&order]() { order.push_back(4); }, past + boost::chrono::milliseconds(3), CScheduler::PRIORITY_LOW, "low");
+
+    scheduler.stop(true);
+    scheduler.serviceQueue();
+
+    BOOST_CHECK(order == std::vector<int>({1, 2, 3, 4}));
+
+    std::map<std::string, CScheduler::TaskStats> stats = scheduler.getTaskStats();
+    BOOST_CHECK_EQUAL(stats.size(), 3U);
+    BOOST_CHECK_EQUAL(stats["low"].nRuns, 2U);
+    BOOST_CHECK_EQUAL(stats["high"].nRuns, 1U);
+    BOOST_CHECK_EQUAL(stats[""].nRuns, 1U);
+    // the tasks were a second late
+    BOOST_CHECK_GE(stats["low"].nMaxDelayMicros, 1000000 - 3000);
+}
+
+BOOST_AUTO_TEST_CASE(serial_domains)
+{
+    CScheduler scheduler;
+    SingleThreadedSchedulerClient first(&scheduler), second(&scheduler);
+
+    std::atomic<int> running[2] = {{0}, {0}};
+    std::atomic<bool> overlap(false);
+    std::vector<int> order[2];
+
+    for (int i = 0; i < 50; i++) {
+        for (int n = 0; n < 2; n++) {
+            SingleThreadedSchedulerClient& client = n == 0 ? first : second;
+            client.AddToProcessQueue([&running, &overlap, &order, n, i]() {
+                if (++running[n] != 1)
+                    overlap = true;
+                order[n].push_back(i);
+                MicroSleep(100);
+                --running[n];
+            });
+        }
+    }
+
+    boost::thread_group threads;
+    for (int i = 0; i < 4; i++)
+        threads.create_thread(boost::bind(&CScheduler::serviceQueue, &scheduler));
+
+    scheduler.stop(true);
+    threads.join_all();
+
+    BOOST_CHECK(!overlap);
+    for (int n = 0; n < 2; n++) {
+        BOOST_REQUIRE_EQUAL(order[n].size(), 50U);
+        for (int i = 0; i < 50; i++)
+            BOOST_CHECK_EQUAL(order[n][i], i);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,8 @@
 #include "../validation.h"
 #include "../secp256k1/include/Scalar.h"
 #include "../sigma.h"
+#include "../coinsetcache.h"
+#include "../liblelantus/params.h"
 #include "./test_bitcoin.h"
 #include "../wallet/wallet.h"
 
@@ -1218,4 +1220,62 @@ BOOST_AUTO_TEST_CASE(sigma_surge_detection_failure_anywhere)
 }
 
 
+BOOST_AUTO_TEST_CASE(sigma_to_lelantus_set_cache)
+{
+    LOCK(cs_main);
+
+    auto params = sigma::Params::get_default();
+    auto denom = sigma::CoinDenomination::SIGMA_DENOM_1;
+    auto denomAndId = std::make_pair(denom, 1);
+    lelantus::CSigmaToLelantusSetCache cache;
+
+    std::vector<uint256> hashes(4);
+    std::vector<CBlockIndex> blocks(4);
+    for (int i = 0; i < 4; i++) {
+        hashes[i] = uint256S(std::to_string(i + 1));
+        blocks[i].nHeight = i;
+        blocks[i].phashBlock = &hashes[i];
+        blocks[i].pprev = i > 0 ? &blocks[i - 1] : nullptr;
+        blocks[i].sigmaMintedPubCoins[denomAndId] = getPubcoins(generateCoins(params, 2, denom));
+    }
+
+    // coins of the blocks from the last one down to the first one
+    auto expected = [&](int first, int last) {
+        std::vector<lelantus::PublicCoin> coins;
+        GroupElement h1Denom = lelantus::Params::get_default()->get_h1() * Scalar(uint64_t(COIN));
+        for (int i = last; i >= first; i--) {
+            for (const auto& coin : blocks[i].sigmaMintedPubCoins[denomAndId]) {
+                coins.emplace_back(coin.getValue() + h1Denom);
+            }
+        }
+        return coins;
+    };
+
+    auto set = cache.GetAnonymitySet(denom, 1, &blocks[0], &blocks[1], false);
+    BOOST_REQUIRE(set);
+    BOOST_CHECK(*set == expected(0, 1));
+    BOOST_CHECK(cache.GetAnonymitySet(denom, 1, &blocks[0], &blocks[1], false) == set);
+
+    // extends the cached set
+    set = cache.GetAnonymitySet(denom, 1, &blocks[0], &blocks[3], false);
+    BOOST_REQUIRE(set);
+    BOOST_CHECK(*set == expected(0, 3));
+
+    // disconnecting a block drops the sets of its groups
+    auto before = cache.GetAnonymitySet(denom, 1, &blocks[0], &blocks[2], false);
+    cache.RemoveBlock(&blocks[3]);
+    BOOST_CHECK(cache.GetAnonymitySet(denom, 1, &blocks[0], &blocks[2], false) != before);
+    BOOST_CHECK(*cache.GetAnonymitySet(denom, 1, &blocks[0], &blocks[2], false) == expected(0, 2));
+
+    // the number of groups is bounded, the least recently used ones are dropped
+    set = cache.GetAnonymitySet(denom, 1, &blocks[0], &blocks[2], false);
+    auto unused = cache.GetAnonymitySet(denom, 2, &blocks[0], &blocks[2], false);
+    for (int id = 3; id < 1000; id++) {
+        BOOST_CHECK(cache.GetAnonymitySet(denom, id, &blocks[0], &blocks[2], false)->empty());
+        BOOST_CHECK(cache.GetAnonymitySet(denom, 1, &blocks[0], &blocks[2], false) == set);
+    }
+    BOOST_CHECK(cache.GetAnonymitySet(denom, 2, &blocks[0], &blocks[2], false) != unused);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "spendproofcache.h"
+
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(spendproofcache_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(entries)
+{
+    uint256 txHash = GetRandHash(), blockHash = GetRandHash();
+
+    uint256 entry = (CSpendProofCacheEntry(txHash) << 1 << blockHash << (uint64_t)100).GetHash();
+    BOOST_CHECK(entry == (CSpendProofCacheEntry(txHash) << 1 << blockHash << (uint64_t)100).GetHash());
+
+    // any change of the anonymity set gives another entry
+    uint256 otherBlock = (CSpendProofCacheEntry(txHash) << 1 << GetRandHash() << (uint64_t)100).GetHash();
+    uint256 otherSize = (CSpendProofCacheEntry(txHash) << 1 << blockHash << (uint64_t)101).GetHash();
+    uint256 otherTx = (CSpendProofCacheEntry(GetRandHash()) << 1 << blockHash << (uint64_t)100).GetHash();
+
+    BOOST_CHECK(!IsSpendProofCached(entry));
+    AddSpendProofToCache(entry);
+    BOOST_CHECK(IsSpendProofCached(entry));
+    // lookups don't remove the entry, block templates are checked over and over again
+    BOOST_CHECK(IsSpendProofCached(entry));
+
+    BOOST_CHECK(!IsSpendProofCached(otherBlock));
+    BOOST_CHECK(!IsSpendProofCached(otherSize));
+    BOOST_CHECK(!IsSpendProofCached(otherTx));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -338,4 +338,121 @@ BOOST_AUTO_TEST_CASE(dbindexhelper_zerospend)
     }
 }
 
+BOOST_AUTO_TEST_CASE(address_balance_index)
+{
+    CBlockTreeDB db(1 << 20, true, true);
+
+    uint160 address;
+    *address.begin() = 1;
+    uint256 tx1 = GetRandHash(), tx2 = GetRandHash();
+
+    std::vector<std::pair<CAddressIndexKey, CAmount> > const received {
+        {CAddressIndexKey(AddressType::payToPubKeyHash, address, 10, 1, tx1, 0, false), 500},
+        {CAddressIndexKey(AddressType::payToPubKeyHash, address, 10, 1, tx1, 1, false), 300}};
+    std::vector<std::pair<CAddressIndexKey, CAmount> > const spent {
+        {CAddressIndexKey(AddressType::payToPubKeyHash, address, 11, 2, tx2, 0, true), -500}};
+
+    auto checkBalance = [&db, &address](CAmount balance, CAmount received, int64_t unspentCount) {
+        CAddressBalanceValue value;
+        BOOST_CHECK(db.ReadAddressBalance(address, AddressType::payToPubKeyHash, value));
+        BOOST_CHECK_EQUAL(value.balance, balance);
+        BOOST_CHECK_EQUAL(value.received, received);
+        BOOST_CHECK_EQUAL(value.unspentCount, unspentCount);
+    };
+
+    // addresses without entries have no record
+    CAddressBalanceValue value;
+    BOOST_CHECK(!db.ReadAddressBalance(address, AddressType::payToPubKeyHash, value));
+
+    uint256 block1 = GetRandHash(), block2 = GetRandHash();
+    BOOST_CHECK(db.WriteAddressIndex(block1, 10, received));
+    BOOST_CHECK(db.WriteAddressIndex(block2, 11, spent));
+    checkBalance(300, 800, 1);
+
+    // a block connected again is not counted twice
+    BOOST_CHECK(db.WriteAddressIndex(block2, 11, spent));
+    checkBalance(300, 800, 1);
+
+    BOOST_CHECK(db.EraseAddressIndex(block2, 11, spent));
+    BOOST_CHECK(db.EraseAddressIndex(block2, 11, spent));
+    checkBalance(800, 800, 2);
+
+    // the entries above the given height belong to blocks which are connected again
+    BOOST_CHECK(db.WriteAddressIndex(block2, 11, spent));
+    BOOST_CHECK(db.BuildAddressBalanceIndex(10));
+    checkBalance(800, 800, 2);
+    BOOST_CHECK(db.WriteAddressIndex(block2, 11, spent));
+    checkBalance(300, 800, 1);
+
+    // blocks counted by the build are taken off when disconnected, and counted again when connected
+    BOOST_CHECK(db.EraseAddressIndex(block2, 11, spent));
+    BOOST_CHECK(db.EraseAddressIndex(block1, 10, received));
+    BOOST_CHECK(db.ReadAddressBalance(address, AddressType::payToPubKeyHash, value));
+    BOOST_CHECK_EQUAL(value.balance, 0);
+    BOOST_CHECK_EQUAL(value.unspentCount, 0);
+    BOOST_CHECK(db.WriteAddressIndex(block1, 10, received));
+    checkBalance(800, 800, 2);
+
+    CAddressBalanceValue other;
+    BOOST_CHECK(!db.ReadAddressBalance(address, AddressType::payToScriptHash, other));
+}
+
+BOOST_AUTO_TEST_CASE(address_index_pages)
+{
+    CBlockTreeDB db(1 << 20, true, true);
+
+    uint160 address, other;
+    *address.begin() = 1;
+    *other.begin() = 2;
+
+    std::vector<std::pair<CAddressIndexKey, CAmount> > entries;
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspent;
+    for (int i = 0; i < 10; i++) {
+        uint256 tx = GetRandHash();
+        entries.push_back({CAddressIndexKey(AddressType::payToPubKeyHash, address, 10 + i, 1, tx, 0, false), 100});
+        entries.push_back({CAddressIndexKey(AddressType::payToPubKeyHash, other, 10 + i, 1, tx, 1, false), 100});
+        unspent.push_back({CAddressUnspentKey(AddressType::payToPubKeyHash, address, tx, 0), CAddressUnspentValue(100, CScript(), 10 + i)});
+        unspent.push_back({CAddressUnspentKey(AddressType::payToPubKeyHash, other, tx, 1), CAddressUnspentValue(100, CScript(), 10 + i)});
+    }
+    BOOST_CHECK(db.WriteAddressIndex(GetRandHash(), 10, entries));
+    BOOST_CHECK(db.UpdateAddressUnspentIndex(unspent));
+
+    std::vector<std::pair<CAddressIndexKey, CAmount> > all, page;
+    BOOST_CHECK(db.ReadAddressIndex(address, AddressType::payToPubKeyHash, all));
+    BOOST_CHECK_EQUAL(all.size(), 10);
+
+    // pages continue after the last entry of the previous one, without crossing to other addresses
+    std::vector<std::pair<CAddressIndexKey, CAmount> > paged;
+    const CAddressIndexKey *after = nullptr;
+    do {
+        page.clear();
+        BOOST_CHECK(db.ReadAddressIndex(address, AddressType::payToPubKeyHash, page, 0, 0, after, 3));
+        BOOST_CHECK(page.size() <= 3);
+        paged.insert(paged.end(), page.begin(), page.end());
+        after = &paged.back().first;
+    } while (page.size() == 3);
+
+    BOOST_CHECK_EQUAL(paged.size(), all.size());
+    for (size_t i = 0; i < all.size(); i++) {
+        BOOST_CHECK(paged[i].first.txhash == all[i].first.txhash);
+        BOOST_CHECK_EQUAL(paged[i].first.blockHeight, 10 + (int)i);
+    }
+
+    // the end height still applies to pages
+    page.clear();
+    BOOST_CHECK(db.ReadAddressIndex(address, AddressType::payToPubKeyHash, page, 10, 15, &all[3].first, 10));
+    BOOST_CHECK_EQUAL(page.size(), 2);
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > allUnspent, unspentPage;
+    BOOST_CHECK(db.ReadAddressUnspentIndex(address, AddressType::payToPubKeyHash, allUnspent));
+    BOOST_CHECK_EQUAL(allUnspent.size(), 10);
+
+    BOOST_CHECK(db.ReadAddressUnspentIndex(address, AddressType::payToPubKeyHash, unspentPage, nullptr, 4));
+    BOOST_CHECK(db.ReadAddressUnspentIndex(address, AddressType::payToPubKeyHash, unspentPage, &allUnspent[3].first, 10));
+    BOOST_CHECK_EQUAL(unspentPage.size(), 10);
+    for (size_t i = 0; i < allUnspent.size(); i++) {
+        BOOST_CHECK(unspentPage[i].first.txhash == allUnspent[i].first.txhash);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 #include "util.h"
 
 #include "clientversion.h"
+#include "mpscqueue.h"
 #include "primitives/transaction.h"
 #include "sync.h"
 #include "utilstrencodings.h"
@@ -13,6 +14,7 @@
 #include "test/test_random.h"
 
 #include <stdint.h>
+#include <set>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -566,4 +568,68 @@ BOOST_AUTO_TEST_CASE(test_ParseFixedPoint)
     BOOST_CHECK(!ParseFixedPoint("1.", 8, &amount));
 }
 
+BOOST_AUTO_TEST_CASE(util_mpscqueue)
+{
+    CBoundedMPSCQueue<std::string> queue(3);
+    BOOST_CHECK_EQUAL(queue.Capacity(), 4U);
+
+    std::string value;
+    BOOST_CHECK(!queue.Pop(value));
+
+    for (int i = 0; i < 4; i++)
+        BOOST_CHECK(queue.Push(std::to_string(i)));
+    value = "4";
+    BOOST_CHECK(!queue.Push(std::move(value)));
+    BOOST_CHECK_EQUAL(value, "4");
+
+    // values come out in order and free their slots
+    for (int i = 0; i < 2; i++) {
+        BOOST_CHECK(queue.Pop(value));
+        BOOST_CHECK_EQUAL(value, std::to_string(i));
+    }
+    BOOST_CHECK(queue.Push("4"));
+    BOOST_CHECK(queue.Push("5"));
+    for (int i = 2; i < 6; i++) {
+        BOOST_CHECK(queue.Pop(value));
+        BOOST_CHECK_EQUAL(value, std::to_string(i));
+    }
+    BOOST_CHECK(!queue.Pop(value));
+}
+
+BOOST_AUTO_TEST_CASE(util_mpscqueue_producers)
+{
+    const int nProducers = 4, nValues = 10000;
+    CBoundedMPSCQueue<int> queue(64);
+
+    boost::thread_group producers;
+    for (int i = 0; i < nProducers; i++) {
+        producers.create_thread([&queue, i] {
+            for (int value = i * nValues; value < (i + 1) * nValues; ) {
+                int copy = value;
+                if (queue.Push(std::move(copy)))
+                    value++;
+                else
+                    boost::this_thread::yield();
+            }
+        });
+    }
+
+    // every value arrives once and the values of a producer keep their order
+    std::set<int> received;
+    std::vector<int> last(nProducers, -1);
+    int value;
+    while ((int)received.size() < nProducers * nValues) {
+        if (!queue.Pop(value)) {
+            boost::this_thread::yield();
+            continue;
+        }
+        BOOST_REQUIRE(received.insert(value).second);
+        BOOST_REQUIRE(value > last[value / nValues]);
+        last[value / nValues] = value;
+    }
+    producers.join_all();
+
+    BOOST_CHECK(!queue.Pop(value));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -8,7 +8,9 @@
 #include "chainparams.h"
 #include "hash.h"
 #include "pow.h"
+#include "ui_interface.h"
 #include "uint256.h"
+#include "util.h"
 #include "validation.h"
 #include "consensus/consensus.h"
 #include "base58.h"
@@ -23,8 +25,11 @@ static const char DB_BLOCK_FILES = 'f';
 static const char DB_TXINDEX = 't';
 static const char DB_ADDRESSINDEX = 'a';
 static const char DB_ADDRESSUNSPENTINDEX = 'u';
+static const char DB_ADDRESSBALANCEINDEX = 'A';
+static const char DB_ADDRESSBALANCEBLOCK = 'w';
 static const char DB_TIMESTAMPINDEX = 's';
 static const char DB_SPENTINDEX = 'p';
+static const char DB_ELYSIUMMARKERINDEX = 'e';
 static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
@@ -32,6 +37,8 @@ static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 static const char DB_TOTAL_SUPPLY = 'S';
+static const char DB_ADDRESSBALANCEHEIGHT = 'W';
+static const char DB_ELYSIUMMARKERINDEX_BLOCK = 'm';
 
 namespace {
 
@@ -234,20 +241,44 @@ bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddres
     return WriteBatch(batch);
 }
 
+namespace {
+
+template<typename Key>
+bool IsSameKey(const Key &a, const Key &b)
+{
+    CDataStream ssA(SER_DISK, CLIENT_VERSION), ssB(SER_DISK, CLIENT_VERSION);
+    ssA << a;
+    ssB << b;
+    return ssA.str() == ssB.str();
+}
+
+}
+
 bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, AddressType type,
-                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
+                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                                           const CAddressUnspentKey *after, size_t limit) {
 
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    if (after) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, *after));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
 
-    while (pcursor->Valid()) {
+    size_t count = 0;
+    while (pcursor->Valid() && (limit == 0 || count < limit)) {
         boost::this_thread::interruption_point();
         std::pair<char,CAddressUnspentKey> key;
         if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.hashBytes == addressHash) {
+            if (after && IsSameKey(key.second, *after)) {
+                pcursor->Next();
+                continue;
+            }
             CAddressUnspentValue nValue;
             if (pcursor->GetValue(nValue)) {
                 unspentOutputs.push_back(std::make_pair(key.second, nValue));
+                count++;
                 pcursor->Next();
             } else {
                 return error("failed to get address unspent value");
@@ -260,16 +291,65 @@ bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, AddressType type
     return true;
 }
 
-bool CBlockTreeDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+namespace {
+
+void ApplyAddressDelta(CAddressBalanceValue &value, const CAddressIndexKey &key, CAmount delta, int sign)
+{
+    value.balance += sign * delta;
+    if (delta > 0)
+        value.received += sign * delta;
+
+    // only regular addresses have their outputs in the unspent index
+    if (key.type == AddressType::payToPubKeyHash || key.type == AddressType::payToScriptHash)
+        value.unspentCount += sign * (key.spending ? -1 : 1);
+}
+
+}
+
+void CBlockTreeDB::UpdateAddressBalances(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect, int sign) {
+    std::map<std::pair<AddressType, uint160>, CAddressBalanceValue> balances;
+
+    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        std::pair<AddressType, uint160> address(it->first.type, it->first.hashBytes);
+        std::map<std::pair<AddressType, uint160>, CAddressBalanceValue>::iterator balance = balances.find(address);
+        if (balance == balances.end()) {
+            balance = balances.insert(std::make_pair(address, CAddressBalanceValue())).first;
+            Read(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(address.first, address.second)), balance->second);
+        }
+
+        ApplyAddressDelta(balance->second, it->first, it->second, sign);
+    }
+
+    for (std::map<std::pair<AddressType, uint160>, CAddressBalanceValue>::const_iterator it=balances.begin(); it!=balances.end(); it++)
+        batch.Write(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(it->first.first, it->first.second)), it->second);
+}
+
+bool CBlockTreeDB::WriteAddressIndex(const uint256 &blockHash, int height, const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
     CDBBatch batch(*this);
+    // blocks connected again after an unclean shutdown must not be counted twice
+    int nBuiltHeight;
+    if (!Exists(std::make_pair(DB_ADDRESSBALANCEBLOCK, blockHash)) &&
+        !(Read(DB_ADDRESSBALANCEHEIGHT, nBuiltHeight) && height <= nBuiltHeight)) {
+        UpdateAddressBalances(batch, vect, 1);
+        batch.Write(std::make_pair(DB_ADDRESSBALANCEBLOCK, blockHash), '1');
+    }
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
         batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
     }
     return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+bool CBlockTreeDB::EraseAddressIndex(const uint256 &blockHash, int height, const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
     CDBBatch batch(*this);
+    int nBuiltHeight;
+    if (Exists(std::make_pair(DB_ADDRESSBALANCEBLOCK, blockHash))) {
+        UpdateAddressBalances(batch, vect, -1);
+        batch.Erase(std::make_pair(DB_ADDRESSBALANCEBLOCK, blockHash));
+    } else if (Read(DB_ADDRESSBALANCEHEIGHT, nBuiltHeight) && height <= nBuiltHeight) {
+        // counted by BuildAddressBalanceIndex, blocks connected in its place are counted again
+        UpdateAddressBalances(batch, vect, -1);
+        batch.Write(DB_ADDRESSBALANCEHEIGHT, height - 1);
+    }
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
     batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
     return WriteBatch(batch);
@@ -277,26 +357,35 @@ bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKe
 
 bool CBlockTreeDB::ReadAddressIndex(uint160 addressHash, AddressType type,
                                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                                    int start, int end) {
+                                    int start, int end,
+                                    const CAddressIndexKey *after, size_t limit) {
 
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    if (start > 0 && end > 0) {
+    if (after) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, *after));
+    } else if (start > 0 && end > 0) {
         pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
     } else {
         pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
     }
 
-    while (pcursor->Valid()) {
+    size_t count = 0;
+    while (pcursor->Valid() && (limit == 0 || count < limit)) {
         boost::this_thread::interruption_point();
         std::pair<char,CAddressIndexKey> key;
         if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.hashBytes == addressHash && key.second.type == type) {
             if (end > 0 && key.second.blockHeight > end) {
                 break;
             }
+            if (after && IsSameKey(key.second, *after)) {
+                pcursor->Next();
+                continue;
+            }
             CAmount nValue;
             if (pcursor->GetValue(nValue)) {
                 addressIndex.push_back(std::make_pair(key.second, nValue));
+                count++;
                 pcursor->Next();
             } else {
                 return error("failed to get address index value");
@@ -310,6 +399,95 @@ bool CBlockTreeDB::ReadAddressIndex(uint160 addressHash, AddressType type,
 }
 
 
+bool CBlockTreeDB::ReadAddressBalance(uint160 addressHash, AddressType type, CAddressBalanceValue &value) {
+    // addresses without any entry in the address index have no record
+    return Read(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(type, addressHash)), value);
+}
+
+bool CBlockTreeDB::BuildAddressBalanceIndex(int height) {
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+    CDBBatch batch(*this);
+
+    // records left by an earlier build, the balances are summed up from scratch
+    pcursor->Seek(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey()));
+    while (pcursor->Valid()) {
+        std::pair<char, CAddressIndexIteratorKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSBALANCEINDEX)
+            break;
+        batch.Erase(key);
+        pcursor->Next();
+    }
+    pcursor->Seek(std::make_pair(DB_ADDRESSBALANCEBLOCK, uint256()));
+    while (pcursor->Valid()) {
+        std::pair<char, uint256> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSBALANCEBLOCK)
+            break;
+        batch.Erase(key);
+        pcursor->Next();
+    }
+
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey()));
+    CAddressIndexIteratorKey address;
+    CAddressBalanceValue balance;
+    bool fAddress = false;
+    int reportDone = 0;
+
+    LogPrintf("[0%%]...");
+    uiInterface.ShowProgress(_("Building address balance index..."), 0);
+
+    // entries of an address are adjacent in the index, so one address is summed up at a time
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX)
+            break;
+
+        CAmount nValue;
+        if (!pcursor->GetValue(nValue))
+            return error("failed to get address index value");
+
+        if (fAddress && (key.second.type != address.type || key.second.hashBytes != address.hashBytes)) {
+            if (balance.received != 0 || balance.balance != 0 || balance.unspentCount != 0)
+                batch.Write(std::make_pair(DB_ADDRESSBALANCEINDEX, address), balance);
+            balance.SetNull();
+
+            if (batch.SizeEstimate() > (1 << 24)) {
+                if (!WriteBatch(batch))
+                    return error("failed to write address balance index");
+                batch.Clear();
+            }
+
+            // nearly all entries are of key hashes, so the progress is the one through them
+            if (key.second.type == AddressType::payToPubKeyHash) {
+                const unsigned char *hash = key.second.hashBytes.begin();
+                int percentageDone = (int)((0x100 * hash[0] + hash[1]) * 100.0 / 65536.0 + 0.5);
+                if (reportDone < percentageDone / 10) {
+                    // report every 10% step
+                    LogPrintf("[%d%%]...", percentageDone);
+                    reportDone = percentageDone / 10;
+                }
+                uiInterface.ShowProgress(_("Building address balance index..."), percentageDone);
+            }
+        }
+
+        address = CAddressIndexIteratorKey(key.second.type, key.second.hashBytes);
+        fAddress = true;
+        // later blocks are connected again and counted then
+        if (key.second.blockHeight <= height)
+            ApplyAddressDelta(balance, key.second, nValue, 1);
+        pcursor->Next();
+    }
+
+    if (fAddress && (balance.received != 0 || balance.balance != 0 || balance.unspentCount != 0))
+        batch.Write(std::make_pair(DB_ADDRESSBALANCEINDEX, address), balance);
+    batch.Write(DB_ADDRESSBALANCEHEIGHT, height);
+
+    bool fSuccess = WriteBatch(batch);
+    LogPrintf("[%s].\n", fSuccess ? "DONE" : "FAILED");
+    uiInterface.ShowProgress("", 100);
+    return fSuccess;
+}
+
 bool CBlockTreeDB::WriteTimestampIndex(const CTimestampIndexKey &timestampIndex) {
     CDBBatch batch(*this);
     batch.Write(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex), 0);
@@ -336,6 +514,64 @@ bool CBlockTreeDB::ReadTimestampIndex(const unsigned int &high, const unsigned i
     return true;
 }
 
+bool CBlockTreeDB::WriteElysiumMarkerIndex(const uint256 &blockHash, const std::vector<std::pair<CElysiumMarkerIndexKey, uint256> > &vect) {
+    CDBBatch batch(*this);
+    for (std::vector<std::pair<CElysiumMarkerIndexKey, uint256> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
+        batch.Write(std::make_pair(DB_ELYSIUMMARKERINDEX, it->first), it->second);
+    // the block record marks the block as covered, it's written together with the entries
+    batch.Write(std::make_pair(DB_ELYSIUMMARKERINDEX_BLOCK, blockHash), (uint32_t)vect.size());
+    return WriteBatch(batch);
+}
+
+bool CBlockTreeDB::EraseElysiumMarkerIndex(int height, const uint256 &blockHash) {
+    CDBBatch batch(*this);
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_ELYSIUMMARKERINDEX, CElysiumMarkerIndexKey(height, 0)));
+
+    while (pcursor->Valid()) {
+        std::pair<char, CElysiumMarkerIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ELYSIUMMARKERINDEX && key.second.blockHeight == height) {
+            batch.Erase(key);
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    batch.Erase(std::make_pair(DB_ELYSIUMMARKERINDEX_BLOCK, blockHash));
+    return WriteBatch(batch);
+}
+
+bool CBlockTreeDB::ReadElysiumMarkerIndex(int start, int end, std::vector<std::pair<CElysiumMarkerIndexKey, uint256> > &vect) {
+
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_ELYSIUMMARKERINDEX, CElysiumMarkerIndexKey(start, 0)));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CElysiumMarkerIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ELYSIUMMARKERINDEX && key.second.blockHeight <= end) {
+            uint256 txid;
+            if (pcursor->GetValue(txid)) {
+                vect.push_back(std::make_pair(key.second, txid));
+                pcursor->Next();
+            } else {
+                return error("failed to get elysium marker index value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool CBlockTreeDB::ReadElysiumMarkerIndexCount(const uint256 &blockHash, uint32_t &count) {
+    return Read(std::make_pair(DB_ELYSIUMMARKERINDEX_BLOCK, blockHash), count);
+}
+
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
     return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
 }
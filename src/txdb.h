@@ -128,16 +128,28 @@ public:
     bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
     bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
     bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
+    /** Read the unspent outputs of an address, starting after the key after if given, and reading at most limit entries if not 0 */
     bool ReadAddressUnspentIndex(uint160 addressHash, AddressType type,
-                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
-    bool WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect,
+                                 const CAddressUnspentKey *after = nullptr, size_t limit = 0);
+    bool WriteAddressIndex(const uint256 &blockHash, int height, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
+    bool EraseAddressIndex(const uint256 &blockHash, int height, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
+    /** Read the index entries of an address, starting after the key after if given, and reading at most limit entries if not 0 */
     bool ReadAddressIndex(uint160 addressHash, AddressType type,
                           std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                          int start = 0, int end = 0);
+                          int start = 0, int end = 0,
+                          const CAddressIndexKey *after = nullptr, size_t limit = 0);
+    bool ReadAddressBalance(uint160 addressHash, AddressType type, CAddressBalanceValue &value);
+    /** Sums up the balances of the address index entries up to the given height, the blocks above are counted when connected */
+    bool BuildAddressBalanceIndex(int height);
 
     bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
     bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &vect);
+    bool WriteElysiumMarkerIndex(const uint256 &blockHash, const std::vector<std::pair<CElysiumMarkerIndexKey, uint256> > &vect);
+    bool EraseElysiumMarkerIndex(int height, const uint256 &blockHash);
+    bool ReadElysiumMarkerIndex(int start, int end, std::vector<std::pair<CElysiumMarkerIndexKey, uint256> > &vect);
+    /** The number of marker index entries of the block, false if the block isn't covered by the index */
+    bool ReadElysiumMarkerIndexCount(const uint256 &blockHash, uint32_t &count);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
     bool LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex);
@@ -145,6 +157,9 @@ public:
     int GetBlockIndexVersion(uint256 const & blockHash);
     bool AddTotalSupply(CAmount const & supply);
     bool ReadTotalSupply(CAmount & supply);
+
+private:
+    void UpdateAddressBalances(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect, int sign);
 };
 
 
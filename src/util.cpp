@@ -12,6 +12,7 @@
 #include "support/allocators/secure.h"
 #include "chainparamsbase.h"
 #include "ctpl.h"
+#include "mpscqueue.h"
 #include "random.h"
 #include "serialize.h"
 #include "stacktraces.h"
@@ -305,21 +306,14 @@ static std::string LogTimestampStr(const std::string &str, std::atomic_bool *fSt
     return strStamped;
 }
 
-int LogPrintStr(const std::string &str)
+static int WriteLogStr(const std::string &str)
 {
-    //A temporary fix for https://github.com/firoorg/firo/issues/1011
-    if (fNoDebug && str.compare(0, 6, "ERROR:", 0, 6) != 0)
-        return 0;
-
     int ret = 0; // Returns total number of characters written
-    static std::atomic_bool fStartedNewLine(true);
-
-    std::string strTimestamped = LogTimestampStr(str, &fStartedNewLine);
 
     if (fPrintToConsole)
     {
         // print to console
-        ret = fwrite(strTimestamped.data(), 1, strTimestamped.size(), stdout);
+        ret = fwrite(str.data(), 1, str.size(), stdout);
         fflush(stdout);
     }
     else if (fPrintToDebugLog)
@@ -330,8 +324,8 @@ int LogPrintStr(const std::string &str)
         // buffer if we haven't opened the log yet
         if (fileout == NULL) {
             assert(vMsgsBeforeOpenLog);
-            ret = strTimestamped.length();
-            vMsgsBeforeOpenLog->push_back(strTimestamped);
+            ret = str.length();
+            vMsgsBeforeOpenLog->push_back(str);
         }
         else
         {
@@ -343,12 +337,128 @@ int LogPrintStr(const std::string &str)
                     setbuf(fileout, NULL); // unbuffered
             }
 
-            ret = FileWriteStr(strTimestamped, fileout);
+            ret = FileWriteStr(str, fileout);
         }
     }
     return ret;
 }
 
+/**
+ * Asynchronous logging: LogPrintStr() only pushes the timestamped messages into logQueue and the writer
+ * thread appends them to the log. The queue is leaked on exit like the other logging objects, a thread may
+ * still hold a pointer to it while logging is being stopped.
+ */
+static CBoundedMPSCQueue<std::string> *logQueue = NULL;
+static std::atomic<bool> fAsyncLogging(false);
+// threads between checking fAsyncLogging and pushing their message
+static std::atomic<int> nLogProducers(0);
+static std::atomic<uint64_t> nDroppedLogMessages(0);
+
+static boost::thread *threadLogWriter = NULL;
+static std::atomic<bool> fStopLogWriter(false);
+static boost::mutex mutexLogWriter;
+static boost::condition_variable condLogWriter;
+
+// upper bound of bytes written at once
+static const size_t MAX_LOG_WRITE_SIZE = 1 << 20;
+static const int LOG_WRITER_INTERVAL_MS = 50;
+
+static void ThreadLogWriter()
+{
+    RenameThread("firo-logger");
+
+    std::string str, batch;
+    while (true) {
+        // the producers are gone once the flag is set, so the queue is empty after writing what it has now
+        bool fStop = fStopLogWriter;
+
+        batch.clear();
+        while (batch.size() < MAX_LOG_WRITE_SIZE && logQueue->Pop(str))
+            batch += str;
+
+        uint64_t nDropped = nDroppedLogMessages.exchange(0);
+        if (nDropped > 0)
+            batch += strprintf("%u log messages were dropped because the log buffer was full\n", nDropped);
+
+        if (!batch.empty()) {
+            WriteLogStr(batch);
+            continue;
+        }
+
+        if (fStop)
+            break;
+
+        // producers don't wake the writer up, it drains the queue in regular intervals
+        boost::unique_lock<boost::mutex> lock(mutexLogWriter);
+        if (!fStopLogWriter)
+            condLogWriter.wait_for(lock, boost::chrono::milliseconds(LOG_WRITER_INTERVAL_MS));
+    }
+}
+
+void StartAsyncLogging(size_t nMaxMessages)
+{
+    assert(threadLogWriter == NULL);
+
+    if (!logQueue)
+        logQueue = new CBoundedMPSCQueue<std::string>(nMaxMessages);
+
+    fStopLogWriter = false;
+    threadLogWriter = new boost::thread(&ThreadLogWriter);
+    fAsyncLogging = true;
+}
+
+void StopAsyncLogging()
+{
+    if (!threadLogWriter)
+        return;
+
+    fAsyncLogging = false;
+    while (nLogProducers > 0)
+        boost::this_thread::yield();
+
+    {
+        boost::unique_lock<boost::mutex> lock(mutexLogWriter);
+        fStopLogWriter = true;
+    }
+    condLogWriter.notify_one();
+
+    threadLogWriter->join();
+    delete threadLogWriter;
+    threadLogWriter = NULL;
+}
+
+int LogPrintStr(const std::string &str)
+{
+    //A temporary fix for https://github.com/firoorg/firo/issues/1011
+    if (fNoDebug && str.compare(0, 6, "ERROR:", 0, 6) != 0)
+        return 0;
+
+    static std::atomic_bool fStartedNewLine(true);
+
+    std::string strTimestamped = LogTimestampStr(str, &fStartedNewLine);
+
+    if (fPrintToConsole || fPrintToDebugLog) {
+        nLogProducers++;
+        if (fAsyncLogging) {
+            int ret = strTimestamped.size();
+            bool fPushed = logQueue->Push(std::move(strTimestamped));
+            nLogProducers--;
+
+            if (fPushed)
+                return ret;
+
+            // the buffer is full, errors are written right away, the others are counted and dropped
+            if (str.compare(0, 6, "ERROR:", 0, 6) == 0)
+                return WriteLogStr(strTimestamped);
+            nDroppedLogMessages++;
+            return 0;
+        }
+        nLogProducers--;
+    }
+
+    return WriteLogStr(strTimestamped);
+}
+
 /** Interpret string as boolean, for argument parsing */
 static bool InterpretBool(const std::string& strValue)
 {
@@ -40,6 +40,8 @@ using namespace boost::placeholders;
 static const bool DEFAULT_LOGTIMEMICROS = false;
 static const bool DEFAULT_LOGIPS        = false;
 static const bool DEFAULT_LOGTIMESTAMPS = true;
+static const bool DEFAULT_ASYNC_LOGGING = false;
+static const unsigned int DEFAULT_LOG_BUFFER_SIZE = 65536;
 
 /** Signals for translation. */
 class CTranslationInterface
@@ -99,6 +101,10 @@ bool SetupNetworking();
 bool LogAcceptCategory(const char* category);
 /** Send a string to the log output */
 int LogPrintStr(const std::string &str);
+/** Leaves writing the log to a background thread, messages are dropped if more than nMaxMessages wait for it */
+void StartAsyncLogging(size_t nMaxMessages);
+/** Writes the messages left and goes back to writing the log on the calling threads */
+void StopAsyncLogging();
 
 #define LogPrint(category, ...) do { \
     if (LogAcceptCategory((category))) { \
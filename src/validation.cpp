@@ -10,6 +10,7 @@
 #endif
 
 #include "arith_uint256.h"
+#include "blockfilter.h"
 #include "chainparams.h"
 #include "checkpoints.h"
 #include "checkqueue.h"
@@ -49,6 +50,7 @@
 #include "definition.h"
 #include "utiltime.h"
 #include "mtpstate.h"
+#include "chainsnapshot.h"
 
 #include "coins.h"
 
@@ -59,6 +61,8 @@
 
 #ifdef ENABLE_ELYSIUM
 #include "elysium/elysium.h"
+#include "elysium/packetencoder.h"
+#include "elysium/sigma.h"
 #endif
 
 #include "masternode-payments.h"
@@ -1606,29 +1610,42 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
 }
 
 bool GetAddressIndex(uint160 addressHash, AddressType type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end)
+                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end,
+                     const CAddressIndexKey *after, size_t limit)
 {
     if (!fAddressIndex)
         return error("address index not enabled");
 
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end))
+    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end, after, limit))
         return error("unable to get txids for address");
 
     return true;
 }
 
 bool GetAddressUnspent(uint160 addressHash, AddressType type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                       const CAddressUnspentKey *after, size_t limit)
 {
     if (!fAddressIndex)
         return error("address index not enabled");
 
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs))
+    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs, after, limit))
         return error("unable to get txids for address");
 
     return true;
 }
 
+bool GetAddressBalance(uint160 addressHash, AddressType type, CAddressBalanceValue &balance)
+{
+    if (!fAddressIndex)
+        return error("address index not enabled");
+
+    if (!pblocktree->ReadAddressBalance(addressHash, type, balance))
+        return error("unable to get balance for address");
+
+    return true;
+}
+
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1697,6 +1714,38 @@ bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus
     return true;
 }
 
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& messageStart)
+{
+    CDiskBlockPos pos = pindex->GetBlockPos();
+    // WriteBlockToDisk() points the position past the message start and the size of the block
+    if (pos.nPos < 8)
+        return error("%s: invalid position %s", __func__, pos.ToString());
+    pos.nPos -= 8;
+
+    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+
+    try {
+        CMessageHeader::MessageStartChars blockMessageStart;
+        unsigned int nSize;
+        filein >> FLATDATA(blockMessageStart) >> nSize;
+
+        if (memcmp(blockMessageStart, messageStart, CMessageHeader::MESSAGE_START_SIZE))
+            return error("%s: block magic mismatch at %s", __func__, pos.ToString());
+        if (nSize < 80 || nSize > MAX_SIZE)
+            return error("%s: invalid block size %u at %s", __func__, nSize, pos.ToString());
+
+        block.resize(nSize);
+        filein.read((char*)block.data(), nSize);
+    }
+    catch (const std::exception &e) {
+        return error("%s: Read or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+    }
+
+    return true;
+}
+
 bool ReadBlockHeaderFromDisk(CBlock &block, const CDiskBlockPos &pos) {
     CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull())
@@ -2431,7 +2480,7 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
     //When called from there, no real disconnect happens.
     if(!pfClean) {
         if (fAddressIndex) {
-            if (!pblocktree->EraseAddressIndex(dbIndexHelper.getAddressIndex())) {
+            if (!pblocktree->EraseAddressIndex(pindex->GetBlockHash(), pindex->nHeight, dbIndexHelper.getAddressIndex())) {
                 AbortNode(state, "Failed to delete address index");
                 error("Failed to delete address index");
                 return DISCONNECT_FAILED;
@@ -2447,6 +2496,15 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
                 return DISCONNECT_FAILED;
             }
         }
+#ifdef ENABLE_ELYSIUM
+        if (fTxIndex) {
+            if (!pblocktree->EraseElysiumMarkerIndex(pindex->nHeight, pindex->GetBlockHash())) {
+                AbortNode(state, "Failed to delete elysium marker index");
+                error("Failed to delete elysium marker index");
+                return DISCONNECT_FAILED;
+            }
+        }
+#endif
     }
 
     /*
@@ -2736,6 +2794,9 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     std::vector<std::pair<uint256, CDiskTxPos> > vPos;
     vPos.reserve(block.vtx.size());
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
+#ifdef ENABLE_ELYSIUM
+    std::vector<std::pair<CElysiumMarkerIndexKey, uint256> > vElysiumMarkers;
+#endif
     CDbIndexHelper dbIndexHelper(fAddressIndex, fSpentIndex);
 
     std::vector<PrecomputedTransactionData> txdata;
@@ -2854,6 +2915,10 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
 
         vPos.push_back(std::make_pair(tx.GetHash(), pos));
         pos.nTxOffset += ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
+#ifdef ENABLE_ELYSIUM
+        if (fTxIndex && elysium::HasMarker(tx))
+            vElysiumMarkers.push_back(std::make_pair(CElysiumMarkerIndexKey(pindex->nHeight, i), tx.GetHash()));
+#endif
 
     }
 
@@ -2978,8 +3043,13 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     if (fTxIndex)
         if (!pblocktree->WriteTxIndex(vPos))
             return AbortNode(state, "Failed to write transaction index");
+#ifdef ENABLE_ELYSIUM
+    if (fTxIndex)
+        if (!pblocktree->WriteElysiumMarkerIndex(pindex->GetBlockHash(), vElysiumMarkers))
+            return AbortNode(state, "Failed to write elysium marker index");
+#endif
     if (fAddressIndex) {
-        if (!pblocktree->WriteAddressIndex(dbIndexHelper.getAddressIndex()))
+        if (!pblocktree->WriteAddressIndex(pindex->GetBlockHash(), pindex->nHeight, dbIndexHelper.getAddressIndex()))
             return AbortNode(state, "Failed to write address index");
 
         if (!pblocktree->UpdateAddressUnspentIndex(dbIndexHelper.getAddressUnspentIndex()))
@@ -3372,8 +3442,10 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     }
     LogPrint("bench", "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
 
-	sigma::DisconnectTipSigma(block, pindexDelete);
-    lelantus::DisconnectTipLelantus(block, pindexDelete);
+    sigma::CSigmaBlockUpdate sigmaUpdate;
+    lelantus::CLelantusBlockUpdate lelantusUpdate;
+	sigma::DisconnectTipSigma(block, pindexDelete, &sigmaUpdate);
+    lelantus::DisconnectTipLelantus(block, pindexDelete, &lelantusUpdate);
 
     BatchProofContainer* batchProofContainer = BatchProofContainer::get_instance();
     if (sigmaSerialsToRemove.size() > 0) {
@@ -3435,6 +3507,9 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     // Update chainActive and related variables.
     UpdateTip(pindexDelete->pprev, chainparams);
 
+    GetMainSignals().NotifySigmaBlock(sigmaUpdate);
+    GetMainSignals().NotifyLelantusBlock(lelantusUpdate);
+
 #ifdef ENABLE_WALLET
     // update mint/spend wallet
     if (!GetBoolArg("-disablewallet", false) && pwalletMain->zwallet) {
@@ -3524,6 +3599,9 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     int64_t nTime2 = GetTimeMicros(); nTimeReadFromDisk += nTime2 - nTime1;
     int64_t nTime3;
     // LogPrint("bench", "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * 0.001, nTimeReadFromDisk * 0.000001);
+    // the coin groups started by the block are notified once it's connected
+    auto sigmaLatestCoinIds = sigma::CSigmaState::GetState()->GetLatestCoinIds();
+    int lelantusLatestCoinId = lelantus::CLelantusState::GetState()->GetLatestCoinID();
     {
         auto dbTx = evoDb->BeginTransaction();
 
@@ -3542,6 +3620,8 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
         bool flushed = view.Flush();
         assert(flushed);
         dbTx->Commit();
+        if (pblockfilterdb && !pblockfilterdb->WriteFilter(pindexNew->GetBlockHash(), BuildBlockFilter(blockConnecting)))
+            return AbortNode(state, "Failed to write block filter");
     }
     int64_t nTime4 = GetTimeMicros(); nTimeFlush += nTime4 - nTime3;
     LogPrint("bench", "  - Flush: %.2fms [%.2fs]\n", (nTime4 - nTime3) * 0.001, nTimeFlush * 0.000001);
@@ -3572,13 +3652,18 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     // Update chainActive & related variables.
     UpdateTip(pindexNew, chainparams);
 
+    GetMainSignals().NotifySigmaBlock(sigma::GetConnectedBlockUpdate(pindexNew, sigmaLatestCoinIds));
+    GetMainSignals().NotifyLelantusBlock(lelantus::GetConnectedBlockUpdate(pindexNew, lelantusLatestCoinId));
+
 #ifdef ENABLE_ELYSIUM
         //! Elysium: new confirmed transaction notification
     if (fElysium) {
-        BOOST_FOREACH(CTransactionRef tx, blockConnecting.vtx) {
-                LogPrint("handler", "Elysium handler: new confirmed transaction [height: %d, idx: %u]\n", GetHeight(), nTxIdx);
-                if (elysium_handler_tx(*tx, GetHeight(), nTxIdx++, pindexNew)) ++nNumMetaTxs;
-            }
+        std::vector<std::pair<unsigned, CTransactionRef>> txs;
+        for (const CTransactionRef& tx : blockConnecting.vtx) {
+            txs.push_back(std::make_pair(nTxIdx++, tx));
+        }
+
+        nNumMetaTxs = elysium_handler_block_txs(txs, GetHeight(), pindexNew);
     }
 #endif
 
@@ -3947,7 +4032,10 @@ bool ActivateBestChain(CValidationState &state, const CChainParams& chainparams,
 
             bool fInvalidFound = false;
             std::shared_ptr<const CBlock> nullBlockPtr;
-            if (!ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && pblock->GetHash() == pindexMostWork->GetBlockHash() ? pblock : nullBlockPtr, fInvalidFound, connectTrace))
+            bool fStepSucceeded = ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && pblock->GetHash() == pindexMostWork->GetBlockHash() ? pblock : nullBlockPtr, fInvalidFound, connectTrace);
+            // the step may have changed the chain even if it failed
+            PublishChainSnapshot();
+            if (!fStepSucceeded)
                 return false;
 
             if (fInvalidFound) {
@@ -4065,6 +4153,7 @@ bool InvalidateBlock(CValidationState& state, const CChainParams& chainparams, C
     }
 
     InvalidChainFound(pindex);
+    PublishChainSnapshot();
     txpools.removeForReorg(pcoinsTip, chainActive.Tip()->nHeight + 1, STANDARD_LOCKTIME_VERIFY_FLAGS);
     GetMainSignals().UpdatedBlockTip(chainActive.Tip(), NULL, IsInitialBlockDownload());
     uiInterface.NotifyBlockTip(IsInitialBlockDownload(), pindex->pprev);
@@ -4725,8 +4814,11 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
         if (!ContextualCheckBlockHeader(block, state, chainparams.GetConsensus(), pindexPrev, GetAdjustedTime()))
             return error("%s: Consensus::ContextualCheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
     }
-    if (pindex == NULL)
+    if (pindex == NULL) {
         pindex = AddToBlockIndex(block);
+        // headers run ahead of the published chain snapshot during sync
+        PublishBestHeader();
+    }
 
     if (ppindex)
         *ppindex = pindex;
@@ -5207,6 +5299,18 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     pblocktree->ReadFlag("addressindex", fAddressIndex);
     LogPrintf("%s: address index %s\n", __func__, fAddressIndex ? "enabled" : "disabled");
 
+    // Address balances are kept next to the address index, sum them up once for an older database
+    bool fAddressBalanceIndex = false;
+    if (fAddressIndex && !(pblocktree->ReadFlag("addressbalanceindex", fAddressBalanceIndex) && fAddressBalanceIndex)) {
+        // the blocks above the chainstate are connected again, so their entries are counted then
+        BlockMap::iterator coinsTip = mapBlockIndex.find(pcoinsTip->GetBestBlock());
+        int nHeight = coinsTip == mapBlockIndex.end() ? -1 : coinsTip->second->nHeight;
+        LogPrintf("%s: building address balance index up to block %d\n", __func__, nHeight);
+        if (!pblocktree->BuildAddressBalanceIndex(nHeight))
+            return error("%s: failed to build address balance index", __func__);
+        pblocktree->WriteFlag("addressbalanceindex", true);
+    }
+
     // Check whether we have a timestamp index
     pblocktree->ReadFlag("timestampindex", fTimestampIndex);
     LogPrintf("%s: timestamp index %s\n", __func__, fTimestampIndex ? "enabled" : "disabled");
@@ -5230,6 +5334,8 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     // Initialize MTP state
     MTPState::GetMTPState()->InitializeFromChain(&chainActive, chainparams.GetConsensus());
 
+    PublishChainSnapshot();
+
     LogPrintf("%s: hashBestChain=%s height=%d date=%s progress=%f\n", __func__,
         chainActive.Tip()->GetBlockHash().ToString(), chainActive.Height(),
         DateTimeStrFormat("%Y-%m-%d %H:%M:%S", chainActive.Tip()->GetBlockTime()),
@@ -5442,6 +5548,7 @@ void UnloadBlockIndex()
     chainActive.SetTip(NULL);
     pindexBestInvalid = NULL;
     pindexBestHeader = NULL;
+    PublishChainSnapshot();
     txpools.clear();
     mapBlocksUnlinked.clear();
     vinfoBlockFile.clear();
@@ -5488,6 +5595,7 @@ bool InitBlockIndex(const CChainParams& chainparams)
     // Use the provided setting for -addressindex in the new database
     fAddressIndex = GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
     pblocktree->WriteFlag("addressindex", fAddressIndex);
+    pblocktree->WriteFlag("addressbalanceindex", fAddressIndex);
 
     fSpentIndex = GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
     pblocktree->WriteFlag("spentindex", fSpentIndex);
@@ -5958,7 +6066,7 @@ void DumpMempool(void)
 }
 
 //! Guess how far we are in the verification process at the given block index
-double GuessVerificationProgress(const ChainTxData& data, CBlockIndex *pindex) {
+double GuessVerificationProgress(const ChainTxData& data, const CBlockIndex *pindex) {
     if (pindex == NULL)
         return 0.0;
 
@@ -28,9 +28,13 @@ void RegisterValidationInterface(CValidationInterface* pwalletIn) {
     g_signals.ScriptForMining.connect(boost::bind(&CValidationInterface::GetScriptForMining, pwalletIn, _1));
     g_signals.BlockFound.connect(boost::bind(&CValidationInterface::ResetRequestCount, pwalletIn, _1));
     g_signals.NewPoWValidBlock.connect(boost::bind(&CValidationInterface::NewPoWValidBlock, pwalletIn, _1, _2));
+    g_signals.NotifyLelantusBlock.connect(boost::bind(&CValidationInterface::NotifyLelantusBlock, pwalletIn, _1));
+    g_signals.NotifySigmaBlock.connect(boost::bind(&CValidationInterface::NotifySigmaBlock, pwalletIn, _1));
 }
 
 void UnregisterValidationInterface(CValidationInterface* pwalletIn) {
+    g_signals.NotifySigmaBlock.disconnect(boost::bind(&CValidationInterface::NotifySigmaBlock, pwalletIn, _1));
+    g_signals.NotifyLelantusBlock.disconnect(boost::bind(&CValidationInterface::NotifyLelantusBlock, pwalletIn, _1));
     g_signals.BlockFound.disconnect(boost::bind(&CValidationInterface::ResetRequestCount, pwalletIn, _1));
     g_signals.ScriptForMining.disconnect(boost::bind(&CValidationInterface::GetScriptForMining, pwalletIn, _1));
     g_signals.BlockChecked.disconnect(boost::bind(&CValidationInterface::BlockChecked, pwalletIn, _1, _2));
@@ -48,6 +52,8 @@ void UnregisterValidationInterface(CValidationInterface* pwalletIn) {
 }
 
 void UnregisterAllValidationInterfaces() {
+    g_signals.NotifySigmaBlock.disconnect_all_slots();
+    g_signals.NotifyLelantusBlock.disconnect_all_slots();
     g_signals.BlockFound.disconnect_all_slots();
     g_signals.ScriptForMining.disconnect_all_slots();
     g_signals.BlockChecked.disconnect_all_slots();
@@ -25,6 +25,9 @@ class CDeterministicMNList;
 class CDeterministicMNListDiff;
 class uint256;
 
+namespace lelantus { struct CLelantusBlockUpdate; }
+namespace sigma { struct CSigmaBlockUpdate; }
+
 // These functions dispatch to one or all registered wallets
 
 /** Register a wallet to receive updates from core */
@@ -54,6 +57,8 @@ protected:
     virtual void GetScriptForMining(boost::shared_ptr<CReserveScript>&) {};
     virtual void ResetRequestCount(const uint256 &hash) {};
     virtual void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& block) {};
+    virtual void NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update) {}
+    virtual void NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update) {}
     friend void ::RegisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterAllValidationInterfaces();
@@ -108,6 +113,10 @@ struct CMainSignals {
      * Notifies listeners that a block which builds directly on our current tip
      * has been received and connected to the headers tree, though not validated yet */
     boost::signals2::signal<void (const CBlockIndex *, const std::shared_ptr<const CBlock>&)> NewPoWValidBlock;
+    /** Notifies listeners of the Lelantus mints, spends and coin groups of a block connected to or disconnected from the tip */
+    boost::signals2::signal<void (const lelantus::CLelantusBlockUpdate &)> NotifyLelantusBlock;
+    /** Notifies listeners of the Sigma mints, spends and coin groups of a block connected to or disconnected from the tip */
+    boost::signals2::signal<void (const sigma::CSigmaBlockUpdate &)> NotifySigmaBlock;
 };
 
 CMainSignals& GetMainSignals();
@@ -0,0 +1,176 @@
+#include "joinsplitcoinselector.h"
+#include "coincontrol.h"
+#include "walletexcept.h"
+
+#include "../chainparams.h"
+
+#include <algorithm>
+
+static const size_t NO_COIN = SIZE_MAX;
+
+JoinSplitCoinSelector::JoinSplitCoinSelector(
+        const CWallet& wallet,
+        const std::list<CSigmaEntry>& sigmaCoins,
+        const std::list<CLelantusEntry>& coins,
+        const CCoinControl *coinControl) :
+    wallet(wallet),
+    coinControl(coinControl),
+    fCoinControlUsed(coinControl != nullptr && coinControl->HasSelected()),
+    sigmaCoins(sigmaCoins),
+    sigmaBalance(0),
+    coins(coins.begin(), coins.end())
+{
+    for (const auto& coin : sigmaCoins) {
+        sigmaBalance += coin.get_denomination_value();
+    }
+
+    // sort by biggest amount. if it is same amount we will prefer the older block
+    std::stable_sort(this->coins.begin(), this->coins.end(), [](const CLelantusEntry& a, const CLelantusEntry& b) -> bool {
+        return a.amount != b.amount ? a.amount > b.amount : a.nHeight < b.nHeight;
+    });
+
+    prefixSums.reserve(this->coins.size() + 1);
+    prefixSums.push_back(0);
+    for (const auto& coin : this->coins) {
+        prefixSums.push_back(prefixSums.back() + coin.amount);
+    }
+}
+
+bool JoinSplitCoinSelector::SelectInputs(
+        CAmount required,
+        std::vector<CSigmaEntry>& sigmaCoinsToSpend_out,
+        std::vector<sigma::CoinDenomination>& coinsToMint_out,
+        std::vector<CLelantusEntry>& coinsToSpend_out,
+        CAmount& changeToMint)
+{
+    bool fSigmaUsed = false;
+    try {
+        if (sigmaBalance > 0) {
+            CAmount inputFromSigma = std::min(required, sigmaBalance);
+            SelectSigmaCoins(inputFromSigma, sigmaCoinsToSpend_out, coinsToMint_out); //try to spend sigma first
+            required -= inputFromSigma;
+            fSigmaUsed = true;
+        }
+    } catch (std::runtime_error const &) {
+    }
+
+    if (required > 0) {
+        SelectLelantusCoins(required, coinsToSpend_out, changeToMint);
+    }
+
+    return fSigmaUsed;
+}
+
+void JoinSplitCoinSelector::SelectSigmaCoins(
+        CAmount required,
+        std::vector<CSigmaEntry>& coinsToSpend_out,
+        std::vector<sigma::CoinDenomination>& coinsToMint_out)
+{
+    auto it = sigmaSelections.find(required);
+    if (it == sigmaSelections.end()) {
+        const auto& consensusParams = Params().GetConsensus();
+
+        SigmaSelection selection;
+        try {
+            std::list<CSigmaEntry> coinsCopy = sigmaCoins;
+            wallet.GetCoinsToSpend(required, selection.coinsToSpend, selection.coinsToMint, coinsCopy,
+                                   consensusParams.nMaxLelantusInputPerTransaction,
+                                   consensusParams.nMaxValueLelantusSpendPerTransaction, coinControl);
+        } catch (...) {
+            selection.error = std::current_exception();
+        }
+
+        it = sigmaSelections.emplace(required, std::move(selection)).first;
+    }
+
+    if (it->second.error) {
+        std::rethrow_exception(it->second.error);
+    }
+
+    coinsToSpend_out.insert(coinsToSpend_out.end(), it->second.coinsToSpend.begin(), it->second.coinsToSpend.end());
+    coinsToMint_out.insert(coinsToMint_out.end(), it->second.coinsToMint.begin(), it->second.coinsToMint.end());
+}
+
+void JoinSplitCoinSelector::CheckLelantusAmount(CAmount required) const
+{
+    if (required > Params().GetConsensus().nMaxValueLelantusSpendPerTransaction) {
+        throw std::invalid_argument(_("The required amount exceeds spend limit"));
+    }
+
+    if (required > prefixSums.back()) {
+        throw InsufficientFunds();
+    }
+}
+
+std::pair<size_t, size_t> JoinSplitCoinSelector::FindLelantusCoins(CAmount required) const
+{
+    if (required <= 0) {
+        return std::make_pair(0, NO_COIN);
+    }
+
+    // the biggest coins are taken while the amount still needed isn't smaller than the next one
+    size_t taken = std::upper_bound(prefixSums.begin(), prefixSums.end(), required) - prefixSums.begin() - 1;
+    if (prefixSums[taken] == required) {
+        return std::make_pair(taken, NO_COIN);
+    }
+
+    // then the smallest coin covering the rest, the oldest one of that amount
+    CAmount need = required - prefixSums[taken];
+    auto end = std::partition_point(coins.begin() + taken, coins.end(), [need](const CLelantusEntry& coin) {
+        return coin.amount >= need;
+    });
+    CAmount amount = std::prev(end)->amount;
+    auto chosen = std::partition_point(coins.begin() + taken, end, [amount](const CLelantusEntry& coin) {
+        return coin.amount > amount;
+    });
+
+    return std::make_pair(taken, chosen - coins.begin());
+}
+
+void JoinSplitCoinSelector::SelectLelantusCoins(
+        CAmount required,
+        std::vector<CLelantusEntry>& coinsToSpend_out,
+        CAmount& changeToMint) const
+{
+    CheckLelantusAmount(required);
+
+    std::vector<CLelantusEntry> coinsToSpend;
+    CAmount spend_val;
+
+    // If coinControl, want to use all inputs
+    if (fCoinControlUsed) {
+        coinsToSpend = coins;
+        spend_val = prefixSums.back();
+    } else {
+        size_t taken, chosen;
+        std::tie(taken, chosen) = FindLelantusCoins(required);
+
+        coinsToSpend.assign(coins.begin(), coins.begin() + taken);
+        spend_val = prefixSums[taken];
+        if (chosen != NO_COIN) {
+            coinsToSpend.push_back(coins[chosen]);
+            spend_val += coins[chosen].amount;
+        }
+    }
+
+    // sort by group id in ascending order, it is mandatory for creating a proper joinsplit
+    std::stable_sort(coinsToSpend.begin(), coinsToSpend.end(), [](const CLelantusEntry& a, const CLelantusEntry& b) -> bool {
+        return a.id < b.id;
+    });
+
+    changeToMint = spend_val - required;
+    coinsToSpend_out.insert(coinsToSpend_out.begin(), coinsToSpend.begin(), coinsToSpend.end());
+}
+
+size_t JoinSplitCoinSelector::CountLelantusCoins(CAmount required) const
+{
+    CheckLelantusAmount(required);
+
+    if (fCoinControlUsed) {
+        return coins.size();
+    }
+
+    size_t taken, chosen;
+    std::tie(taken, chosen) = FindLelantusCoins(required);
+    return taken + (chosen != NO_COIN ? 1 : 0);
+}
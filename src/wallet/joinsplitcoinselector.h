@@ -0,0 +1,83 @@
+#ifndef FIRO_WALLET_JOINSPLITCOINSELECTOR_H
+#define FIRO_WALLET_JOINSPLITCOINSELECTOR_H
+
+#include "wallet.h"
+
+#include "../amount.h"
+#include "../primitives/mint_spend.h"
+
+#include <exception>
+#include <list>
+#include <map>
+#include <vector>
+
+/**
+ * Spendable Sigma and Lelantus coins of the wallet, sorted once for the repeated input selections of a joinsplit
+ * and its fee estimation.
+ *
+ * Lelantus selections pick the same coins as CWallet::GetCoinsToJoinSplit with binary searches over prefix sums
+ * of the sorted coins. Sigma selections run CWallet::GetCoinsToSpend and are kept for the amount they were made
+ * for, as the same amount is usually selected again for the next fee.
+ */
+class JoinSplitCoinSelector {
+public:
+    JoinSplitCoinSelector(
+            const CWallet& wallet,
+            const std::list<CSigmaEntry>& sigmaCoins,
+            const std::list<CLelantusEntry>& coins,
+            const CCoinControl *coinControl = nullptr);
+
+    CAmount GetSigmaBalance() const { return sigmaBalance; }
+
+    /**
+     * Selects the inputs of a joinsplit spending required like LelantusJoinSplitBuilder does, Sigma coins first.
+     * Returns true if Sigma coins were selected, throws InsufficientFunds if the Lelantus coins aren't enough.
+     */
+    bool SelectInputs(
+            CAmount required,
+            std::vector<CSigmaEntry>& sigmaCoinsToSpend_out,
+            std::vector<sigma::CoinDenomination>& coinsToMint_out,
+            std::vector<CLelantusEntry>& coinsToSpend_out,
+            CAmount& changeToMint);
+
+    /** Selects Sigma coins to spend and the denominations to re-mint like CWallet::GetCoinsToSpend. */
+    void SelectSigmaCoins(
+            CAmount required,
+            std::vector<CSigmaEntry>& coinsToSpend_out,
+            std::vector<sigma::CoinDenomination>& coinsToMint_out);
+
+    /** Selects Lelantus coins to spend like CWallet::GetCoinsToJoinSplit, sorted by group id. */
+    void SelectLelantusCoins(
+            CAmount required,
+            std::vector<CLelantusEntry>& coinsToSpend_out,
+            CAmount& changeToMint) const;
+
+    /** Returns the number of coins SelectLelantusCoins would select, without copying them. */
+    size_t CountLelantusCoins(CAmount required) const;
+
+private:
+    struct SigmaSelection {
+        std::vector<CSigmaEntry> coinsToSpend;
+        std::vector<sigma::CoinDenomination> coinsToMint;
+        std::exception_ptr error;
+    };
+
+    void CheckLelantusAmount(CAmount required) const;
+    // returns the index of the first coin not taken in full, and the index of the coin completing the amount or size
+    std::pair<size_t, size_t> FindLelantusCoins(CAmount required) const;
+
+    const CWallet& wallet;
+    const CCoinControl *coinControl;
+    bool fCoinControlUsed;
+
+    std::list<CSigmaEntry> sigmaCoins;
+    CAmount sigmaBalance;
+    std::map<CAmount, SigmaSelection> sigmaSelections;
+
+    // sorted by biggest amount, then by the oldest block
+    std::vector<CLelantusEntry> coins;
+    // prefixSums[i] is the amount of the first i coins
+    std::vector<CAmount> prefixSums;
+};
+
+#endif //FIRO_WALLET_JOINSPLITCOINSELECTOR_H
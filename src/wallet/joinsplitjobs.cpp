@@ -0,0 +1,141 @@
+#include "joinsplitjobs.h"
+#include "lelantusjoinsplitbuilder.h"
+
+#include "../random.h"
+#include "../util.h"
+#include "../utiltime.h"
+
+CJoinSplitJobQueue joinSplitJobs;
+
+std::string JoinSplitJobStatusToString(JoinSplitJobStatus status)
+{
+    switch (status) {
+        case JoinSplitJobStatus::Queued:
+            return "queued";
+        case JoinSplitJobStatus::Proving:
+            return "proving";
+        case JoinSplitJobStatus::Committed:
+            return "committed";
+        case JoinSplitJobStatus::Failed:
+            return "failed";
+    }
+    return "unknown";
+}
+
+CJoinSplitJobQueue::CJoinSplitJobQueue()
+{
+}
+
+CJoinSplitJobQueue::~CJoinSplitJobQueue()
+{
+    Stop();
+}
+
+void CJoinSplitJobQueue::Start(int threads)
+{
+    workerPool.resize(std::max(threads, 1));
+    RenameThreadPool(workerPool, "firo-joinsplit");
+}
+
+void CJoinSplitJobQueue::Stop()
+{
+    workerPool.clear_queue();
+    workerPool.stop(true);
+
+    // the jobs which didn't start are dropped with the queue, they would be reported as queued forever
+    std::vector<uint256> cancelledJobs;
+    {
+        LOCK(cs);
+        for (const auto& job : jobs) {
+            if (job.second.status == JoinSplitJobStatus::Queued) {
+                cancelledJobs.push_back(job.first);
+            }
+        }
+    }
+
+    for (const uint256& id : cancelledJobs) {
+        Finish(id, JoinSplitJobStatus::Failed, uint256(), _("Cancelled at shutdown"));
+    }
+}
+
+uint256 CJoinSplitJobQueue::Submit(CWallet *wallet, const std::vector<CRecipient>& recipients, const std::vector<CAmount>& newMints)
+{
+    CJoinSplitJob job;
+    job.id = GetRandHash();
+    job.status = JoinSplitJobStatus::Queued;
+    job.nCreateTime = GetTime();
+
+    {
+        LOCK(cs);
+        jobs.emplace(job.id, job);
+    }
+
+    uint256 id = job.id;
+    workerPool.push([this, wallet, id, recipients, newMints](int) {
+        Process(wallet, id, recipients, newMints);
+    });
+
+    return id;
+}
+
+bool CJoinSplitJobQueue::GetJob(const uint256& id, CJoinSplitJob& job) const
+{
+    LOCK(cs);
+
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return false;
+    }
+
+    job = it->second;
+    return true;
+}
+
+void CJoinSplitJobQueue::Process(CWallet *wallet, const uint256& id, const std::vector<CRecipient>& recipients, const std::vector<CAmount>& newMints)
+{
+    {
+        LOCK(cs);
+        jobs[id].status = JoinSplitJobStatus::Proving;
+    }
+
+    try {
+        if (!wallet->zwallet) {
+            throw std::runtime_error(_("Lelantus feature requires HD wallet"));
+        }
+        if (wallet->IsLocked()) {
+            throw std::runtime_error(_("Wallet locked"));
+        }
+
+        LelantusJoinSplitBuilder builder(*wallet, *wallet->zwallet);
+        builder.proveWithoutLocks = true;
+
+        CAmount fee;
+        CWalletTx wtx = builder.Build(recipients, fee, newMints);
+
+        // the builder holds the locks again, no other transaction can take the coins before they are committed
+        if (!wallet->CommitLelantusTransaction(wtx, builder.spendCoins, builder.sigmaSpendCoins, builder.mintCoins)) {
+            throw std::runtime_error(_("Failed to commit the joinsplit transaction"));
+        }
+
+        Finish(id, JoinSplitJobStatus::Committed, wtx.GetHash(), "");
+    } catch (const std::exception& e) {
+        LogPrintf("CJoinSplitJobQueue: job %s failed: %s\n", id.ToString(), e.what());
+        Finish(id, JoinSplitJobStatus::Failed, uint256(), e.what());
+    }
+}
+
+void CJoinSplitJobQueue::Finish(const uint256& id, JoinSplitJobStatus status, const uint256& txid, const std::string& error)
+{
+    LOCK(cs);
+
+    auto& job = jobs[id];
+    job.status = status;
+    job.txid = txid;
+    job.error = error;
+
+    finishedJobs.push_back(id);
+    while (finishedJobs.size() > MAX_FINISHED_JOBS) {
+        jobs.erase(finishedJobs.front());
+        finishedJobs.pop_front();
+    }
+}
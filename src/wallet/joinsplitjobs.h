@@ -0,0 +1,71 @@
+#ifndef FIRO_WALLET_JOINSPLITJOBS_H
+#define FIRO_WALLET_JOINSPLITJOBS_H
+
+#include "wallet.h"
+
+#include "../amount.h"
+#include "../sync.h"
+#include "../uint256.h"
+
+#include <ctpl.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+enum class JoinSplitJobStatus {
+    Queued,
+    Proving,
+    Committed,
+    Failed
+};
+
+std::string JoinSplitJobStatusToString(JoinSplitJobStatus status);
+
+struct CJoinSplitJob {
+    uint256 id;
+    JoinSplitJobStatus status;
+    int64_t nCreateTime;
+    // set once the transaction is committed
+    uint256 txid;
+    // set if the job failed
+    std::string error;
+};
+
+/**
+ * Joinsplits created on worker threads, for the asynchronous mode of the joinsplit RPC.
+ *
+ * A worker selects the coins and takes the anonymity sets while cs_main and cs_wallet are held, releases them
+ * while the proof is created and commits the transaction once it holds them again. Finished jobs are kept to
+ * be polled, the oldest ones are dropped once there are more than MAX_FINISHED_JOBS.
+ */
+class CJoinSplitJobQueue {
+public:
+    CJoinSplitJobQueue();
+    ~CJoinSplitJobQueue();
+
+    void Start(int threads);
+    void Stop();
+
+    /** Queues a joinsplit paying the recipients and creating the mints, returns the id of the job. */
+    uint256 Submit(CWallet *wallet, const std::vector<CRecipient>& recipients, const std::vector<CAmount>& newMints);
+
+    bool GetJob(const uint256& id, CJoinSplitJob& job) const;
+
+private:
+    static const size_t MAX_FINISHED_JOBS = 1000;
+
+    void Process(CWallet *wallet, const uint256& id, const std::vector<CRecipient>& recipients, const std::vector<CAmount>& newMints);
+    void Finish(const uint256& id, JoinSplitJobStatus status, const uint256& txid, const std::string& error);
+
+    mutable CCriticalSection cs;
+    std::map<uint256, CJoinSplitJob> jobs;
+    std::deque<uint256> finishedJobs;
+
+    ctpl::thread_pool workerPool;
+};
+
+extern CJoinSplitJobQueue joinSplitJobs;
+
+#endif //FIRO_WALLET_JOINSPLITJOBS_H
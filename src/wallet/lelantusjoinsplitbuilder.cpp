@@ -1,5 +1,6 @@
 #include "lelantusjoinsplitbuilder.h"
 #include "walletexcept.h"
+#include "joinsplitcoinselector.h"
 
 #include "../primitives/transaction.h"
 
@@ -8,6 +9,7 @@
 
 
 #include "../lelantus.h"
+#include "../coinsetcache.h"
 
 #include <boost/format.hpp>
 #include <random>
@@ -19,8 +21,29 @@ struct CoinCompare
     }
 };
 
+// Releases the locks taken by the builder for its scope, they are taken again in the same order
+class BuilderLocksReleaser
+{
+public:
+    explicit BuilderLocksReleaser(CWallet& wallet) : wallet(wallet)
+    {
+        wallet.cs_wallet.unlock();
+        cs_main.unlock();
+    }
+
+    ~BuilderLocksReleaser()
+    {
+        cs_main.lock();
+        wallet.cs_wallet.lock();
+    }
+
+private:
+    CWallet& wallet;
+};
+
 LelantusJoinSplitBuilder::LelantusJoinSplitBuilder(CWallet& wallet, CHDMintWallet& mintWallet, const CCoinControl *coinControl) :
     wallet(wallet),
+    verifyProof(GetBoolArg("-verifyjoinsplit", DEFAULT_VERIFY_JOINSPLIT)),
     mintWallet(mintWallet)
 {
     cs_main.lock();
@@ -122,7 +145,9 @@ CWalletTx LelantusJoinSplitBuilder::Build(
 
     std::list<CSigmaEntry> sigmaCoins = pwalletMain->GetAvailableCoins(coinControl);
     std::list<CLelantusEntry> coins = pwalletMain->GetAvailableLelantusCoins(coinControl);
-    std::tie(fee, std::ignore) = wallet.EstimateJoinSplitFee(vOut + mint, recipientsToSubtractFee, sigmaCoins, coins, coinControl);
+    // coins are sorted once for the fee estimation and all the selections below
+    JoinSplitCoinSelector selector(wallet, sigmaCoins, coins, coinControl);
+    std::tie(fee, std::ignore) = wallet.EstimateJoinSplitFee(vOut + mint, recipientsToSubtractFee, selector);
 
     for (;;) {
         // In case of not enough fee, reset mint seed counter
@@ -188,36 +213,8 @@ CWalletTx LelantusJoinSplitBuilder::Build(
         CAmount changeToMint = 0;
 
         std::vector<sigma::CoinDenomination> denomChanges;
-        try {
-            CAmount availableBalance(0);
-            for (auto coin : sigmaCoins) {
-                availableBalance += coin.get_denomination_value();
-            }
-            if(availableBalance > 0) {
-                CAmount inputFromSigma;
-                if (required > availableBalance)
-                    inputFromSigma = availableBalance;
-                else
-                    inputFromSigma = required;
-
-                std::list<CSigmaEntry> sigmaCoinsCp = sigmaCoins;
-                wallet.GetCoinsToSpend(inputFromSigma, sigmaSpendCoins, denomChanges, sigmaCoinsCp, //try to spend sigma first
-                                       consensusParams.nMaxLelantusInputPerTransaction,
-                                       consensusParams.nMaxValueLelantusSpendPerTransaction, coinControl);
-
-                required -= inputFromSigma;
-
-                isSigmaToLelantusJoinSplit = true;
-            }
-        } catch (std::runtime_error const &) {
-        }
-
-        if(required > 0) {
-            if (!wallet.GetCoinsToJoinSplit(required, spendCoins, changeToMint, coins,
-                                            consensusParams.nMaxLelantusInputPerTransaction,
-                                            consensusParams.nMaxValueLelantusSpendPerTransaction, coinControl)) {
-                throw InsufficientFunds();
-            }
+        if (selector.SelectInputs(required, sigmaSpendCoins, denomChanges, spendCoins, changeToMint)) {
+            isSigmaToLelantusJoinSplit = true;
         }
 
         if ((sigmaSpendCoins.size() + spendCoins.size()) > consensusParams.nMaxLelantusInputPerTransaction)
@@ -416,12 +413,11 @@ void LelantusJoinSplitBuilder::GenerateMints(const std::vector<CAmount>& newMint
     }
 }
 
-void LelantusJoinSplitBuilder::CreateJoinSplit(
+LelantusJoinSplitBuilder::JoinSplitInputs LelantusJoinSplitBuilder::PrepareJoinSplit(
         const uint256& txHash,
         const std::vector<lelantus::PrivateCoin>& Cout,
         const uint64_t& Vout,
-        const uint64_t& fee,
-        CMutableTransaction& tx) {
+        const uint64_t& fee) {
 
     lelantus::CLelantusState* state = lelantus::CLelantusState::GetState();
     auto params = lelantus::Params::get_default();
@@ -536,37 +532,120 @@ void LelantusJoinSplitBuilder::CreateJoinSplit(
                     group) < 2)
                 throw std::runtime_error(
                         _("Has to have at least two mint coins with at least 1 confirmation in order to spend a coin"));
-            std::vector<lelantus::PublicCoin> set;
-            set.reserve(group.size());
-            for(auto& coin : group) {
-                set.push_back(coin.getValue() + params->get_h1() * denom);
-            }
+            LOCK(cs_main);
+            sigma::CSigmaState::SigmaCoinGroupInfo coinGroup;
+            if (!sigmaState->GetCoinGroupInfo(spend.get_denomination(), groupId, coinGroup) || !mapBlockIndex.count(blockHash))
+                throw std::runtime_error(_("One of the sigma coins has not been found in the chain!"));
+
+            auto set = lelantus::sigmaToLelantusSetCache.GetAnonymitySet(
+                    spend.get_denomination(),
+                    groupId,
+                    coinGroup.firstBlock,
+                    mapBlockIndex[blockHash],
+                    chainActive.Height() >= Params().GetConsensus().nStartSigmaBlacklist);
+            if (!set)
+                throw std::runtime_error(_("One of the sigma coins has not been found in the chain!"));
+
             groupBlockHashes[denom / 1000 + groupId] = blockHash;
-            anonymity_sets[denom / 1000 + groupId] = set;
+            anonymity_sets[denom / 1000 + groupId] = *set;
         }
 
     }
 
     std::sort(coins.begin(), coins.end(), CoinCompare());
 
-    lelantus::JoinSplit joinSplit(params, coins, anonymity_sets, anonymity_set_hashes, Vout, Cout, fee, groupBlockHashes, txHash, version);
+    JoinSplitInputs inputs;
+    inputs.coins = std::move(coins);
+    inputs.anonymity_sets = std::move(anonymity_sets);
+    inputs.anonymity_set_hashes = std::move(anonymity_set_hashes);
+    inputs.groupBlockHashes = std::move(groupBlockHashes);
+    inputs.Cout = Cout;
+    inputs.Vout = Vout;
+    inputs.fee = fee;
+    inputs.txHash = txHash;
+    inputs.version = version;
+    inputs.fPayload = chainActive.Height() >= Params().GetConsensus().nLelantusV3PayloadStartBlock;
+    return inputs;
+}
+
+std::vector<unsigned char> LelantusJoinSplitBuilder::ProveJoinSplit(const JoinSplitInputs& inputs) const {
+    auto params = lelantus::Params::get_default();
 
-    std::vector<lelantus::PublicCoin>  pCout;
-    pCout.reserve(Cout.size());
-    for(const auto& coin : Cout)
-        pCout.emplace_back(coin.getPublicCoin());
+    lelantus::JoinSplit joinSplit(params, inputs.coins, inputs.anonymity_sets, inputs.anonymity_set_hashes, inputs.Vout, inputs.Cout, inputs.fee, inputs.groupBlockHashes, inputs.txHash, inputs.version);
 
-    if (!joinSplit.Verify(anonymity_sets, anonymity_set_hashes, pCout, Vout, txHash)) {
-        throw std::runtime_error(_("The joinsplit transaction failed to verify"));
+    if (verifyProof) {
+        std::vector<lelantus::PublicCoin>  pCout;
+        pCout.reserve(inputs.Cout.size());
+        for(const auto& coin : inputs.Cout)
+            pCout.emplace_back(coin.getPublicCoin());
+
+        if (!joinSplit.Verify(inputs.anonymity_sets, inputs.anonymity_set_hashes, pCout, inputs.Vout, inputs.txHash)) {
+            throw std::runtime_error(_("The joinsplit transaction failed to verify"));
+        }
     }
 
-    // construct spend script
     CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
     serialized << joinSplit;
+    return std::vector<unsigned char>(serialized.begin(), serialized.end());
+}
+
+std::vector<unsigned char> LelantusJoinSplitBuilder::ProveJoinSplitWithoutLocks(const JoinSplitInputs& inputs) {
+    // keep other transactions off the spent coins and the counters of the new mints until the locks are taken again
+    std::vector<COutPoint> reserved;
+    for (const auto& spend : spendCoins) {
+        COutPoint outPoint;
+        if (lelantus::GetOutPoint(outPoint, lelantus::PublicCoin(spend.value)) && !wallet.IsLockedCoin(outPoint.hash, outPoint.n))
+            reserved.push_back(outPoint);
+    }
+    for (const auto& spend : sigmaSpendCoins) {
+        COutPoint outPoint;
+        if (sigma::GetOutPoint(outPoint, sigma::PublicCoin(spend.value, spend.get_denomination())) && !wallet.IsLockedCoin(outPoint.hash, outPoint.n))
+            reserved.push_back(outPoint);
+    }
+    for (const auto& outPoint : reserved)
+        wallet.LockCoin(outPoint);
+
+    {
+        CWalletDB walletdb(wallet.strWalletFile);
+        mintWallet.UpdateCountDB(walletdb);
+    }
+
+    std::vector<unsigned char> proof;
+    try {
+        BuilderLocksReleaser unlocked(wallet);
+        proof = ProveJoinSplit(inputs);
+    } catch (...) {
+        for (const auto& outPoint : reserved)
+            wallet.UnlockCoin(outPoint);
+        throw;
+    }
 
+    for (const auto& outPoint : reserved)
+        wallet.UnlockCoin(outPoint);
+
+    for (const auto& groupBlockHash : inputs.groupBlockHashes) {
+        auto it = mapBlockIndex.find(groupBlockHash.second);
+        if (it == mapBlockIndex.end() || !chainActive.Contains(it->second))
+            throw std::runtime_error(_("The chain was reorganized while the joinsplit proof was created"));
+    }
+
+    return proof;
+}
+
+void LelantusJoinSplitBuilder::CreateJoinSplit(
+        const uint256& txHash,
+        const std::vector<lelantus::PrivateCoin>& Cout,
+        const uint64_t& Vout,
+        const uint64_t& fee,
+        CMutableTransaction& tx) {
+
+    JoinSplitInputs inputs = PrepareJoinSplit(txHash, Cout, Vout, fee);
+    std::vector<unsigned char> serialized = proveWithoutLocks ? ProveJoinSplitWithoutLocks(inputs) : ProveJoinSplit(inputs);
+
+    // construct spend script
     CScript script;
 
-    if (chainActive.Height() >= Params().GetConsensus().nLelantusV3PayloadStartBlock) {
+    if (inputs.fPayload) {
         script << OP_LELANTUSJOINSPLITPAYLOAD;
         tx.nVersion = 3;
         tx.nType = TRANSACTION_LELANTUS;
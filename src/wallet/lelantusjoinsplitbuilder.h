@@ -22,6 +22,20 @@ public:
         std::function<void(CTxOut & , LelantusJoinSplitBuilder const &)> outModifier = nullptr);
 
 private:
+    // Everything the prover needs, taken from the chain and the wallet while the locks are held
+    struct JoinSplitInputs {
+        std::vector<std::pair<lelantus::PrivateCoin, uint32_t>> coins;
+        std::map<uint32_t, std::vector<lelantus::PublicCoin>> anonymity_sets;
+        std::vector<std::vector<unsigned char>> anonymity_set_hashes;
+        std::map<uint32_t, uint256> groupBlockHashes;
+        std::vector<lelantus::PrivateCoin> Cout;
+        uint64_t Vout;
+        uint64_t fee;
+        uint256 txHash;
+        int version;
+        bool fPayload;
+    };
+
     void GenerateMints(const std::vector<CAmount>& newMints, const CAmount& changeToMint, std::vector<lelantus::PrivateCoin>& Cout, std::vector<CTxOut>& outputs);
     void CreateJoinSplit(
             const uint256& txHash,
@@ -29,6 +43,13 @@ private:
             const uint64_t& Vout,
             const uint64_t& fee,
             CMutableTransaction& tx);
+    JoinSplitInputs PrepareJoinSplit(
+            const uint256& txHash,
+            const std::vector<lelantus::PrivateCoin>& Cout,
+            const uint64_t& Vout,
+            const uint64_t& fee);
+    std::vector<unsigned char> ProveJoinSplit(const JoinSplitInputs& inputs) const;
+    std::vector<unsigned char> ProveJoinSplitWithoutLocks(const JoinSplitInputs& inputs);
 
 public:
     std::vector<CLelantusEntry> spendCoins;
@@ -41,6 +62,12 @@ public:
     bool isSigmaToLelantusJoinSplit = false;
     CAmount fee = 0;
 
+    // Releases cs_main and cs_wallet while the proof is created, the caller must not hold them itself.
+    // The spent coins are locked and the mint counter is written meanwhile, so other transactions don't reuse them.
+    bool proveWithoutLocks = false;
+    // Verifies the created proof before the transaction is returned
+    bool verifyProof;
+
 private:
     CHDMintWallet& mintWallet;
 };
@@ -29,6 +29,8 @@
 #include "walletexcept.h"
 #include "masternode-payments.h"
 #include "lelantusjoinsplitbuilder.h"
+#include "joinsplitjobs.h"
+#include "joinsplitcoinselector.h"
 #include "bip47/paymentchannel.h"
 #include "bip47/account.h"
 
@@ -3435,9 +3437,9 @@ UniValue joinsplit(const JSONRPCRequest& request) {
         return NullUniValue;
     }
 
-    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 4)
         throw std::runtime_error(
-                "joinsplit {\"address\":amount,...} ([\"address\",...] )\n"
+                "joinsplit {\"address\":amount,...} ([\"address\",...] ) ([amount,...]) (async)\n"
                 "\nSpend lelantus and mint in one transaction, you need at least provide one of 1-st or 3-rd arguments."
                 + HelpRequiringPassphrase(pwallet) + "\n"
                 "\nArguments:\n"
@@ -3459,14 +3461,19 @@ UniValue joinsplit(const JSONRPCRequest& request) {
                 "      \"mint\"\n"
                 "      ,...\n"
                 "    }\n"
+                "4. async                   (boolean, optional, default=false) Create the proof in the background and return the id of the job,\n"
+                "                           its state is returned by getjoinsplitstatus.\n"
                 "\nResult:\n"
                 "\"transactionid\"          (string) The transaction id for the send. Only 1 transaction is created regardless of \n"
                 "                                    the number of addresses.\n"
+                "\"jobid\"                  (string) The id of the job if async is set.\n"
                 "\nExamples:\n"
                 "\nSend two amounts to two different addresses:\n"
                 + HelpExampleCli("joinsplit", "\"{\\\"1D1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XZ\\\":0.01,\\\"1353tsE8YMTA4EuV7dgUXGjNFf9KpVvKHz\\\":0.02}\"") +
                 "\nSend two amounts to two different addresses and subtract fee from amount:\n"
-                + HelpExampleCli("joinsplit", "\"{\\\"1D1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XZ\\\":0.01,\\\"1353tsE8YMTA4EuV7dgUXGjNFf9KpVvKHz\\\":0.02}\"\"[\\\"1D1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XZ\\\",\\\"1353tsE8YMTA4EuV7dgUXGjNFf9KpVvKHz\\\"]\"")
+                + HelpExampleCli("joinsplit", "\"{\\\"1D1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XZ\\\":0.01,\\\"1353tsE8YMTA4EuV7dgUXGjNFf9KpVvKHz\\\":0.02}\"\"[\\\"1D1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XZ\\\",\\\"1353tsE8YMTA4EuV7dgUXGjNFf9KpVvKHz\\\"]\"") +
+                "\nSend an amount in the background:\n"
+                + HelpExampleCli("joinsplit", "\"{\\\"1D1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XZ\\\":0.01}\" \"[]\" \"{}\" true")
         );
 
     if (!lelantus::IsLelantusAllowed()) {
@@ -3546,6 +3553,10 @@ UniValue joinsplit(const JSONRPCRequest& request) {
 
     EnsureWalletIsUnlocked(pwallet);
 
+    if (request.params.size() > 3 && request.params[3].get_bool()) {
+        return joinSplitJobs.Submit(pwallet, vecSend, vMints).GetHex();
+    }
+
     CWalletTx wtx;
 
     try {
@@ -3561,6 +3572,201 @@ UniValue joinsplit(const JSONRPCRequest& request) {
     return wtx.GetHash().GetHex();
 }
 
+UniValue simulatejoinsplit(const JSONRPCRequest& request) {
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
+        throw std::runtime_error(
+                "simulatejoinsplit {\"address\":amount,...} ([\"address\",...] ) ([amount,...])\n"
+                "\nReturns the fee and the inputs joinsplit would select for the same arguments, without creating a transaction.\n"
+                "\nArguments:\n"
+                "1. \"amounts\"             (string, optional) A json object with addresses and amounts\n"
+                "    {\n"
+                "      \"address\":amount   (numeric or string) The Firo address is the key, the numeric amount (can be string) in " + CURRENCY_UNIT + " is the value\n"
+                "      ,...\n"
+                "    }\n"
+                "2. subtractfeefromamount   (string, optional) A json array with addresses to subtract the fee from.\n"
+                "3. output mints            (numeric, optional) A json object with amounts to mint\n"
+                "\nResult:\n"
+                "{\n"
+                "  \"fee\" : x.xxx,          (numeric) The estimated fee in " + CURRENCY_UNIT + "\n"
+                "  \"size\" : n,             (numeric) The estimated size of the transaction in bytes\n"
+                "  \"inputs\" : [            (array) The coins which would be spent\n"
+                "    {\n"
+                "      \"type\" : \"type\",     (string) sigma or lelantus\n"
+                "      \"amount\" : x.xxx,    (numeric) The value of the coin\n"
+                "      \"groupid\" : n,       (numeric) The anonymity set the coin belongs to\n"
+                "      \"height\" : n         (numeric) The height of the block the coin was minted in\n"
+                "    }\n"
+                "    ,...\n"
+                "  ],\n"
+                "  \"change\" : x.xxx        (numeric) The amount which would be minted back to the wallet\n"
+                "}\n"
+                "\nExamples:\n"
+                + HelpExampleCli("simulatejoinsplit", "\"{\\\"1D1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XZ\\\":0.01}\"")
+                + HelpExampleRpc("simulatejoinsplit", "\"{\\\"1D1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XZ\\\":0.01}\"")
+        );
+
+    if (!lelantus::IsLelantusAllowed()) {
+        throw JSONRPCError(RPC_WALLET_ERROR, "Lelantus is not activated yet");
+    }
+
+    EnsureLelantusWalletIsAvailable();
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    UniValue sendTo = request.params[0].get_obj();
+
+    std::unordered_set<std::string> subtractFeeFromAmountSet;
+    if (request.params.size() > 1 && request.params[1].isArray()) {
+        UniValue subtractFeeFromAmount = request.params[1].get_array();
+        for (int i = subtractFeeFromAmount.size(); i--;) {
+            subtractFeeFromAmountSet.insert(subtractFeeFromAmount[i].get_str());
+        }
+    }
+
+    UniValue mintAmounts;
+    if (request.params.size() > 2 && request.params[2].isObject()) {
+        mintAmounts = request.params[2].get_obj();
+    }
+
+    CAmount vOut = 0;
+    CAmount mint = 0;
+    bool fSubtractFeeFromAmount = false;
+
+    auto keys = sendTo.getKeys();
+    std::vector<UniValue> mints = mintAmounts.empty() ? std::vector<UniValue>() : mintAmounts.getValues();
+
+    if(keys.empty() && mints.empty())
+        throw JSONRPCError(RPC_TYPE_ERROR, "You have to provide at least public addressed or amount to mint");
+
+    for (const auto& strAddr : keys) {
+        if (!CBitcoinAddress(strAddr).IsValid())
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid Firo address: " + strAddr);
+
+        CAmount nAmount = AmountFromValue(sendTo[strAddr]);
+        if (nAmount <= 0) {
+            throw JSONRPCError(RPC_TYPE_ERROR, "Invalid amount for send");
+        }
+        vOut += nAmount;
+
+        if (subtractFeeFromAmountSet.count(strAddr)) {
+            fSubtractFeeFromAmount = true;
+        }
+    }
+
+    for(const auto& value : mints) {
+        auto val = value.get_int64();
+        if (!lelantus::IsAvailableToMint(val) || val <= 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Amount to mint is invalid.\n");
+        }
+        mint += val;
+    }
+
+    // the private values of the coins aren't needed to pick them, so a locked wallet can be simulated too
+    JoinSplitCoinSelector selector(*pwallet, pwallet->GetAvailableCoins(nullptr, false, true), pwallet->GetAvailableLelantusCoins(nullptr, false, true));
+
+    CAmount fee;
+    unsigned int size;
+    std::tie(fee, size) = pwallet->EstimateJoinSplitFee(vOut + mint, fSubtractFeeFromAmount, selector);
+
+    CAmount required = vOut + mint;
+    if (!fSubtractFeeFromAmount) {
+        required += fee;
+    }
+
+    std::vector<CSigmaEntry> sigmaSpendCoins;
+    std::vector<sigma::CoinDenomination> denomChanges;
+    std::vector<CLelantusEntry> spendCoins;
+    CAmount changeToMint = 0;
+
+    try {
+        selector.SelectInputs(required, sigmaSpendCoins, denomChanges, spendCoins, changeToMint);
+    }
+    catch (const InsufficientFunds& e) {
+        throw JSONRPCError(RPC_WALLET_INSUFFICIENT_FUNDS, e.what());
+    }
+    catch (const std::exception& e) {
+        throw JSONRPCError(RPC_WALLET_ERROR, e.what());
+    }
+
+    CAmount input = 0;
+    UniValue inputs(UniValue::VARR);
+    for (const auto& coin : sigmaSpendCoins) {
+        UniValue entry(UniValue::VOBJ);
+        entry.push_back(Pair("type", "sigma"));
+        entry.push_back(Pair("amount", ValueFromAmount(coin.get_denomination_value())));
+        entry.push_back(Pair("groupid", coin.id));
+        entry.push_back(Pair("height", coin.nHeight));
+        inputs.push_back(entry);
+        input += coin.get_denomination_value();
+    }
+    for (const auto& coin : spendCoins) {
+        UniValue entry(UniValue::VOBJ);
+        entry.push_back(Pair("type", "lelantus"));
+        entry.push_back(Pair("amount", ValueFromAmount(coin.amount)));
+        entry.push_back(Pair("groupid", coin.id));
+        entry.push_back(Pair("height", coin.nHeight));
+        inputs.push_back(entry);
+        input += coin.amount;
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("fee", ValueFromAmount(fee)));
+    result.push_back(Pair("size", (uint64_t)size));
+    result.push_back(Pair("inputs", inputs));
+    result.push_back(Pair("change", ValueFromAmount(input - required)));
+
+    return result;
+}
+
+UniValue getjoinsplitstatus(const JSONRPCRequest& request) {
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+                "getjoinsplitstatus \"jobid\"\n"
+                "\nReturns the state of a joinsplit created with async set.\n"
+                "\nArguments:\n"
+                "1. \"jobid\"              (string, required) The id returned by joinsplit\n"
+                "\nResult:\n"
+                "{\n"
+                "  \"jobid\" : \"id\",        (string) The id of the job\n"
+                "  \"status\" : \"status\",   (string) One of queued, proving, committed or failed\n"
+                "  \"time\" : n,            (numeric) The time the job was created in seconds since epoch\n"
+                "  \"txid\" : \"id\",         (string) The id of the transaction if it is committed\n"
+                "  \"error\" : \"message\",   (string) The reason of the failure if it failed\n"
+                "}\n"
+                "\nExamples:\n"
+                + HelpExampleCli("getjoinsplitstatus", "\"a64bf7b459d3bb09653e444d75a942e9848ed8e1f30e2890f999426ed6dd4a2c\"")
+                + HelpExampleRpc("getjoinsplitstatus", "\"a64bf7b459d3bb09653e444d75a942e9848ed8e1f30e2890f999426ed6dd4a2c\"")
+        );
+
+    CJoinSplitJob job;
+    if (!joinSplitJobs.GetJob(ParseHashV(request.params[0], "jobid"), job)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown joinsplit job");
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("jobid", job.id.GetHex()));
+    result.push_back(Pair("status", JoinSplitJobStatusToString(job.status)));
+    result.push_back(Pair("time", job.nCreateTime));
+    if (job.status == JoinSplitJobStatus::Committed) {
+        result.push_back(Pair("txid", job.txid.GetHex()));
+    }
+    if (job.status == JoinSplitJobStatus::Failed) {
+        result.push_back(Pair("error", job.error));
+    }
+
+    return result;
+}
+
 UniValue resetsigmamint(const JSONRPCRequest& request) {
     CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
     if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
@@ -3580,7 +3786,7 @@ UniValue resetsigmamint(const JSONRPCRequest& request) {
 
     BOOST_FOREACH(CMintMeta &mint, listMints) {
         CHDMint dMint;
-        if (!walletdb.ReadHDMint(mint.GetPubCoinValueHash(), false, dMint)){
+        if (!pwallet->zwallet->GetTracker().GetHDMint(mint.GetPubCoinValueHash(), false, dMint)){
             continue;
         }
         dMint.SetUsed(false);
@@ -3610,7 +3816,7 @@ UniValue resetlelantusmint(const JSONRPCRequest& request) {
 
     BOOST_FOREACH(const CLelantusMintMeta& mint, listMints) {
         CHDMint dMint;
-        if (!walletdb.ReadHDMint(mint.GetPubCoinValueHash(), true, dMint)) {
+        if (!pwallet->zwallet->GetTracker().GetHDMint(mint.GetPubCoinValueHash(), true, dMint)) {
             continue;
         }
         dMint.SetUsed(false);
@@ -3806,7 +4012,7 @@ UniValue setsigmamintstatus(const JSONRPCRequest& request) {
             continue;
 
         CHDMint dMint;
-        if (!walletdb.ReadHDMint(mint.GetPubCoinValueHash(), false, dMint)){
+        if (!pwallet->zwallet->GetTracker().GetHDMint(mint.GetPubCoinValueHash(), false, dMint)){
             continue;
         }
 
@@ -3888,7 +4094,7 @@ UniValue setlelantusmintstatus(const JSONRPCRequest& request) {
             continue;
 
         CHDMint dMint;
-        if (!walletdb.ReadHDMint(mint.GetPubCoinValueHash(), true, dMint)){
+        if (!pwallet->zwallet->GetTracker().GetHDMint(mint.GetPubCoinValueHash(), true, dMint)){
             continue;
         }
 
@@ -4883,6 +5089,8 @@ static const CRPCCommand commands[] =
     { "wallet",             "autoMintlelantus",         &autoMintlelantus,         false },
     { "wallet",             "spendmany",                &spendmany,                false },
     { "wallet",             "joinsplit",                &joinsplit,                false },
+    { "wallet",             "getjoinsplitstatus",       &getjoinsplitstatus,       true  },
+    { "wallet",             "simulatejoinsplit",        &simulatejoinsplit,        false },
     { "wallet",             "resetsigmamint",           &resetsigmamint,           false },
     { "wallet",             "resetlelantusmint",        &resetlelantusmint,        false },
     { "wallet",             "setsigmamintstatus",       &setsigmamintstatus,       false },
@@ -0,0 +1,27 @@
+#include "../joinsplitjobs.h"
+
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(joinsplitjobs_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(stop_cancels_queued_jobs)
+{
+    // without worker threads the jobs stay in the queue
+    CJoinSplitJobQueue queue;
+    uint256 id = queue.Submit(nullptr, {}, {});
+
+    CJoinSplitJob job;
+    BOOST_REQUIRE(queue.GetJob(id, job));
+    BOOST_CHECK(job.status == JoinSplitJobStatus::Queued);
+
+    queue.Stop();
+
+    BOOST_REQUIRE(queue.GetJob(id, job));
+    BOOST_CHECK(job.status == JoinSplitJobStatus::Failed);
+    BOOST_CHECK(job.txid.IsNull());
+    BOOST_CHECK(!job.error.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
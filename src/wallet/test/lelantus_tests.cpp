@@ -2,6 +2,7 @@
 #include "../../validation.h"
 #include "../../lelantus.h"
 #include "../walletexcept.h"
+#include "../joinsplitcoinselector.h"
 #include <exception>
 
 #include "../wallet.h"
@@ -110,6 +111,12 @@ BOOST_AUTO_TEST_CASE(get_and_list_mints)
     BOOST_CHECK(std::is_permutation(confirmed.begin(), confirmed.end(), confirmedAmounts.begin()));
     BOOST_CHECK(std::is_permutation(all.begin(), all.end(), allAmounts.begin()));
 
+    // mints of erased transactions are not listed anymore
+    BOOST_CHECK(pwalletMain->EraseFromWallet(txs.back().GetHash()));
+    pwalletMain->ListAvailableLelantusMintCoins(allCoins, false);
+    all = extractAmountsFromOutputs(allCoins);
+    BOOST_CHECK(std::is_permutation(all.begin(), all.end(), confirmedAmounts.begin()));
+
     // get mints
     CLelantusEntry entry;
     BOOST_CHECK(pwalletMain->GetMint(mints.front().GetSerialHash(), entry));
@@ -299,4 +306,58 @@ BOOST_AUTO_TEST_CASE(spend)
     lelantus::CLelantusState::GetState()->Reset();
 }
 
+BOOST_AUTO_TEST_CASE(joinsplit_coin_selector)
+{
+    LOCK(pwalletMain->cs_wallet);
+
+    auto& consensus = ::Params().GetConsensus();
+
+    // coins of equal amounts are ordered by the height
+    std::list<CLelantusEntry> coins;
+    for (int i = 0; i < 40; i++) {
+        CLelantusEntry coin;
+        coin.IsUsed = false;
+        coin.amount = ((i * 7) % 11 + 1) * COIN / 2;
+        coin.nHeight = 100 + (i * 13) % 17;
+        coin.id = 1 + i % 3;
+        coins.push_back(coin);
+    }
+
+    JoinSplitCoinSelector selector(*pwalletMain, {}, coins);
+    BOOST_CHECK_EQUAL(selector.GetSigmaBalance(), 0);
+
+    CAmount balance = 0;
+    for (const auto& coin : coins) {
+        balance += coin.amount;
+    }
+
+    for (CAmount required = COIN / 4; required <= balance + COIN; required += COIN / 4) {
+        std::vector<CLelantusEntry> expected, selected;
+        CAmount expectedChange = 0, change = 0;
+
+        bool fInsufficient = false;
+        try {
+            pwalletMain->GetCoinsToJoinSplit(required, expected, expectedChange, coins,
+                    consensus.nMaxLelantusInputPerTransaction, consensus.nMaxValueLelantusSpendPerTransaction);
+        } catch (const InsufficientFunds&) {
+            fInsufficient = true;
+        }
+
+        if (fInsufficient) {
+            BOOST_CHECK_THROW(selector.SelectLelantusCoins(required, selected, change), InsufficientFunds);
+            continue;
+        }
+
+        selector.SelectLelantusCoins(required, selected, change);
+        BOOST_CHECK_EQUAL(change, expectedChange);
+        BOOST_CHECK_EQUAL(selector.CountLelantusCoins(required), expected.size());
+        BOOST_REQUIRE_EQUAL(selected.size(), expected.size());
+        for (size_t i = 0; i < selected.size(); i++) {
+            BOOST_CHECK_EQUAL(selected[i].amount, expected[i].amount);
+            BOOST_CHECK_EQUAL(selected[i].nHeight, expected[i].nHeight);
+            BOOST_CHECK_EQUAL(selected[i].id, expected[i].id);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,8 +7,11 @@
 #include "walletexcept.h"
 #include "sigmaspendbuilder.h"
 #include "lelantusjoinsplitbuilder.h"
+#include "joinsplitjobs.h"
+#include "joinsplitcoinselector.h"
 #include "amount.h"
 #include "base58.h"
+#include "blockfilter.h"
 #include "checkpoints.h"
 #include "chain.h"
 #include "wallet/coincontrol.h"
@@ -1185,6 +1188,7 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
                          wtxIn.hashBlock.ToString());
         }
         AddToSpends(hash);
+        AddToMintOutputs(wtx);
     }
 
     bool fUpdated = false;
@@ -1246,6 +1250,41 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
     return true;
 }
 
+void CWallet::AddToMintOutputs(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+
+    uint256 hash = wtx.GetHash();
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        const CScript& script = wtx.tx->vout[i].scriptPubKey;
+        CWalletMintOutput output;
+        try {
+            if (script.IsSigmaMint()) {
+                output.fLelantus = false;
+                output.pubCoin = sigma::ParseSigmaMintScript(script);
+            } else if (script.IsLelantusMint() || script.IsLelantusJMint()) {
+                output.fLelantus = true;
+                lelantus::ParseLelantusMintScript(script, output.pubCoin);
+            } else {
+                continue;
+            }
+        } catch (std::invalid_argument &) {
+            continue;
+        }
+        mapMintOutputs[COutPoint(hash, i)] = output;
+    }
+}
+
+void CWallet::RemoveFromMintOutputs(const uint256& hash)
+{
+    AssertLockHeld(cs_wallet);
+
+    auto it = mapMintOutputs.lower_bound(COutPoint(hash, 0));
+    while (it != mapMintOutputs.end() && it->first.hash == hash) {
+        it = mapMintOutputs.erase(it);
+    }
+}
+
 bool CWallet::LoadToWallet(const CWalletTx& wtxIn)
 {
     uint256 hash = wtxIn.GetHash();
@@ -1255,6 +1294,7 @@ bool CWallet::LoadToWallet(const CWalletTx& wtxIn)
     wtx.BindWallet(this);
     wtxOrdered.insert(make_pair(wtx.nOrderPos, TxPair(&wtx, (CAccountingEntry*)0)));
     AddToSpends(hash);
+    AddToMintOutputs(wtx);
     BOOST_FOREACH(const CTxIn& txin, wtx.tx->vin) {
         if (mapWallet.count(txin.prevout.hash)) {
             CWalletTx& prevtx = mapWallet[txin.prevout.hash];
@@ -1441,7 +1481,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
                 CLelantusMintMeta meta;
                 if(zwallet->GetTracker().GetMetaFromSerial(hashSerial, meta)){
                     meta.isUsed = false;
-                    zwallet->GetTracker().UpdateState(meta);
+                    zwallet->GetTracker().UpdateState(meta, false);
 
                     // erase lelantus spend entry
                     CLelantusSpendEntry spendEntry;
@@ -1449,6 +1489,8 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
                     walletdb.EraseLelantusSpendSerialEntry(spendEntry);
                 }
             }
+            if (!zwallet->GetTracker().Flush())
+                LogPrintf("%s: failed to write the unspent Lelantus mints, they are kept in memory\n", __func__);
         }
 
         if (wtx.tx->IsSigmaMint()) {
@@ -1719,7 +1761,6 @@ CAmount CWallet::GetCredit(const CTxOut& txout, const isminefilter& filter) cons
     if (txout.scriptPubKey.IsLelantusJMint()) {
         if (!(filter & ISMINE_SPENDABLE))
             return 0;
-        CWalletDB db(strWalletFile);
         secp_primitives::GroupElement pub;
         try {
             std::vector<unsigned char> encryptedValue;
@@ -1729,7 +1770,8 @@ CAmount CWallet::GetCredit(const CTxOut& txout, const isminefilter& filter) cons
         }
         uint256 hashPubcoin = primitives::GetPubCoinValueHash(pub);
         CHDMint dMint;
-        if (db.ReadHDMint(hashPubcoin, true, dMint)) {
+        // the tracker holds the updates which are not flushed to the database yet
+        if (zwallet && zwallet->GetTracker().GetHDMint(hashPubcoin, true, dMint)) {
             return dMint.GetAmount();
         }
         return 0;
@@ -2143,6 +2185,16 @@ void CWalletTx::GetAmounts(std::list<COutputEntry>& listReceived,
 
 }
 
+static bool IsBlockFilterQueryUsable(const GCSFilter::ElementSet& query, const CBlockIndex* pindex)
+{
+    if (query.size() <= MAX_BLOCK_FILTER_QUERY_SIZE)
+        return true;
+
+    LogPrintf("%s: block filter query of %u elements exceeds %u, reading all blocks from height %d\n",
+        __func__, query.size(), MAX_BLOCK_FILTER_QUERY_SIZE, pindex ? pindex->nHeight : -1);
+    return false;
+}
+
 /**
  * Scan the block chain (starting in pindexStart) for transactions
  * from or to us. If fUpdate is true, found transactions that already
@@ -2173,6 +2225,15 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex *pindexStart, bool f
             while (pindex && nTimeFirstKey && (pindex->GetBlockTime() < (nTimeFirstKey - 7200)))
                 pindex = chainActive.Next(pindex);
 
+        // with block filters only the blocks that may contain our transactions are read
+        GCSFilter::ElementSet filterQuery;
+        std::set<CKeyID> filterQueryKeys;
+        bool fUseFilters = pblockfilterdb != nullptr;
+        if (fUseFilters) {
+            GetBlockFilterQuery(filterQuery, filterQueryKeys);
+            fUseFilters = IsBlockFilterQueryUsable(filterQuery, pindex);
+        }
+
         ShowProgress(_("Rescanning..."), 0); // show rescan progress in GUI as dialog or on splashscreen, if -rescan on startup
         double dProgressStart = GuessVerificationProgress(chainParams.TxData(), pindex);
         double dProgressTip = GuessVerificationProgress(chainParams.TxData(), chainActive.Tip());
@@ -2188,14 +2249,50 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex *pindexStart, bool f
                 LogPrintf("Still rescanning. At block %d. Progress=%f\n", pindex->nHeight, GuessVerificationProgress(chainParams.TxData(), pindex));
             }
 
+            bool fHaveFilter = false, fMatch = true;
+            if (fUseFilters) {
+                std::vector<unsigned char> encodedFilter;
+                fHaveFilter = pblockfilterdb->ReadFilter(pindex->GetBlockHash(), encodedFilter);
+                if (fHaveFilter) {
+                    try {
+                        fMatch = GCSFilter(pindex->GetBlockHash(), std::move(encodedFilter)).MatchAny(filterQuery);
+                    } catch (const std::ios_base::failure&) {
+                        fHaveFilter = false;
+                    }
+                }
+            }
+
             CBlock block;
-            if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            if (!fMatch) {
+                if (!ret) {
+                    ret = pindex;
+                }
+            } else if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+                // blocks connected before the index was enabled get their filters on the first rescan
+                if (fUseFilters && !fHaveFilter)
+                    pblockfilterdb->WriteFilter(pindex->GetBlockHash(), BuildBlockFilter(block));
+
+                bool fInvolvesMe = false;
                 for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
-                    AddToWalletIfInvolvingMe(*block.vtx[posInBlock], pindex, posInBlock, fUpdate);
+                    const CTransaction& tx = *block.vtx[posInBlock];
+                    if (!AddToWalletIfInvolvingMe(tx, pindex, posInBlock, fUpdate))
+                        continue;
+                    fInvolvesMe = true;
+                    // spends of the new outputs are committed by their prevouts
+                    if (fUseFilters) {
+                        for (uint32_t i = 0; i < tx.vout.size(); i++)
+                            filterQuery.insert(GetFilterElement(COutPoint(tx.GetHash(), i)));
+                    }
                 }
                 if (!ret) {
                     ret = pindex;
                 }
+
+                // the keypool may have been topped up for the keys used by the new transactions
+                if (fUseFilters && fInvolvesMe) {
+                    GetBlockFilterQueryKeys(filterQuery, filterQueryKeys);
+                    fUseFilters = IsBlockFilterQueryUsable(filterQuery, pindex);
+                }
             } else {
                 ret = nullptr;
             }
@@ -2206,6 +2303,64 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex *pindexStart, bool f
     return ret;
 }
 
+void CWallet::GetBlockFilterQueryKeys(GCSFilter::ElementSet& query, std::set<CKeyID>& queryKeys) const
+{
+    AssertLockHeld(cs_wallet);
+
+    std::set<CKeyID> keys;
+    GetKeys(keys);
+    for (const CKeyID& keyid : keys) {
+        if (!queryKeys.insert(keyid).second)
+            continue;
+        query.insert(GetFilterElement(GetScriptForDestination(keyid)));
+        CPubKey pubkey;
+        if (GetPubKey(keyid, pubkey))
+            query.insert(GetFilterElement(GetScriptForRawPubKey(pubkey)));
+    }
+}
+
+void CWallet::GetBlockFilterQuery(GCSFilter::ElementSet& query, std::set<CKeyID>& queryKeys) const
+{
+    AssertLockHeld(cs_wallet);
+
+    GetBlockFilterQueryKeys(query, queryKeys);
+
+    {
+        LOCK(cs_KeyStore);
+        for (const auto& script : mapScripts) {
+            query.insert(GetFilterElement(GetScriptForDestination(script.first)));
+            query.insert(GetFilterElement(script.second));
+        }
+        for (const CScript& script : setWatchOnly)
+            query.insert(GetFilterElement(script));
+    }
+
+    // spends of transparent outputs are committed by their prevouts
+    for (const auto& entry : mapWallet) {
+        for (uint32_t i = 0; i < entry.second.tx->vout.size(); i++)
+            query.insert(GetFilterElement(COutPoint(entry.first, i)));
+    }
+
+    // mints are recognized by their pubcoins and spends by the serials in the wallet
+    CWalletDB walletdb(strWalletFile);
+    for (bool isLelantus : {false, true}) {
+        for (const CHDMint& dMint : walletdb.ListHDMints(isLelantus)) {
+            query.insert(GetFilterElement(dMint.GetPubCoinHash()));
+            query.insert(GetFilterElement(dMint.GetSerialHash()));
+        }
+    }
+
+    std::list<CSigmaSpendEntry> sigmaSpends;
+    walletdb.ListCoinSpendSerial(sigmaSpends);
+    for (const CSigmaSpendEntry& spend : sigmaSpends)
+        query.insert(GetFilterElement(primitives::GetSerialHash(spend.coinSerial)));
+
+    std::list<CLelantusSpendEntry> lelantusSpends;
+    walletdb.ListLelantusSpendSerial(lelantusSpends);
+    for (const CLelantusSpendEntry& spend : lelantusSpends)
+        query.insert(GetFilterElement(primitives::GetSerialHash(spend.coinSerial)));
+}
+
 void CWallet::ReacceptWalletTransactions()
 {
     // If transactions aren't being broadcasted, don't let them into local mempool either
@@ -3608,114 +3763,77 @@ bool CWallet::GetVinAndKeysFromOutput(COutput out, CTxIn &txinRet, CPubKey &pubK
 }
 
 //[firo]
-void CWallet::ListAvailableSigmaMintCoins(std::vector<COutput> &vCoins, bool fOnlyConfirmed) const {
-    EnsureMintWalletAvailable();
+void CWallet::ListAvailableMintCoins(std::vector<COutput> &vCoins, bool fOnlyConfirmed, bool fLelantus,
+        const std::unordered_set<secp_primitives::GroupElement>& ownCoins) const {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
 
-    vCoins.clear();
-    LOCK2(cs_main, cs_wallet);
-    std::list<CSigmaEntry> listOwnCoins;
-    CWalletDB walletdb(pwalletMain->strWalletFile);
-    listOwnCoins = zwallet->GetTracker().MintsAsSigmaEntries(true, false);
-    LogPrintf("listOwnCoins.size()=%s\n", listOwnCoins.size());
-    for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
-        const CWalletTx *pcoin = &(*it).second;
-//        LogPrintf("pcoin=%s\n", pcoin->GetHash().ToString());
+    for (const auto& mint : mapMintOutputs) {
+        if (mint.second.fLelantus != fLelantus || !ownCoins.count(mint.second.pubCoin)) {
+            continue;
+        }
+
+        auto it = mapWallet.find(mint.first.hash);
+        if (it == mapWallet.end()) {
+            continue;
+        }
+
+        const CWalletTx *pcoin = &it->second;
         if (!CheckFinalTx(*pcoin)) {
-            LogPrintf("!CheckFinalTx(*pcoin)=%s\n", !CheckFinalTx(*pcoin));
             continue;
         }
 
         if (fOnlyConfirmed && !pcoin->IsTrusted()) {
-            LogPrintf("fOnlyConfirmed = %s, !pcoin->IsTrusted()\n", fOnlyConfirmed, !pcoin->IsTrusted());
             continue;
         }
 
         if (pcoin->IsCoinBase() && pcoin->GetBlocksToMaturity() > 0) {
-            LogPrintf("Not trusted\n");
             continue;
         }
 
         int nDepth = pcoin->GetDepthInMainChain();
         if (nDepth < 0) {
-            LogPrintf("nDepth=%s\n", nDepth);
             continue;
         }
-        LogPrintf("pcoin->tx->vout.size()=%s\n", pcoin->tx->vout.size());
-
-        for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-            if (pcoin->tx->vout[i].scriptPubKey.IsSigmaMint()) {
-                CTxOut txout = pcoin->tx->vout[i];
-                secp_primitives::GroupElement pubCoin = sigma::ParseSigmaMintScript(
-                    txout.scriptPubKey);
-                LogPrintf("Pubcoin=%s\n", pubCoin.tostring());
-                // CHECKING PROCESS
-                BOOST_FOREACH(const CSigmaEntry &ownCoinItem, listOwnCoins) {
-                   if (ownCoinItem.value == pubCoin && ownCoinItem.IsUsed == false &&
-                        ownCoinItem.randomness != uint64_t(0) && ownCoinItem.serialNumber != uint64_t(0)) {
-                        vCoins.push_back(COutput(pcoin, i, nDepth, true, true));
-                        LogPrintf("-->OK\n");
-                    }
-                }
-            }
-        }
+
+        vCoins.push_back(COutput(pcoin, mint.first.n, nDepth, true, true));
     }
 }
 
-void CWallet::ListAvailableLelantusMintCoins(std::vector<COutput> &vCoins, bool fOnlyConfirmed) const {
+void CWallet::ListAvailableSigmaMintCoins(std::vector<COutput> &vCoins, bool fOnlyConfirmed) const {
     EnsureMintWalletAvailable();
 
     vCoins.clear();
     LOCK2(cs_main, cs_wallet);
-    std::list<CLelantusEntry> listOwnCoins;
-    CWalletDB walletdb(pwalletMain->strWalletFile);
-    listOwnCoins = zwallet->GetTracker().MintsAsLelantusEntries(true, false);
-    LogPrintf("listOwnCoins.size()=%s\n", listOwnCoins.size());
-    for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
-        const CWalletTx *pcoin = &(*it).second;
-//        LogPrintf("pcoin=%s\n", pcoin->GetHash().ToString());
-        if (!CheckFinalTx(*pcoin)) {
-            LogPrintf("!CheckFinalTx(*pcoin)=%s\n", !CheckFinalTx(*pcoin));
-            continue;
-        }
 
-        if (fOnlyConfirmed && !pcoin->IsTrusted()) {
-            LogPrintf("fOnlyConfirmed = %s, !pcoin->IsTrusted() = %s\n", fOnlyConfirmed, !pcoin->IsTrusted());
-            continue;
+    std::unordered_set<secp_primitives::GroupElement> ownCoins;
+    for (const CSigmaEntry &ownCoinItem : zwallet->GetTracker().MintsAsSigmaEntries(true, false)) {
+        if (ownCoinItem.IsUsed == false &&
+            ownCoinItem.randomness != uint64_t(0) && ownCoinItem.serialNumber != uint64_t(0)) {
+            ownCoins.insert(ownCoinItem.value);
         }
+    }
+    LogPrintf("ListAvailableSigmaMintCoins: %s own coins, %s mint outputs\n", ownCoins.size(), mapMintOutputs.size());
 
-        if (pcoin->IsCoinBase() && pcoin->GetBlocksToMaturity() > 0) {
-            LogPrintf("Not trusted\n");
-            continue;
-        }
+    ListAvailableMintCoins(vCoins, fOnlyConfirmed, false, ownCoins);
+}
 
-        int nDepth = pcoin->GetDepthInMainChain();
-        if (nDepth < 0) {
-            LogPrintf("nDepth=%s\n", nDepth);
-            continue;
-        }
-        LogPrintf("pcoin->tx->vout.size()=%s\n", pcoin->tx->vout.size());
+void CWallet::ListAvailableLelantusMintCoins(std::vector<COutput> &vCoins, bool fOnlyConfirmed) const {
+    EnsureMintWalletAvailable();
 
-        for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-            if (pcoin->tx->vout[i].scriptPubKey.IsLelantusMint() || pcoin->tx->vout[i].scriptPubKey.IsLelantusJMint()) {
-                CTxOut txout = pcoin->tx->vout[i];
-                secp_primitives::GroupElement pubCoin;
-                try {
-                    lelantus::ParseLelantusMintScript(txout.scriptPubKey, pubCoin);
-                } catch (std::invalid_argument &) {
-                    continue;
-                }
-                LogPrintf("Pubcoin=%s\n", pubCoin.tostring());
-                // CHECKING PROCESS
-                BOOST_FOREACH(const CLelantusEntry& ownCoinItem, listOwnCoins) {
-                    if (ownCoinItem.value == pubCoin && ownCoinItem.IsUsed == false &&
-                        !ownCoinItem.randomness.isZero() && !ownCoinItem.serialNumber.isZero()) {
-                        vCoins.push_back(COutput(pcoin, i, nDepth, true, true));
-                        LogPrintf("-->OK\n");
-                    }
-                }
-            }
+    vCoins.clear();
+    LOCK2(cs_main, cs_wallet);
+
+    std::unordered_set<secp_primitives::GroupElement> ownCoins;
+    for (const CLelantusEntry& ownCoinItem : zwallet->GetTracker().MintsAsLelantusEntries(true, false)) {
+        if (ownCoinItem.IsUsed == false &&
+            !ownCoinItem.randomness.isZero() && !ownCoinItem.serialNumber.isZero()) {
+            ownCoins.insert(ownCoinItem.value);
         }
     }
+    LogPrintf("ListAvailableLelantusMintCoins: %s own coins, %s mint outputs\n", ownCoins.size(), mapMintOutputs.size());
+
+    ListAvailableMintCoins(vCoins, fOnlyConfirmed, true, ownCoins);
 }
 
 static void ApproximateBestSubset(std::vector<std::pair<CAmount, std::pair<const CWalletTx*,unsigned int> > >vValue, const CAmount& nTotalLower, const CAmount& nTargetValue,
@@ -4436,8 +4554,10 @@ bool CWallet::EraseFromWallet(uint256 hash) {
         return false;
     {
         LOCK(cs_wallet);
-        if (mapWallet.erase(hash))
+        if (mapWallet.erase(hash)) {
+            RemoveFromMintOutputs(hash);
             CWalletDB(strWalletFile).EraseTx(hash);
+        }
     }
     return true;
 }
@@ -5456,18 +5576,19 @@ CWalletTx CWallet::CreateLelantusJoinSplitTransaction(
 std::pair<CAmount, unsigned int> CWallet::EstimateJoinSplitFee(
         CAmount required,
         bool subtractFeeFromAmount,
-        std::list<CSigmaEntry> sigmaCoins,
-        std::list<CLelantusEntry> coins,
+        const std::list<CSigmaEntry>& sigmaCoins,
+        const std::list<CLelantusEntry>& coins,
         const CCoinControl *coinControl) {
+    JoinSplitCoinSelector selector(*this, sigmaCoins, coins, coinControl);
+    return EstimateJoinSplitFee(required, subtractFeeFromAmount, selector);
+}
+
+std::pair<CAmount, unsigned int> CWallet::EstimateJoinSplitFee(
+        CAmount required,
+        bool subtractFeeFromAmount,
+        JoinSplitCoinSelector& selector) {
     CAmount fee;
     unsigned size;
-    std::vector<CLelantusEntry> spendCoins;
-    std::vector<CSigmaEntry> sigmaSpendCoins;
-
-    CAmount availableSigmaBalance(0);
-    for (auto coin : sigmaCoins) {
-        availableSigmaBalance += coin.get_denomination_value();
-    }
 
     for (fee = payTxFee.GetFeePerK();;) {
         CAmount currentRequired = required;
@@ -5475,38 +5596,27 @@ std::pair<CAmount, unsigned int> CWallet::EstimateJoinSplitFee(
         if (!subtractFeeFromAmount)
             currentRequired += fee;
 
-        spendCoins.clear();
-        sigmaSpendCoins.clear();
-        const auto &consensusParams = Params().GetConsensus();
-        CAmount changeToMint = 0;
-
-        std::vector<sigma::CoinDenomination> denomChanges;
+        // only the number of inputs matters here, the sigma selection is usually the same for every fee
+        size_t inputs = 0;
         try {
-            if (availableSigmaBalance > 0) {
-                CAmount inputFromSigma;
-                if (currentRequired > availableSigmaBalance)
-                    inputFromSigma = availableSigmaBalance;
-                else
-                    inputFromSigma = currentRequired;
-                this->GetCoinsToSpend(inputFromSigma, sigmaSpendCoins, denomChanges, sigmaCoins, //try to spend sigma first
-                                       consensusParams.nMaxLelantusInputPerTransaction,
-                                       consensusParams.nMaxValueLelantusSpendPerTransaction, coinControl);
+            if (selector.GetSigmaBalance() > 0) {
+                CAmount inputFromSigma = std::min(currentRequired, selector.GetSigmaBalance());
+                std::vector<CSigmaEntry> sigmaSpendCoins;
+                std::vector<sigma::CoinDenomination> denomChanges;
+                selector.SelectSigmaCoins(inputFromSigma, sigmaSpendCoins, denomChanges); //try to spend sigma first
+                inputs += sigmaSpendCoins.size();
                 currentRequired -= inputFromSigma;
             }
 
             if (currentRequired > 0) {
-                if (!this->GetCoinsToJoinSplit(currentRequired, spendCoins, changeToMint, coins,
-                                                consensusParams.nMaxLelantusInputPerTransaction,
-                                                consensusParams.nMaxValueLelantusSpendPerTransaction, coinControl)) {
-                    return std::make_pair(0, 0);
-                }
+                inputs += selector.CountLelantusCoins(currentRequired);
             }
         } catch (std::runtime_error const &) {
         }
 
         // 1054 is constant part, mainly Schnorr and Range proofs, 2560 is for each sigma/aux data
         // 179 other parts of tx, assuming 1 utxo and 1 jmint
-        size = 1054 + 2560 * (spendCoins.size() + sigmaSpendCoins.size()) + 179;
+        size = 1054 + 2560 * inputs + 179;
         CAmount feeNeeded = CWallet::GetMinimumFee(size, nTxConfirmTarget, mempool);
 
         if (fee >= feeNeeded) {
@@ -5670,7 +5780,7 @@ bool CWallet::GetMint(const uint256& hashSerial, CSigmaEntry& sigmaEntry, bool f
     CWalletDB walletdb(strWalletFile);
      if (meta.isDeterministic) {
         CHDMint dMint;
-        if (!walletdb.ReadHDMint(meta.GetPubCoinValueHash(), false, dMint))
+        if (!zwallet->GetTracker().GetHDMint(meta.GetPubCoinValueHash(), false, dMint))
             return error("%s: failed to read deterministic mint", __func__);
         if (!zwallet->RegenerateMint(walletdb, dMint, sigmaEntry, forEstimation))
             return error("%s: failed to generate mint", __func__);
@@ -5698,7 +5808,7 @@ bool CWallet::GetMint(const uint256& hashSerial, CLelantusEntry& mint, bool forE
     CWalletDB walletdb(strWalletFile);
 
     CHDMint dMint;
-    if (!walletdb.ReadHDMint(meta.GetPubCoinValueHash(), true, dMint))
+    if (!zwallet->GetTracker().GetHDMint(meta.GetPubCoinValueHash(), true, dMint))
         return error("%s: failed to read deterministic Lelantus mint", __func__);
     if (!zwallet->RegenerateMint(walletdb, dMint, mint, forEstimation))
         return error("%s: failed to generate Lelantus mint", __func__);
@@ -5839,6 +5949,13 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
     if (nZapSelectTxRet != DB_LOAD_OK)
         return nZapSelectTxRet;
 
+    {
+        LOCK(cs_wallet);
+        for (const uint256& hash : vHashOut) {
+            RemoveFromMintOutputs(hash);
+        }
+    }
+
     MarkDirty();
 
     return DB_LOAD_OK;
@@ -6393,7 +6510,13 @@ bool CWallet::HasMasternode(){
 
 void CWallet::ListProTxCoins(std::vector<COutPoint>& vOutpts)
 {
-    auto mnList = deterministicMNManager->GetListForBlock(chainActive.Tip());
+    AssertLockHeld(cs_main);
+    ListProTxCoins(vOutpts, chainActive.Tip());
+}
+
+void CWallet::ListProTxCoins(std::vector<COutPoint>& vOutpts, const CBlockIndex* pindex)
+{
+    auto mnList = deterministicMNManager->GetListForBlock(pindex);
 
     AssertLockHeld(cs_wallet);
     for (const auto &o : setWalletUTXO) {
@@ -6527,6 +6650,7 @@ std::string CWallet::GetWalletHelpString(bool showDebug)
                                " " + strprintf(_("(default: %u)"), DEFAULT_USE_MNEMONIC));
     strUsage += HelpMessageOpt("-mnemonic=<text>", _("User defined mnemonic for HD wallet (bip39). Only has effect during wallet creation/first start (default: randomly generated)"));
     strUsage += HelpMessageOpt("-mnemonicpassphrase=<text>", _("User defined mnemonic passphrase for HD wallet (BIP39). Only has effect during wallet creation/first start (default: empty string)"));
+    strUsage += HelpMessageOpt("-joinsplitthreads=<n>", strprintf(_("Number of threads creating joinsplit proofs of asynchronous joinsplit calls (default: %u)"), DEFAULT_JOINSPLIT_THREADS));
     strUsage += HelpMessageOpt("-hdseed=<hex>", _("User defined seed for HD wallet (should be in hex). Only has effect during wallet creation/first start (default: randomly generated)"));
     strUsage += HelpMessageOpt("-batching", _("In case of sync/reindex verifies sigma/lelantus proofs with batch verification, default: true"));
     strUsage += HelpMessageOpt("-walletrbf", strprintf(_("Send transactions with full-RBF opt-in enabled (default: %u)"), DEFAULT_WALLET_RBF));
@@ -6546,6 +6670,7 @@ std::string CWallet::GetWalletHelpString(bool showDebug)
         strUsage += HelpMessageOpt("-flushwallet", strprintf("Run a thread to flush wallet periodically (default: %u)", DEFAULT_FLUSHWALLET));
         strUsage += HelpMessageOpt("-privdb", strprintf("Sets the DB_PRIVATE flag in the wallet db environment (default: %u)", DEFAULT_WALLET_PRIVDB));
         strUsage += HelpMessageOpt("-walletrejectlongchains", strprintf(_("Wallet will not create transactions that violate mempool chain limits (default: %u)"), DEFAULT_WALLET_REJECT_LONG_CHAINS));
+        strUsage += HelpMessageOpt("-verifyjoinsplit", strprintf("Verify the proofs of created joinsplit transactions before they are sent (default: %u)", DEFAULT_VERIFY_JOINSPLIT));
     }
 
     return strUsage;
@@ -6837,6 +6962,8 @@ void CWallet::postInitProcess(boost::thread_group& threadGroup)
     if (!CWallet::fFlushThreadRunning.exchange(true)) {
         threadGroup.create_thread(ThreadFlushWalletDB);
     }
+
+    joinSplitJobs.Start(GetArg("-joinsplitthreads", DEFAULT_JOINSPLIT_THREADS));
 }
 
 bool CWallet::ParameterInteraction()
@@ -7205,13 +7332,7 @@ boost::optional<bip47::CPaymentCodeDescription> CWallet::FindPcode(CBitcoinAddre
     bip47wallet->enumerateReceivers(
         [&address, &result](bip47::CAccountReceiver & rec)->bool
         {
-            bip47::MyAddrContT addrs = rec.getMyUsedAddresses();
-            if (std::find_if(addrs.begin(), addrs.end(), bip47::FindByAddress(address)) != addrs.end())
-            {
-                result.emplace(rec.getAccountNum(), rec.getMyPcode(), rec.getLabel(), rec.getMyPcode().getNotificationAddress(), bip47::CPaymentCodeSide::Receiver);
-                return false;
-            }
-            addrs = rec.getMyNextAddresses();
+            bip47::MyAddrContT const & addrs = rec.getMyUsedAddresses();
             if (std::find_if(addrs.begin(), addrs.end(), bip47::FindByAddress(address)) != addrs.end())
             {
                 result.emplace(rec.getAccountNum(), rec.getMyPcode(), rec.getLabel(), rec.getMyPcode().getNotificationAddress(), bip47::CPaymentCodeSide::Receiver);
@@ -7220,6 +7341,11 @@ boost::optional<bip47::CPaymentCodeDescription> CWallet::FindPcode(CBitcoinAddre
             return true;
         }
     );
+    if (!result) {
+        bip47::CAccountReceiver const * rec = bip47wallet->findReceiverByAddress(address);
+        if (rec)
+            result.emplace(rec->getAccountNum(), rec->getMyPcode(), rec->getLabel(), rec->getMyPcode().getNotificationAddress(), bip47::CPaymentCodeSide::Receiver);
+    }
     bip47wallet->enumerateSenders(
         [&address, &result, this](bip47::CAccountSender & sender)->bool
         {
@@ -7248,19 +7374,7 @@ bip47::CAccountReceiver const * CWallet::AddressUsed(CBitcoinAddress const & add
     if(!bip47wallet)
         return result;
 
-    bip47wallet->enumerateReceivers(
-        [&address, &result](bip47::CAccountReceiver & rec)->bool
-        {
-            bip47::MyAddrContT addrs = rec.getMyNextAddresses();
-            if (std::find_if(addrs.begin(), addrs.end(), bip47::FindByAddress(address)) != addrs.end())
-            {
-                rec.addressUsed(address);
-                result = &rec;
-                return false;
-            }
-            return true;
-        }
-    );
+    result = bip47wallet->markAddressUsed(address);
     if (result)
         CWalletDB(strWalletFile).WriteBip47Account(*result);
     return result;
@@ -7269,7 +7383,6 @@ bip47::CAccountReceiver const * CWallet::AddressUsed(CBitcoinAddress const & add
 void CWallet::HandleBip47Transaction(CWalletTx const & wtx)
 {
     bip47::Bytes masked = bip47::utils::GetMaskedPcode(wtx.tx);
-    CKey key;
     bip47::CAccountReceiver * accFound = nullptr;
     int nRequired = 0;
     std::vector<CTxDestination> addresses;
@@ -7295,19 +7408,11 @@ void CWallet::HandleBip47Transaction(CWalletTx const & wtx)
         LogBip47("Cannot extract destinations for tx: %s\n", wtx.tx->GetHash().ToString());
         goto notifTxExit;
     }
-    bip47wallet->enumerateReceivers(
-        [&key, &addresses, &accFound](bip47::CAccountReceiver & acc)->bool
-        {
-            for (CBitcoinAddress addr : addresses) {
-                if(acc.getMyNotificationAddress() == addr) {
-                    key = acc.getMyNextAddresses()[0].second;
-                    accFound = &acc;
-                    return false;
-                }
-            }
-            return true;
-        }
-    );
+    for (CBitcoinAddress addr : addresses) {
+        accFound = bip47wallet->findReceiverByAddress(addr, true);
+        if (accFound)
+            break;
+    }
     if(!accFound) {
         LogBip47("There was no account set up to receive payments on address: %s\n", CBitcoinAddress(addresses[0]).ToString());
         goto notifTxExit;
@@ -7320,6 +7425,7 @@ void CWallet::HandleBip47Transaction(CWalletTx const & wtx)
 notifTxExit:
     if (success) {
         LogBip47("The payment code has been accepted: %s\n", accFound->lastPcode().toString());
+        bip47wallet->updateAddressIndex(*accFound);
         HandleSecretAddresses(*this, *accFound);
         CWalletDB(strWalletFile).WriteBip47Account(*accFound);
         LockCoin(COutPoint(wtx.tx->GetHash(), std::distance(wtx.tx->vout.begin(), iregout))); //Locking the notif tx output to be spent only manually
@@ -7428,6 +7534,7 @@ size_t CWallet::SetUsedAddressNumber(bip47::CPaymentCode const & pcode, size_t n
         }
     );
     if(resutRec) {
+        bip47wallet->updateAddressIndex(*receiver);
         HandleSecretAddresses(*this, *receiver);
         return *resutRec;
     }
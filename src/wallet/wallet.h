@@ -40,6 +40,7 @@
 #include <stdint.h>
 #include <string>
 #include <utility>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
@@ -75,6 +76,10 @@ static const bool DEFAULT_SPEND_ZEROCONF_CHANGE = true;
 static const bool DEFAULT_SEND_FREE_TRANSACTIONS = false;
 //! Default for -walletrejectlongchains
 static const bool DEFAULT_WALLET_REJECT_LONG_CHAINS = false;
+//! Default for -verifyjoinsplit
+static const bool DEFAULT_VERIFY_JOINSPLIT = true;
+//! Default for -joinsplitthreads
+static const int DEFAULT_JOINSPLIT_THREADS = 2;
 //! -txconfirmtarget default
 static const unsigned int DEFAULT_TX_CONFIRM_TARGET = 6;
 //! -walletrbf default
@@ -82,6 +87,8 @@ static const bool DEFAULT_WALLET_RBF = false;
 //! Largest (in bytes) free transaction we're willing to create
 static const unsigned int MAX_FREE_TRANSACTION_CREATE_SIZE = 1000;
 static const bool DEFAULT_WALLETBROADCAST = true;
+//! Matching a filter hashes every element of the query, so block filters are not used for larger wallets
+static const size_t MAX_BLOCK_FILTER_QUERY_SIZE = 20000;
 static const bool DEFAULT_DISABLE_WALLET = false;
 
 static const bool DEFAULT_UPGRADE_CHAIN = false;
@@ -528,6 +535,12 @@ public:
 };
 
 
+/** Sigma or Lelantus mint output of a wallet transaction with its parsed public coin */
+struct CWalletMintOutput
+{
+    bool fLelantus;
+    secp_primitives::GroupElement pubCoin;
+};
 
 
 /** Private key that includes an expiration date in case it never gets used. */
@@ -640,6 +653,7 @@ private:
 };
 
 class LelantusJoinSplitBuilder;
+class JoinSplitCoinSelector;
 
 /**
  * A CWallet is an extension of a keystore, which also maintains a set of transactions and balances,
@@ -686,6 +700,14 @@ private:
 
     std::set<COutPoint> setWalletUTXO;
 
+    /**
+     * Mint outputs of the transactions in mapWallet, so listing the mints doesn't need to
+     * go through every transaction and decompress the public coins again.
+     */
+    std::map<COutPoint, CWalletMintOutput> mapMintOutputs;
+    void AddToMintOutputs(const CWalletTx& wtx);
+    void RemoveFromMintOutputs(const uint256& hash);
+
     /* Mark a transaction (and its in-wallet descendants) as conflicting with a particular block. */
     void MarkConflicted(const uint256& hashBlock, const uint256& hashTx);
 
@@ -837,6 +859,8 @@ public:
     void UnlockAllCoins();
     void ListLockedCoins(std::vector<COutPoint>& vOutpts);
     void ListProTxCoins(std::vector<COutPoint>& vOutpts);
+    /** Lists the coins of the wallet which are collaterals of the masternode list of a block, doesn't need cs_main */
+    void ListProTxCoins(std::vector<COutPoint>& vOutpts, const CBlockIndex* pindex);
 
     bool HasMasternode();
 
@@ -909,6 +933,13 @@ public:
     void SyncTransaction(const CTransaction& tx, const CBlockIndex *pindex, int posInBlock) override;
     bool AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlockIndex* pIndex, int posInBlock, bool fUpdate);
     CBlockIndex* ScanForWalletTransactions(CBlockIndex* pindexStart, bool fUpdate = false, bool fRecoverMnemonic = false);
+    /**
+     * Adds the block filter elements of everything AddToWalletIfInvolvingMe() can recognize to query, see
+     * GetBlockFilterElements(). Keys already in queryKeys are skipped so the query can be extended after new
+     * transactions topped up the keypool.
+     */
+    void GetBlockFilterQuery(std::set<std::vector<unsigned char>>& query, std::set<CKeyID>& queryKeys) const;
+    void GetBlockFilterQueryKeys(std::set<std::vector<unsigned char>>& query, std::set<CKeyID>& queryKeys) const;
     void ReacceptWalletTransactions();
     void ResendWalletTransactions(int64_t nBestBlockTime, CConnman* connman) override;
     std::vector<uint256> ResendWalletTransactionsBefore(int64_t nTime, CConnman* connman);
@@ -999,6 +1030,9 @@ public:
      */
     void ListAvailableSigmaMintCoins(std::vector <COutput> &vCoins, bool fOnlyConfirmed) const;
     void ListAvailableLelantusMintCoins(std::vector<COutput> &vCoins, bool fOnlyConfirmed) const;
+    // Lists the mint outputs of mapWallet which are in ownCoins, the Sigma ones unless fLelantus is set
+    void ListAvailableMintCoins(std::vector<COutput> &vCoins, bool fOnlyConfirmed, bool fLelantus,
+            const std::unordered_set<secp_primitives::GroupElement>& ownCoins) const;
 
     bool CreateMintTransaction(const std::vector<CRecipient>& vecSend, CWalletTx& wtxNew, CReserveKey& reservekey, CAmount& nFeeRet, int& nChangePosInOut,
                            std::string& strFailReason, const CCoinControl *coinControl = NULL, bool sign = true);
@@ -1053,7 +1087,8 @@ public:
 
     std::vector<CLelantusEntry> JoinSplitLelantus(const std::vector<CRecipient>& recipients, const std::vector<CAmount>& newMints, CWalletTx& result);
 
-    std::pair<CAmount, unsigned int> EstimateJoinSplitFee(CAmount required, bool subtractFeeFromAmount, std::list<CSigmaEntry> sigmaCoins, std::list<CLelantusEntry> coins, const CCoinControl *coinControl);
+    std::pair<CAmount, unsigned int> EstimateJoinSplitFee(CAmount required, bool subtractFeeFromAmount, const std::list<CSigmaEntry>& sigmaCoins, const std::list<CLelantusEntry>& coins, const CCoinControl *coinControl);
+    std::pair<CAmount, unsigned int> EstimateJoinSplitFee(CAmount required, bool subtractFeeFromAmount, JoinSplitCoinSelector& selector);
 
     bool GetMint(const uint256& hashSerial, CSigmaEntry& sigmaEntry, bool forEstimation = false) const;
 
@@ -20,3 +20,13 @@ bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/
 {
     return true;
 }
+
+bool CZMQAbstractNotifier::NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &/*update*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifySigmaBlock(const sigma::CSigmaBlockUpdate &/*update*/)
+{
+    return true;
+}
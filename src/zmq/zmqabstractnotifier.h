@@ -10,6 +10,9 @@
 class CBlockIndex;
 class CZMQAbstractNotifier;
 
+namespace lelantus { struct CLelantusBlockUpdate; }
+namespace sigma { struct CSigmaBlockUpdate; }
+
 typedef CZMQAbstractNotifier* (*CZMQNotifierFactory)();
 
 class CZMQAbstractNotifier
@@ -34,6 +37,8 @@ public:
 
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    virtual bool NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update);
+    virtual bool NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update);
 
 protected:
     void *psocket;
@@ -39,6 +39,12 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["publelantusmint"] = CZMQAbstractNotifier::Create<CZMQPublishLelantusMintNotifier>;
+    factories["publelantusspend"] = CZMQAbstractNotifier::Create<CZMQPublishLelantusSpendNotifier>;
+    factories["publelantusgroup"] = CZMQAbstractNotifier::Create<CZMQPublishLelantusGroupNotifier>;
+    factories["pubsigmamint"] = CZMQAbstractNotifier::Create<CZMQPublishSigmaMintNotifier>;
+    factories["pubsigmaspend"] = CZMQAbstractNotifier::Create<CZMQPublishSigmaSpendNotifier>;
+    factories["pubsigmagroup"] = CZMQAbstractNotifier::Create<CZMQPublishSigmaGroupNotifier>;
 
     for (std::map<std::string, CZMQNotifierFactory>::const_iterator i=factories.begin(); i!=factories.end(); ++i)
     {
@@ -164,3 +170,37 @@ void CZMQNotificationInterface::SyncTransaction(const CTransaction& tx, const CB
         }
     }
 }
+
+void CZMQNotificationInterface::NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifyLelantusBlock(update))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
+void CZMQNotificationInterface::NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (notifier->NotifySigmaBlock(update))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
@@ -26,6 +26,8 @@ protected:
     // CValidationInterface
     void SyncTransaction(const CTransaction& tx, const CBlockIndex *pindex, int posInBlock);
     void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload);
+    void NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update);
+    void NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update);
 
 private:
     CZMQNotificationInterface();
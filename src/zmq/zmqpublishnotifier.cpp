@@ -8,6 +8,8 @@
 #include "validation.h"
 #include "util.h"
 #include "rpc/server.h"
+#include "lelantus.h"
+#include "sigma.h"
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
@@ -15,6 +17,12 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_LELANTUSMINT  = "lelantusmint";
+static const char *MSG_LELANTUSSPEND = "lelantusspend";
+static const char *MSG_LELANTUSGROUP = "lelantusgroup";
+static const char *MSG_SIGMAMINT     = "sigmamint";
+static const char *MSG_SIGMASPEND    = "sigmaspend";
+static const char *MSG_SIGMAGROUP    = "sigmagroup";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -191,3 +199,46 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+// Publishes the changes of a block, blocks not having any of them are skipped
+template <typename Update, typename Changes>
+static bool SendBlockUpdate(CZMQAbstractPublishNotifier *notifier, const char *command, const Update &update, const Changes &changes)
+{
+    if (changes.empty())
+        return true;
+
+    LogPrint("zmq", "zmq: Publish %s %s\n", command, update.blockHash.GetHex());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << update.blockHash << update.nHeight << update.fConnected << changes;
+    return notifier->SendMessage(command, &(*ss.begin()), ss.size());
+}
+
+bool CZMQPublishLelantusMintNotifier::NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update)
+{
+    return SendBlockUpdate(this, MSG_LELANTUSMINT, update, update.mints);
+}
+
+bool CZMQPublishLelantusSpendNotifier::NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update)
+{
+    return SendBlockUpdate(this, MSG_LELANTUSSPEND, update, update.spentSerials);
+}
+
+bool CZMQPublishLelantusGroupNotifier::NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update)
+{
+    return SendBlockUpdate(this, MSG_LELANTUSGROUP, update, update.newCoinGroups);
+}
+
+bool CZMQPublishSigmaMintNotifier::NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update)
+{
+    return SendBlockUpdate(this, MSG_SIGMAMINT, update, update.mints);
+}
+
+bool CZMQPublishSigmaSpendNotifier::NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update)
+{
+    return SendBlockUpdate(this, MSG_SIGMASPEND, update, update.spentSerials);
+}
+
+bool CZMQPublishSigmaGroupNotifier::NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update)
+{
+    return SendBlockUpdate(this, MSG_SIGMAGROUP, update, update.newCoinGroups);
+}
@@ -52,4 +52,42 @@ public:
     bool NotifyTransaction(const CTransaction &transaction);
 };
 
+/* Lelantus and Sigma notifiers publish the serialized block hash, height and a connected flag (false when the block
+   was disconnected and its changes are reverted), followed by the serialized vector of the block's changes */
+class CZMQPublishLelantusMintNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update);
+};
+
+class CZMQPublishLelantusSpendNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update);
+};
+
+class CZMQPublishLelantusGroupNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyLelantusBlock(const lelantus::CLelantusBlockUpdate &update);
+};
+
+class CZMQPublishSigmaMintNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update);
+};
+
+class CZMQPublishSigmaSpendNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update);
+};
+
+class CZMQPublishSigmaGroupNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifySigmaBlock(const sigma::CSigmaBlockUpdate &update);
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H